@@ -211,6 +211,35 @@ int base58_encode_check(const uint8_t *data, int datalen, HasherType hasher_type
 	return success ? res : 0;
 }
 
+int base58_encode_check_batch(const uint8_t * const *data, int datalen, size_t count, HasherType hasher_type, char * const *str, int strsize, int *res)
+{
+	if (datalen > 128) {
+		return 0;
+	}
+	uint8_t buf[HASHER_BATCH_SIZE][datalen + 32];
+	HasherBatch batch;
+	int encoded = 0;
+	hasher_batch_Init(&batch, hasher_type);
+	for (size_t i = 0; i < count; i += HASHER_BATCH_SIZE) {
+		size_t n = count - i < HASHER_BATCH_SIZE ? count - i : HASHER_BATCH_SIZE;
+		for (size_t j = 0; j < n; j++) {
+			memcpy(buf[j], data[i + j], datalen);
+			hasher_batch_Submit(&batch, buf[j], datalen, buf[j] + datalen);
+		}
+		hasher_batch_Flush(&batch);
+		for (size_t j = 0; j < n; j++) {
+			size_t sz = strsize;
+			bool success = b58enc(str[i + j], &sz, buf[j], datalen + 4);
+			if (res) {
+				res[i + j] = success ? sz : 0;
+			}
+			encoded += success;
+		}
+	}
+	memzero(buf, sizeof(buf));
+	return encoded;
+}
+
 int base58_decode_check(const char *str, HasherType hasher_type, uint8_t *data, int datalen)
 {
 	if (datalen > 128) {
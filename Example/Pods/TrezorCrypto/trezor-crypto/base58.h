@@ -33,6 +33,9 @@ extern const char b58digits_ordered[];
 extern const int8_t b58digits_map[];
 
 int base58_encode_check(const uint8_t *data, int len, HasherType hasher_type, char *str, int strsize);
+// Encode count equally sized buffers; res (may be NULL) receives each result of base58_encode_check.
+// Returns the number of buffers that were encoded successfully.
+int base58_encode_check_batch(const uint8_t * const *data, int datalen, size_t count, HasherType hasher_type, char * const *str, int strsize, int *res);
 int base58_decode_check(const char *str, HasherType hasher_type, uint8_t *data, int datalen);
 
 // Private
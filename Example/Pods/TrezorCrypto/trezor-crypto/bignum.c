@@ -1078,6 +1078,394 @@ size_t bn_format(const bignum256 *amnt, const char *prefix, const char *suffix,
 	return prefixlen + len - 1;
 }
 
+/* Fast decimal conversion.
+ *
+ * The amount is split into decimal chunks first: with a 128 bit type the
+ * number is held in four 64 bit words and divided by 10^19, where each
+ * 128/64 bit division is replaced by a multiplication with a precomputed
+ * reciprocal (10^19 is already normalized, its top bit is set).  Without
+ * one the base 2^30 digits are divided by 10^9 instead.  Chunks are then
+ * printed two digits at a time, and the decimal point, rounding and
+ * trailing zeros are applied to the digit string.  Nothing is allocated,
+ * so arrays of amounts can be formatted into caller provided storage.
+ */
+
+#if defined(__SIZEOF_INT128__)
+#define BN_DEC_CHUNK_DIGITS 19
+#define BN_DEC_CHUNKS 5
+typedef uint64_t bn_dec_chunk;
+#else
+#define BN_DEC_CHUNK_DIGITS 9
+#define BN_DEC_CHUNKS 9
+typedef uint32_t bn_dec_chunk;
+#endif
+
+// number of decimal digits produced by bn_to_decimal (2^256 has 78)
+#define BN_DEC_DIGITS (BN_DEC_CHUNK_DIGITS * BN_DEC_CHUNKS)
+
+static const char bn_digit_pairs[201] =
+	"00010203040506070809"
+	"10111213141516171819"
+	"20212223242526272829"
+	"30313233343536373839"
+	"40414243444546474849"
+	"50515253545556575859"
+	"60616263646566676869"
+	"70717273747576777879"
+	"80818283848586878889"
+	"90919293949596979899";
+
+static const bn_dec_chunk bn_pow10[BN_DEC_CHUNK_DIGITS + 1] = {
+	1u, 10u, 100u, 1000u, 10000u, 100000u, 1000000u, 10000000u, 100000000u, 1000000000u,
+#if defined(__SIZEOF_INT128__)
+	10000000000ull, 100000000000ull, 1000000000000ull, 10000000000000ull,
+	100000000000000ull, 1000000000000000ull, 10000000000000000ull,
+	100000000000000000ull, 1000000000000000000ull, 10000000000000000000ull,
+#endif
+};
+
+#if defined(__SIZEOF_INT128__)
+typedef unsigned __int128 bn_uint128;
+
+// 10^19 and floor((2^128 - 1) / 10^19) - 2^64
+#define BN_DEC_CHUNK_BASE 10000000000000000000ull
+#define BN_DEC_CHUNK_RECIPROCAL 0xd83c94fb6d2ac34aull
+
+// (hi * 2^64 + lo) / 10^19 for hi < 10^19, remainder in *r
+// (Moeller and Granlund, "Improved division by invariant integers")
+static inline uint64_t bn_div_chunk(uint64_t hi, uint64_t lo, uint64_t *r)
+{
+	bn_uint128 q = (bn_uint128)BN_DEC_CHUNK_RECIPROCAL * hi;
+	q += ((bn_uint128)hi << 64) | lo;
+	uint64_t q1 = (uint64_t)(q >> 64) + 1;
+	uint64_t q0 = (uint64_t)q;
+	uint64_t rem = lo - q1 * BN_DEC_CHUNK_BASE;
+	if (rem > q0) {
+		q1--;
+		rem += BN_DEC_CHUNK_BASE;
+	}
+	if (rem >= BN_DEC_CHUNK_BASE) {
+		q1++;
+		rem -= BN_DEC_CHUNK_BASE;
+	}
+	*r = rem;
+	return q1;
+}
+
+// split a normalized number into decimal chunks, least significant first
+static void bn_to_chunks(const bignum256 *a, bn_dec_chunk chunks[BN_DEC_CHUNKS])
+{
+	uint64_t w[4] = {0};
+	int i, j, top = 3;
+
+	for (i = 0; i < 9; i++) {
+		unsigned int s = 30 * i;
+		w[s / 64] |= (uint64_t)a->val[i] << (s % 64);
+		if (s % 64 > 34 && s / 64 < 3) {
+			w[s / 64 + 1] |= (uint64_t)a->val[i] >> (64 - s % 64);
+		}
+	}
+
+	for (j = 0; j < BN_DEC_CHUNKS - 1; j++) {
+		uint64_t r = 0;
+		while (top > 0 && w[top] == 0) {
+			top--;
+		}
+		for (i = top; i >= 0; i--) {
+			w[i] = bn_div_chunk(r, w[i], &r);
+		}
+		chunks[j] = r;
+	}
+	// 2^256 < 10^(19*4) * 10^19, so the quotient is the last chunk
+	chunks[BN_DEC_CHUNKS - 1] = w[0];
+}
+
+// a = a * 10^digits + chunk, returns false on overflow past 256 bits
+static bool bn_mul_add_chunk(uint64_t w[4], unsigned int digits, uint64_t chunk)
+{
+	uint64_t carry = chunk;
+	for (int i = 0; i < 4; i++) {
+		bn_uint128 t = (bn_uint128)w[i] * bn_pow10[digits] + carry;
+		w[i] = (uint64_t)t;
+		carry = (uint64_t)(t >> 64);
+	}
+	return carry == 0;
+}
+#else
+// split a normalized number into decimal chunks, least significant first
+static void bn_to_chunks(const bignum256 *a, bn_dec_chunk chunks[BN_DEC_CHUNKS])
+{
+	bignum256 val;
+	int i, j;
+
+	memcpy(&val, a, sizeof(bignum256));
+	for (j = 0; j < BN_DEC_CHUNKS; j++) {
+		uint64_t rem = 0;
+		for (i = 8; i >= 0; i--) {
+			uint64_t tmp = (rem << 30) | val.val[i];
+			val.val[i] = (uint32_t)(tmp / 1000000000u);
+			rem = tmp % 1000000000u;
+		}
+		chunks[j] = (bn_dec_chunk)rem;
+	}
+	memzero(&val, sizeof(val));
+}
+
+// a = a * 10^digits + chunk, returns false on overflow past 256 bits
+static bool bn_mul_add_chunk(bignum256 *a, unsigned int digits, uint32_t chunk)
+{
+	uint64_t carry = chunk;
+	for (int i = 0; i < 9; i++) {
+		uint64_t t = (uint64_t)a->val[i] * bn_pow10[digits] + carry;
+		a->val[i] = (uint32_t)(t & 0x3FFFFFFF);
+		carry = t >> 30;
+	}
+	return carry == 0 && a->val[8] <= 0xFFFF;
+}
+#endif
+
+// write the BN_DEC_DIGITS decimal digits of a, zero padded; returns the
+// offset of the first significant digit (the last digit for zero)
+static size_t bn_to_decimal(const bignum256 *a, char digits[BN_DEC_DIGITS])
+{
+	bn_dec_chunk chunks[BN_DEC_CHUNKS];
+	size_t first = BN_DEC_DIGITS - 1;
+
+	bn_to_chunks(a, chunks);
+	for (int j = 0; j < BN_DEC_CHUNKS; j++) {
+		char *p = &digits[BN_DEC_DIGITS - (j + 1) * BN_DEC_CHUNK_DIGITS];
+		bn_dec_chunk c = chunks[j];
+		int k = BN_DEC_CHUNK_DIGITS;
+		// both chunk sizes are odd, the leading digit is written on its own
+		while (k > 1) {
+			memcpy(&p[k - 2], &bn_digit_pairs[2 * (c % 100)], 2);
+			c /= 100;
+			k -= 2;
+		}
+		p[0] = '0' + (char)c;
+	}
+	for (size_t i = 0; i < BN_DEC_DIGITS; i++) {
+		if (digits[i] != '0') {
+			first = i;
+			break;
+		}
+	}
+	memzero(chunks, sizeof(chunks));
+	return first;
+}
+
+size_t bn_format_amount(const bignum256 *amnt, const bn_format_options *options, char *out, size_t outlen)
+{
+	// one spare digit in front for a carry out of rounding
+	char buf[BN_DEC_DIGITS + 1];
+	char *digits = &buf[1];
+	size_t first = bn_to_decimal(amnt, digits);
+	size_t len = BN_DEC_DIGITS - first;
+	bool zero = len == 1 && digits[first] == '0';
+	unsigned int decimals = options->decimals;
+	size_t zeros = 0;
+
+	buf[0] = '0';
+	if (!zero && options->exponent > 0) {
+		zeros = (size_t)options->exponent;
+	} else if (!zero && options->exponent < 0) {
+		// drop -exponent digits and round the ones that are kept
+		size_t drop = (size_t)-(int64_t)options->exponent;
+		if (drop <= len) {
+			const char *dropped = &digits[BN_DEC_DIGITS - drop];
+			bool rest = false, up = false;
+			for (size_t i = 1; i < drop; i++) {
+				rest |= dropped[i] != '0';
+			}
+			switch (options->rounding) {
+			case BN_ROUND_DOWN:
+				break;
+			case BN_ROUND_HALF_UP:
+				up = dropped[0] >= '5';
+				break;
+			case BN_ROUND_HALF_EVEN:
+				up = dropped[0] > '5' || (dropped[0] == '5' && (rest || (dropped[-1] - '0') % 2 == 1));
+				break;
+			case BN_ROUND_UP:
+				up = dropped[0] != '0' || rest;
+				break;
+			}
+			len -= drop;
+			first = BN_DEC_DIGITS - drop - len;
+			if (up) {
+				char *p = &digits[BN_DEC_DIGITS - drop - 1];
+				while (*p == '9') {
+					*p-- = '0';
+				}
+				(*p)++;
+				if (p < &digits[first]) {
+					first--;
+					len++;
+				}
+			}
+		} else {
+			// every digit is dropped, the first one dropped is a leading zero
+			len = 0;
+			if (options->rounding == BN_ROUND_UP) {
+				digits[BN_DEC_DIGITS - 1] = '1';
+				len = 1;
+			}
+			first = BN_DEC_DIGITS - len;
+		}
+	}
+
+	// the value is digits[first..first+len) followed by zeros times '0',
+	// padded with leading zeros to at least decimals + 1 digits
+	const char *value = &digits[first];
+	size_t total = len + zeros;
+	size_t lead = total <= decimals ? decimals + 1 - total : 0;
+	size_t intlen = lead + total - decimals;
+	size_t fraclen = decimals;
+
+#define BN_AMOUNT_DIGIT(k) \
+	((k) < lead || (k) - lead >= len ? '0' : value[(k) - lead])
+
+	if (options->trailing != BN_TRAILING_KEEP) {
+		size_t keep = options->trailing == BN_TRAILING_ONE && fraclen > 0 ? 1 : 0;
+		while (fraclen > keep && BN_AMOUNT_DIGIT(intlen + fraclen - 1) == '0') {
+			fraclen--;
+		}
+	}
+
+	size_t prefixlen = options->prefix ? strlen(options->prefix) : 0;
+	size_t suffixlen = options->suffix ? strlen(options->suffix) : 0;
+	if (prefixlen + intlen + (fraclen ? fraclen + 1 : 0) + suffixlen + 1 > outlen) {
+		memzero(buf, sizeof(buf));
+		return 0;
+	}
+
+	char *str = out;
+	if (prefixlen) {
+		memcpy(str, options->prefix, prefixlen);
+		str += prefixlen;
+	}
+	for (size_t k = 0; k < intlen; k++) {
+		*str++ = BN_AMOUNT_DIGIT(k);
+	}
+	if (fraclen) {
+		*str++ = '.';
+		for (size_t k = intlen; k < intlen + fraclen; k++) {
+			*str++ = BN_AMOUNT_DIGIT(k);
+		}
+	}
+#undef BN_AMOUNT_DIGIT
+	if (suffixlen) {
+		memcpy(str, options->suffix, suffixlen);
+		str += suffixlen;
+	}
+	*str = '\0';
+
+	memzero(buf, sizeof(buf));
+	return (size_t)(str - out);
+}
+
+size_t bn_format_amounts(const bignum256 *amnts, size_t count, const bn_format_options *options, char *out, size_t stride, size_t *lengths)
+{
+	size_t formatted = 0;
+	for (size_t i = 0; i < count; i++) {
+		size_t len = bn_format_amount(&amnts[i], options, &out[i * stride], stride);
+		if (lengths) {
+			lengths[i] = len;
+		}
+		if (len) {
+			formatted++;
+		}
+	}
+	return formatted;
+}
+
+bool bn_parse_amount(const char *str, size_t len, unsigned int decimals, bignum256 *amnt)
+{
+#if defined(__SIZEOF_INT128__)
+	uint64_t w[4] = {0};
+#define BN_PARSE_CHUNK(digits, chunk) bn_mul_add_chunk(w, (digits), (chunk))
+#else
+	bignum256 val;
+	bn_zero(&val);
+#define BN_PARSE_CHUNK(digits, chunk) bn_mul_add_chunk(&val, (digits), (chunk))
+#endif
+	bn_dec_chunk chunk = 0;
+	unsigned int chunklen = 0, intlen = 0, fraclen = 0;
+	bool point = false, ok = true;
+
+	for (size_t i = 0; i < len && ok; i++) {
+		char c = str[i];
+		if (c == '.' && !point && intlen > 0) {
+			point = true;
+			continue;
+		}
+		if (c < '0' || c > '9') {
+			ok = false;
+			break;
+		}
+		if (point) {
+			if (fraclen == decimals) {
+				// more decimals than the amount has, accept only zeros
+				ok = c == '0';
+				continue;
+			}
+			fraclen++;
+		} else {
+			intlen++;
+		}
+		chunk = chunk * 10 + (bn_dec_chunk)(c - '0');
+		if (++chunklen == BN_DEC_CHUNK_DIGITS) {
+			ok = BN_PARSE_CHUNK(chunklen, chunk);
+			chunk = 0;
+			chunklen = 0;
+		}
+	}
+	ok = ok && intlen > 0 && (!point || str[len - 1] != '.');
+	if (ok && chunklen) {
+		ok = BN_PARSE_CHUNK(chunklen, chunk);
+	}
+	for (unsigned int pad = decimals - fraclen; ok && pad > 0;) {
+		unsigned int n = pad < BN_DEC_CHUNK_DIGITS ? pad : BN_DEC_CHUNK_DIGITS;
+		ok = BN_PARSE_CHUNK(n, 0);
+		pad -= n;
+	}
+#undef BN_PARSE_CHUNK
+
+#if defined(__SIZEOF_INT128__)
+	for (int i = 0; i < 9; i++) {
+		unsigned int s = 30 * i;
+		uint64_t v = w[s / 64] >> (s % 64);
+		if (s % 64 > 34 && s / 64 < 3) {
+			v |= w[s / 64 + 1] << (64 - s % 64);
+		}
+		amnt->val[i] = (uint32_t)v & 0x3FFFFFFF;
+	}
+	memzero(w, sizeof(w));
+#else
+	memcpy(amnt, &val, sizeof(bignum256));
+	memzero(&val, sizeof(val));
+#endif
+	if (!ok) {
+		bn_zero(amnt);
+	}
+	return ok;
+}
+
+size_t bn_parse_amounts(const char *const *strs, const size_t *lens, size_t count, unsigned int decimals, bignum256 *amnts, bool *res)
+{
+	size_t parsed = 0;
+	for (size_t i = 0; i < count; i++) {
+		bool ok = bn_parse_amount(strs[i], lens[i], decimals, &amnts[i]);
+		if (res) {
+			res[i] = ok;
+		}
+		if (ok) {
+			parsed++;
+		}
+	}
+	return parsed;
+}
+
 #if USE_BN_PRINT
 void bn_print(const bignum256 *a)
 {
@@ -159,6 +159,43 @@ static inline size_t bn_format_uint64(uint64_t amount, const char *prefix, const
 	return bn_format(&amnt, prefix, suffix, decimals, exponent, trailing, out, outlen);
 }
 
+// how digits dropped by a negative exponent round the digits that are kept
+typedef enum {
+	BN_ROUND_DOWN,      // truncate, as bn_format does
+	BN_ROUND_HALF_UP,
+	BN_ROUND_HALF_EVEN,
+	BN_ROUND_UP,        // away from zero
+} bn_rounding;
+
+// which trailing zeros of the decimals are printed
+typedef enum {
+	BN_TRAILING_KEEP,   // all of them (bn_format with trailing = true)
+	BN_TRAILING_ONE,    // none, but at least one decimal (trailing = false)
+	BN_TRAILING_NONE,   // none, and no decimal point for whole amounts
+} bn_trailing;
+
+typedef struct {
+	const char *prefix;
+	const char *suffix;
+	unsigned int decimals;
+	int exponent;
+	bn_trailing trailing;
+	bn_rounding rounding;
+} bn_format_options;
+
+// same output as bn_format for BN_ROUND_DOWN, without repeated bn_divmod1000
+size_t bn_format_amount(const bignum256 *amnt, const bn_format_options *options, char *out, size_t outlen);
+
+// format amnts[i] into out + i * stride (stride bytes each), returns how many fit
+size_t bn_format_amounts(const bignum256 *amnts, size_t count, const bn_format_options *options, char *out, size_t stride, size_t *lengths);
+
+// parse a decimal amount such as "12.5" into its value in units of 10^-decimals;
+// fails (and sets amnt to zero) on bad syntax, lost decimals or overflow
+bool bn_parse_amount(const char *str, size_t len, unsigned int decimals, bignum256 *amnt);
+
+// parse strs[i] into amnts[i], returns how many were valid
+size_t bn_parse_amounts(const char *const *strs, const size_t *lens, size_t count, unsigned int decimals, bignum256 *amnts, bool *res);
+
 #if USE_BN_PRINT
 void bn_print(const bignum256 *a);
 void bn_print_raw(const bignum256 *a);
@@ -37,3 +37,32 @@ static inline uint64_t rotr64( const uint64_t w, const unsigned c )
   return ( w >> c ) | ( w << ( 64 - c ) );
 }
 
+
+/*
+ * Vector kernels. With GCC/clang vector extensions the compress functions
+ * have vectorized variants (NEON on ARM, SSE/AVX2 on x86) next to the
+ * portable reference ones. On x86 the variant is picked at run time from
+ * the CPU features, so the library still runs on CPUs without them.
+ */
+#if defined(__GNUC__) || defined(__clang__)
+#define BLAKE2_USE_VECTOR 1
+#else
+#define BLAKE2_USE_VECTOR 0
+#endif
+
+#if BLAKE2_USE_VECTOR && (defined(__x86_64__) || defined(__i386__))
+#define BLAKE2_X86_DISPATCH 1
+#define BLAKE2_TARGET(t) __attribute__((target(t)))
+#define BLAKE2_CPU_SUPPORTS(f) __builtin_cpu_supports(f)
+#else
+#define BLAKE2_X86_DISPATCH 0
+#endif
+
+#if BLAKE2_USE_VECTOR
+#if defined(__clang__) || __GNUC__ >= 12
+#define BLAKE2_SHUFFLE(x, a, b, c, d) __builtin_shufflevector(x, x, a, b, c, d)
+#else
+#define BLAKE2_SHUFFLE(x, a, b, c, d) __builtin_shuffle(x, (__typeof__(x)){ a, b, c, d })
+#endif
+#define BLAKE2_VROTR(x, c, bits) ( ( (x) >> (c) ) | ( (x) << ( (bits) - (c) ) ) )
+#endif
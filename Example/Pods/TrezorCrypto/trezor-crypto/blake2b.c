@@ -210,7 +210,7 @@ int blake2b_InitKey( blake2b_state *S, size_t outlen, const void *key, size_t ke
     G(r,7,v[ 3],v[ 4],v[ 9],v[14]); \
   } while(0)
 
-static void blake2b_compress( blake2b_state *S, const uint8_t block[BLAKE2B_BLOCKBYTES] )
+static void blake2b_compress_ref( blake2b_state *S, const uint8_t block[BLAKE2B_BLOCKBYTES] )
 {
   uint64_t m[16];
   uint64_t v[16];
@@ -254,6 +254,166 @@ static void blake2b_compress( blake2b_state *S, const uint8_t block[BLAKE2B_BLOC
 #undef G
 #undef ROUND
 
+#if BLAKE2_USE_VECTOR
+
+/* Four 64-bit words per vector: a row of the state, or one word of each lane */
+typedef uint64_t blake2b_vec __attribute__((vector_size(32)));
+
+#define G(r,i,a,b,c,d)                      \
+  do {                                      \
+    a = a + b + m[blake2b_sigma[r][2*i+0]]; \
+    d = BLAKE2_VROTR(d ^ a, 32, 64);        \
+    c = c + d;                              \
+    b = BLAKE2_VROTR(b ^ c, 24, 64);        \
+    a = a + b + m[blake2b_sigma[r][2*i+1]]; \
+    d = BLAKE2_VROTR(d ^ a, 16, 64);        \
+    c = c + d;                              \
+    b = BLAKE2_VROTR(b ^ c, 63, 64);        \
+  } while(0)
+
+#define ROUND(r)                    \
+  do {                              \
+    G(r,0,v[ 0],v[ 4],v[ 8],v[12]); \
+    G(r,1,v[ 1],v[ 5],v[ 9],v[13]); \
+    G(r,2,v[ 2],v[ 6],v[10],v[14]); \
+    G(r,3,v[ 3],v[ 7],v[11],v[15]); \
+    G(r,4,v[ 0],v[ 5],v[10],v[15]); \
+    G(r,5,v[ 1],v[ 6],v[11],v[12]); \
+    G(r,6,v[ 2],v[ 7],v[ 8],v[13]); \
+    G(r,7,v[ 3],v[ 4],v[ 9],v[14]); \
+  } while(0)
+
+/*
+ * Compress one block in each of BLAKE2B_LANES lanes. h[i] and m[i] hold word i
+ * of every lane, p[0..3] the lanes' t[0], t[1], f[0], f[1] and p[4] is all ones
+ * in the lanes whose state is updated; the other lanes keep their h.
+ */
+static inline __attribute__((always_inline)) void blake2b_compress_x4_body( blake2b_vec h[8], const blake2b_vec m[16], const blake2b_vec p[5] )
+{
+  blake2b_vec v[16];
+  size_t i;
+
+  for( i = 0; i < 8; ++i ) {
+    v[i] = h[i];
+    v[i + 8] = ( blake2b_vec ){ blake2b_IV[i], blake2b_IV[i], blake2b_IV[i], blake2b_IV[i] };
+  }
+
+  v[12] ^= p[0];
+  v[13] ^= p[1];
+  v[14] ^= p[2];
+  v[15] ^= p[3];
+
+  ROUND( 0 );
+  ROUND( 1 );
+  ROUND( 2 );
+  ROUND( 3 );
+  ROUND( 4 );
+  ROUND( 5 );
+  ROUND( 6 );
+  ROUND( 7 );
+  ROUND( 8 );
+  ROUND( 9 );
+  ROUND( 10 );
+  ROUND( 11 );
+
+  for( i = 0; i < 8; ++i ) {
+    h[i] = h[i] ^ ( ( v[i] ^ v[i + 8] ) & p[4] );
+  }
+}
+
+#undef G
+#undef ROUND
+
+#if BLAKE2_X86_DISPATCH
+BLAKE2_TARGET("avx2") static void blake2b_compress_x4_avx2( blake2b_vec h[8], const blake2b_vec m[16], const blake2b_vec p[5] )
+{
+  blake2b_compress_x4_body( h, m, p );
+}
+#endif
+
+static void blake2b_compress_x4( blake2b_vec h[8], const blake2b_vec m[16], const blake2b_vec p[5] )
+{
+#if BLAKE2_X86_DISPATCH
+  if( BLAKE2_CPU_SUPPORTS( "avx2" ) ) {
+    blake2b_compress_x4_avx2( h, m, p );
+    return;
+  }
+#endif
+  blake2b_compress_x4_body( h, m, p );
+}
+
+#if BLAKE2_X86_DISPATCH
+/*
+ * Single-stream compress with one state row per 256-bit register. The
+ * diagonal step rotates rows b, c and d instead of picking words. Only
+ * worth it with AVX2; on ARM a 256-bit row spans two NEON registers and
+ * the reference code is as fast.
+ */
+#define G(a,b,c,d,x,y)                      \
+  do {                                      \
+    a = a + b + x;                          \
+    d = BLAKE2_VROTR(d ^ a, 32, 64);        \
+    c = c + d;                              \
+    b = BLAKE2_VROTR(b ^ c, 24, 64);        \
+    a = a + b + y;                          \
+    d = BLAKE2_VROTR(d ^ a, 16, 64);        \
+    c = c + d;                              \
+    b = BLAKE2_VROTR(b ^ c, 63, 64);        \
+  } while(0)
+
+#define MSG(r,i,j,k,l) ( blake2b_vec ){ m[blake2b_sigma[r][i]], m[blake2b_sigma[r][j]], m[blake2b_sigma[r][k]], m[blake2b_sigma[r][l]] }
+
+BLAKE2_TARGET("avx2") static void blake2b_compress_avx2( blake2b_state *S, const uint8_t block[BLAKE2B_BLOCKBYTES] )
+{
+  uint64_t m[16];
+  blake2b_vec a, b, c, d, h0, h1;
+  size_t i, r;
+
+  for( i = 0; i < 16; ++i ) {
+    m[i] = load64( block + i * sizeof( m[i] ) );
+  }
+
+  memcpy( &h0, S->h, sizeof( h0 ) );
+  memcpy( &h1, S->h + 4, sizeof( h1 ) );
+  a = h0;
+  b = h1;
+  c = ( blake2b_vec ){ blake2b_IV[0], blake2b_IV[1], blake2b_IV[2], blake2b_IV[3] };
+  d = ( blake2b_vec ){ blake2b_IV[4] ^ S->t[0], blake2b_IV[5] ^ S->t[1], blake2b_IV[6] ^ S->f[0], blake2b_IV[7] ^ S->f[1] };
+
+  for( r = 0; r < 12; ++r ) {
+    G( a, b, c, d, MSG( r, 0, 2, 4, 6 ), MSG( r, 1, 3, 5, 7 ) );
+    b = BLAKE2_SHUFFLE( b, 1, 2, 3, 0 );
+    c = BLAKE2_SHUFFLE( c, 2, 3, 0, 1 );
+    d = BLAKE2_SHUFFLE( d, 3, 0, 1, 2 );
+    G( a, b, c, d, MSG( r, 8, 10, 12, 14 ), MSG( r, 9, 11, 13, 15 ) );
+    b = BLAKE2_SHUFFLE( b, 3, 0, 1, 2 );
+    c = BLAKE2_SHUFFLE( c, 2, 3, 0, 1 );
+    d = BLAKE2_SHUFFLE( d, 1, 2, 3, 0 );
+  }
+
+  h0 ^= a ^ c;
+  h1 ^= b ^ d;
+  memcpy( S->h, &h0, sizeof( h0 ) );
+  memcpy( S->h + 4, &h1, sizeof( h1 ) );
+}
+
+#undef G
+#undef MSG
+#endif
+
+#endif
+
+static void blake2b_compress( blake2b_state *S, const uint8_t block[BLAKE2B_BLOCKBYTES] )
+{
+#if BLAKE2_X86_DISPATCH
+  if( BLAKE2_CPU_SUPPORTS( "avx2" ) ) {
+    blake2b_compress_avx2( S, block );
+    return;
+  }
+#endif
+  blake2b_compress_ref( S, block );
+}
+
 int blake2b_Update( blake2b_state *S, const void *pin, size_t inlen )
 {
   const unsigned char * in = (const unsigned char *)pin;
@@ -322,3 +482,109 @@ int blake2b_Key(const uint8_t *msg, uint32_t msg_len, const void *key, size_t ke
     if (0 != blake2b_Final(&ctx, out, outlen)) return -1;
     return 0;
 }
+
+/* Copy block k of the state's buffered bytes followed by msg into block; returns the message bytes in it */
+static size_t blake2b_lane_block( const blake2b_state *S, const uint8_t *msg, size_t msg_len, size_t k, uint8_t block[BLAKE2B_BLOCKBYTES] )
+{
+  size_t offset = k * BLAKE2B_BLOCKBYTES;
+  size_t n = 0, fill;
+
+  memset( block, 0, BLAKE2B_BLOCKBYTES );
+  if( offset < S->buflen ) {
+    n = S->buflen - offset;
+    memcpy( block, S->buf + offset, n );
+  }
+  if( offset + n < S->buflen + msg_len ) {
+    size_t from = offset + n - S->buflen;
+    fill = msg_len - from;
+    if( fill > BLAKE2B_BLOCKBYTES - n ) fill = BLAKE2B_BLOCKBYTES - n;
+    memcpy( block + n, msg + from, fill );
+    n += fill;
+  }
+  return n;
+}
+
+int blake2b_Final_x4( blake2b_state *const S[BLAKE2B_LANES], const uint8_t *const msg[BLAKE2B_LANES], const size_t msg_len[BLAKE2B_LANES], uint8_t *const out[BLAKE2B_LANES], size_t outlen )
+{
+  uint8_t buffer[BLAKE2B_OUTBYTES] = {0};
+  size_t i, j;
+
+  for( i = 0; i < BLAKE2B_LANES; ++i ) {
+    if( out[i] == NULL || outlen < S[i]->outlen )
+      return -1;
+
+    if( blake2b_is_lastblock( S[i] ) )
+      return -1;
+  }
+
+#if BLAKE2_USE_VECTOR
+  {
+    blake2b_vec h[8], m[16], p[5];
+    uint8_t block[BLAKE2B_BLOCKBYTES];
+    size_t blocks[BLAKE2B_LANES], max_blocks = 0, k;
+
+    for( i = 0; i < BLAKE2B_LANES; ++i ) {
+      size_t total = S[i]->buflen + msg_len[i];
+      blocks[i] = total ? ( total + BLAKE2B_BLOCKBYTES - 1 ) / BLAKE2B_BLOCKBYTES : 1;
+      if( blocks[i] > max_blocks ) max_blocks = blocks[i];
+      for( j = 0; j < 8; ++j ) h[j][i] = S[i]->h[j];
+    }
+
+    for( k = 0; k < max_blocks; ++k ) {
+      for( i = 0; i < BLAKE2B_LANES; ++i ) {
+        if( k < blocks[i] ) {
+          blake2b_increment_counter( S[i], blake2b_lane_block( S[i], msg[i], msg_len[i], k, block ) );
+          if( k == blocks[i] - 1 ) blake2b_set_lastblock( S[i] );
+          p[4][i] = (uint64_t)-1;
+        } else {
+          memset( block, 0, BLAKE2B_BLOCKBYTES );
+          p[4][i] = 0;
+        }
+        for( j = 0; j < 16; ++j ) m[j][i] = load64( block + j * sizeof( uint64_t ) );
+        p[0][i] = S[i]->t[0];
+        p[1][i] = S[i]->t[1];
+        p[2][i] = S[i]->f[0];
+        p[3][i] = S[i]->f[1];
+      }
+      blake2b_compress_x4( h, m, p );
+    }
+
+    for( i = 0; i < BLAKE2B_LANES; ++i ) {
+      for( j = 0; j < 8; ++j ) S[i]->h[j] = h[j][i];
+      S[i]->buflen = 0;
+    }
+    memzero( m, sizeof( m ) );
+    memzero( block, sizeof( block ) );
+  }
+#else
+  /* Without vector support, lanes are processed one after another */
+  for( i = 0; i < BLAKE2B_LANES; ++i ) {
+    blake2b_Update( S[i], msg[i], msg_len[i] );
+    blake2b_increment_counter( S[i], S[i]->buflen );
+    blake2b_set_lastblock( S[i] );
+    memset( S[i]->buf + S[i]->buflen, 0, BLAKE2B_BLOCKBYTES - S[i]->buflen ); /* Padding */
+    blake2b_compress( S[i], S[i]->buf );
+  }
+#endif
+
+  /* Digests are written only after every lane has been read, so out may alias msg */
+  for( i = 0; i < BLAKE2B_LANES; ++i ) {
+    for( j = 0; j < 8; ++j ) /* Output full hash to temp buffer */
+      store64( buffer + sizeof( S[i]->h[j] ) * j, S[i]->h[j] );
+
+    memcpy( out[i], buffer, S[i]->outlen );
+  }
+  memzero(buffer, sizeof(buffer));
+  return 0;
+}
+
+int blake2b_x4(const uint8_t *const msg[BLAKE2B_LANES], const size_t msg_len[BLAKE2B_LANES], uint8_t *const out[BLAKE2B_LANES], size_t outlen)
+{
+    BLAKE2B_CTX ctx[BLAKE2B_LANES];
+    BLAKE2B_CTX *S[BLAKE2B_LANES];
+    for (size_t i = 0; i < BLAKE2B_LANES; i++) {
+        if (0 != blake2b_Init(&ctx[i], outlen)) return -1;
+        S[i] = &ctx[i];
+    }
+    return blake2b_Final_x4(S, msg, msg_len, out, outlen);
+}
@@ -28,6 +28,7 @@ typedef struct __blake2b_state
 #define BLAKE2B_BLOCK_LENGTH   BLAKE2B_BLOCKBYTES
 #define BLAKE2B_DIGEST_LENGTH  BLAKE2B_OUTBYTES
 #define BLAKE2B_KEY_LENGTH     BLAKE2B_KEYBYTES
+#define BLAKE2B_LANES          4
 
 int blake2b_Init(blake2b_state *S, size_t outlen);
 int blake2b_InitKey(blake2b_state *S, size_t outlen, const void *key, size_t keylen);
@@ -38,4 +39,8 @@ int blake2b_Final(blake2b_state *S, void *out, size_t outlen);
 int blake2b(const uint8_t *msg, uint32_t msg_len, void *out, size_t outlen);
 int blake2b_Key(const uint8_t *msg, uint32_t msg_len, const void *key, size_t keylen, void *out, size_t outlen);
 
+/* Absorb msg[i] into the initialized state S[i] and finalize it into out[i], for BLAKE2B_LANES states at once */
+int blake2b_Final_x4(blake2b_state *const S[BLAKE2B_LANES], const uint8_t *const msg[BLAKE2B_LANES], const size_t msg_len[BLAKE2B_LANES], uint8_t *const out[BLAKE2B_LANES], size_t outlen);
+int blake2b_x4(const uint8_t *const msg[BLAKE2B_LANES], const size_t msg_len[BLAKE2B_LANES], uint8_t *const out[BLAKE2B_LANES], size_t outlen);
+
 #endif
@@ -28,6 +28,7 @@ typedef struct __blake2s_state
 #define BLAKE2S_BLOCK_LENGTH   BLAKE2S_BLOCKBYTES
 #define BLAKE2S_DIGEST_LENGTH  BLAKE2S_OUTBYTES
 #define BLAKE2S_KEY_LENGTH     BLAKE2S_KEYBYTES
+#define BLAKE2S_LANES          4
 
 int blake2s_Init(blake2s_state *S, size_t outlen);
 int blake2s_InitKey(blake2s_state *S, size_t outlen, const void *key, size_t keylen);
@@ -38,4 +39,8 @@ int blake2s_Final(blake2s_state *S, void *out, size_t outlen);
 int blake2s(const uint8_t *msg, uint32_t msg_len, void *out, size_t outlen);
 int blake2s_Key(const uint8_t *msg, uint32_t msg_len, const void *key, size_t keylen, void *out, size_t outlen);
 
+/* Absorb msg[i] into the initialized state S[i] and finalize it into out[i], for BLAKE2S_LANES states at once */
+int blake2s_Final_x4(blake2s_state *const S[BLAKE2S_LANES], const uint8_t *const msg[BLAKE2S_LANES], const size_t msg_len[BLAKE2S_LANES], uint8_t *const out[BLAKE2S_LANES], size_t outlen);
+int blake2s_x4(const uint8_t *const msg[BLAKE2S_LANES], const size_t msg_len[BLAKE2S_LANES], uint8_t *const out[BLAKE2S_LANES], size_t outlen);
+
 #endif
@@ -866,16 +866,20 @@ int ecdsa_uncompress_pubkey(const ecdsa_curve *curve, const uint8_t *pub_key, ui
 	return 1;
 }
 
-void ecdsa_get_pubkeyhash(const uint8_t *pub_key, HasherType hasher_pubkey, uint8_t *pubkeyhash)
+static size_t ecdsa_pubkey_length(const uint8_t *pub_key)
 {
-	uint8_t h[HASHER_DIGEST_LENGTH];
 	if (pub_key[0] == 0x04) {  // uncompressed format
-		hasher_Raw(hasher_pubkey, pub_key, 65, h);
+		return 65;
 	} else if (pub_key[0] == 0x00) { // point at infinity
-		hasher_Raw(hasher_pubkey, pub_key,  1, h);
-	} else { // expecting compressed format
-		hasher_Raw(hasher_pubkey, pub_key, 33, h);
+		return 1;
 	}
+	return 33; // expecting compressed format
+}
+
+void ecdsa_get_pubkeyhash(const uint8_t *pub_key, HasherType hasher_pubkey, uint8_t *pubkeyhash)
+{
+	uint8_t h[HASHER_DIGEST_LENGTH];
+	hasher_Raw(hasher_pubkey, pub_key, ecdsa_pubkey_length(pub_key), h);
 	memcpy(pubkeyhash, h, 20);
 	memzero(h, sizeof(h));
 }
@@ -897,6 +901,44 @@ void ecdsa_get_address(const uint8_t *pub_key, uint32_t version, HasherType hash
 	memzero(raw, sizeof(raw));
 }
 
+void ecdsa_get_pubkeyhash_batch(const uint8_t * const *pub_keys, size_t count, HasherType hasher_pubkey, uint8_t * const *pubkeyhashes)
+{
+	uint8_t h[HASHER_BATCH_SIZE][HASHER_DIGEST_LENGTH];
+	HasherBatch batch;
+	hasher_batch_Init(&batch, hasher_pubkey);
+	for (size_t i = 0; i < count; i += HASHER_BATCH_SIZE) {
+		size_t n = count - i < HASHER_BATCH_SIZE ? count - i : HASHER_BATCH_SIZE;
+		for (size_t j = 0; j < n; j++) {
+			hasher_batch_Submit(&batch, pub_keys[i + j], ecdsa_pubkey_length(pub_keys[i + j]), h[j]);
+		}
+		hasher_batch_Flush(&batch);
+		for (size_t j = 0; j < n; j++) {
+			memcpy(pubkeyhashes[i + j], h[j], 20);
+		}
+	}
+	memzero(h, sizeof(h));
+}
+
+void ecdsa_get_address_batch(const uint8_t * const *pub_keys, size_t count, uint32_t version, HasherType hasher_pubkey, HasherType hasher_base58, char * const *addrs, int addrsize)
+{
+	uint8_t raw[HASHER_BATCH_SIZE][MAX_ADDR_RAW_SIZE];
+	uint8_t *hashes[HASHER_BATCH_SIZE];
+	const uint8_t *raws[HASHER_BATCH_SIZE];
+	size_t prefix_len = address_prefix_bytes_len(version);
+	for (size_t j = 0; j < HASHER_BATCH_SIZE; j++) {
+		address_write_prefix_bytes(version, raw[j]);
+		hashes[j] = raw[j] + prefix_len;
+		raws[j] = raw[j];
+	}
+	for (size_t i = 0; i < count; i += HASHER_BATCH_SIZE) {
+		size_t n = count - i < HASHER_BATCH_SIZE ? count - i : HASHER_BATCH_SIZE;
+		ecdsa_get_pubkeyhash_batch(pub_keys + i, n, hasher_pubkey, hashes);
+		base58_encode_check_batch(raws, 20 + prefix_len, n, hasher_base58, addrs + i, addrsize, NULL);
+	}
+	// not as important to clear this one, but we might as well
+	memzero(raw, sizeof(raw));
+}
+
 void ecdsa_get_address_segwit_p2sh_raw(const uint8_t *pub_key, uint32_t version, HasherType hasher_pubkey, uint8_t *addr_raw)
 {
 	uint8_t buf[32 + 2];
@@ -20,8 +20,14 @@
  * OTHER DEALINGS IN THE SOFTWARE.
  */
 
+#include <string.h>
+
 #include "hasher.h"
 #include "ripemd160.h"
+#include "memzero.h"
+
+// SHA256_LANES, RIPEMD160_LANES and SHA3_LANES all have this value
+#define HASHER_BATCH_LANES 4
 
 void hasher_Init(Hasher *hasher, HasherType type) {
 	hasher->type = type;
@@ -151,3 +157,91 @@ void hasher_Raw(HasherType type, const uint8_t *data, size_t length, uint8_t has
 	hasher_Update(&hasher, data, length);
 	hasher_Final(&hasher, hash);
 }
+
+void hasher_batch_Init(HasherBatch *batch, HasherType type) {
+	batch->type = type;
+	batch->count = 0;
+}
+
+void hasher_batch_Submit(HasherBatch *batch, const uint8_t *data, size_t length, uint8_t hash[HASHER_DIGEST_LENGTH]) {
+	batch->data[batch->count] = data;
+	batch->length[batch->count] = length;
+	batch->hash[batch->count] = hash;
+	batch->count++;
+	if (batch->count == HASHER_BATCH_SIZE) {
+		hasher_batch_Flush(batch);
+	}
+}
+
+// Hash up to HASHER_BATCH_LANES messages in lanes. Unused lanes repeat the first message
+// and write into a scratch buffer.
+static void hasher_batch_Lanes(HasherType type, const uint8_t *const *data, const size_t *length, uint8_t *const *hash, size_t count) {
+	const uint8_t *d[HASHER_BATCH_LANES];
+	size_t l[HASHER_BATCH_LANES];
+	uint32_t l32[HASHER_BATCH_LANES];
+	uint8_t *h[HASHER_BATCH_LANES];
+	uint8_t scratch[HASHER_BATCH_LANES][HASHER_DIGEST_LENGTH];
+
+	for (size_t i = 0; i < HASHER_BATCH_LANES; i++) {
+		d[i] = data[i < count ? i : 0];
+		l[i] = length[i < count ? i : 0];
+		h[i] = i < count ? hash[i] : scratch[i];
+	}
+
+	switch (type) {
+	case HASHER_SHA2:
+		sha256_Raw_x4(d, l, h);
+		break;
+	case HASHER_SHA2D:
+		sha256_Raw_x4(d, l, h);
+		for (size_t i = 0; i < HASHER_BATCH_LANES; i++) {
+			l[i] = HASHER_DIGEST_LENGTH;
+		}
+		sha256_Raw_x4((const uint8_t *const *)h, l, h);
+		break;
+	case HASHER_SHA2_RIPEMD:
+		sha256_Raw_x4(d, l, h);
+		for (size_t i = 0; i < HASHER_BATCH_LANES; i++) {
+			l32[i] = HASHER_DIGEST_LENGTH;
+		}
+		ripemd160_x4((const uint8_t *const *)h, l32, h);
+		break;
+	case HASHER_SHA3:
+		sha3_256_x4(d, l, h);
+		break;
+#if USE_KECCAK
+	case HASHER_SHA3K:
+		keccak_256_x4(d, l, h);
+		break;
+#endif
+	case HASHER_OVERWINTER_PREVOUTS:
+	case HASHER_OVERWINTER_SEQUENCE:
+	case HASHER_OVERWINTER_OUTPUTS:
+	case HASHER_OVERWINTER_PREIMAGE:
+	case HASHER_SAPLING_PREIMAGE: {
+		Hasher hasher[HASHER_BATCH_LANES];
+		blake2b_state *S[HASHER_BATCH_LANES];
+		for (size_t i = 0; i < HASHER_BATCH_LANES; i++) {
+			hasher_Init(&hasher[i], type);
+			S[i] = &hasher[i].ctx.blake2b;
+		}
+		blake2b_Final_x4(S, d, l, h, HASHER_DIGEST_LENGTH);
+		memzero(hasher, sizeof(hasher));
+		break;
+	}
+	default:
+		for (size_t i = 0; i < count; i++) {
+			hasher_Raw(type, data[i], length[i], hash[i]);
+		}
+		break;
+	}
+	memzero(scratch, sizeof(scratch));
+}
+
+void hasher_batch_Flush(HasherBatch *batch) {
+	for (size_t i = 0; i < batch->count; i += HASHER_BATCH_LANES) {
+		size_t n = batch->count - i < HASHER_BATCH_LANES ? batch->count - i : HASHER_BATCH_LANES;
+		hasher_batch_Lanes(batch->type, batch->data + i, batch->length + i, batch->hash + i, n);
+	}
+	batch->count = 0;
+}
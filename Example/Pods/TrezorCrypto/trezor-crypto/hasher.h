@@ -33,6 +33,7 @@
 #include "blake2b.h"
 
 #define HASHER_DIGEST_LENGTH 32
+#define HASHER_BATCH_SIZE 16
 
 typedef enum {
     HASHER_SHA2,
@@ -76,4 +77,21 @@ void hasher_Final(Hasher *hasher, uint8_t hash[HASHER_DIGEST_LENGTH]);
 
 void hasher_Raw(HasherType type, const uint8_t *data, size_t length, uint8_t hash[HASHER_DIGEST_LENGTH]);
 
+// Batch of independent messages hashed with the same HasherType.
+// SHA2{,D,_RIPEMD}, SHA3{,K}, OVERWINTER_* and SAPLING_* are hashed several
+// messages at a time in SIMD lanes, the other types one message at a time. Submitted data must stay valid
+// and hashes are only written once the batch is flushed (explicitly, or
+// implicitly when HASHER_BATCH_SIZE messages are pending).
+typedef struct {
+    HasherType type;
+    size_t count;
+    const uint8_t *data[HASHER_BATCH_SIZE];
+    size_t length[HASHER_BATCH_SIZE];
+    uint8_t *hash[HASHER_BATCH_SIZE];
+} HasherBatch;
+
+void hasher_batch_Init(HasherBatch *batch, HasherType type);
+void hasher_batch_Submit(HasherBatch *batch, const uint8_t *data, size_t length, uint8_t hash[HASHER_DIGEST_LENGTH]);
+void hasher_batch_Flush(HasherBatch *batch);
+
 #endif
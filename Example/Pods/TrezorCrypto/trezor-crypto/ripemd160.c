@@ -250,6 +250,262 @@ void ripemd160_process( RIPEMD160_CTX *ctx, const uint8_t data[RIPEMD160_BLOCK_L
 }
 #endif /* !MBEDTLS_RIPEMD160_PROCESS_ALT */
 
+#if defined(__GNUC__) || defined(__clang__)
+typedef uint32_t ripemd160_vec32 __attribute__((vector_size(16)));
+
+/*
+ * RIPEMD-160 compression over RIPEMD160_LANES independent blocks at once,
+ * one lane per vector element. The round macros above work unchanged on
+ * the vector type.
+ */
+static void ripemd160_process_x4( ripemd160_vec32 state[5], const uint8_t *data[RIPEMD160_LANES] )
+{
+    ripemd160_vec32 A, B, C, D, E, Ap, Bp, Cp, Dp, Ep, X[16];
+    uint32_t w[RIPEMD160_LANES];
+    int i, j;
+
+    for( i = 0; i < 16; i++ )
+    {
+        for( j = 0; j < RIPEMD160_LANES; j++ )
+        {
+            GET_UINT32_LE( w[j], data[j], 4 * i );
+        }
+        X[i] = (ripemd160_vec32){ w[0], w[1], w[2], w[3] };
+    }
+
+    A = Ap = state[0];
+    B = Bp = state[1];
+    C = Cp = state[2];
+    D = Dp = state[3];
+    E = Ep = state[4];
+
+#define F   F1
+#define K   0x00000000
+#define Fp  F5
+#define Kp  0x50A28BE6
+    P2( A, B, C, D, E,  0, 11,  5,  8 );
+    P2( E, A, B, C, D,  1, 14, 14,  9 );
+    P2( D, E, A, B, C,  2, 15,  7,  9 );
+    P2( C, D, E, A, B,  3, 12,  0, 11 );
+    P2( B, C, D, E, A,  4,  5,  9, 13 );
+    P2( A, B, C, D, E,  5,  8,  2, 15 );
+    P2( E, A, B, C, D,  6,  7, 11, 15 );
+    P2( D, E, A, B, C,  7,  9,  4,  5 );
+    P2( C, D, E, A, B,  8, 11, 13,  7 );
+    P2( B, C, D, E, A,  9, 13,  6,  7 );
+    P2( A, B, C, D, E, 10, 14, 15,  8 );
+    P2( E, A, B, C, D, 11, 15,  8, 11 );
+    P2( D, E, A, B, C, 12,  6,  1, 14 );
+    P2( C, D, E, A, B, 13,  7, 10, 14 );
+    P2( B, C, D, E, A, 14,  9,  3, 12 );
+    P2( A, B, C, D, E, 15,  8, 12,  6 );
+#undef F
+#undef K
+#undef Fp
+#undef Kp
+
+#define F   F2
+#define K   0x5A827999
+#define Fp  F4
+#define Kp  0x5C4DD124
+    P2( E, A, B, C, D,  7,  7,  6,  9 );
+    P2( D, E, A, B, C,  4,  6, 11, 13 );
+    P2( C, D, E, A, B, 13,  8,  3, 15 );
+    P2( B, C, D, E, A,  1, 13,  7,  7 );
+    P2( A, B, C, D, E, 10, 11,  0, 12 );
+    P2( E, A, B, C, D,  6,  9, 13,  8 );
+    P2( D, E, A, B, C, 15,  7,  5,  9 );
+    P2( C, D, E, A, B,  3, 15, 10, 11 );
+    P2( B, C, D, E, A, 12,  7, 14,  7 );
+    P2( A, B, C, D, E,  0, 12, 15,  7 );
+    P2( E, A, B, C, D,  9, 15,  8, 12 );
+    P2( D, E, A, B, C,  5,  9, 12,  7 );
+    P2( C, D, E, A, B,  2, 11,  4,  6 );
+    P2( B, C, D, E, A, 14,  7,  9, 15 );
+    P2( A, B, C, D, E, 11, 13,  1, 13 );
+    P2( E, A, B, C, D,  8, 12,  2, 11 );
+#undef F
+#undef K
+#undef Fp
+#undef Kp
+
+#define F   F3
+#define K   0x6ED9EBA1
+#define Fp  F3
+#define Kp  0x6D703EF3
+    P2( D, E, A, B, C,  3, 11, 15,  9 );
+    P2( C, D, E, A, B, 10, 13,  5,  7 );
+    P2( B, C, D, E, A, 14,  6,  1, 15 );
+    P2( A, B, C, D, E,  4,  7,  3, 11 );
+    P2( E, A, B, C, D,  9, 14,  7,  8 );
+    P2( D, E, A, B, C, 15,  9, 14,  6 );
+    P2( C, D, E, A, B,  8, 13,  6,  6 );
+    P2( B, C, D, E, A,  1, 15,  9, 14 );
+    P2( A, B, C, D, E,  2, 14, 11, 12 );
+    P2( E, A, B, C, D,  7,  8,  8, 13 );
+    P2( D, E, A, B, C,  0, 13, 12,  5 );
+    P2( C, D, E, A, B,  6,  6,  2, 14 );
+    P2( B, C, D, E, A, 13,  5, 10, 13 );
+    P2( A, B, C, D, E, 11, 12,  0, 13 );
+    P2( E, A, B, C, D,  5,  7,  4,  7 );
+    P2( D, E, A, B, C, 12,  5, 13,  5 );
+#undef F
+#undef K
+#undef Fp
+#undef Kp
+
+#define F   F4
+#define K   0x8F1BBCDC
+#define Fp  F2
+#define Kp  0x7A6D76E9
+    P2( C, D, E, A, B,  1, 11,  8, 15 );
+    P2( B, C, D, E, A,  9, 12,  6,  5 );
+    P2( A, B, C, D, E, 11, 14,  4,  8 );
+    P2( E, A, B, C, D, 10, 15,  1, 11 );
+    P2( D, E, A, B, C,  0, 14,  3, 14 );
+    P2( C, D, E, A, B,  8, 15, 11, 14 );
+    P2( B, C, D, E, A, 12,  9, 15,  6 );
+    P2( A, B, C, D, E,  4,  8,  0, 14 );
+    P2( E, A, B, C, D, 13,  9,  5,  6 );
+    P2( D, E, A, B, C,  3, 14, 12,  9 );
+    P2( C, D, E, A, B,  7,  5,  2, 12 );
+    P2( B, C, D, E, A, 15,  6, 13,  9 );
+    P2( A, B, C, D, E, 14,  8,  9, 12 );
+    P2( E, A, B, C, D,  5,  6,  7,  5 );
+    P2( D, E, A, B, C,  6,  5, 10, 15 );
+    P2( C, D, E, A, B,  2, 12, 14,  8 );
+#undef F
+#undef K
+#undef Fp
+#undef Kp
+
+#define F   F5
+#define K   0xA953FD4E
+#define Fp  F1
+#define Kp  0x00000000
+    P2( B, C, D, E, A,  4,  9, 12,  8 );
+    P2( A, B, C, D, E,  0, 15, 15,  5 );
+    P2( E, A, B, C, D,  5,  5, 10, 12 );
+    P2( D, E, A, B, C,  9, 11,  4,  9 );
+    P2( C, D, E, A, B,  7,  6,  1, 12 );
+    P2( B, C, D, E, A, 12,  8,  5,  5 );
+    P2( A, B, C, D, E,  2, 13,  8, 14 );
+    P2( E, A, B, C, D, 10, 12,  7,  6 );
+    P2( D, E, A, B, C, 14,  5,  6,  8 );
+    P2( C, D, E, A, B,  1, 12,  2, 13 );
+    P2( B, C, D, E, A,  3, 13, 13,  6 );
+    P2( A, B, C, D, E,  8, 14, 14,  5 );
+    P2( E, A, B, C, D, 11, 11,  0, 15 );
+    P2( D, E, A, B, C,  6,  8,  3, 13 );
+    P2( C, D, E, A, B, 15,  5,  9, 11 );
+    P2( B, C, D, E, A, 13,  6, 11, 11 );
+#undef F
+#undef K
+#undef Fp
+#undef Kp
+
+    C        = state[1] + C + Dp;
+    state[1] = state[2] + D + Ep;
+    state[2] = state[3] + E + Ap;
+    state[3] = state[4] + A + Bp;
+    state[4] = state[0] + B + Cp;
+    state[0] = C;
+}
+#endif
+
+/* Build block number `block` of the padded message */
+static void ripemd160_lane_block( const uint8_t *msg, uint32_t msg_len, uint32_t block, uint8_t buffer[RIPEMD160_BLOCK_LENGTH] )
+{
+    uint32_t offset = block * RIPEMD160_BLOCK_LENGTH;
+    uint32_t blocks = ( msg_len + 8 ) / RIPEMD160_BLOCK_LENGTH + 1;
+    uint32_t n;
+
+    memset( buffer, 0, RIPEMD160_BLOCK_LENGTH );
+    if( offset < msg_len )
+    {
+        n = msg_len - offset < RIPEMD160_BLOCK_LENGTH ? msg_len - offset : RIPEMD160_BLOCK_LENGTH;
+        memcpy( buffer, msg + offset, n );
+    }
+    if( offset <= msg_len && msg_len < offset + RIPEMD160_BLOCK_LENGTH )
+    {
+        buffer[msg_len - offset] = 0x80;
+    }
+    if( block == blocks - 1 )
+    {
+        PUT_UINT32_LE( msg_len << 3, buffer, 56 );
+        PUT_UINT32_LE( msg_len >> 29, buffer, 60 );
+    }
+}
+
+/*
+ * RIPEMD-160 of RIPEMD160_LANES independent messages
+ */
+void ripemd160_x4( const uint8_t * const msg[RIPEMD160_LANES], const uint32_t msg_len[RIPEMD160_LANES], uint8_t * const hash[RIPEMD160_LANES] )
+{
+    uint8_t buffer[RIPEMD160_LANES][RIPEMD160_BLOCK_LENGTH];
+    uint32_t result[RIPEMD160_LANES][5];
+    uint32_t blocks[RIPEMD160_LANES], max_blocks = 0;
+    uint32_t block;
+    int i, j;
+
+    for( i = 0; i < RIPEMD160_LANES; i++ )
+    {
+        blocks[i] = ( msg_len[i] + 8 ) / RIPEMD160_BLOCK_LENGTH + 1;
+        if( blocks[i] > max_blocks )
+            max_blocks = blocks[i];
+    }
+
+#if defined(__GNUC__) || defined(__clang__)
+    const uint8_t *lanes[RIPEMD160_LANES];
+    ripemd160_vec32 state[5] = {
+        { 0x67452301, 0x67452301, 0x67452301, 0x67452301 },
+        { 0xEFCDAB89, 0xEFCDAB89, 0xEFCDAB89, 0xEFCDAB89 },
+        { 0x98BADCFE, 0x98BADCFE, 0x98BADCFE, 0x98BADCFE },
+        { 0x10325476, 0x10325476, 0x10325476, 0x10325476 },
+        { 0xC3D2E1F0, 0xC3D2E1F0, 0xC3D2E1F0, 0xC3D2E1F0 },
+    };
+    for( i = 0; i < RIPEMD160_LANES; i++ )
+        lanes[i] = buffer[i];
+    for( block = 0; block < max_blocks; block++ )
+    {
+        for( i = 0; i < RIPEMD160_LANES; i++ )
+            ripemd160_lane_block( msg[i], msg_len[i], block, buffer[i] );
+        ripemd160_process_x4( state, lanes );
+        for( i = 0; i < RIPEMD160_LANES; i++ )
+        {
+            if( block == blocks[i] - 1 )
+            {
+                for( j = 0; j < 5; j++ )
+                    result[i][j] = state[j][i];
+            }
+        }
+    }
+    memzero( state, sizeof( state ) );
+#else
+    RIPEMD160_CTX ctx;
+    for( i = 0; i < RIPEMD160_LANES; i++ )
+    {
+        ripemd160_Init( &ctx );
+        for( block = 0; block < blocks[i]; block++ )
+        {
+            ripemd160_lane_block( msg[i], msg_len[i], block, buffer[i] );
+            ripemd160_process( &ctx, buffer[i] );
+        }
+        memcpy( result[i], ctx.state, sizeof( ctx.state ) );
+    }
+    memzero( &ctx, sizeof( ctx ) );
+#endif
+
+    /* Outputs are written only after every lane has been read, so a hash may alias its message */
+    for( i = 0; i < RIPEMD160_LANES; i++ )
+    {
+        for( j = 0; j < 5; j++ )
+            PUT_UINT32_LE( result[i][j], hash[i], 4 * j );
+    }
+    memzero( buffer, sizeof( buffer ) );
+    memzero( result, sizeof( result ) );
+}
+
 /*
  * RIPEMD-160 process buffer
  */
@@ -5,6 +5,7 @@
 
 #define RIPEMD160_BLOCK_LENGTH   64
 #define RIPEMD160_DIGEST_LENGTH  20
+#define RIPEMD160_LANES          4
 
 typedef struct _RIPEMD160_CTX {
     uint32_t total[2];    /*!< number of bytes processed  */
@@ -16,5 +17,6 @@ void ripemd160_Init(RIPEMD160_CTX *ctx);
 void ripemd160_Update(RIPEMD160_CTX *ctx, const uint8_t *input, uint32_t ilen);
 void ripemd160_Final(RIPEMD160_CTX *ctx, uint8_t output[RIPEMD160_DIGEST_LENGTH]);
 void ripemd160(const uint8_t *msg, uint32_t msg_len, uint8_t hash[RIPEMD160_DIGEST_LENGTH]);
+void ripemd160_x4(const uint8_t * const msg[RIPEMD160_LANES], const uint32_t msg_len[RIPEMD160_LANES], uint8_t * const hash[RIPEMD160_LANES]);
 
 #endif
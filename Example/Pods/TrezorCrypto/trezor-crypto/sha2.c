@@ -974,6 +974,161 @@ char* sha256_Data(const sha2_byte* data, size_t len, char digest[SHA256_DIGEST_S
 }
 
 
+/*** SHA-256 x4: ******************************************************/
+/*
+ * Hash SHA256_LANES independent messages at once. Each lane is padded
+ * on its own, and lanes whose message needs fewer blocks than the
+ * longest one keep compressing zero blocks after their digest has been
+ * captured. With GCC/clang vector extensions the four lanes are held
+ * in one 128-bit vector each (NEON on ARM, SSE2 on x86); otherwise the
+ * lanes fall back to sha256_Transform one after another.
+ */
+
+/* Build block number `block` of the padded message into host order words */
+static void sha256_lane_block(const sha2_byte* data, size_t len, size_t block, sha2_word32 words[16]) {
+	sha2_byte buffer[SHA256_BLOCK_LENGTH];
+	size_t offset = block * SHA256_BLOCK_LENGTH;
+	size_t blocks = (len + 8) / SHA256_BLOCK_LENGTH + 1;
+	size_t n = 0;
+
+	memzero(buffer, sizeof(buffer));
+	if (offset < len) {
+		n = len - offset < SHA256_BLOCK_LENGTH ? len - offset : SHA256_BLOCK_LENGTH;
+		MEMCPY_BCOPY(buffer, data + offset, n);
+	}
+	if (offset <= len && len < offset + SHA256_BLOCK_LENGTH) {
+		buffer[len - offset] = 0x80;
+	}
+	for (int j = 0; j < 16; j++) {
+		words[j] = ((sha2_word32)buffer[4*j] << 24) | ((sha2_word32)buffer[4*j+1] << 16) |
+		           ((sha2_word32)buffer[4*j+2] << 8) | (sha2_word32)buffer[4*j+3];
+	}
+	if (block == blocks - 1) {
+		words[14] = (sha2_word32)((sha2_word64)len >> 29);
+		words[15] = (sha2_word32)((sha2_word64)len << 3);
+	}
+	memzero(buffer, sizeof(buffer));
+}
+
+#if defined(__GNUC__) || defined(__clang__)
+
+typedef sha2_word32 sha2_vec32 __attribute__((vector_size(16)));
+
+static void sha256_Transform_x4(sha2_vec32 state[8], const sha2_word32 data[SHA256_LANES][16]) {
+	sha2_vec32	a, b, c, d, e, f, g, h, s0, s1;
+	sha2_vec32	T1, T2, W256[16];
+	int		j;
+
+	a = state[0];
+	b = state[1];
+	c = state[2];
+	d = state[3];
+	e = state[4];
+	f = state[5];
+	g = state[6];
+	h = state[7];
+
+	for (j = 0; j < 16; j++) {
+		W256[j] = (sha2_vec32){ data[0][j], data[1][j], data[2][j], data[3][j] };
+		T1 = h + Sigma1_256(e) + Ch(e, f, g) + K256[j] + W256[j];
+		T2 = Sigma0_256(a) + Maj(a, b, c);
+		h = g;
+		g = f;
+		f = e;
+		e = d + T1;
+		d = c;
+		c = b;
+		b = a;
+		a = T1 + T2;
+	}
+
+	for (; j < 64; j++) {
+		s0 = W256[(j+1)&0x0f];
+		s0 = sigma0_256(s0);
+		s1 = W256[(j+14)&0x0f];
+		s1 = sigma1_256(s1);
+
+		T1 = h + Sigma1_256(e) + Ch(e, f, g) + K256[j] +
+		     (W256[j&0x0f] += s1 + W256[(j+9)&0x0f] + s0);
+		T2 = Sigma0_256(a) + Maj(a, b, c);
+		h = g;
+		g = f;
+		f = e;
+		e = d + T1;
+		d = c;
+		c = b;
+		b = a;
+		a = T1 + T2;
+	}
+
+	state[0] += a;
+	state[1] += b;
+	state[2] += c;
+	state[3] += d;
+	state[4] += e;
+	state[5] += f;
+	state[6] += g;
+	state[7] += h;
+}
+
+#endif
+
+void sha256_Raw_x4(const sha2_byte* const data[SHA256_LANES], const size_t len[SHA256_LANES], uint8_t* const digest[SHA256_LANES]) {
+	sha2_word32	words[SHA256_LANES][16];
+	sha2_word32	result[SHA256_LANES][8];
+	size_t		blocks[SHA256_LANES], max_blocks = 0;
+	int		i, j;
+
+	for (i = 0; i < SHA256_LANES; i++) {
+		blocks[i] = (len[i] + 8) / SHA256_BLOCK_LENGTH + 1;
+		if (blocks[i] > max_blocks) {
+			max_blocks = blocks[i];
+		}
+	}
+
+#if defined(__GNUC__) || defined(__clang__)
+	sha2_vec32	state[8];
+	for (j = 0; j < 8; j++) {
+		state[j] = (sha2_vec32){ sha256_initial_hash_value[j], sha256_initial_hash_value[j],
+		                         sha256_initial_hash_value[j], sha256_initial_hash_value[j] };
+	}
+	for (size_t block = 0; block < max_blocks; block++) {
+		for (i = 0; i < SHA256_LANES; i++) {
+			sha256_lane_block(data[i], len[i], block, words[i]);
+		}
+		sha256_Transform_x4(state, (const sha2_word32 (*)[16])words);
+		for (i = 0; i < SHA256_LANES; i++) {
+			if (block == blocks[i] - 1) {
+				for (j = 0; j < 8; j++) {
+					result[i][j] = state[j][i];
+				}
+			}
+		}
+	}
+	memzero(state, sizeof(state));
+#else
+	for (i = 0; i < SHA256_LANES; i++) {
+		MEMCPY_BCOPY(result[i], sha256_initial_hash_value, SHA256_DIGEST_LENGTH);
+		for (size_t block = 0; block < blocks[i]; block++) {
+			sha256_lane_block(data[i], len[i], block, words[i]);
+			sha256_Transform(result[i], words[i], result[i]);
+		}
+	}
+#endif
+
+	/* Digests are written only after every lane has been read, so a digest may alias its input */
+	for (i = 0; i < SHA256_LANES; i++) {
+		for (j = 0; j < 8; j++) {
+			digest[i][4*j]   = (uint8_t)(result[i][j] >> 24);
+			digest[i][4*j+1] = (uint8_t)(result[i][j] >> 16);
+			digest[i][4*j+2] = (uint8_t)(result[i][j] >> 8);
+			digest[i][4*j+3] = (uint8_t)result[i][j];
+		}
+	}
+	memzero(words, sizeof(words));
+	memzero(result, sizeof(result));
+}
+
 /*** SHA-512: *********************************************************/
 void sha512_Init(SHA512_CTX* context) {
 	if (context == (SHA512_CTX*)0) {
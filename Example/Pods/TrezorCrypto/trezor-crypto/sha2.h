@@ -43,6 +43,7 @@
 #define SHA512_BLOCK_LENGTH		128
 #define SHA512_DIGEST_LENGTH		64
 #define SHA512_DIGEST_STRING_LENGTH	(SHA512_DIGEST_LENGTH * 2 + 1)
+#define SHA256_LANES			4
 
 typedef struct _SHA1_CTX {
 	uint32_t	state[5];
@@ -104,6 +105,7 @@ void sha256_Final(SHA256_CTX*, uint8_t[SHA256_DIGEST_LENGTH]);
 char* sha256_End(SHA256_CTX*, char[SHA256_DIGEST_STRING_LENGTH]);
 void sha256_Raw(const uint8_t*, size_t, uint8_t[SHA256_DIGEST_LENGTH]);
 char* sha256_Data(const uint8_t*, size_t, char[SHA256_DIGEST_STRING_LENGTH]);
+void sha256_Raw_x4(const uint8_t* const[SHA256_LANES], const size_t[SHA256_LANES], uint8_t* const[SHA256_LANES]);
 
 void sha512_Transform(const uint64_t* state_in, const uint64_t* data, uint64_t* state_out);
 void sha512_Init(SHA512_CTX*);
@@ -380,6 +380,191 @@ void keccak_512(const unsigned char* data, size_t len, unsigned char* digest)
 }
 #endif /* USE_KECCAK */
 
+#if defined(__GNUC__) || defined(__clang__)
+typedef uint64_t sha3_vec64 __attribute__((vector_size(32)));
+
+/* Keccak-f[1600] over SHA3_LANES independent states, one lane per vector element */
+static void sha3_permutation_x4(sha3_vec64 *A)
+{
+	int round;
+	unsigned int x;
+	sha3_vec64 C[5], D[5], A1, A0;
+
+	for (round = 0; round < NumberOfRounds; round++)
+	{
+		/* theta */
+		for (x = 0; x < 5; x++) {
+			C[x] = A[x] ^ A[x + 5] ^ A[x + 10] ^ A[x + 15] ^ A[x + 20];
+		}
+		D[0] = ROTL64(C[1], 1) ^ C[4];
+		D[1] = ROTL64(C[2], 1) ^ C[0];
+		D[2] = ROTL64(C[3], 1) ^ C[1];
+		D[3] = ROTL64(C[4], 1) ^ C[2];
+		D[4] = ROTL64(C[0], 1) ^ C[3];
+		for (x = 0; x < 5; x++) {
+			A[x]      ^= D[x];
+			A[x + 5]  ^= D[x];
+			A[x + 10] ^= D[x];
+			A[x + 15] ^= D[x];
+			A[x + 20] ^= D[x];
+		}
+
+		/* rho */
+		A[ 1] = ROTL64(A[ 1],  1);
+		A[ 2] = ROTL64(A[ 2], 62);
+		A[ 3] = ROTL64(A[ 3], 28);
+		A[ 4] = ROTL64(A[ 4], 27);
+		A[ 5] = ROTL64(A[ 5], 36);
+		A[ 6] = ROTL64(A[ 6], 44);
+		A[ 7] = ROTL64(A[ 7],  6);
+		A[ 8] = ROTL64(A[ 8], 55);
+		A[ 9] = ROTL64(A[ 9], 20);
+		A[10] = ROTL64(A[10],  3);
+		A[11] = ROTL64(A[11], 10);
+		A[12] = ROTL64(A[12], 43);
+		A[13] = ROTL64(A[13], 25);
+		A[14] = ROTL64(A[14], 39);
+		A[15] = ROTL64(A[15], 41);
+		A[16] = ROTL64(A[16], 45);
+		A[17] = ROTL64(A[17], 15);
+		A[18] = ROTL64(A[18], 21);
+		A[19] = ROTL64(A[19],  8);
+		A[20] = ROTL64(A[20], 18);
+		A[21] = ROTL64(A[21],  2);
+		A[22] = ROTL64(A[22], 61);
+		A[23] = ROTL64(A[23], 56);
+		A[24] = ROTL64(A[24], 14);
+
+		/* pi */
+		A1 = A[1];
+		A[ 1] = A[ 6];
+		A[ 6] = A[ 9];
+		A[ 9] = A[22];
+		A[22] = A[14];
+		A[14] = A[20];
+		A[20] = A[ 2];
+		A[ 2] = A[12];
+		A[12] = A[13];
+		A[13] = A[19];
+		A[19] = A[23];
+		A[23] = A[15];
+		A[15] = A[ 4];
+		A[ 4] = A[24];
+		A[24] = A[21];
+		A[21] = A[ 8];
+		A[ 8] = A[16];
+		A[16] = A[ 5];
+		A[ 5] = A[ 3];
+		A[ 3] = A[18];
+		A[18] = A[17];
+		A[17] = A[11];
+		A[11] = A[ 7];
+		A[ 7] = A[10];
+		A[10] = A1;
+
+		/* chi */
+		for (x = 0; x < 25; x += 5) {
+			A0 = A[0 + x];
+			A1 = A[1 + x];
+			A[0 + x] ^= ~A1 & A[2 + x];
+			A[1 + x] ^= ~A[2 + x] & A[3 + x];
+			A[2 + x] ^= ~A[3 + x] & A[4 + x];
+			A[3 + x] ^= ~A[4 + x] & A0;
+			A[4 + x] ^= ~A0 & A1;
+		}
+
+		/* iota */
+		A[0] ^= keccak_round_constants[round];
+	}
+}
+#endif
+
+/* Build block number `block` of the padded message, `pad` being the domain separation byte */
+static void sha3_lane_block(const unsigned char* data, size_t len, size_t block, unsigned char pad, uint64_t words[SHA3_256_BLOCK_LENGTH / 8])
+{
+	unsigned char *buffer = (unsigned char*)words;
+	size_t offset = block * SHA3_256_BLOCK_LENGTH;
+	size_t n;
+
+	memset(buffer, 0, SHA3_256_BLOCK_LENGTH);
+	if (offset < len) {
+		n = len - offset < SHA3_256_BLOCK_LENGTH ? len - offset : SHA3_256_BLOCK_LENGTH;
+		memcpy(buffer, data + offset, n);
+	}
+	if (offset <= len && len < offset + SHA3_256_BLOCK_LENGTH) {
+		buffer[len - offset] |= pad;
+		buffer[SHA3_256_BLOCK_LENGTH - 1] |= 0x80;
+	}
+}
+
+/* 256-bit Keccak/SHA3 of SHA3_LANES independent messages */
+static void sha3_256_lanes(const unsigned char* const data[SHA3_LANES], const size_t len[SHA3_LANES], unsigned char pad, unsigned char* const digest[SHA3_LANES])
+{
+	uint64_t words[SHA3_LANES][SHA3_256_BLOCK_LENGTH / 8];
+	uint64_t result[SHA3_LANES][sha3_256_hash_size / 8];
+	size_t blocks[SHA3_LANES], max_blocks = 0, block;
+	int i, j;
+
+	for (i = 0; i < SHA3_LANES; i++) {
+		blocks[i] = len[i] / SHA3_256_BLOCK_LENGTH + 1;
+		if (blocks[i] > max_blocks) {
+			max_blocks = blocks[i];
+		}
+	}
+
+#if defined(__GNUC__) || defined(__clang__)
+	sha3_vec64 state[sha3_max_permutation_size];
+	memset(state, 0, sizeof(state));
+	for (block = 0; block < max_blocks; block++) {
+		for (i = 0; i < SHA3_LANES; i++) {
+			sha3_lane_block(data[i], len[i], block, pad, words[i]);
+		}
+		for (j = 0; j < SHA3_256_BLOCK_LENGTH / 8; j++) {
+			state[j] ^= (sha3_vec64){ le2me_64(words[0][j]), le2me_64(words[1][j]), le2me_64(words[2][j]), le2me_64(words[3][j]) };
+		}
+		sha3_permutation_x4(state);
+		for (i = 0; i < SHA3_LANES; i++) {
+			if (block == blocks[i] - 1) {
+				for (j = 0; j < sha3_256_hash_size / 8; j++) {
+					result[i][j] = state[j][i];
+				}
+			}
+		}
+	}
+	memzero(state, sizeof(state));
+#else
+	uint64_t state[sha3_max_permutation_size];
+	for (i = 0; i < SHA3_LANES; i++) {
+		memset(state, 0, sizeof(state));
+		for (block = 0; block < blocks[i]; block++) {
+			sha3_lane_block(data[i], len[i], block, pad, words[i]);
+			sha3_process_block(state, words[i], SHA3_256_BLOCK_LENGTH);
+		}
+		memcpy(result[i], state, sizeof(result[i]));
+	}
+	memzero(state, sizeof(state));
+#endif
+
+	/* Digests are written only after every lane has been read, so a digest may alias its input */
+	for (i = 0; i < SHA3_LANES; i++) {
+		me64_to_le_str(digest[i], result[i], sha3_256_hash_size);
+	}
+	memzero(words, sizeof(words));
+	memzero(result, sizeof(result));
+}
+
+#if USE_KECCAK
+void keccak_256_x4(const unsigned char* const data[SHA3_LANES], const size_t len[SHA3_LANES], unsigned char* const digest[SHA3_LANES])
+{
+	sha3_256_lanes(data, len, 0x01, digest);
+}
+#endif /* USE_KECCAK */
+
+void sha3_256_x4(const unsigned char* const data[SHA3_LANES], const size_t len[SHA3_LANES], unsigned char* const digest[SHA3_LANES])
+{
+	sha3_256_lanes(data, len, 0x06, digest);
+}
+
 void sha3_256(const unsigned char* data, size_t len, unsigned char* digest)
 {
 	SHA3_CTX ctx;
@@ -44,6 +44,8 @@ extern "C" {
 #define SHA3_384_DIGEST_LENGTH  sha3_384_hash_size
 #define SHA3_512_DIGEST_LENGTH  sha3_512_hash_size
 
+#define SHA3_LANES 4
+
 /**
  * SHA3 Algorithm context.
  */
@@ -77,10 +79,12 @@ void sha3_Final(SHA3_CTX *ctx, unsigned char* result);
 void keccak_Final(SHA3_CTX *ctx, unsigned char* result);
 void keccak_256(const unsigned char* data, size_t len, unsigned char* digest);
 void keccak_512(const unsigned char* data, size_t len, unsigned char* digest);
+void keccak_256_x4(const unsigned char* const data[SHA3_LANES], const size_t len[SHA3_LANES], unsigned char* const digest[SHA3_LANES]);
 #endif
 
 void sha3_256(const unsigned char* data, size_t len, unsigned char* digest);
 void sha3_512(const unsigned char* data, size_t len, unsigned char* digest);
+void sha3_256_x4(const unsigned char* const data[SHA3_LANES], const size_t len[SHA3_LANES], unsigned char* const digest[SHA3_LANES]);
 
 #ifdef __cplusplus
 } /* extern "C" */
@@ -134,6 +134,23 @@ GRPCAPI grpc_event grpc_completion_queue_next(grpc_completion_queue* cq,
                                               gpr_timespec deadline,
                                               void* reserved);
 
+/** Like grpc_completion_queue_next, but returns as many events as are ready
+    (up to max_events, which must be positive) once the first one is, paying
+    the locking and polling overhead of a call once for all of them.
+
+    Returns the number of events written to events: either that many
+    GRPC_OP_COMPLETE events, or a single GRPC_QUEUE_TIMEOUT or
+    GRPC_QUEUE_SHUTDOWN event under the same conditions
+    grpc_completion_queue_next would return one.
+
+    Only valid on completion queues of type GRPC_CQ_NEXT. The same restrictions
+    as for grpc_completion_queue_next apply. */
+GRPCAPI int grpc_completion_queue_next_batch(grpc_completion_queue* cq,
+                                             grpc_event* events,
+                                             int max_events,
+                                             gpr_timespec deadline,
+                                             void* reserved);
+
 /** Blocks until an event with tag 'tag' is available, the completion queue is
     being shutdown or deadline is reached.
 
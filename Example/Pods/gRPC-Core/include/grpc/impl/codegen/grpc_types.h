@@ -179,6 +179,21 @@ typedef struct {
    application will see the compressed message in the byte buffer. */
 #define GRPC_ARG_ENABLE_PER_MESSAGE_DECOMPRESSION \
   "grpc.per_message_decompression"
+/** Experimental Arg. Path of a file holding a preset dictionary for the
+   deflate compression algorithm (see zlib's deflateSetDictionary). The file
+   is read once, when the channel or server is created. Each side announces
+   the dictionary in its initial metadata (grpc-deflate-dictionary), and
+   deflate messages are primed with it only once the peer has announced the
+   same one; until then, e.g. for a client's first request, they are sent
+   without it. Has no effect on gzip. String valued. */
+#define GRPC_ARG_DEFLATE_DICTIONARY_FILE "grpc.deflate_dictionary_file"
+/** Experimental Arg. Messages of at least this many bytes (as sent, or as
+   received while still compressed) are compressed or decompressed on the
+   EventEngine thread pool rather than inline, so that they do not hold up
+   other calls on the same thread. 0 disables offloading. Defaults to 0
+   (disabled). Int valued, bytes. */
+#define GRPC_ARG_COMPRESSION_OFFLOAD_THRESHOLD \
+  "grpc.compression_offload_threshold"
 /** Enable/disable support for deadline checking. Defaults to 1, unless
     GRPC_ARG_MINIMAL_STACK is enabled, in which case it defaults to 0 */
 #define GRPC_ARG_ENABLE_DEADLINE_CHECKS "grpc.enable_deadline_checking"
@@ -196,6 +211,16 @@ typedef struct {
 /** How much memory to use for hpack encoding. Int valued, bytes. */
 #define GRPC_ARG_HTTP2_HPACK_TABLE_SIZE_ENCODER \
   "grpc.http2.hpack_table_size.encoder"
+/** Comma separated list of metadata keys whose values the hpack encoder must
+    never add to its table, and which intermediaries are asked not to index
+    either. String valued. */
+#define GRPC_ARG_HTTP2_HPACK_NEVER_INDEX_KEYS \
+  "grpc.http2.hpack_never_index_keys"
+/** Comma separated list of metadata keys whose values the hpack encoder adds
+    to its table the first time they are sent (and again whenever they have
+    been evicted), instead of waiting to see them repeat. Meant for values
+    that are sent on every call, such as auth tokens. String valued. */
+#define GRPC_ARG_HTTP2_HPACK_PINNED_KEYS "grpc.http2.hpack_pinned_keys"
 /** How big a frame are we willing to receive via HTTP2.
     Min 16384, max 16777215. Larger values give lower CPU usage for large
     messages, but more head of line blocking for small messages. */
@@ -232,6 +257,17 @@ typedef struct {
 /** How much data are we willing to queue up per stream if
     GRPC_WRITE_BUFFER_HINT is set? This is an upper bound */
 #define GRPC_ARG_HTTP2_WRITE_BUFFER_SIZE "grpc.http2.write_buffer_size"
+/** Upper bound on how long an http2 write may be held back so that frames
+    from several calls go out together. Writes are only held back while the
+    connection is busy with small writes. Int valued, milliseconds. Defaults
+    to 0 (disabled). */
+#define GRPC_ARG_HTTP2_WRITE_COALESCING_MAX_DELAY_MS \
+  "grpc.http2.write_coalescing_max_delay_ms"
+/** Once this many bytes of messages are queued behind a held-back http2
+    write, it is flushed without waiting for the rest of the delay. Int
+    valued, bytes. Defaults to 64KiB. */
+#define GRPC_ARG_HTTP2_WRITE_COALESCING_MAX_BYTES \
+  "grpc.http2.write_coalescing_max_bytes"
 /** Should we allow receipt of true-binary data on http2 connections?
     Defaults to on (1) */
 #define GRPC_ARG_HTTP2_ENABLE_TRUE_BINARY "grpc.http2.true_binary"
@@ -350,6 +386,17 @@ typedef struct {
    issued by the tcp_write(). By default, this is set to 4. */
 #define GRPC_ARG_TCP_TX_ZEROCOPY_MAX_SIMULT_SENDS \
   "grpc.experimental.tcp_tx_zerocopy_max_simultaneous_sends"
+/* If non-zero, connections over unix domain sockets move their byte stream
+   onto shared-memory rings after connecting (Linux only). On a client this is
+   set implicitly by "unix-shm:" targets; a server must set it to accept such
+   connections. Plain unix clients of such a server are unaffected. Int valued,
+   defaults to 0. */
+#define GRPC_ARG_SHM_TRANSPORT "grpc.experimental.shm_transport"
+/* Size in bytes of each direction's shared-memory ring, rounded up to a power
+   of two between 64KiB and 64MiB. Only read by the server, which allocates the
+   segment. Defaults to 1MiB. */
+#define GRPC_ARG_SHM_TRANSPORT_RING_SIZE \
+  "grpc.experimental.shm_transport_ring_size"
 /* Timeout in milliseconds to use for calls to the grpclb load balancer.
    If 0 or unset, the balancer calls will have no deadline. */
 #define GRPC_ARG_GRPCLB_CALL_TIMEOUT_MS "grpc.grpclb_call_timeout_ms"
@@ -389,15 +436,14 @@ typedef struct {
     retries are enabled when they are configured via the service config.
     For details, see:
       https://github.com/grpc/proposal/blob/master/A6-client-retries.md
-    NOTE: Hedging functionality is not yet implemented, so those
-          fields in the service config will currently be ignored.  See
-          also the GRPC_ARG_EXPERIMENTAL_ENABLE_HEDGING arg below.
+    NOTE: Hedging policies in the service config are ignored unless the
+          GRPC_ARG_EXPERIMENTAL_ENABLE_HEDGING arg below is also set.
  */
 #define GRPC_ARG_ENABLE_RETRIES "grpc.enable_retries"
 /** Enables hedging functionality, as described in:
       https://github.com/grpc/proposal/blob/master/A6-client-retries.md
-    Default is currently false, since this functionality is not yet
-    fully implemented.
+    When set, the hedgingPolicy field of the service config's method
+    configs is honored.  Default is currently false.
     NOTE: This channel arg is experimental and will eventually be removed.
           Once hedging functionality has been implemented and proves stable,
           this arg will be removed, and the hedging functionality will
@@ -441,6 +487,18 @@ typedef struct {
 /** If set, uses a local subchannel pool within the channel. Otherwise, uses the
  * global subchannel pool. */
 #define GRPC_ARG_USE_LOCAL_SUBCHANNEL_POOL "grpc.use_local_subchannel_pool"
+/** Maximum number of connections a subchannel may open to its address. Once
+ * every open connection has as many calls as the peer's
+ * SETTINGS_MAX_CONCURRENT_STREAMS allows, the subchannel opens another one;
+ * each new call goes to the least-loaded connection. Int valued, defaults to
+ * 1 (one connection per subchannel). */
+#define GRPC_ARG_MAX_CONNECTIONS_PER_SUBCHANNEL \
+  "grpc.max_connections_per_subchannel"
+/** How long a subchannel keeps an additional connection (see
+ * GRPC_ARG_MAX_CONNECTIONS_PER_SUBCHANNEL) open without any calls on it.
+ * Int valued, milliseconds. Defaults to 30 seconds. */
+#define GRPC_ARG_SUBCHANNEL_CONNECTION_IDLE_TIMEOUT_MS \
+  "grpc.subchannel_connection_idle_timeout_ms"
 /** gRPC Objective-C channel pooling domain string. */
 #define GRPC_ARG_CHANNEL_POOL_DOMAIN "grpc.channel_pooling_domain"
 /** gRPC Objective-C channel pooling id. */
@@ -507,6 +507,10 @@ class ClientChannel::SubchannelWrapper : public SubchannelInterface {
     return subchannel_->connected_subchannel();
   }
 
+  RefCountedPtr<ConnectedSubchannel> connected_subchannel_for_call() const {
+    return subchannel_->GetConnectedSubchannelForCall();
+  }
+
   void RequestConnection() override { subchannel_->RequestConnection(); }
 
   void ResetBackoff() override { subchannel_->ResetBackoff(); }
@@ -2810,6 +2814,14 @@ void ClientChannel::LoadBalancedCall::StartTransportStreamOpBatch(
       gpr_log(GPR_INFO, "chand=%p lb_call=%p: recording cancel_error=%s",
               chand_, this, grpc_error_std_string(cancel_error_).c_str());
     }
+    // If our pick is queued, drop it from the queue here.  We can't rely on
+    // the call combiner cancellation closure to do that, because when the
+    // retry filter is hedging, a later attempt's queued pick may have
+    // replaced ours as the registered closure.
+    {
+      MutexLock lock(&chand_->data_plane_mu_);
+      MaybeRemoveCallFromLbQueuedCallsLocked();
+    }
     // Fail all pending batches.
     PendingBatchesFail(GRPC_ERROR_REF(cancel_error_), NoYieldCallCombiner);
     // Note: This will release the call combiner.
@@ -2959,10 +2971,7 @@ void ClientChannel::LoadBalancedCall::RecordCallCompletion(
 void ClientChannel::LoadBalancedCall::CreateSubchannelCall() {
   SubchannelCall::Args call_args = {
       std::move(connected_subchannel_), pollent_, path_.Ref(), /*start_time=*/0,
-      deadline_, arena_,
-      // TODO(roth): When we implement hedging support, we will probably
-      // need to use a separate call context for each subchannel call.
-      call_context_, call_combiner_};
+      deadline_, arena_, call_context_, call_combiner_};
   grpc_error_handle error = GRPC_ERROR_NONE;
   subchannel_call_ = SubchannelCall::Create(std::move(call_args), &error);
   if (GRPC_TRACE_FLAG_ENABLED(grpc_client_channel_lb_call_trace)) {
@@ -2983,11 +2992,12 @@ void ClientChannel::LoadBalancedCall::CreateSubchannelCall() {
 
 // A class to handle the call combiner cancellation callback for a
 // queued pick.
-// TODO(roth): When we implement hedging support, we won't be able to
-// register a call combiner cancellation closure for each LB pick,
-// because there may be multiple LB picks happening in parallel.
-// Instead, we will probably need to maintain a list in the CallData
-// object of pending LB picks to be cancelled when the closure runs.
+// Note that when the retry filter is hedging, there may be multiple LB
+// picks happening in parallel, and only the most recently queued one has
+// its closure registered.  The others are removed from the queue when the
+// retry filter sends them a cancel_stream op.
+// TODO(roth): Consider maintaining a list in the CallData object of
+// pending LB picks to be cancelled when the closure runs.
 class ClientChannel::LoadBalancedCall::LbQueuedCallCanceller {
  public:
   explicit LbQueuedCallCanceller(RefCountedPtr<LoadBalancedCall> lb_call)
@@ -3121,7 +3131,8 @@ bool ClientChannel::LoadBalancedCall::PickSubchannelLocked(
             // holding the data plane mutex.
             SubchannelWrapper* subchannel = static_cast<SubchannelWrapper*>(
                 complete_pick->subchannel.get());
-            connected_subchannel_ = subchannel->connected_subchannel();
+            connected_subchannel_ =
+                subchannel->connected_subchannel_for_call();
             // If the subchannel has no connected subchannel (e.g., if the
             // subchannel has moved out of state READY but the LB policy hasn't
             // yet seen that change and given us a new picker), then just
@@ -20,7 +20,9 @@
 
 #include "src/core/ext/filters/client_channel/client_channel_channelz.h"
 
+#include <algorithm>
 #include <map>
+#include <vector>
 
 #include "src/core/lib/transport/connectivity_state.h"
 
@@ -46,6 +48,22 @@ void SubchannelNode::SetChildSocket(RefCountedPtr<SocketNode> socket) {
   child_socket_ = std::move(socket);
 }
 
+void SubchannelNode::AddPooledSocket(RefCountedPtr<SocketNode> socket) {
+  if (socket == nullptr) return;
+  MutexLock lock(&socket_mu_);
+  pooled_sockets_.push_back(std::move(socket));
+}
+
+void SubchannelNode::RemovePooledSocket(SocketNode* socket) {
+  MutexLock lock(&socket_mu_);
+  pooled_sockets_.erase(
+      std::remove_if(pooled_sockets_.begin(), pooled_sockets_.end(),
+                     [socket](const RefCountedPtr<SocketNode>& s) {
+                       return s.get() == socket;
+                     }),
+      pooled_sockets_.end());
+}
+
 Json SubchannelNode::RenderJson() {
   // Create and fill the data child.
   grpc_connectivity_state state =
@@ -73,20 +91,24 @@ Json SubchannelNode::RenderJson() {
        }},
       {"data", std::move(data)},
   };
-  // Populate the child socket.
-  RefCountedPtr<SocketNode> child_socket;
+  // Populate the child sockets: the main connection first, followed by any
+  // pooled ones.
+  std::vector<RefCountedPtr<SocketNode>> sockets;
   {
     MutexLock lock(&socket_mu_);
-    child_socket = child_socket_;
+    if (child_socket_ != nullptr) sockets.push_back(child_socket_);
+    sockets.insert(sockets.end(), pooled_sockets_.begin(),
+                   pooled_sockets_.end());
   }
-  if (child_socket != nullptr && child_socket->uuid() != 0) {
-    object["socketRef"] = Json::Array{
-        Json::Object{
-            {"socketId", std::to_string(child_socket->uuid())},
-            {"name", child_socket->name()},
-        },
-    };
+  Json::Array socket_refs;
+  for (const auto& socket : sockets) {
+    if (socket->uuid() == 0) continue;
+    socket_refs.emplace_back(Json::Object{
+        {"socketId", std::to_string(socket->uuid())},
+        {"name", socket->name()},
+    });
   }
+  if (!socket_refs.empty()) object["socketRef"] = std::move(socket_refs);
   return object;
 }
 
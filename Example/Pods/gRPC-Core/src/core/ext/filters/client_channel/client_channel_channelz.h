@@ -26,6 +26,7 @@
 #include <atomic>
 #include <string>
 #include <utility>
+#include <vector>
 
 #include "absl/base/thread_annotations.h"
 
@@ -54,6 +55,11 @@ class SubchannelNode : public BaseNode {
   // subchannel unrefs the transport.
   void SetChildSocket(RefCountedPtr<SocketNode> socket);
 
+  // Used when the subchannel opens or closes a connection in addition to its
+  // main one (see GRPC_ARG_MAX_CONNECTIONS_PER_SUBCHANNEL).
+  void AddPooledSocket(RefCountedPtr<SocketNode> socket);
+  void RemovePooledSocket(SocketNode* socket);
+
   Json RenderJson() override;
 
   // proxy methods to composed classes.
@@ -74,6 +80,8 @@ class SubchannelNode : public BaseNode {
   std::atomic<grpc_connectivity_state> connectivity_state_{GRPC_CHANNEL_IDLE};
   Mutex socket_mu_;
   RefCountedPtr<SocketNode> child_socket_ ABSL_GUARDED_BY(socket_mu_);
+  std::vector<RefCountedPtr<SocketNode>> pooled_sockets_
+      ABSL_GUARDED_BY(socket_mu_);
   std::string target_;
   CallCountingHelper call_counter_;
   ChannelTrace trace_;
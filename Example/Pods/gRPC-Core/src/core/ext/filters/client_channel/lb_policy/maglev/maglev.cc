@@ -0,0 +1,849 @@
+//
+// Copyright 2022 gRPC authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+#include <grpc/support/port_platform.h>
+
+#include "src/core/ext/filters/client_channel/lb_policy/maglev/maglev.h"
+
+#include <inttypes.h>
+#include <stdlib.h>
+
+#include <algorithm>
+#include <atomic>
+#include <limits>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "absl/base/attributes.h"
+#include "absl/base/thread_annotations.h"
+#include "absl/memory/memory.h"
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/strings/numbers.h"
+#include "absl/strings/str_cat.h"
+#include "absl/strings/str_join.h"
+#include "absl/strings/string_view.h"
+#include "absl/types/optional.h"
+
+#define XXH_INLINE_ALL
+#include "xxhash.h"
+
+#include <grpc/impl/codegen/connectivity_state.h>
+#include <grpc/support/alloc.h>
+#include <grpc/support/log.h>
+
+#include "src/core/ext/filters/client_channel/client_channel.h"
+#include "src/core/ext/filters/client_channel/lb_policy/ring_hash/ring_hash.h"
+#include "src/core/ext/filters/client_channel/lb_policy/subchannel_list.h"
+#include "src/core/lib/address_utils/sockaddr_utils.h"
+#include "src/core/lib/channel/channel_args.h"
+#include "src/core/lib/debug/trace.h"
+#include "src/core/lib/gpr/env.h"
+#include "src/core/lib/gpr/string.h"
+#include "src/core/lib/gprpp/debug_location.h"
+#include "src/core/lib/gprpp/orphanable.h"
+#include "src/core/lib/gprpp/ref_counted.h"
+#include "src/core/lib/gprpp/ref_counted_ptr.h"
+#include "src/core/lib/gprpp/sync.h"
+#include "src/core/lib/gprpp/unique_type_name.h"
+#include "src/core/lib/gprpp/work_serializer.h"
+#include "src/core/lib/iomgr/closure.h"
+#include "src/core/lib/iomgr/error.h"
+#include "src/core/lib/iomgr/exec_ctx.h"
+#include "src/core/lib/json/json.h"
+#include "src/core/lib/load_balancing/lb_policy.h"
+#include "src/core/lib/load_balancing/lb_policy_factory.h"
+#include "src/core/lib/load_balancing/lb_policy_registry.h"
+#include "src/core/lib/load_balancing/subchannel_interface.h"
+#include "src/core/lib/resolver/server_address.h"
+#include "src/core/lib/transport/connectivity_state.h"
+
+namespace grpc_core {
+
+TraceFlag grpc_lb_maglev_trace(false, "maglev_lb");
+
+bool XdsMaglevEnabled() {
+  char* value = gpr_getenv("GRPC_EXPERIMENTAL_XDS_MAGLEV_LB");
+  bool parsed_value;
+  bool parse_succeeded = gpr_parse_bool_value(value, &parsed_value);
+  gpr_free(value);
+  return parse_succeeded && parsed_value;
+}
+
+absl::Status ValidateMaglevTableSize(uint64_t table_size) {
+  // Same upper bound as Envoy.
+  bool valid = table_size >= 2 && table_size <= 5000011;
+  for (uint64_t d = 2; valid && d * d <= table_size; ++d) {
+    if (table_size % d == 0) valid = false;
+  }
+  if (!valid) {
+    return absl::InvalidArgumentError(
+        "field:table_size error: must be a prime number between 2 and "
+        "5000011");
+  }
+  return absl::OkStatus();
+}
+
+// Helper Parser method
+absl::StatusOr<MaglevConfig> ParseMaglevLbConfig(const Json& json) {
+  if (json.type() != Json::Type::OBJECT) {
+    return absl::InvalidArgumentError(
+        "maglev_experimental should be of type object");
+  }
+  MaglevConfig config;
+  std::vector<std::string> errors;
+  const Json::Object& maglev = json.object_value();
+  auto maglev_it = maglev.find("table_size");
+  if (maglev_it != maglev.end()) {
+    if (maglev_it->second.type() != Json::Type::NUMBER) {
+      errors.emplace_back("field:table_size error: should be of type number");
+    } else {
+      uint64_t table_size;
+      if (!absl::SimpleAtoi(maglev_it->second.string_value(), &table_size)) {
+        errors.emplace_back(
+            "field:table_size error: should be a non-negative integer");
+      } else {
+        config.table_size = table_size;
+        absl::Status status = ValidateMaglevTableSize(table_size);
+        if (!status.ok()) errors.emplace_back(status.message());
+      }
+    }
+  }
+  if (!errors.empty()) {
+    return absl::InvalidArgumentError(
+        absl::StrCat("errors parsing maglev LB config: [",
+                     absl::StrJoin(errors, "; "), "]"));
+  }
+  return config;
+}
+
+namespace {
+
+constexpr absl::string_view kMaglev = "maglev_experimental";
+
+class MaglevLbConfig : public LoadBalancingPolicy::Config {
+ public:
+  explicit MaglevLbConfig(uint64_t table_size) : table_size_(table_size) {}
+  absl::string_view name() const override { return kMaglev; }
+  uint64_t table_size() const { return table_size_; }
+
+ private:
+  uint64_t table_size_;
+};
+
+//
+// maglev LB policy
+//
+
+class Maglev : public LoadBalancingPolicy {
+ public:
+  explicit Maglev(Args args);
+
+  absl::string_view name() const override { return kMaglev; }
+
+  void UpdateLocked(UpdateArgs args) override;
+  void ResetBackoffLocked() override;
+
+ private:
+  ~Maglev() override;
+
+  // Forward declarations.
+  class MaglevSubchannelList;
+  class Table;
+
+  // Data for a particular subchannel in a subchannel list.
+  // This subclass adds the following functionality:
+  // - Tracks the previous connectivity state of the subchannel, so that
+  //   we know how many subchannels are in each state.
+  class MaglevSubchannelData
+      : public SubchannelData<MaglevSubchannelList, MaglevSubchannelData> {
+   public:
+    MaglevSubchannelData(
+        SubchannelList<MaglevSubchannelList, MaglevSubchannelData>*
+            subchannel_list,
+        const ServerAddress& address,
+        RefCountedPtr<SubchannelInterface> subchannel)
+        : SubchannelData(subchannel_list, address, std::move(subchannel)),
+          address_(address) {}
+
+    const ServerAddress& address() const { return address_; }
+
+    grpc_connectivity_state GetConnectivityState() const {
+      return connectivity_state_.load(std::memory_order_relaxed);
+    }
+
+    absl::Status GetConnectivityStatus() const {
+      MutexLock lock(&mu_);
+      return connectivity_status_;
+    }
+
+   private:
+    // Performs connectivity state updates that need to be done only
+    // after we have started watching.
+    void ProcessConnectivityChangeLocked(
+        absl::optional<grpc_connectivity_state> old_state,
+        grpc_connectivity_state new_state) override;
+
+    ServerAddress address_;
+
+    // Last logical connectivity state seen.
+    // Note that this may differ from the state actually reported by the
+    // subchannel in some cases; for example, once this is set to
+    // TRANSIENT_FAILURE, we do not change it again until we get READY,
+    // so we skip any interim stops in CONNECTING.
+    // Uses an atomic so that it can be accessed outside of the WorkSerializer.
+    std::atomic<grpc_connectivity_state> connectivity_state_{GRPC_CHANNEL_IDLE};
+
+    mutable Mutex mu_;
+    absl::Status connectivity_status_ ABSL_GUARDED_BY(&mu_);
+  };
+
+  // A list of subchannels.
+  class MaglevSubchannelList
+      : public SubchannelList<MaglevSubchannelList, MaglevSubchannelData> {
+   public:
+    MaglevSubchannelList(Maglev* policy, ServerAddressList addresses,
+                         const ChannelArgs& args)
+        : SubchannelList(policy,
+                         (GRPC_TRACE_FLAG_ENABLED(grpc_lb_maglev_trace)
+                              ? "MaglevSubchannelList"
+                              : nullptr),
+                         std::move(addresses), policy->channel_control_helper(),
+                         args),
+          num_idle_(num_subchannels()),
+          table_(MakeRefCounted<Table>(policy, Ref(DEBUG_LOCATION, "Table"))) {
+      // Need to maintain a ref to the LB policy as long as we maintain
+      // any references to subchannels, since the subchannels'
+      // pollset_sets will include the LB policy's pollset_set.
+      policy->Ref(DEBUG_LOCATION, "subchannel_list").release();
+    }
+
+    ~MaglevSubchannelList() override {
+      table_.reset(DEBUG_LOCATION, "~MaglevSubchannelList");
+      Maglev* p = static_cast<Maglev*>(policy());
+      p->Unref(DEBUG_LOCATION, "subchannel_list");
+    }
+
+    // Updates the counters of subchannels in each state when a
+    // subchannel transitions from old_state to new_state.
+    void UpdateStateCountersLocked(grpc_connectivity_state old_state,
+                                   grpc_connectivity_state new_state);
+
+    // Updates the Maglev policy's connectivity state based on the
+    // subchannel list's state counters, creating a new picker.
+    // The index parameter indicates the index into the list of the subchannel
+    // whose status report triggered the call to
+    // UpdateMaglevConnectivityStateLocked().
+    // connection_attempt_complete is true if the subchannel just
+    // finished a connection attempt.
+    void UpdateMaglevConnectivityStateLocked(size_t index,
+                                             bool connection_attempt_complete,
+                                             absl::Status status);
+
+   private:
+    bool AllSubchannelsSeenInitialState() {
+      for (size_t i = 0; i < num_subchannels(); ++i) {
+        if (!subchannel(i)->connectivity_state().has_value()) return false;
+      }
+      return true;
+    }
+
+    void ShutdownLocked() override {
+      table_.reset(DEBUG_LOCATION, "MaglevSubchannelList::ShutdownLocked()");
+      SubchannelList::ShutdownLocked();
+    }
+
+    size_t num_idle_;
+    size_t num_ready_ = 0;
+    size_t num_connecting_ = 0;
+    size_t num_transient_failure_ = 0;
+
+    RefCountedPtr<Table> table_;
+
+    // The index of the subchannel currently doing an internally
+    // triggered connection attempt, if any.
+    absl::optional<size_t> internally_triggered_connection_index_;
+
+    // TODO(roth): If we ever change the helper UpdateState() API to not
+    // need the status reported for TRANSIENT_FAILURE state (because
+    // it's not currently actually used for anything outside of the picker),
+    // then we will no longer need this data member.
+    absl::Status last_failure_;
+  };
+
+  // The Maglev lookup table.  Each backend fills table slots in the
+  // order of its own permutation of the table, taking turns in proportion
+  // to its weight, until the table is full.  A pick is a single table
+  // lookup, and adding or removing a backend only moves the slots of
+  // backends whose preferred slots collide with it.
+  class Table : public RefCounted<Table> {
+   public:
+    Table(Maglev* parent, RefCountedPtr<MaglevSubchannelList> subchannel_list);
+
+    size_t size() const { return table_.size(); }
+
+    MaglevSubchannelData* subchannel(size_t position) const {
+      return subchannel_list_->subchannel(table_[position]);
+    }
+
+   private:
+    RefCountedPtr<MaglevSubchannelList> subchannel_list_;
+    // Indexes into subchannel_list_.
+    std::vector<uint32_t> table_;
+  };
+
+  class Picker : public SubchannelPicker {
+   public:
+    Picker(RefCountedPtr<Maglev> parent, RefCountedPtr<Table> table)
+        : parent_(std::move(parent)), table_(std::move(table)) {}
+
+    PickResult Pick(PickArgs args) override;
+
+   private:
+    // A fire-and-forget class that schedules subchannel connection attempts
+    // on the control plane WorkSerializer.
+    class SubchannelConnectionAttempter : public Orphanable {
+     public:
+      explicit SubchannelConnectionAttempter(
+          RefCountedPtr<Maglev> maglev_lb)
+          : maglev_lb_(std::move(maglev_lb)) {
+        GRPC_CLOSURE_INIT(&closure_, RunInExecCtx, this, nullptr);
+      }
+
+      void AddSubchannel(RefCountedPtr<SubchannelInterface> subchannel) {
+        subchannels_.push_back(std::move(subchannel));
+      }
+
+      void Orphan() override {
+        // Hop into ExecCtx, so that we're not holding the data plane mutex
+        // while we run control-plane code.
+        ExecCtx::Run(DEBUG_LOCATION, &closure_, GRPC_ERROR_NONE);
+      }
+
+     private:
+      static void RunInExecCtx(void* arg, grpc_error_handle /*error*/) {
+        auto* self = static_cast<SubchannelConnectionAttempter*>(arg);
+        self->maglev_lb_->work_serializer()->Run(
+            [self]() {
+              if (!self->maglev_lb_->shutdown_) {
+                for (auto& subchannel : self->subchannels_) {
+                  subchannel->RequestConnection();
+                }
+              }
+              delete self;
+            },
+            DEBUG_LOCATION);
+      }
+
+      RefCountedPtr<Maglev> maglev_lb_;
+      grpc_closure closure_;
+      std::vector<RefCountedPtr<SubchannelInterface>> subchannels_;
+    };
+
+    RefCountedPtr<Maglev> parent_;
+    RefCountedPtr<Table> table_;
+  };
+
+  void ShutdownLocked() override;
+
+  // Current config from resolver.
+  RefCountedPtr<MaglevLbConfig> config_;
+
+  // list of subchannels.
+  OrphanablePtr<MaglevSubchannelList> subchannel_list_;
+  OrphanablePtr<MaglevSubchannelList> latest_pending_subchannel_list_;
+  // indicating if we are shutting down.
+  bool shutdown_ = false;
+};
+
+//
+// Maglev::Table
+//
+
+Maglev::Table::Table(Maglev* parent,
+                     RefCountedPtr<MaglevSubchannelList> subchannel_list)
+    : subchannel_list_(std::move(subchannel_list)) {
+  const size_t num_subchannels = subchannel_list_->num_subchannels();
+  if (num_subchannels == 0) return;
+  const uint64_t table_size = parent->config_->table_size();
+  struct BuildEntry {
+    // Next slot in this backend's permutation of the table.
+    uint64_t position;
+    uint64_t skip;
+    uint64_t weight = 1;
+    // In units of max_weight; the backend takes a turn once
+    // iteration * weight reaches this.
+    uint64_t target_weight = 0;
+  };
+  std::vector<BuildEntry> entries;
+  entries.reserve(num_subchannels);
+  uint64_t max_weight = 0;
+  for (size_t i = 0; i < num_subchannels; ++i) {
+    MaglevSubchannelData* sd = subchannel_list_->subchannel(i);
+    const ServerAddressWeightAttribute* weight_attribute = static_cast<
+        const ServerAddressWeightAttribute*>(sd->address().GetAttribute(
+        ServerAddressWeightAttribute::kServerAddressWeightAttributeKey));
+    const std::string address =
+        grpc_sockaddr_to_string(&sd->address().address(), false).value();
+    BuildEntry entry;
+    entry.position =
+        XXH64(address.data(), address.size(), /*seed=*/0) % table_size;
+    entry.skip =
+        XXH64(address.data(), address.size(), /*seed=*/1) % (table_size - 1) +
+        1;
+    // Weight should never be zero, but ignore it just in case, since
+    // that value would keep the backend from ever taking a turn.
+    if (weight_attribute != nullptr && weight_attribute->weight() > 0) {
+      entry.weight = weight_attribute->weight();
+    }
+    max_weight = std::max(max_weight, entry.weight);
+    entries.push_back(entry);
+  }
+  constexpr uint32_t kEmpty = std::numeric_limits<uint32_t>::max();
+  table_.assign(table_size, kEmpty);
+  // Since table_size is prime, every skip is coprime with it, so each
+  // permutation visits every slot and the loop below terminates.
+  // position and skip are both below table_size, so advancing never
+  // needs more than one subtraction (cheaper than a 64-bit modulo in
+  // this loop, which dominates the build time as the table fills up).
+  auto advance = [table_size](BuildEntry* entry) {
+    entry->position += entry->skip;
+    if (entry->position >= table_size) entry->position -= table_size;
+  };
+  uint64_t filled = 0;
+  for (uint64_t iteration = 1; filled < table_size; ++iteration) {
+    for (size_t i = 0; i < num_subchannels && filled < table_size; ++i) {
+      BuildEntry& entry = entries[i];
+      if (iteration * entry.weight < entry.target_weight) continue;
+      entry.target_weight += max_weight;
+      while (table_[entry.position] != kEmpty) advance(&entry);
+      table_[entry.position] = static_cast<uint32_t>(i);
+      advance(&entry);
+      ++filled;
+    }
+  }
+  if (GRPC_TRACE_FLAG_ENABLED(grpc_lb_maglev_trace)) {
+    gpr_log(GPR_INFO,
+            "[MAGLEV %p] created lookup table from subchannel_list=%p "
+            "with %" PRIuPTR " entries",
+            parent, subchannel_list_.get(), table_.size());
+  }
+}
+
+//
+// Maglev::Picker
+//
+
+Maglev::PickResult Maglev::Picker::Pick(PickArgs args) {
+  auto* call_state = static_cast<ClientChannel::LoadBalancedCall::LbCallState*>(
+      args.call_state);
+  auto hash = call_state->GetCallAttribute(RequestHashAttributeName());
+  uint64_t h;
+  if (!absl::SimpleAtoi(hash, &h)) {
+    return PickResult::Fail(
+        absl::InternalError("maglev hash value is not a number"));
+  }
+  const Table& table = *table_;
+  const size_t first_index = h % table.size();
+  MaglevSubchannelData* first_subchannel = table.subchannel(first_index);
+  OrphanablePtr<SubchannelConnectionAttempter> subchannel_connection_attempter;
+  auto ScheduleSubchannelConnectionAttempt =
+      [&](RefCountedPtr<SubchannelInterface> subchannel) {
+        if (subchannel_connection_attempter == nullptr) {
+          subchannel_connection_attempter =
+              MakeOrphanable<SubchannelConnectionAttempter>(parent_);
+        }
+        subchannel_connection_attempter->AddSubchannel(std::move(subchannel));
+      };
+  switch (first_subchannel->GetConnectivityState()) {
+    case GRPC_CHANNEL_READY:
+      return PickResult::Complete(first_subchannel->subchannel()->Ref());
+    case GRPC_CHANNEL_IDLE:
+      ScheduleSubchannelConnectionAttempt(
+          first_subchannel->subchannel()->Ref());
+      ABSL_FALLTHROUGH_INTENDED;
+    case GRPC_CHANNEL_CONNECTING:
+      return PickResult::Queue();
+    default:  // GRPC_CHANNEL_TRANSIENT_FAILURE
+      break;
+  }
+  ScheduleSubchannelConnectionAttempt(first_subchannel->subchannel()->Ref());
+  // Loop through remaining subchannels to find one in READY.
+  // On the way, we make sure the right set of connection attempts
+  // will happen.
+  bool found_second_subchannel = false;
+  bool found_first_non_failed = false;
+  for (size_t i = 1; i < table.size(); ++i) {
+    MaglevSubchannelData* subchannel =
+        table.subchannel((first_index + i) % table.size());
+    if (subchannel == first_subchannel) continue;
+    grpc_connectivity_state connectivity_state =
+        subchannel->GetConnectivityState();
+    if (connectivity_state == GRPC_CHANNEL_READY) {
+      return PickResult::Complete(subchannel->subchannel()->Ref());
+    }
+    if (!found_second_subchannel) {
+      switch (connectivity_state) {
+        case GRPC_CHANNEL_IDLE:
+          ScheduleSubchannelConnectionAttempt(subchannel->subchannel()->Ref());
+          ABSL_FALLTHROUGH_INTENDED;
+        case GRPC_CHANNEL_CONNECTING:
+          return PickResult::Queue();
+        default:
+          break;
+      }
+      found_second_subchannel = true;
+    }
+    if (!found_first_non_failed) {
+      if (connectivity_state == GRPC_CHANNEL_TRANSIENT_FAILURE) {
+        ScheduleSubchannelConnectionAttempt(subchannel->subchannel()->Ref());
+      } else {
+        if (connectivity_state == GRPC_CHANNEL_IDLE) {
+          ScheduleSubchannelConnectionAttempt(subchannel->subchannel()->Ref());
+        }
+        found_first_non_failed = true;
+      }
+    }
+  }
+  return PickResult::Fail(absl::UnavailableError(absl::StrCat(
+      "maglev cannot find a connected subchannel; first failure: ",
+      first_subchannel->GetConnectivityStatus().ToString())));
+}
+
+//
+// Maglev::MaglevSubchannelList
+//
+
+void Maglev::MaglevSubchannelList::UpdateStateCountersLocked(
+    grpc_connectivity_state old_state, grpc_connectivity_state new_state) {
+  if (old_state == GRPC_CHANNEL_IDLE) {
+    GPR_ASSERT(num_idle_ > 0);
+    --num_idle_;
+  } else if (old_state == GRPC_CHANNEL_READY) {
+    GPR_ASSERT(num_ready_ > 0);
+    --num_ready_;
+  } else if (old_state == GRPC_CHANNEL_CONNECTING) {
+    GPR_ASSERT(num_connecting_ > 0);
+    --num_connecting_;
+  } else if (old_state == GRPC_CHANNEL_TRANSIENT_FAILURE) {
+    GPR_ASSERT(num_transient_failure_ > 0);
+    --num_transient_failure_;
+  }
+  GPR_ASSERT(new_state != GRPC_CHANNEL_SHUTDOWN);
+  if (new_state == GRPC_CHANNEL_IDLE) {
+    ++num_idle_;
+  } else if (new_state == GRPC_CHANNEL_READY) {
+    ++num_ready_;
+  } else if (new_state == GRPC_CHANNEL_CONNECTING) {
+    ++num_connecting_;
+  } else if (new_state == GRPC_CHANNEL_TRANSIENT_FAILURE) {
+    ++num_transient_failure_;
+  }
+}
+
+void Maglev::MaglevSubchannelList::UpdateMaglevConnectivityStateLocked(
+    size_t index, bool connection_attempt_complete, absl::Status status) {
+  Maglev* p = static_cast<Maglev*>(policy());
+  // If this is latest_pending_subchannel_list_, then swap it into
+  // subchannel_list_ as soon as we get the initial connectivity state
+  // report for every subchannel in the list.
+  if (p->latest_pending_subchannel_list_.get() == this &&
+      AllSubchannelsSeenInitialState()) {
+    if (GRPC_TRACE_FLAG_ENABLED(grpc_lb_maglev_trace)) {
+      gpr_log(GPR_INFO, "[MAGLEV %p] replacing subchannel list %p with %p", p,
+              p->subchannel_list_.get(), this);
+    }
+    p->subchannel_list_ = std::move(p->latest_pending_subchannel_list_);
+  }
+  // Only set connectivity state if this is the current subchannel list.
+  if (p->subchannel_list_.get() != this) return;
+  // The overall aggregation rules here are:
+  // 1. If there is at least one subchannel in READY state, report READY.
+  // 2. If there are 2 or more subchannels in TRANSIENT_FAILURE state, report
+  //    TRANSIENT_FAILURE.
+  // 3. If there is at least one subchannel in CONNECTING state, report
+  //    CONNECTING.
+  // 4. If there is one subchannel in TRANSIENT_FAILURE state and there is
+  //    more than one subchannel, report CONNECTING.
+  // 5. If there is at least one subchannel in IDLE state, report IDLE.
+  // 6. Otherwise, report TRANSIENT_FAILURE.
+  //
+  // We set start_connection_attempt to true if we match rules 2, 3, or 6.
+  grpc_connectivity_state state;
+  bool start_connection_attempt = false;
+  if (num_ready_ > 0) {
+    state = GRPC_CHANNEL_READY;
+  } else if (num_transient_failure_ >= 2) {
+    state = GRPC_CHANNEL_TRANSIENT_FAILURE;
+    start_connection_attempt = true;
+  } else if (num_connecting_ > 0) {
+    state = GRPC_CHANNEL_CONNECTING;
+  } else if (num_transient_failure_ == 1 && num_subchannels() > 1) {
+    state = GRPC_CHANNEL_CONNECTING;
+    start_connection_attempt = true;
+  } else if (num_idle_ > 0) {
+    state = GRPC_CHANNEL_IDLE;
+  } else {
+    state = GRPC_CHANNEL_TRANSIENT_FAILURE;
+    start_connection_attempt = true;
+  }
+  // In TRANSIENT_FAILURE, report the last reported failure.
+  // Otherwise, report OK.
+  if (state == GRPC_CHANNEL_TRANSIENT_FAILURE) {
+    if (!status.ok()) {
+      last_failure_ = absl::UnavailableError(absl::StrCat(
+          "no reachable subchannels; last error: ", status.ToString()));
+    }
+    status = last_failure_;
+  } else {
+    status = absl::OkStatus();
+  }
+  // Generate new picker and return it to the channel.
+  // Note that we use our own picker regardless of connectivity state.
+  p->channel_control_helper()->UpdateState(
+      state, status,
+      absl::make_unique<Picker>(p->Ref(DEBUG_LOCATION, "MaglevPicker"),
+                                table_));
+  // While the maglev policy is reporting TRANSIENT_FAILURE, it will
+  // not be getting any pick requests from the priority policy.
+  // However, because the maglev policy does not attempt to
+  // reconnect to subchannels unless it is getting pick requests,
+  // it will need special handling to ensure that it will eventually
+  // recover from TRANSIENT_FAILURE state once the problem is resolved.
+  // Specifically, it will make sure that it is attempting to connect to
+  // at least one subchannel at any given time.  After a given subchannel
+  // fails a connection attempt, it will move on to the next subchannel
+  // in the list.  It will keep doing this until one of the subchannels
+  // successfully connects, at which point it will report READY and stop
+  // proactively trying to connect.  The policy will remain in
+  // TRANSIENT_FAILURE until at least one subchannel becomes connected,
+  // even if subchannels are in state CONNECTING during that time.
+  //
+  // Note that we do the same thing when the policy is in state
+  // CONNECTING, just to ensure that we don't remain in CONNECTING state
+  // indefinitely if there are no new picks coming in.
+  if (internally_triggered_connection_index_.has_value() &&
+      *internally_triggered_connection_index_ == index &&
+      connection_attempt_complete) {
+    internally_triggered_connection_index_.reset();
+  }
+  if (start_connection_attempt &&
+      !internally_triggered_connection_index_.has_value()) {
+    size_t next_index = (index + 1) % num_subchannels();
+    if (GRPC_TRACE_FLAG_ENABLED(grpc_lb_maglev_trace)) {
+      gpr_log(GPR_INFO,
+              "[MAGLEV %p] triggering internal connection attempt for "
+              "subchannel %p, subchannel_list %p (index %" PRIuPTR
+              " of %" PRIuPTR ")",
+              p, subchannel(next_index)->subchannel(), this, next_index,
+              num_subchannels());
+    }
+    internally_triggered_connection_index_ = next_index;
+    subchannel(next_index)->subchannel()->RequestConnection();
+  }
+}
+
+//
+// Maglev::MaglevSubchannelData
+//
+
+void Maglev::MaglevSubchannelData::ProcessConnectivityChangeLocked(
+    absl::optional<grpc_connectivity_state> old_state,
+    grpc_connectivity_state new_state) {
+  Maglev* p = static_cast<Maglev*>(subchannel_list()->policy());
+  grpc_connectivity_state last_connectivity_state = GetConnectivityState();
+  if (GRPC_TRACE_FLAG_ENABLED(grpc_lb_maglev_trace)) {
+    gpr_log(
+        GPR_INFO,
+        "[MAGLEV %p] connectivity changed for subchannel %p, subchannel_list "
+        "%p (index %" PRIuPTR " of %" PRIuPTR "): prev_state=%s new_state=%s",
+        p, subchannel(), subchannel_list(), Index(),
+        subchannel_list()->num_subchannels(),
+        ConnectivityStateName(last_connectivity_state),
+        ConnectivityStateName(new_state));
+  }
+  GPR_ASSERT(subchannel() != nullptr);
+  // If this is not the initial state notification and the new state is
+  // TRANSIENT_FAILURE or IDLE, re-resolve.
+  // Note that we don't want to do this on the initial state notification,
+  // because that would result in an endless loop of re-resolution.
+  if (old_state.has_value() && (new_state == GRPC_CHANNEL_TRANSIENT_FAILURE ||
+                                new_state == GRPC_CHANNEL_IDLE)) {
+    if (GRPC_TRACE_FLAG_ENABLED(grpc_lb_maglev_trace)) {
+      gpr_log(GPR_INFO,
+              "[MAGLEV %p] Subchannel %p reported %s; requesting "
+              "re-resolution",
+              p, subchannel(), ConnectivityStateName(new_state));
+    }
+    p->channel_control_helper()->RequestReresolution();
+  }
+  const bool connection_attempt_complete = new_state != GRPC_CHANNEL_CONNECTING;
+  // Decide what state to report for the purposes of aggregation and
+  // picker behavior.
+  // If the last recorded state was TRANSIENT_FAILURE, ignore the update
+  // unless the new state is READY.
+  bool update_status = true;
+  absl::Status status = connectivity_status();
+  if (last_connectivity_state == GRPC_CHANNEL_TRANSIENT_FAILURE &&
+      new_state != GRPC_CHANNEL_READY &&
+      new_state != GRPC_CHANNEL_TRANSIENT_FAILURE) {
+    new_state = GRPC_CHANNEL_TRANSIENT_FAILURE;
+    {
+      MutexLock lock(&mu_);
+      status = connectivity_status_;
+    }
+    update_status = false;
+  }
+  // Update state counters used for aggregation.
+  subchannel_list()->UpdateStateCountersLocked(last_connectivity_state,
+                                               new_state);
+  // Update status seen by picker if needed.
+  if (update_status) {
+    MutexLock lock(&mu_);
+    connectivity_status_ = connectivity_status();
+  }
+  // Update last seen state, also used by picker.
+  connectivity_state_.store(new_state, std::memory_order_relaxed);
+  // Update the Maglev policy's connectivity state, creating a new picker.
+  subchannel_list()->UpdateMaglevConnectivityStateLocked(
+      Index(), connection_attempt_complete, status);
+}
+
+//
+// Maglev
+//
+
+Maglev::Maglev(Args args) : LoadBalancingPolicy(std::move(args)) {
+  if (GRPC_TRACE_FLAG_ENABLED(grpc_lb_maglev_trace)) {
+    gpr_log(GPR_INFO, "[MAGLEV %p] Created", this);
+  }
+}
+
+Maglev::~Maglev() {
+  if (GRPC_TRACE_FLAG_ENABLED(grpc_lb_maglev_trace)) {
+    gpr_log(GPR_INFO, "[MAGLEV %p] Destroying Maglev policy", this);
+  }
+  GPR_ASSERT(subchannel_list_ == nullptr);
+  GPR_ASSERT(latest_pending_subchannel_list_ == nullptr);
+}
+
+void Maglev::ShutdownLocked() {
+  if (GRPC_TRACE_FLAG_ENABLED(grpc_lb_maglev_trace)) {
+    gpr_log(GPR_INFO, "[MAGLEV %p] Shutting down", this);
+  }
+  shutdown_ = true;
+  subchannel_list_.reset();
+  latest_pending_subchannel_list_.reset();
+}
+
+void Maglev::ResetBackoffLocked() {
+  subchannel_list_->ResetBackoffLocked();
+  if (latest_pending_subchannel_list_ != nullptr) {
+    latest_pending_subchannel_list_->ResetBackoffLocked();
+  }
+}
+
+void Maglev::UpdateLocked(UpdateArgs args) {
+  config_ = std::move(args.config);
+  ServerAddressList addresses;
+  if (args.addresses.ok()) {
+    if (GRPC_TRACE_FLAG_ENABLED(grpc_lb_maglev_trace)) {
+      gpr_log(GPR_INFO,
+              "[MAGLEV %p] received update with %" PRIuPTR " addresses", this,
+              args.addresses->size());
+    }
+    addresses = *std::move(args.addresses);
+  } else {
+    if (GRPC_TRACE_FLAG_ENABLED(grpc_lb_maglev_trace)) {
+      gpr_log(GPR_INFO, "[MAGLEV %p] received update with addresses error: %s",
+              this, args.addresses.status().ToString().c_str());
+    }
+    // If we already have a subchannel list, then ignore the resolver
+    // failure and keep using the existing list.
+    if (subchannel_list_ != nullptr) return;
+  }
+  if (GRPC_TRACE_FLAG_ENABLED(grpc_lb_maglev_trace) &&
+      latest_pending_subchannel_list_ != nullptr) {
+    gpr_log(GPR_INFO, "[MAGLEV %p] replacing latest pending subchannel list %p",
+            this, latest_pending_subchannel_list_.get());
+  }
+  latest_pending_subchannel_list_ = MakeOrphanable<MaglevSubchannelList>(
+      this, std::move(addresses), args.args);
+  latest_pending_subchannel_list_->StartWatchingLocked();
+  // If we have no existing list or the new list is empty, immediately
+  // promote the new list.
+  // Otherwise, do nothing; the new list will be promoted when the
+  // initial subchannel states are reported.
+  if (subchannel_list_ == nullptr ||
+      latest_pending_subchannel_list_->num_subchannels() == 0) {
+    if (GRPC_TRACE_FLAG_ENABLED(grpc_lb_maglev_trace) &&
+        subchannel_list_ != nullptr) {
+      gpr_log(GPR_INFO,
+              "[MAGLEV %p] empty address list, replacing subchannel list %p",
+              this, subchannel_list_.get());
+    }
+    subchannel_list_ = std::move(latest_pending_subchannel_list_);
+    // If the new list is empty, report TRANSIENT_FAILURE.
+    if (subchannel_list_->num_subchannels() == 0) {
+      absl::Status status =
+          args.addresses.ok()
+              ? absl::UnavailableError(
+                    absl::StrCat("empty address list: ", args.resolution_note))
+              : args.addresses.status();
+      channel_control_helper()->UpdateState(
+          GRPC_CHANNEL_TRANSIENT_FAILURE, status,
+          absl::make_unique<TransientFailurePicker>(status));
+    } else {
+      // Otherwise, report IDLE.
+      subchannel_list_->UpdateMaglevConnectivityStateLocked(
+          /*index=*/0, /*connection_attempt_complete=*/false, absl::OkStatus());
+    }
+  }
+}
+
+//
+// factory
+//
+
+class MaglevFactory : public LoadBalancingPolicyFactory {
+ public:
+  OrphanablePtr<LoadBalancingPolicy> CreateLoadBalancingPolicy(
+      LoadBalancingPolicy::Args args) const override {
+    return MakeOrphanable<Maglev>(std::move(args));
+  }
+
+  absl::string_view name() const override { return kMaglev; }
+
+  absl::StatusOr<RefCountedPtr<LoadBalancingPolicy::Config>>
+  ParseLoadBalancingConfig(const Json& json) const override {
+    auto config = ParseMaglevLbConfig(json);
+    if (!config.ok()) return config.status();
+    return MakeRefCounted<MaglevLbConfig>(config->table_size);
+  }
+};
+
+}  // namespace
+
+void GrpcLbPolicyMaglevInit() {
+  LoadBalancingPolicyRegistry::Builder::RegisterLoadBalancingPolicyFactory(
+      absl::make_unique<MaglevFactory>());
+}
+
+void GrpcLbPolicyMaglevShutdown() {}
+
+}  // namespace grpc_core
@@ -0,0 +1,53 @@
+//
+// Copyright 2022 gRPC authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+#ifndef GRPC_CORE_EXT_FILTERS_CLIENT_CHANNEL_LB_POLICY_MAGLEV_MAGLEV_H
+#define GRPC_CORE_EXT_FILTERS_CLIENT_CHANNEL_LB_POLICY_MAGLEV_MAGLEV_H
+
+#include <grpc/support/port_platform.h>
+
+#include <stdint.h>
+
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+
+#include "src/core/lib/json/json.h"
+
+namespace grpc_core {
+
+// Whether the xDS MAGLEV cluster LB policy is accepted.  Remove once it
+// is no longer experimental.
+bool XdsMaglevEnabled();
+
+// The Maglev policy picks using the same request hash as ring_hash (see
+// RequestHashAttributeName()), so it can be swapped in for ring_hash
+// without changing the route's hash policies.
+//
+// Helper parsing method to parse maglev policy configs; for example,
+// lookup table size validity.
+struct MaglevConfig {
+  // Must be prime.  Should be well above 100 times the number of backends
+  // to keep the per-backend share of the table within ~1% of its weight.
+  uint64_t table_size = 65537;
+};
+absl::StatusOr<MaglevConfig> ParseMaglevLbConfig(const Json& json);
+
+// Returns an error if table_size is not a valid lookup table size.
+absl::Status ValidateMaglevTableSize(uint64_t table_size);
+
+}  // namespace grpc_core
+
+#endif  // GRPC_CORE_EXT_FILTERS_CLIENT_CHANNEL_LB_POLICY_MAGLEV_MAGLEV_H
@@ -0,0 +1,923 @@
+//
+// Copyright 2022 gRPC authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+#include <grpc/support/port_platform.h>
+
+#include <inttypes.h>
+#include <stdlib.h>
+
+#include <algorithm>
+#include <map>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "absl/base/thread_annotations.h"
+#include "absl/memory/memory.h"
+#include "absl/random/random.h"
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/strings/str_cat.h"
+#include "absl/strings/str_join.h"
+#include "absl/strings/string_view.h"
+#include "absl/types/optional.h"
+
+#include <grpc/impl/codegen/connectivity_state.h>
+#include <grpc/support/log.h>
+
+#include "src/core/ext/filters/client_channel/lb_policy/backend_metric_data.h"
+#include "src/core/ext/filters/client_channel/lb_policy/oob_backend_metric.h"
+#include "src/core/ext/filters/client_channel/lb_policy/subchannel_list.h"
+#include "src/core/lib/address_utils/sockaddr_utils.h"
+#include "src/core/lib/channel/channel_args.h"
+#include "src/core/lib/debug/trace.h"
+#include "src/core/lib/gprpp/debug_location.h"
+#include "src/core/lib/gprpp/orphanable.h"
+#include "src/core/lib/gprpp/ref_counted.h"
+#include "src/core/lib/gprpp/ref_counted_ptr.h"
+#include "src/core/lib/gprpp/sync.h"
+#include "src/core/lib/gprpp/time.h"
+#include "src/core/lib/iomgr/error.h"
+#include "src/core/lib/iomgr/exec_ctx.h"
+#include "src/core/lib/iomgr/resolved_address.h"
+#include "src/core/lib/json/json.h"
+#include "src/core/lib/json/json_util.h"
+#include "src/core/lib/load_balancing/lb_policy.h"
+#include "src/core/lib/load_balancing/lb_policy_factory.h"
+#include "src/core/lib/load_balancing/lb_policy_registry.h"
+#include "src/core/lib/load_balancing/subchannel_interface.h"
+#include "src/core/lib/resolver/server_address.h"
+#include "src/core/lib/transport/connectivity_state.h"
+
+namespace grpc_core {
+
+TraceFlag grpc_lb_weighted_round_robin_trace(false, "weighted_round_robin_lb");
+
+namespace {
+
+//
+// weighted_round_robin LB policy
+//
+
+constexpr absl::string_view kWeightedRoundRobin = "weighted_round_robin";
+
+class WeightedRoundRobinConfig : public LoadBalancingPolicy::Config {
+ public:
+  WeightedRoundRobinConfig(bool enable_oob_load_report,
+                           Duration oob_reporting_period,
+                           Duration blackout_period,
+                           Duration weight_update_period,
+                           Duration weight_expiration_period)
+      : enable_oob_load_report_(enable_oob_load_report),
+        oob_reporting_period_(oob_reporting_period),
+        blackout_period_(blackout_period),
+        weight_update_period_(weight_update_period),
+        weight_expiration_period_(weight_expiration_period) {}
+
+  absl::string_view name() const override { return kWeightedRoundRobin; }
+
+  bool enable_oob_load_report() const { return enable_oob_load_report_; }
+  Duration oob_reporting_period() const { return oob_reporting_period_; }
+  Duration blackout_period() const { return blackout_period_; }
+  Duration weight_update_period() const { return weight_update_period_; }
+  Duration weight_expiration_period() const {
+    return weight_expiration_period_;
+  }
+
+ private:
+  bool enable_oob_load_report_;
+  Duration oob_reporting_period_;
+  Duration blackout_period_;
+  Duration weight_update_period_;
+  Duration weight_expiration_period_;
+};
+
+class WeightedRoundRobin : public LoadBalancingPolicy {
+ public:
+  explicit WeightedRoundRobin(Args args);
+
+  absl::string_view name() const override { return kWeightedRoundRobin; }
+
+  void UpdateLocked(UpdateArgs args) override;
+  void ResetBackoffLocked() override;
+
+ private:
+  // The weight of a backend address, derived from the backend metrics
+  // it reports.  Shared between all subchannels for the same address, so
+  // that weights survive address list updates.
+  class AddressWeight : public RefCounted<AddressWeight> {
+   public:
+    AddressWeight(RefCountedPtr<WeightedRoundRobin> wrr, std::string key)
+        : wrr_(std::move(wrr)), key_(std::move(key)) {}
+    ~AddressWeight() override;
+
+    // Updates the weight from a backend metric report.  Reports without
+    // both a positive QPS and a positive CPU utilization are ignored.
+    void MaybeUpdateWeight(double qps, double cpu_utilization);
+
+    // Returns the current weight, or 0 if the weight is still in its
+    // blackout period or has not been updated recently enough.
+    double GetWeight(Timestamp now, Duration weight_expiration_period,
+                     Duration blackout_period);
+
+    // Restarts the blackout period.  Called when the subchannel
+    // (re)connects, since load reported over an older connection may not
+    // reflect the backend's current state.
+    void ResetNonEmptySince();
+
+   private:
+    RefCountedPtr<WeightedRoundRobin> wrr_;
+    const std::string key_;
+
+    Mutex mu_;
+    double weight_ ABSL_GUARDED_BY(&mu_) = 0;
+    Timestamp non_empty_since_ ABSL_GUARDED_BY(&mu_) = Timestamp::InfFuture();
+    Timestamp last_update_time_ ABSL_GUARDED_BY(&mu_) = Timestamp::InfPast();
+  };
+
+  // Forward declaration.
+  class WeightedRoundRobinSubchannelList;
+
+  // Data for a particular subchannel in a subchannel list.
+  // This subclass adds the following functionality:
+  // - Tracks the previous connectivity state of the subchannel, so that
+  //   we know how many subchannels are in each state.
+  // - Holds the weight of the subchannel's address and, if configured,
+  //   an OOB backend metric watcher that feeds it.
+  class WeightedRoundRobinSubchannelData
+      : public SubchannelData<WeightedRoundRobinSubchannelList,
+                              WeightedRoundRobinSubchannelData> {
+   public:
+    WeightedRoundRobinSubchannelData(
+        SubchannelList<WeightedRoundRobinSubchannelList,
+                       WeightedRoundRobinSubchannelData>* subchannel_list,
+        const ServerAddress& address,
+        RefCountedPtr<SubchannelInterface> subchannel);
+
+    absl::optional<grpc_connectivity_state> connectivity_state() const {
+      return logical_connectivity_state_;
+    }
+
+    RefCountedPtr<AddressWeight> weight() const { return weight_; }
+
+   private:
+    class OobWatcher : public OobBackendMetricWatcher {
+     public:
+      explicit OobWatcher(RefCountedPtr<AddressWeight> weight)
+          : weight_(std::move(weight)) {}
+
+      void OnBackendMetricReport(
+          const BackendMetricData& backend_metric_data) override {
+        weight_->MaybeUpdateWeight(backend_metric_data.qps,
+                                   backend_metric_data.cpu_utilization);
+      }
+
+     private:
+      RefCountedPtr<AddressWeight> weight_;
+    };
+
+    // Performs connectivity state updates that need to be done only
+    // after we have started watching.
+    void ProcessConnectivityChangeLocked(
+        absl::optional<grpc_connectivity_state> old_state,
+        grpc_connectivity_state new_state) override;
+
+    // Updates the logical connectivity state.
+    void UpdateLogicalConnectivityStateLocked(
+        grpc_connectivity_state connectivity_state);
+
+    RefCountedPtr<AddressWeight> weight_;
+
+    // The logical connectivity state of the subchannel.
+    // Note that the logical connectivity state may differ from the
+    // actual reported state in some cases (e.g., after we see
+    // TRANSIENT_FAILURE, we ignore any subsequent state changes until
+    // we see READY).
+    absl::optional<grpc_connectivity_state> logical_connectivity_state_;
+  };
+
+  // A list of subchannels.
+  class WeightedRoundRobinSubchannelList
+      : public SubchannelList<WeightedRoundRobinSubchannelList,
+                              WeightedRoundRobinSubchannelData> {
+   public:
+    WeightedRoundRobinSubchannelList(WeightedRoundRobin* policy,
+                                     ServerAddressList addresses,
+                                     const ChannelArgs& args)
+        : SubchannelList(
+              policy,
+              (GRPC_TRACE_FLAG_ENABLED(grpc_lb_weighted_round_robin_trace)
+                   ? "WeightedRoundRobinSubchannelList"
+                   : nullptr),
+              std::move(addresses), policy->channel_control_helper(), args) {
+      // Need to maintain a ref to the LB policy as long as we maintain
+      // any references to subchannels, since the subchannels'
+      // pollset_sets will include the LB policy's pollset_set.
+      policy->Ref(DEBUG_LOCATION, "subchannel_list").release();
+    }
+
+    ~WeightedRoundRobinSubchannelList() override {
+      WeightedRoundRobin* p = static_cast<WeightedRoundRobin*>(policy());
+      p->Unref(DEBUG_LOCATION, "subchannel_list");
+    }
+
+    // Updates the counters of subchannels in each state when a
+    // subchannel transitions from old_state to new_state.
+    void UpdateStateCountersLocked(
+        absl::optional<grpc_connectivity_state> old_state,
+        grpc_connectivity_state new_state);
+
+    // Ensures that the right subchannel list is used and then updates
+    // the WRR policy's connectivity state based on the subchannel list's
+    // state counters.
+    void MaybeUpdateWeightedRoundRobinConnectivityStateLocked(
+        absl::Status status_for_tf);
+
+   private:
+    std::string CountersString() const {
+      return absl::StrCat("num_subchannels=", num_subchannels(),
+                          " num_ready=", num_ready_,
+                          " num_connecting=", num_connecting_,
+                          " num_transient_failure=", num_transient_failure_);
+    }
+
+    size_t num_ready_ = 0;
+    size_t num_connecting_ = 0;
+    size_t num_transient_failure_ = 0;
+
+    absl::Status last_failure_;
+  };
+
+  // Picks subchannels using an earliest-deadline-first scheduler: each
+  // subchannel is scheduled every 1/weight units of virtual time, and a
+  // pick takes the subchannel with the earliest deadline.  Weights are
+  // re-read every weight_update_period.
+  class Picker : public SubchannelPicker {
+   public:
+    Picker(WeightedRoundRobin* parent,
+           WeightedRoundRobinSubchannelList* subchannel_list);
+
+    PickResult Pick(PickArgs args) override;
+
+   private:
+    // Reports per-call backend metrics to the address weight.
+    class SubchannelCallTracker;
+
+    struct SubchannelEntry {
+      RefCountedPtr<SubchannelInterface> subchannel;
+      RefCountedPtr<AddressWeight> weight;
+    };
+
+    struct SchedulerEntry {
+      double deadline;
+      double period;
+      size_t index;
+    };
+
+    // Rebuilds scheduler_ from the current address weights.
+    void BuildSchedulerLocked(Timestamp now)
+        ABSL_EXCLUSIVE_LOCKS_REQUIRED(&mu_);
+
+    // Returns the index of the next subchannel to use.
+    size_t PickIndexLocked() ABSL_EXCLUSIVE_LOCKS_REQUIRED(&mu_);
+
+    // Using pointer value only, no ref held -- do not dereference!
+    WeightedRoundRobin* parent_;
+
+    RefCountedPtr<WeightedRoundRobinConfig> config_;
+    std::vector<SubchannelEntry> subchannels_;
+
+    Mutex mu_;
+    absl::BitGen bit_gen_ ABSL_GUARDED_BY(&mu_);
+    Timestamp next_weight_update_ ABSL_GUARDED_BY(&mu_);
+    // Min-heap on deadline.  Empty if fewer than two subchannels have a
+    // usable weight, in which case we fall back to plain round robin.
+    std::vector<SchedulerEntry> scheduler_ ABSL_GUARDED_BY(&mu_);
+    size_t last_picked_index_ ABSL_GUARDED_BY(&mu_);
+  };
+
+  ~WeightedRoundRobin() override;
+
+  void ShutdownLocked() override;
+
+  // Returns the weight for the given address, creating it if needed.
+  RefCountedPtr<AddressWeight> GetOrCreateWeight(
+      const grpc_resolved_address& address);
+
+  RefCountedPtr<WeightedRoundRobinConfig> config_;
+
+  // List of subchannels.
+  OrphanablePtr<WeightedRoundRobinSubchannelList> subchannel_list_;
+  // Latest pending subchannel list.
+  // When we get an updated address list, we create a new subchannel list
+  // for it here, and we wait to swap it into subchannel_list_ until the new
+  // list becomes READY.
+  OrphanablePtr<WeightedRoundRobinSubchannelList>
+      latest_pending_subchannel_list_;
+
+  // Weights are looked up by address, so that they are shared between
+  // subchannel lists.  Entries remove themselves when destroyed; they are
+  // held by subchannels, pickers and call trackers, which may all be used
+  // outside of the WorkSerializer.
+  Mutex address_weight_map_mu_;
+  std::map<std::string, AddressWeight*> address_weight_map_
+      ABSL_GUARDED_BY(&address_weight_map_mu_);
+
+  bool shutdown_ = false;
+};
+
+//
+// WeightedRoundRobin::AddressWeight
+//
+
+WeightedRoundRobin::AddressWeight::~AddressWeight() {
+  MutexLock lock(&wrr_->address_weight_map_mu_);
+  auto it = wrr_->address_weight_map_.find(key_);
+  if (it != wrr_->address_weight_map_.end() && it->second == this) {
+    wrr_->address_weight_map_.erase(it);
+  }
+}
+
+void WeightedRoundRobin::AddressWeight::MaybeUpdateWeight(
+    double qps, double cpu_utilization) {
+  if (qps <= 0 || cpu_utilization <= 0) return;
+  const double weight = qps / cpu_utilization;
+  const Timestamp now = ExecCtx::Get()->Now();
+  MutexLock lock(&mu_);
+  if (GRPC_TRACE_FLAG_ENABLED(grpc_lb_weighted_round_robin_trace)) {
+    gpr_log(GPR_INFO,
+            "[WRR %p] subchannel %s: qps=%f, cpu_utilization=%f: setting "
+            "weight=%f (was %f)",
+            wrr_.get(), key_.c_str(), qps, cpu_utilization, weight, weight_);
+  }
+  if (non_empty_since_ == Timestamp::InfFuture()) non_empty_since_ = now;
+  last_update_time_ = now;
+  weight_ = weight;
+}
+
+double WeightedRoundRobin::AddressWeight::GetWeight(
+    Timestamp now, Duration weight_expiration_period,
+    Duration blackout_period) {
+  MutexLock lock(&mu_);
+  // If the most recent update was longer ago than the expiration
+  // period, reset non_empty_since_ so that we apply the blackout period
+  // again if we start getting data again in the future.
+  if (now - last_update_time_ >= weight_expiration_period) {
+    non_empty_since_ = Timestamp::InfFuture();
+    return 0;
+  }
+  // If we don't have at least blackout_period worth of data, return 0.
+  if (blackout_period > Duration::Zero() &&
+      now - non_empty_since_ < blackout_period) {
+    return 0;
+  }
+  return weight_;
+}
+
+void WeightedRoundRobin::AddressWeight::ResetNonEmptySince() {
+  MutexLock lock(&mu_);
+  non_empty_since_ = Timestamp::InfFuture();
+}
+
+//
+// WeightedRoundRobin::Picker::SubchannelCallTracker
+//
+
+class WeightedRoundRobin::Picker::SubchannelCallTracker
+    : public LoadBalancingPolicy::SubchannelCallTrackerInterface {
+ public:
+  explicit SubchannelCallTracker(RefCountedPtr<AddressWeight> weight)
+      : weight_(std::move(weight)) {}
+
+  void Start() override {}
+
+  void Finish(FinishArgs args) override {
+    const BackendMetricData* backend_metric_data =
+        args.backend_metric_accessor->GetBackendMetricData();
+    if (backend_metric_data == nullptr) return;
+    weight_->MaybeUpdateWeight(backend_metric_data->qps,
+                               backend_metric_data->cpu_utilization);
+  }
+
+ private:
+  RefCountedPtr<AddressWeight> weight_;
+};
+
+//
+// WeightedRoundRobin::Picker
+//
+
+WeightedRoundRobin::Picker::Picker(
+    WeightedRoundRobin* parent,
+    WeightedRoundRobinSubchannelList* subchannel_list)
+    : parent_(parent), config_(parent->config_) {
+  for (size_t i = 0; i < subchannel_list->num_subchannels(); ++i) {
+    WeightedRoundRobinSubchannelData* sd = subchannel_list->subchannel(i);
+    if (sd->connectivity_state().value_or(GRPC_CHANNEL_IDLE) ==
+        GRPC_CHANNEL_READY) {
+      subchannels_.push_back({sd->subchannel()->Ref(), sd->weight()});
+    }
+  }
+  MutexLock lock(&mu_);
+  // For discussion on why we generate a random starting index for
+  // the picker, see https://github.com/grpc/grpc-go/issues/2580.
+  last_picked_index_ =
+      absl::Uniform<size_t>(bit_gen_, 0, subchannels_.size());
+  BuildSchedulerLocked(ExecCtx::Get()->Now());
+  if (GRPC_TRACE_FLAG_ENABLED(grpc_lb_weighted_round_robin_trace)) {
+    gpr_log(GPR_INFO,
+            "[WRR %p picker %p] created picker from subchannel_list=%p "
+            "with %" PRIuPTR " READY subchannels; scheduler has %" PRIuPTR
+            " entries",
+            parent_, this, subchannel_list, subchannels_.size(),
+            scheduler_.size());
+  }
+}
+
+void WeightedRoundRobin::Picker::BuildSchedulerLocked(Timestamp now) {
+  next_weight_update_ = now + config_->weight_update_period();
+  scheduler_.clear();
+  std::vector<double> weights;
+  weights.reserve(subchannels_.size());
+  size_t num_weighted = 0;
+  double sum = 0;
+  for (const SubchannelEntry& entry : subchannels_) {
+    double weight =
+        entry.weight->GetWeight(now, config_->weight_expiration_period(),
+                                config_->blackout_period());
+    weights.push_back(weight);
+    if (weight > 0) {
+      ++num_weighted;
+      sum += weight;
+    }
+  }
+  // With fewer than two known weights there is nothing to balance.
+  if (num_weighted < 2) return;
+  // Subchannels without a usable weight get the mean weight, so that new
+  // backends are neither starved nor flooded while they warm up.
+  const double mean = sum / num_weighted;
+  scheduler_.reserve(subchannels_.size());
+  for (size_t i = 0; i < weights.size(); ++i) {
+    const double period = 1.0 / (weights[i] > 0 ? weights[i] : mean);
+    // Start each subchannel at a random point within its first period,
+    // so that pickers built at the same time on different clients do not
+    // all send their first picks to the same backend.
+    scheduler_.push_back(
+        {absl::Uniform<double>(bit_gen_, 0, period), period, i});
+  }
+  std::make_heap(scheduler_.begin(), scheduler_.end(),
+                 [](const SchedulerEntry& a, const SchedulerEntry& b) {
+                   return a.deadline > b.deadline;
+                 });
+}
+
+size_t WeightedRoundRobin::Picker::PickIndexLocked() {
+  if (scheduler_.empty()) {
+    last_picked_index_ = (last_picked_index_ + 1) % subchannels_.size();
+    return last_picked_index_;
+  }
+  auto later = [](const SchedulerEntry& a, const SchedulerEntry& b) {
+    return a.deadline > b.deadline;
+  };
+  std::pop_heap(scheduler_.begin(), scheduler_.end(), later);
+  SchedulerEntry& entry = scheduler_.back();
+  const size_t index = entry.index;
+  entry.deadline += entry.period;
+  std::push_heap(scheduler_.begin(), scheduler_.end(), later);
+  return index;
+}
+
+WeightedRoundRobin::PickResult WeightedRoundRobin::Picker::Pick(
+    PickArgs /*args*/) {
+  size_t index;
+  {
+    MutexLock lock(&mu_);
+    const Timestamp now = ExecCtx::Get()->Now();
+    if (now >= next_weight_update_) BuildSchedulerLocked(now);
+    index = PickIndexLocked();
+  }
+  if (GRPC_TRACE_FLAG_ENABLED(grpc_lb_weighted_round_robin_trace)) {
+    gpr_log(GPR_INFO,
+            "[WRR %p picker %p] returning index %" PRIuPTR ", subchannel=%p",
+            parent_, this, index, subchannels_[index].subchannel.get());
+  }
+  const SubchannelEntry& entry = subchannels_[index];
+  std::unique_ptr<SubchannelCallTrackerInterface> subchannel_call_tracker;
+  if (!config_->enable_oob_load_report()) {
+    subchannel_call_tracker =
+        absl::make_unique<SubchannelCallTracker>(entry.weight);
+  }
+  return PickResult::Complete(entry.subchannel,
+                              std::move(subchannel_call_tracker));
+}
+
+//
+// WeightedRoundRobin
+//
+
+WeightedRoundRobin::WeightedRoundRobin(Args args)
+    : LoadBalancingPolicy(std::move(args)) {
+  if (GRPC_TRACE_FLAG_ENABLED(grpc_lb_weighted_round_robin_trace)) {
+    gpr_log(GPR_INFO, "[WRR %p] Created", this);
+  }
+}
+
+WeightedRoundRobin::~WeightedRoundRobin() {
+  if (GRPC_TRACE_FLAG_ENABLED(grpc_lb_weighted_round_robin_trace)) {
+    gpr_log(GPR_INFO, "[WRR %p] Destroying weighted round robin policy",
+            this);
+  }
+  GPR_ASSERT(subchannel_list_ == nullptr);
+  GPR_ASSERT(latest_pending_subchannel_list_ == nullptr);
+}
+
+void WeightedRoundRobin::ShutdownLocked() {
+  if (GRPC_TRACE_FLAG_ENABLED(grpc_lb_weighted_round_robin_trace)) {
+    gpr_log(GPR_INFO, "[WRR %p] Shutting down", this);
+  }
+  shutdown_ = true;
+  subchannel_list_.reset();
+  latest_pending_subchannel_list_.reset();
+}
+
+void WeightedRoundRobin::ResetBackoffLocked() {
+  subchannel_list_->ResetBackoffLocked();
+  if (latest_pending_subchannel_list_ != nullptr) {
+    latest_pending_subchannel_list_->ResetBackoffLocked();
+  }
+}
+
+RefCountedPtr<WeightedRoundRobin::AddressWeight>
+WeightedRoundRobin::GetOrCreateWeight(const grpc_resolved_address& address) {
+  // The weight holds a ref to the policy so that it can remove itself
+  // from address_weight_map_ when destroyed.
+  auto self = [this]() {
+    return RefCountedPtr<WeightedRoundRobin>(static_cast<WeightedRoundRobin*>(
+        Ref(DEBUG_LOCATION, "AddressWeight").release()));
+  };
+  auto key = grpc_sockaddr_to_uri(&address);
+  if (!key.ok()) {
+    // Not shared with any other subchannel, but still usable.
+    return MakeRefCounted<AddressWeight>(self(), "");
+  }
+  MutexLock lock(&address_weight_map_mu_);
+  auto it = address_weight_map_.find(*key);
+  if (it != address_weight_map_.end()) {
+    auto weight = it->second->RefIfNonZero();
+    if (weight != nullptr) return weight;
+  }
+  auto weight = MakeRefCounted<AddressWeight>(self(), *key);
+  address_weight_map_[std::move(*key)] = weight.get();
+  return weight;
+}
+
+void WeightedRoundRobin::UpdateLocked(UpdateArgs args) {
+  config_ = std::move(args.config);
+  ServerAddressList addresses;
+  if (args.addresses.ok()) {
+    if (GRPC_TRACE_FLAG_ENABLED(grpc_lb_weighted_round_robin_trace)) {
+      gpr_log(GPR_INFO, "[WRR %p] received update with %" PRIuPTR " addresses",
+              this, args.addresses->size());
+    }
+    addresses = std::move(*args.addresses);
+  } else {
+    if (GRPC_TRACE_FLAG_ENABLED(grpc_lb_weighted_round_robin_trace)) {
+      gpr_log(GPR_INFO, "[WRR %p] received update with address error: %s",
+              this, args.addresses.status().ToString().c_str());
+    }
+    // If we already have a subchannel list, then ignore the resolver
+    // failure and keep using the existing list.
+    if (subchannel_list_ != nullptr) return;
+  }
+  // Create new subchannel list, replacing the previous pending list, if any.
+  if (GRPC_TRACE_FLAG_ENABLED(grpc_lb_weighted_round_robin_trace) &&
+      latest_pending_subchannel_list_ != nullptr) {
+    gpr_log(GPR_INFO, "[WRR %p] replacing previous pending subchannel list %p",
+            this, latest_pending_subchannel_list_.get());
+  }
+  latest_pending_subchannel_list_ =
+      MakeOrphanable<WeightedRoundRobinSubchannelList>(
+          this, std::move(addresses), args.args);
+  latest_pending_subchannel_list_->StartWatchingLocked();
+  // If the new list is empty, immediately promote it to
+  // subchannel_list_ and report TRANSIENT_FAILURE.
+  if (latest_pending_subchannel_list_->num_subchannels() == 0) {
+    if (GRPC_TRACE_FLAG_ENABLED(grpc_lb_weighted_round_robin_trace) &&
+        subchannel_list_ != nullptr) {
+      gpr_log(GPR_INFO, "[WRR %p] replacing previous subchannel list %p", this,
+              subchannel_list_.get());
+    }
+    subchannel_list_ = std::move(latest_pending_subchannel_list_);
+    absl::Status status =
+        args.addresses.ok() ? absl::UnavailableError(absl::StrCat(
+                                  "empty address list: ", args.resolution_note))
+                            : args.addresses.status();
+    channel_control_helper()->UpdateState(
+        GRPC_CHANNEL_TRANSIENT_FAILURE, status,
+        absl::make_unique<TransientFailurePicker>(status));
+  }
+  // Otherwise, if this is the initial update, immediately promote it to
+  // subchannel_list_ and report CONNECTING.
+  else if (subchannel_list_.get() == nullptr) {
+    subchannel_list_ = std::move(latest_pending_subchannel_list_);
+    channel_control_helper()->UpdateState(
+        GRPC_CHANNEL_CONNECTING, absl::Status(),
+        absl::make_unique<QueuePicker>(Ref(DEBUG_LOCATION, "QueuePicker")));
+  }
+}
+
+//
+// WeightedRoundRobinSubchannelList
+//
+
+void WeightedRoundRobin::WeightedRoundRobinSubchannelList::
+    UpdateStateCountersLocked(absl::optional<grpc_connectivity_state> old_state,
+                              grpc_connectivity_state new_state) {
+  if (old_state.has_value()) {
+    GPR_ASSERT(*old_state != GRPC_CHANNEL_SHUTDOWN);
+    if (*old_state == GRPC_CHANNEL_READY) {
+      GPR_ASSERT(num_ready_ > 0);
+      --num_ready_;
+    } else if (*old_state == GRPC_CHANNEL_CONNECTING) {
+      GPR_ASSERT(num_connecting_ > 0);
+      --num_connecting_;
+    } else if (*old_state == GRPC_CHANNEL_TRANSIENT_FAILURE) {
+      GPR_ASSERT(num_transient_failure_ > 0);
+      --num_transient_failure_;
+    }
+  }
+  GPR_ASSERT(new_state != GRPC_CHANNEL_SHUTDOWN);
+  if (new_state == GRPC_CHANNEL_READY) {
+    ++num_ready_;
+  } else if (new_state == GRPC_CHANNEL_CONNECTING) {
+    ++num_connecting_;
+  } else if (new_state == GRPC_CHANNEL_TRANSIENT_FAILURE) {
+    ++num_transient_failure_;
+  }
+}
+
+void WeightedRoundRobin::WeightedRoundRobinSubchannelList::
+    MaybeUpdateWeightedRoundRobinConnectivityStateLocked(
+        absl::Status status_for_tf) {
+  WeightedRoundRobin* p = static_cast<WeightedRoundRobin*>(policy());
+  // If this is latest_pending_subchannel_list_, then swap it into
+  // subchannel_list_ in the following cases:
+  // - subchannel_list_ has no READY subchannels.
+  // - This list has at least one READY subchannel.
+  // - All of the subchannels in this list are in TRANSIENT_FAILURE.
+  //   (This may cause the channel to go from READY to TRANSIENT_FAILURE,
+  //   but we're doing what the control plane told us to do.)
+  if (p->latest_pending_subchannel_list_.get() == this &&
+      (p->subchannel_list_->num_ready_ == 0 || num_ready_ > 0 ||
+       num_transient_failure_ == num_subchannels())) {
+    if (GRPC_TRACE_FLAG_ENABLED(grpc_lb_weighted_round_robin_trace)) {
+      const std::string old_counters_string =
+          p->subchannel_list_ != nullptr ? p->subchannel_list_->CountersString()
+                                         : "";
+      gpr_log(
+          GPR_INFO,
+          "[WRR %p] swapping out subchannel list %p (%s) in favor of %p (%s)",
+          p, p->subchannel_list_.get(), old_counters_string.c_str(), this,
+          CountersString().c_str());
+    }
+    p->subchannel_list_ = std::move(p->latest_pending_subchannel_list_);
+  }
+  // Only set connectivity state if this is the current subchannel list.
+  if (p->subchannel_list_.get() != this) return;
+  // First matching rule wins:
+  // 1) ANY subchannel is READY => policy is READY.
+  // 2) ANY subchannel is CONNECTING => policy is CONNECTING.
+  // 3) ALL subchannels are TRANSIENT_FAILURE => policy is TRANSIENT_FAILURE.
+  if (num_ready_ > 0) {
+    if (GRPC_TRACE_FLAG_ENABLED(grpc_lb_weighted_round_robin_trace)) {
+      gpr_log(GPR_INFO, "[WRR %p] reporting READY with subchannel list %p", p,
+              this);
+    }
+    p->channel_control_helper()->UpdateState(
+        GRPC_CHANNEL_READY, absl::Status(), absl::make_unique<Picker>(p, this));
+  } else if (num_connecting_ > 0) {
+    if (GRPC_TRACE_FLAG_ENABLED(grpc_lb_weighted_round_robin_trace)) {
+      gpr_log(GPR_INFO, "[WRR %p] reporting CONNECTING with subchannel list %p",
+              p, this);
+    }
+    p->channel_control_helper()->UpdateState(
+        GRPC_CHANNEL_CONNECTING, absl::Status(),
+        absl::make_unique<QueuePicker>(p->Ref(DEBUG_LOCATION, "QueuePicker")));
+  } else if (num_transient_failure_ == num_subchannels()) {
+    if (GRPC_TRACE_FLAG_ENABLED(grpc_lb_weighted_round_robin_trace)) {
+      gpr_log(
+          GPR_INFO,
+          "[WRR %p] reporting TRANSIENT_FAILURE with subchannel list %p: %s", p,
+          this, status_for_tf.ToString().c_str());
+    }
+    if (!status_for_tf.ok()) {
+      last_failure_ = absl::UnavailableError(
+          absl::StrCat("connections to all backends failing; last error: ",
+                       status_for_tf.ToString()));
+    }
+    p->channel_control_helper()->UpdateState(
+        GRPC_CHANNEL_TRANSIENT_FAILURE, last_failure_,
+        absl::make_unique<TransientFailurePicker>(last_failure_));
+  }
+}
+
+//
+// WeightedRoundRobinSubchannelData
+//
+
+WeightedRoundRobin::WeightedRoundRobinSubchannelData::
+    WeightedRoundRobinSubchannelData(
+        SubchannelList<WeightedRoundRobinSubchannelList,
+                       WeightedRoundRobinSubchannelData>* subchannel_list,
+        const ServerAddress& address,
+        RefCountedPtr<SubchannelInterface> subchannel)
+    : SubchannelData(subchannel_list, address, std::move(subchannel)) {
+  WeightedRoundRobin* p =
+      static_cast<WeightedRoundRobin*>(subchannel_list->policy());
+  weight_ = p->GetOrCreateWeight(address.address());
+  if (p->config_->enable_oob_load_report()) {
+    this->subchannel()->AddDataWatcher(MakeOobBackendMetricWatcher(
+        p->config_->oob_reporting_period(),
+        absl::make_unique<OobWatcher>(weight_)));
+  }
+}
+
+void WeightedRoundRobin::WeightedRoundRobinSubchannelData::
+    ProcessConnectivityChangeLocked(
+        absl::optional<grpc_connectivity_state> old_state,
+        grpc_connectivity_state new_state) {
+  WeightedRoundRobin* p =
+      static_cast<WeightedRoundRobin*>(subchannel_list()->policy());
+  GPR_ASSERT(subchannel() != nullptr);
+  // If this is not the initial state notification and the new state is
+  // TRANSIENT_FAILURE or IDLE, re-resolve.
+  // Note that we don't want to do this on the initial state notification,
+  // because that would result in an endless loop of re-resolution.
+  if (old_state.has_value() && (new_state == GRPC_CHANNEL_TRANSIENT_FAILURE ||
+                                new_state == GRPC_CHANNEL_IDLE)) {
+    if (GRPC_TRACE_FLAG_ENABLED(grpc_lb_weighted_round_robin_trace)) {
+      gpr_log(GPR_INFO,
+              "[WRR %p] Subchannel %p reported %s; requesting re-resolution", p,
+              subchannel(), ConnectivityStateName(new_state));
+    }
+    p->channel_control_helper()->RequestReresolution();
+  }
+  if (new_state == GRPC_CHANNEL_IDLE) {
+    if (GRPC_TRACE_FLAG_ENABLED(grpc_lb_weighted_round_robin_trace)) {
+      gpr_log(GPR_INFO,
+              "[WRR %p] Subchannel %p reported IDLE; requesting connection", p,
+              subchannel());
+    }
+    subchannel()->RequestConnection();
+  }
+  // A fresh connection restarts the blackout period for the address.  The
+  // initial notification is not one: a subchannel that is already READY
+  // when the address list is updated keeps its weight.
+  if (new_state == GRPC_CHANNEL_READY && old_state.has_value() &&
+      *old_state != GRPC_CHANNEL_READY) {
+    weight_->ResetNonEmptySince();
+  }
+  // Update logical connectivity state.
+  UpdateLogicalConnectivityStateLocked(new_state);
+  // Update the policy state.
+  subchannel_list()->MaybeUpdateWeightedRoundRobinConnectivityStateLocked(
+      connectivity_status());
+}
+
+void WeightedRoundRobin::WeightedRoundRobinSubchannelData::
+    UpdateLogicalConnectivityStateLocked(
+        grpc_connectivity_state connectivity_state) {
+  WeightedRoundRobin* p =
+      static_cast<WeightedRoundRobin*>(subchannel_list()->policy());
+  if (GRPC_TRACE_FLAG_ENABLED(grpc_lb_weighted_round_robin_trace)) {
+    gpr_log(
+        GPR_INFO,
+        "[WRR %p] connectivity changed for subchannel %p, subchannel_list %p "
+        "(index %" PRIuPTR " of %" PRIuPTR "): prev_state=%s new_state=%s",
+        p, subchannel(), subchannel_list(), Index(),
+        subchannel_list()->num_subchannels(),
+        (logical_connectivity_state_.has_value()
+             ? ConnectivityStateName(*logical_connectivity_state_)
+             : "N/A"),
+        ConnectivityStateName(connectivity_state));
+  }
+  // Decide what state to report for aggregation purposes.
+  // If the last logical state was TRANSIENT_FAILURE, then ignore the
+  // state change unless the new state is READY.
+  if (logical_connectivity_state_.has_value() &&
+      *logical_connectivity_state_ == GRPC_CHANNEL_TRANSIENT_FAILURE &&
+      connectivity_state != GRPC_CHANNEL_READY) {
+    return;
+  }
+  // If the new state is IDLE, treat it as CONNECTING, since it will
+  // immediately transition into CONNECTING anyway.
+  if (connectivity_state == GRPC_CHANNEL_IDLE) {
+    if (GRPC_TRACE_FLAG_ENABLED(grpc_lb_weighted_round_robin_trace)) {
+      gpr_log(GPR_INFO,
+              "[WRR %p] subchannel %p, subchannel_list %p (index %" PRIuPTR
+              " of %" PRIuPTR "): treating IDLE as CONNECTING",
+              p, subchannel(), subchannel_list(), Index(),
+              subchannel_list()->num_subchannels());
+    }
+    connectivity_state = GRPC_CHANNEL_CONNECTING;
+  }
+  // If no change, return false.
+  if (logical_connectivity_state_.has_value() &&
+      *logical_connectivity_state_ == connectivity_state) {
+    return;
+  }
+  // Otherwise, update counters and logical state.
+  subchannel_list()->UpdateStateCountersLocked(logical_connectivity_state_,
+                                               connectivity_state);
+  logical_connectivity_state_ = connectivity_state;
+}
+
+//
+// factory
+//
+
+class WeightedRoundRobinFactory : public LoadBalancingPolicyFactory {
+ public:
+  OrphanablePtr<LoadBalancingPolicy> CreateLoadBalancingPolicy(
+      LoadBalancingPolicy::Args args) const override {
+    return MakeOrphanable<WeightedRoundRobin>(std::move(args));
+  }
+
+  absl::string_view name() const override { return kWeightedRoundRobin; }
+
+  absl::StatusOr<RefCountedPtr<LoadBalancingPolicy::Config>>
+  ParseLoadBalancingConfig(const Json& json) const override {
+    bool enable_oob_load_report = false;
+    Duration oob_reporting_period = Duration::Seconds(10);
+    Duration blackout_period = Duration::Seconds(10);
+    Duration weight_update_period = Duration::Seconds(1);
+    Duration weight_expiration_period = Duration::Minutes(3);
+    // A null config comes from the deprecated loadBalancingPolicy field
+    // or the client API; use the defaults.
+    if (json.type() == Json::Type::OBJECT) {
+      std::vector<grpc_error_handle> error_list;
+      const Json::Object& object = json.object_value();
+      ParseJsonObjectField(object, "enableOobLoadReport",
+                           &enable_oob_load_report, &error_list,
+                           /*required=*/false);
+      ParseJsonObjectFieldAsDuration(object, "oobReportingPeriod",
+                                     &oob_reporting_period, &error_list,
+                                     /*required=*/false);
+      ParseJsonObjectFieldAsDuration(object, "blackoutPeriod",
+                                     &blackout_period, &error_list,
+                                     /*required=*/false);
+      ParseJsonObjectFieldAsDuration(object, "weightUpdatePeriod",
+                                     &weight_update_period, &error_list,
+                                     /*required=*/false);
+      ParseJsonObjectFieldAsDuration(object, "weightExpirationPeriod",
+                                     &weight_expiration_period, &error_list,
+                                     /*required=*/false);
+      if (!error_list.empty()) {
+        std::vector<std::string> errors;
+        for (auto& error : error_list) {
+          errors.emplace_back(grpc_error_std_string(error));
+          GRPC_ERROR_UNREF(error);
+        }
+        return absl::InvalidArgumentError(
+            absl::StrCat("weighted_round_robin LB policy config: [",
+                         absl::StrJoin(errors, "; "), "]"));
+      }
+    } else if (json.type() != Json::Type::JSON_NULL) {
+      return absl::InvalidArgumentError(
+          "weighted_round_robin LB policy config: type must be object");
+    }
+    // Recomputing the scheduler is not free; don't let it run on every
+    // pick.
+    weight_update_period =
+        std::max(weight_update_period, Duration::Milliseconds(100));
+    return MakeRefCounted<WeightedRoundRobinConfig>(
+        enable_oob_load_report, oob_reporting_period, blackout_period,
+        weight_update_period, weight_expiration_period);
+  }
+};
+
+}  // namespace
+
+}  // namespace grpc_core
+
+void grpc_lb_policy_weighted_round_robin_init() {
+  grpc_core::LoadBalancingPolicyRegistry::Builder::
+      RegisterLoadBalancingPolicyFactory(
+          absl::make_unique<grpc_core::WeightedRoundRobinFactory>());
+}
+
+void grpc_lb_policy_weighted_round_robin_shutdown() {}
@@ -496,6 +496,10 @@ void CdsLb::OnClusterChanged(const std::string& name,
           {"min_ring_size", cluster_data.min_ring_size},
           {"max_ring_size", cluster_data.max_ring_size},
       };
+    } else if (lb_policy == "MAGLEV") {
+      xds_lb_policy["MAGLEV"] = Json::Object{
+          {"table_size", cluster_data.maglev_table_size},
+      };
     } else {
       xds_lb_policy["ROUND_ROBIN"] = Json::Object();
     }
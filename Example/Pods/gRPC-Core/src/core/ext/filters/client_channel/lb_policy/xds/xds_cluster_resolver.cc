@@ -41,6 +41,7 @@
 
 #include "src/core/ext/filters/client_channel/lb_policy/address_filtering.h"
 #include "src/core/ext/filters/client_channel/lb_policy/child_policy_handler.h"
+#include "src/core/ext/filters/client_channel/lb_policy/maglev/maglev.h"
 #include "src/core/ext/filters/client_channel/lb_policy/outlier_detection/outlier_detection.h"
 #include "src/core/ext/filters/client_channel/lb_policy/ring_hash/ring_hash.h"
 #include "src/core/ext/filters/client_channel/lb_policy/xds/xds.h"
@@ -890,6 +891,14 @@ XdsClusterResolverLb::CreateChildPolicyConfigLocked() {
           GPR_ASSERT(it != config.end());
           (*it->second.mutable_object())["targets"] =
               std::move(weighted_targets);
+        } else if (xds_lb_policy.find("MAGLEV") != xds_lb_policy.end()) {
+          auto it = xds_lb_policy.find("MAGLEV");
+          Json::Object maglev_experimental_policy = it->second.object_value();
+          child_policy = Json::Array{
+              Json::Object{
+                  {"maglev_experimental", maglev_experimental_policy},
+              },
+          };
         } else {
           auto it = xds_lb_policy.find("RING_HASH");
           GPR_ASSERT(it != xds_lb_policy.end());
@@ -1145,6 +1154,15 @@ class XdsClusterResolverLbFactory : public LoadBalancingPolicyFactory {
                   absl_status_to_grpc_error(config.status()));
             }
           }
+          policy_it = policy.find("MAGLEV");
+          if (policy_it != policy.end()) {
+            xds_lb_policy = array[i];
+            auto config = ParseMaglevLbConfig(policy_it->second);
+            if (!config.ok()) {
+              error_list.emplace_back(
+                  absl_status_to_grpc_error(config.status()));
+            }
+          }
         }
       }
     }
@@ -115,9 +115,16 @@
 // When constructing the "child" batches, we compare the state in the
 // CallAttempt object against the state in the CallData object to see
 // which batches need to be sent on the LB call for a given attempt.
-
-// TODO(roth): In subsequent PRs:
-// - implement hedging
+//
+// Hedging (the hedgingPolicy from gRFC A6) reuses the same machinery, but
+// instead of waiting for an attempt to fail before starting the next one,
+// a new attempt is started every hedgingDelay (or immediately, when an
+// attempt fails with a non-fatal status) until maxAttempts is reached.
+// Until the call is committed, all of the in-flight attempts are kept in
+// CallData::hedged_attempts_ and every batch from the surface is started
+// on each of them.  The first attempt that receives a response (or fails
+// with a fatal status) wins: it becomes CallData::call_attempt_, and all
+// of the other attempts are abandoned and cancelled.
 
 // By default, we buffer 256 KiB per RPC for retries.
 // TODO(roth): Do we have any data to suggest a better value?
@@ -253,10 +260,20 @@ class RetryFilter::CallData {
 
     bool lb_call_committed() const { return lb_call_committed_; }
 
+    // Returns the number of send ops that have been started on this
+    // call attempt.
+    size_t num_send_ops_started() const {
+      return started_send_initial_metadata_ + started_send_message_count_ +
+             started_send_trailing_metadata_;
+    }
+
     // Constructs and starts whatever batches are needed on this call
     // attempt.
     void StartRetriableBatches();
 
+    // Adds whatever batches are needed on this attempt to closures.
+    void AddRetriableBatches(CallCombinerClosureList* closures);
+
     // Frees cached send ops that have already been completed after
     // committing the call.
     void FreeCachedSendOpDataAfterCommit();
@@ -264,6 +281,15 @@ class RetryFilter::CallData {
     // Cancels the call attempt.
     void CancelFromSurface(grpc_transport_stream_op_batch* cancel_batch);
 
+    // Abandons a hedged attempt that lost to another one and adds a batch
+    // to closures to cancel it.
+    void CancelLosingHedgedAttempt(CallCombinerClosureList* closures);
+
+    // Copies the peer and any call context values this hedged attempt's
+    // LB call has set to calld_.  Called when the call is committed to
+    // this attempt, and again if its transport sets them later.
+    void PropagateHedgedStateToCall();
+
    private:
     // State used for starting a retryable batch on the call attempt's LB call.
     // This provides its own grpc_transport_stream_op_batch and other data
@@ -371,7 +397,9 @@ class RetryFilter::CallData {
       void Commit() override {
         call_attempt_->lb_call_committed_ = true;
         auto* calld = call_attempt_->calld_;
-        if (calld->retry_committed_) {
+        // A losing hedged attempt may finish its pick after the call has
+        // been committed to another attempt.
+        if (calld->retry_committed_ && !call_attempt_->abandoned_) {
           auto* service_config_call_data =
               static_cast<ClientChannelServiceConfigCallData*>(
                   calld->call_context_[GRPC_CONTEXT_SERVICE_CONFIG_CALL_DATA]
@@ -418,9 +446,6 @@ class RetryFilter::CallData {
     // Adds batches for pending batches to closures.
     void AddBatchesForPendingBatches(CallCombinerClosureList* closures);
 
-    // Adds whatever batches are needed on this attempt to closures.
-    void AddRetriableBatches(CallCombinerClosureList* closures);
-
     // Returns true if any send op in the batch was not yet started on this
     // attempt.
     bool PendingBatchContainsUnstartedSendOps(PendingBatch* pending);
@@ -437,9 +462,23 @@ class RetryFilter::CallData {
     bool ShouldRetry(absl::optional<grpc_status_code> status,
                      absl::optional<Duration> server_pushback_ms);
 
+    // Returns true if this hedged attempt's result should be dropped in
+    // favor of other attempts that are in flight or yet to be started,
+    // false if the call should be committed to it.  May add a closure
+    // to closures to start the next hedged attempt.
+    bool ShouldAbandonHedgedAttempt(grpc_status_code status,
+                                    absl::optional<Duration> server_pushback,
+                                    CallCombinerClosureList* closures);
+
     // Abandons the call attempt.  Unrefs any deferred batches.
     void Abandon();
 
+    // Returns true if this is a hedged attempt with its own call context
+    // and peer string slot.
+    bool HasOwnCallState() const {
+      return call_context_ != calld_->call_context_;
+    }
+
     static void OnPerAttemptRecvTimer(void* arg, grpc_error_handle error);
     static void OnPerAttemptRecvTimerLocked(void* arg, grpc_error_handle error);
     void MaybeCancelPerAttemptRecvTimer();
@@ -448,6 +487,14 @@ class RetryFilter::CallData {
     AttemptDispatchController attempt_dispatch_controller_;
     OrphanablePtr<ClientChannel::LoadBalancedCall> lb_call_;
     bool lb_call_committed_ = false;
+    // Value for grpc-previous-rpc-attempts when hedging.
+    const int num_previous_hedged_attempts_;
+    // The call context used by lb_call_.  Concurrent hedged attempts would
+    // overwrite each other's values in calld_'s context, so each of them
+    // gets a copy; otherwise this is calld_->call_context_.
+    grpc_call_context_element* call_context_;
+    // The transport's peer for a hedged attempt, propagated on commit.
+    gpr_atm hedged_peer_string_ = 0;
 
     grpc_timer per_attempt_recv_timer_;
     grpc_closure on_per_attempt_recv_timer_;
@@ -542,6 +589,14 @@ class RetryFilter::CallData {
   // Commits the call so that no further retry attempts will be performed.
   void RetryCommit(CallAttempt* call_attempt);
 
+  // Returns true if cached send op data may be freed once the committed
+  // attempt is done with it.  If more than one hedged attempt has been
+  // started, the losing attempts may still have send ops in flight that
+  // reference the cache, so it is kept until the call is destroyed.
+  bool CanFreeCachedSendOpDataAfterCommit() const {
+    return num_hedged_attempts_started_ <= 1;
+  }
+
   // Starts a timer to retry after appropriate back-off.
   // If server_pushback is nullopt, retry_backoff_ is used.
   void StartRetryTimer(absl::optional<Duration> server_pushback);
@@ -555,10 +610,42 @@ class RetryFilter::CallData {
 
   OrphanablePtr<ClientChannel::LoadBalancedCall> CreateLoadBalancedCall(
       ConfigSelector::CallDispatchController* call_dispatch_controller,
-      bool is_transparent_retry);
+      bool is_transparent_retry, grpc_call_context_element* call_context);
 
   void CreateCallAttempt(bool is_transparent_retry);
 
+  // Returns a copy of call_context_ for a hedged attempt.  The copy borrows
+  // the call's values; anything the attempt sets in it is owned by the
+  // attempt's LB call.
+  grpc_call_context_element* CopyCallContextForHedgedAttempt();
+
+  // Hedging support.
+  bool IsHedging() const {
+    return retry_policy_ != nullptr &&
+           retry_policy_->hedging_delay().has_value();
+  }
+  // Returns true if policy, throttling and the call dispatch controller
+  // all allow starting another hedged attempt.
+  bool HedgingAllowed();
+  // Returns true if a scheduled hedged attempt should actually be started.
+  bool ShouldStartHedgedAttempt(bool is_transparent_retry);
+  // Starts pending batches on every in-flight hedged attempt.
+  void StartRetriableBatchesOnHedgedAttempts();
+  // Picks the in-flight hedged attempt to commit to when we have to commit
+  // before any attempt has won, or nullptr if there are none.
+  CallAttempt* HedgedAttemptToCommit();
+  // Makes call_attempt the committed attempt and cancels all others.
+  void CommitHedgedAttempt(CallAttempt* call_attempt);
+  void RemoveHedgedAttempt(CallAttempt* call_attempt);
+  void MaybeStartHedgingTimer(Timestamp deadline);
+  void MaybeCancelHedgingTimer();
+  static void OnHedgingTimer(void* arg, grpc_error_handle error);
+  static void OnHedgingTimerLocked(void* arg, grpc_error_handle error);
+  // Adds a closure to closures to start the next hedged attempt without
+  // waiting for the hedging delay.
+  void AddClosureToStartHedgedAttempt(CallCombinerClosureList* closures);
+  static void StartHedgedAttempt(void* arg, grpc_error_handle error);
+
   RetryFilter* chand_;
   grpc_polling_entity* pollent_;
   RefCountedPtr<ServerRetryThrottleData> retry_throttle_data_;
@@ -576,11 +663,13 @@ class RetryFilter::CallData {
 
   RefCountedPtr<CallStackDestructionBarrier> call_stack_destruction_barrier_;
 
-  // TODO(roth): As part of implementing hedging, we will need to maintain a
-  // list of all pending attempts, so that we can cancel them all if the call
-  // gets cancelled.
+  // The current call attempt.  When hedging, this is not set until the
+  // call is committed to one of hedged_attempts_.
   RefCountedPtr<CallAttempt> call_attempt_;
 
+  // Hedged attempts that are in flight and not yet committed or abandoned.
+  absl::InlinedVector<RefCountedPtr<CallAttempt>, 2> hedged_attempts_;
+
   // LB call used when we've committed to a call attempt and the retry
   // state for that attempt is no longer needed.  This provides a fast
   // path for long-running streaming calls that minimizes overhead.
@@ -606,18 +695,21 @@ class RetryFilter::CallData {
   grpc_timer retry_timer_;
   grpc_closure retry_closure_;
 
+  // Hedging state.
+  bool hedging_timer_pending_ : 1;
+  // Set when server push-back asks us not to start any more attempts.
+  bool hedging_stopped_ : 1;
+  // Does not include transparent retries.
+  int num_hedged_attempts_started_ = 0;
+  // Server push-back holds off the next hedged attempt until this time.
+  Timestamp hedging_not_before_;
+  grpc_timer hedging_timer_;
+  grpc_closure hedging_closure_;
+
   // Cached data for retrying send ops.
   // send_initial_metadata
   bool seen_send_initial_metadata_ = false;
   grpc_metadata_batch send_initial_metadata_{arena_};
-  // TODO(roth): As part of implementing hedging, we'll probably need to
-  // have the LB call set a value in CallAttempt and then propagate it
-  // from CallAttempt to the parent call when we commit.  Otherwise, we
-  // may leave this with a value for a peer other than the one we
-  // actually commit to.  Alternatively, maybe see if there's a way to
-  // change the surface API such that the peer isn't available until
-  // after initial metadata is received?  (Could even change the
-  // transport API to return this with the recv_initial_metadata op.)
   gpr_atm* peer_string_;
   // send_message
   // When we get a send_message op, we replace the original byte stream
@@ -670,20 +762,39 @@ class RetryFilter::CallData::CallStackDestructionBarrier
   }
 
   // Invoked to get an on_call_stack_destruction closure for a new LB call.
-  grpc_closure* MakeLbCallDestructionClosure(CallData* calld) {
+  // If the LB call has its own call context, the values it still owns
+  // there are destroyed along with it.
+  grpc_closure* MakeLbCallDestructionClosure(
+      CallData* calld, grpc_call_context_element* own_call_context) {
     Ref().release();  // Ref held by callback.
-    grpc_closure* on_lb_call_destruction_complete =
-        calld->arena_->New<grpc_closure>();
-    GRPC_CLOSURE_INIT(on_lb_call_destruction_complete,
-                      OnLbCallDestructionComplete, this, nullptr);
-    return on_lb_call_destruction_complete;
+    auto* lb_call_destruction = calld->arena_->New<LbCallDestruction>();
+    lb_call_destruction->barrier = this;
+    lb_call_destruction->own_call_context = own_call_context;
+    GRPC_CLOSURE_INIT(&lb_call_destruction->closure,
+                      OnLbCallDestructionComplete, lb_call_destruction,
+                      nullptr);
+    return &lb_call_destruction->closure;
   }
 
  private:
+  struct LbCallDestruction {
+    grpc_closure closure;
+    CallStackDestructionBarrier* barrier;
+    grpc_call_context_element* own_call_context;
+  };
+
   static void OnLbCallDestructionComplete(void* arg,
                                           grpc_error_handle /*error*/) {
-    auto* self = static_cast<CallStackDestructionBarrier*>(arg);
-    self->Unref();
+    auto* lb_call_destruction = static_cast<LbCallDestruction*>(arg);
+    grpc_call_context_element* context = lb_call_destruction->own_call_context;
+    if (context != nullptr) {
+      for (size_t i = 0; i < GRPC_CONTEXT_COUNT; ++i) {
+        if (context[i].destroy != nullptr) {
+          context[i].destroy(context[i].value);
+        }
+      }
+    }
+    lb_call_destruction->barrier->Unref();
   }
 
   grpc_closure* on_call_stack_destruction_ = nullptr;
@@ -699,7 +810,11 @@ RetryFilter::CallData::CallAttempt::CallAttempt(CallData* calld,
                                                            : nullptr),
       calld_(calld),
       attempt_dispatch_controller_(this),
-      batch_payload_(calld->call_context_),
+      num_previous_hedged_attempts_(calld->num_hedged_attempts_started_),
+      call_context_(calld->IsHedging() && !calld->retry_committed_
+                        ? calld->CopyCallContextForHedgedAttempt()
+                        : calld->call_context_),
+      batch_payload_(call_context_),
       started_send_initial_metadata_(false),
       completed_send_initial_metadata_(false),
       started_send_trailing_metadata_(false),
@@ -712,7 +827,7 @@ RetryFilter::CallData::CallAttempt::CallAttempt(CallData* calld,
       seen_recv_trailing_metadata_from_surface_(false),
       abandoned_(false) {
   lb_call_ = calld->CreateLoadBalancedCall(&attempt_dispatch_controller_,
-                                           is_transparent_retry);
+                                           is_transparent_retry, call_context_);
   if (GRPC_TRACE_FLAG_ENABLED(grpc_retry_trace)) {
     gpr_log(GPR_INFO,
             "chand=%p calld=%p attempt=%p: created attempt, lb_call=%p",
@@ -750,10 +865,9 @@ RetryFilter::CallData::CallAttempt::~CallAttempt() {
 }
 
 void RetryFilter::CallData::CallAttempt::FreeCachedSendOpDataAfterCommit() {
-  // TODO(roth): When we implement hedging, this logic will need to get
-  // a bit more complex, because there may be other (now abandoned) call
-  // attempts still using this data.  We may need to do some sort of
-  // ref-counting instead.
+  // If there may be other (now abandoned) hedged attempts still using
+  // this data, leave it for ~CallData() to free.
+  if (!calld_->CanFreeCachedSendOpDataAfterCommit()) return;
   if (completed_send_initial_metadata_) {
     calld_->FreeCachedSendInitialMetadata();
   }
@@ -793,12 +907,11 @@ bool RetryFilter::CallData::CallAttempt::HaveSendOpsToReplay() {
 }
 
 void RetryFilter::CallData::CallAttempt::MaybeSwitchToFastPath() {
-  // If we're not yet committed, we can't switch yet.
-  // TODO(roth): As part of implementing hedging, this logic needs to
-  // check that *this* call attempt is the one that we've committed to.
-  // Might need to replace abandoned_ with an enum indicating whether we're
-  // in flight, abandoned, or the winning call attempt.
-  if (!calld_->retry_committed_) return;
+  // If we're not yet committed, or if we've committed to a different
+  // (hedged) attempt, we can't switch.
+  if (!calld_->retry_committed_ || calld_->call_attempt_.get() != this) {
+    return;
+  }
   // If we've already switched to fast path, there's nothing to do here.
   if (calld_->committed_call_ != nullptr) return;
   // If the perAttemptRecvTimeout timer is pending, we can't switch yet.
@@ -1123,6 +1236,21 @@ void RetryFilter::CallData::CallAttempt::CancelFromSurface(
   lb_call_->StartTransportStreamOpBatch(cancel_batch);
 }
 
+void RetryFilter::CallData::CallAttempt::CancelLosingHedgedAttempt(
+    CallCombinerClosureList* closures) {
+  if (GRPC_TRACE_FLAG_ENABLED(grpc_retry_trace)) {
+    gpr_log(GPR_INFO,
+            "chand=%p calld=%p attempt=%p: cancelling losing hedged attempt",
+            calld_->chand_, calld_, this);
+  }
+  Abandon();
+  MaybeAddBatchForCancelOp(
+      grpc_error_set_int(
+          GRPC_ERROR_CREATE_FROM_STATIC_STRING("lost to hedged attempt"),
+          GRPC_ERROR_INT_GRPC_STATUS, GRPC_STATUS_CANCELLED),
+      closures);
+}
+
 bool RetryFilter::CallData::CallAttempt::ShouldRetry(
     absl::optional<grpc_status_code> status,
     absl::optional<Duration> server_pushback) {
@@ -1224,6 +1352,78 @@ bool RetryFilter::CallData::CallAttempt::ShouldRetry(
   return true;
 }
 
+bool RetryFilter::CallData::CallAttempt::ShouldAbandonHedgedAttempt(
+    grpc_status_code status, absl::optional<Duration> server_pushback,
+    CallCombinerClosureList* closures) {
+  if (GPR_LIKELY(status == GRPC_STATUS_OK)) {
+    if (calld_->retry_throttle_data_ != nullptr) {
+      calld_->retry_throttle_data_->RecordSuccess();
+    }
+    if (GRPC_TRACE_FLAG_ENABLED(grpc_retry_trace)) {
+      gpr_log(GPR_INFO, "chand=%p calld=%p attempt=%p: call succeeded",
+              calld_->chand_, calld_, this);
+    }
+    return false;
+  }
+  // A fatal status commits the call, which cancels the other attempts.
+  if (!calld_->retry_policy_->non_fatal_status_codes().Contains(status)) {
+    if (GRPC_TRACE_FLAG_ENABLED(grpc_retry_trace)) {
+      gpr_log(GPR_INFO,
+              "chand=%p calld=%p attempt=%p: status %s is fatal for hedging",
+              calld_->chand_, calld_, this, grpc_status_code_to_string(status));
+    }
+    return false;
+  }
+  // As with retries, only non-fatal failures count against throttling.
+  if (calld_->retry_throttle_data_ != nullptr) {
+    calld_->retry_throttle_data_->RecordFailure();
+  }
+  // Negative server push-back means no more hedged attempts; otherwise,
+  // the next one is held off for the push-back delay.
+  if (server_pushback.has_value()) {
+    if (*server_pushback < Duration::Zero()) {
+      if (GRPC_TRACE_FLAG_ENABLED(grpc_retry_trace)) {
+        gpr_log(GPR_INFO,
+                "chand=%p calld=%p attempt=%p: server push-back stops "
+                "hedging",
+                calld_->chand_, calld_, this);
+      }
+      calld_->hedging_stopped_ = true;
+    } else {
+      if (GRPC_TRACE_FLAG_ENABLED(grpc_retry_trace)) {
+        gpr_log(GPR_INFO,
+                "chand=%p calld=%p attempt=%p: server push-back: next hedged "
+                "attempt in %" PRId64 " ms",
+                calld_->chand_, calld_, this, server_pushback->millis());
+      }
+      calld_->hedging_not_before_ = ExecCtx::Get()->Now() + *server_pushback;
+    }
+  }
+  // If this is the last attempt that can produce a result, its status is
+  // the call's status.
+  const bool other_attempts_in_flight = calld_->hedged_attempts_.size() > 1;
+  const bool can_start_more = calld_->HedgingAllowed();
+  if (!other_attempts_in_flight && !can_start_more) {
+    if (GRPC_TRACE_FLAG_ENABLED(grpc_retry_trace)) {
+      gpr_log(GPR_INFO,
+              "chand=%p calld=%p attempt=%p: no more hedged attempts",
+              calld_->chand_, calld_, this);
+    }
+    return false;
+  }
+  // Per gRFC A6, a non-fatal failure sends the next hedged attempt right
+  // away instead of waiting for the hedging delay, unless server push-back
+  // told us to wait.
+  if (can_start_more) {
+    if (ExecCtx::Get()->Now() < calld_->hedging_not_before_) {
+      calld_->MaybeStartHedgingTimer(calld_->hedging_not_before_);
+    } else {
+      calld_->AddClosureToStartHedgedAttempt(closures);
+    }
+  }
+  return true;
+}
+
 void RetryFilter::CallData::CallAttempt::Abandon() {
   abandoned_ = true;
   // Unref batches for deferred completion callbacks that will now never
@@ -1254,6 +1454,24 @@ void RetryFilter::CallData::CallAttempt::Abandon() {
   on_complete_deferred_batches_.clear();
 }
 
+void RetryFilter::CallData::CallAttempt::PropagateHedgedStateToCall() {
+  if (!HasOwnCallState()) return;
+  gpr_atm peer_string = gpr_atm_acq_load(&hedged_peer_string_);
+  if (calld_->peer_string_ != nullptr && peer_string != 0) {
+    gpr_atm_rel_store(calld_->peer_string_, peer_string);
+  }
+  // Only fill in values the call does not have yet: other attempts may
+  // still be using the ones it has.
+  for (size_t i = 0; i < GRPC_CONTEXT_COUNT; ++i) {
+    grpc_call_context_element* from = &call_context_[i];
+    grpc_call_context_element* to = &calld_->call_context_[i];
+    if (to->value != nullptr || from->value == nullptr) continue;
+    *to = *from;
+    // The call owns the value now.
+    from->destroy = nullptr;
+  }
+}
+
 void RetryFilter::CallData::CallAttempt::OnPerAttemptRecvTimer(
     void* arg, grpc_error_handle error) {
   auto* call_attempt = static_cast<CallAttempt*>(arg);
@@ -1364,10 +1582,9 @@ RetryFilter::CallData::CallAttempt::BatchData::~BatchData() {
 void RetryFilter::CallData::CallAttempt::BatchData::
     FreeCachedSendOpDataForCompletedBatch() {
   auto* calld = call_attempt_->calld_;
-  // TODO(roth): When we implement hedging, this logic will need to get
-  // a bit more complex, because there may be other (now abandoned) call
-  // attempts still using this data.  We may need to do some sort of
-  // ref-counting instead.
+  // If there may be other (now abandoned) hedged attempts still using
+  // this data, leave it for ~CallData() to free.
+  if (!calld->CanFreeCachedSendOpDataAfterCommit()) return;
   if (batch_.send_initial_metadata) {
     calld->FreeCachedSendInitialMetadata();
   }
@@ -1774,7 +1991,13 @@ void RetryFilter::CallData::CallAttempt::BatchData::RecvTrailingMetadataReady(
   }
   // Check if we should retry.
   if (!is_lb_drop) {  // Never retry on LB drops.
-    enum { kNoRetry, kTransparentRetry, kConfigurableRetry } retry = kNoRetry;
+    enum {
+      kNoRetry,
+      kTransparentRetry,
+      kConfigurableRetry,
+      kAbandonHedgedAttempt
+    } retry = kNoRetry;
+    CallCombinerClosureList closures;
     // Handle transparent retries.
     if (stream_network_state.has_value() && !calld->retry_committed_) {
       // If not sent on wire, then always retry.
@@ -1788,14 +2011,22 @@ void RetryFilter::CallData::CallAttempt::BatchData::RecvTrailingMetadataReady(
         retry = kTransparentRetry;
       }
     }
-    // If not transparently retrying, check for configurable retry.
-    if (retry == kNoRetry &&
-        call_attempt->ShouldRetry(status, server_pushback)) {
-      retry = kConfigurableRetry;
+    // If not transparently retrying, check for configurable retry.  When
+    // hedging, check whether we can drop this attempt's result in favor of
+    // other attempts instead.
+    if (retry == kNoRetry) {
+      if (calld->IsHedging()) {
+        if (!calld->retry_committed_ &&
+            call_attempt->ShouldAbandonHedgedAttempt(status, server_pushback,
+                                                     &closures)) {
+          retry = kAbandonHedgedAttempt;
+        }
+      } else if (call_attempt->ShouldRetry(status, server_pushback)) {
+        retry = kConfigurableRetry;
+      }
     }
     // If we're retrying, do so.
     if (retry != kNoRetry) {
-      CallCombinerClosureList closures;
       // Cancel call attempt.
       call_attempt->MaybeAddBatchForCancelOp(
           GRPC_ERROR_IS_NONE(error)
@@ -1807,13 +2038,16 @@ void RetryFilter::CallData::CallAttempt::BatchData::RecvTrailingMetadataReady(
       // For transparent retries, add a closure to immediately start a new
       // call attempt.
       // For configurable retries, start retry timer.
+      // For hedging, ShouldAbandonHedgedAttempt() has already arranged for
+      // the next attempt, if any.
       if (retry == kTransparentRetry) {
         calld->AddClosureToStartTransparentRetry(&closures);
-      } else {
+      } else if (retry == kConfigurableRetry) {
         calld->StartRetryTimer(server_pushback);
       }
       // Record that this attempt has been abandoned.
       call_attempt->Abandon();
+      calld->RemoveHedgedAttempt(call_attempt);
       // Yields call combiner.
       closures.RunClosures(calld->call_combiner_);
       return;
@@ -1846,8 +2080,11 @@ void RetryFilter::CallData::CallAttempt::BatchData::
                batch_.send_trailing_metadata == batch->send_trailing_metadata;
       });
   // If batch_data is a replay batch, then there will be no pending
-  // batch to complete.
-  if (pending == nullptr) {
+  // batch to complete.  Likewise if the pending batch with the same set of
+  // send ops has not been started (and therefore not cached) yet, which can
+  // happen when a replayed or hedged send op completes after the surface
+  // has started its next batch.
+  if (pending == nullptr || !pending->send_ops_cached) {
     GRPC_ERROR_UNREF(error);
     return;
   }
@@ -1937,6 +2174,11 @@ void RetryFilter::CallData::CallAttempt::BatchData::OnComplete(
   // Update bookkeeping in call_attempt.
   if (batch_data->batch_.send_initial_metadata) {
     call_attempt->completed_send_initial_metadata_ = true;
+    // The transport sets the peer by the time send_initial_metadata
+    // completes, which may be after we committed to this attempt.
+    if (calld->call_attempt_.get() == call_attempt) {
+      call_attempt->PropagateHedgedStateToCall();
+    }
   }
   if (batch_data->batch_.send_message) {
     ++call_attempt->completed_send_message_count_;
@@ -1997,12 +2239,15 @@ void RetryFilter::CallData::CallAttempt::BatchData::
   // the filters in the subchannel stack may modify this batch, and we don't
   // want those modifications to be passed forward to subsequent attempts.
   //
-  // If we've already completed one or more attempts, add the
-  // grpc-retry-attempts header.
+  // If we've already completed one or more attempts (or, when hedging,
+  // started one or more other attempts), add the grpc-retry-attempts header.
   call_attempt_->send_initial_metadata_ = calld->send_initial_metadata_.Copy();
-  if (GPR_UNLIKELY(calld->num_attempts_completed_ > 0)) {
+  const int num_previous_attempts =
+      calld->IsHedging() ? call_attempt_->num_previous_hedged_attempts_
+                         : calld->num_attempts_completed_;
+  if (GPR_UNLIKELY(num_previous_attempts > 0)) {
     call_attempt_->send_initial_metadata_.Set(GrpcPreviousRpcAttemptsMetadata(),
-                                              calld->num_attempts_completed_);
+                                              num_previous_attempts);
   } else {
     call_attempt_->send_initial_metadata_.Remove(
         GrpcPreviousRpcAttemptsMetadata());
@@ -2011,7 +2256,10 @@ void RetryFilter::CallData::CallAttempt::BatchData::
   batch_.send_initial_metadata = true;
   batch_.payload->send_initial_metadata.send_initial_metadata =
       &call_attempt_->send_initial_metadata_;
-  batch_.payload->send_initial_metadata.peer_string = calld->peer_string_;
+  batch_.payload->send_initial_metadata.peer_string =
+      calld->peer_string_ != nullptr && call_attempt_->HasOwnCallState()
+          ? &call_attempt_->hedged_peer_string_
+          : calld->peer_string_;
 }
 
 void RetryFilter::CallData::CallAttempt::BatchData::
@@ -2187,7 +2435,9 @@ RetryFilter::CallData::CallData(RetryFilter* chand,
       retry_committed_(false),
       retry_timer_pending_(false),
       retry_codepath_started_(false),
-      sent_transparent_retry_not_seen_by_server_(false) {}
+      sent_transparent_retry_not_seen_by_server_(false),
+      hedging_timer_pending_(false),
+      hedging_stopped_(false) {}
 
 RetryFilter::CallData::~CallData() {
   FreeAllCachedSendOpData();
@@ -2232,21 +2482,26 @@ void RetryFilter::CallData::StartTransportStreamOpBatch(
     }
     // Fail any pending batches.
     PendingBatchesFail(GRPC_ERROR_REF(cancelled_from_surface_));
+    // If we have hedged attempts in flight, commit to one of them; that
+    // cancels the others, and the batch is sent down to the one we
+    // committed to below.  The call stack is not destroyed before the
+    // cancelled attempts' LB calls are, so their cancellations need not
+    // complete before this batch does.
+    if (call_attempt_ == nullptr && !hedged_attempts_.empty()) {
+      RetryCommit(hedged_attempts_.front().get());
+    }
     // If we have a current call attempt, commit the call, then send
     // the cancellation down to that attempt.  When the call fails, it
     // will not be retried, because we have committed it here.
     if (call_attempt_ != nullptr) {
       RetryCommit(call_attempt_.get());
-      // TODO(roth): When implementing hedging, this will get more
-      // complex, because instead of just passing the batch down to a
-      // single call attempt, we'll need to cancel multiple call
-      // attempts and wait for the cancellation on_complete from each call
-      // attempt before we propagate the on_complete from this batch
-      // back to the surface.
       // Note: This will release the call combiner.
       call_attempt_->CancelFromSurface(batch);
       return;
     }
+    // Cancel hedging timer if needed.  Any cached send op data is left for
+    // ~CallData(), since abandoned attempts may still reference it.
+    MaybeCancelHedgingTimer();
     // Cancel retry timer if needed.
     if (retry_timer_pending_) {
       if (GRPC_TRACE_FLAG_ENABLED(grpc_retry_trace)) {
@@ -2274,7 +2529,15 @@ void RetryFilter::CallData::StartTransportStreamOpBatch(
     return;
   }
   // If we do not yet have a call attempt, create one.
-  if (call_attempt_ == nullptr) {
+  if (call_attempt_ == nullptr && hedged_attempts_.empty()) {
+    // When hedging, if every attempt so far has failed, the next one has
+    // already been scheduled, and it will pick up this batch.
+    if (retry_codepath_started_ && IsHedging()) {
+      GRPC_CALL_COMBINER_STOP(
+          call_combiner_,
+          "added pending batch while waiting for next hedged attempt");
+      return;
+    }
     // If this is the first batch and retries are already committed
     // (e.g., if this batch put the call above the buffer size limit), then
     // immediately create an LB call and delegate the batch to it.  This
@@ -2305,7 +2568,7 @@ void RetryFilter::CallData::StartTransportStreamOpBatch(
               call_context_[GRPC_CONTEXT_SERVICE_CONFIG_CALL_DATA].value);
       committed_call_ = CreateLoadBalancedCall(
           service_config_call_data->call_dispatch_controller(),
-          /*is_transparent_retry=*/false);
+          /*is_transparent_retry=*/false, call_context_);
       committed_call_->StartTransportStreamOpBatch(batch);
       return;
     }
@@ -2320,7 +2583,11 @@ void RetryFilter::CallData::StartTransportStreamOpBatch(
     CreateCallAttempt(/*is_transparent_retry=*/false);
     return;
   }
-  // Send batches to call attempt.
+  // Send batches to call attempt(s).
+  if (call_attempt_ == nullptr) {
+    StartRetriableBatchesOnHedgedAttempts();
+    return;
+  }
   if (GRPC_TRACE_FLAG_ENABLED(grpc_retry_trace)) {
     gpr_log(GPR_INFO, "chand=%p calld=%p: starting batch on attempt=%p", chand_,
             this, call_attempt_.get());
@@ -2331,21 +2598,45 @@ void RetryFilter::CallData::StartTransportStreamOpBatch(
 OrphanablePtr<ClientChannel::LoadBalancedCall>
 RetryFilter::CallData::CreateLoadBalancedCall(
     ConfigSelector::CallDispatchController* call_dispatch_controller,
-    bool is_transparent_retry) {
-  grpc_call_element_args args = {owning_call_, nullptr,          call_context_,
+    bool is_transparent_retry, grpc_call_context_element* call_context) {
+  grpc_call_element_args args = {owning_call_, nullptr,          call_context,
                                  path_,        /*start_time=*/0, deadline_,
                                  arena_,       call_combiner_};
   return chand_->client_channel_->CreateLoadBalancedCall(
       args, pollent_,
       // This callback holds a ref to the CallStackDestructionBarrier
       // object until the LB call is destroyed.
-      call_stack_destruction_barrier_->MakeLbCallDestructionClosure(this),
+      call_stack_destruction_barrier_->MakeLbCallDestructionClosure(
+          this, call_context != call_context_ ? call_context : nullptr),
       call_dispatch_controller, is_transparent_retry);
 }
 
+grpc_call_context_element*
+RetryFilter::CallData::CopyCallContextForHedgedAttempt() {
+  auto* context = static_cast<grpc_call_context_element*>(
+      arena_->Alloc(sizeof(grpc_call_context_element) * GRPC_CONTEXT_COUNT));
+  for (size_t i = 0; i < GRPC_CONTEXT_COUNT; ++i) {
+    context[i].value = call_context_[i].value;
+    context[i].destroy = nullptr;
+  }
+  return context;
+}
+
 void RetryFilter::CallData::CreateCallAttempt(bool is_transparent_retry) {
-  call_attempt_ = MakeRefCounted<CallAttempt>(this, is_transparent_retry);
-  call_attempt_->StartRetriableBatches();
+  auto call_attempt = MakeRefCounted<CallAttempt>(this, is_transparent_retry);
+  CallAttempt* attempt = call_attempt.get();
+  if (IsHedging() && !retry_committed_) {
+    hedged_attempts_.push_back(std::move(call_attempt));
+    // Schedule the next hedged attempt.
+    if (!is_transparent_retry) {
+      ++num_hedged_attempts_started_;
+      MaybeStartHedgingTimer(ExecCtx::Get()->Now() +
+                             *retry_policy_->hedging_delay());
+    }
+  } else {
+    call_attempt_ = std::move(call_attempt);
+  }
+  attempt->StartRetriableBatches();
 }
 
 //
@@ -2463,9 +2754,6 @@ RetryFilter::CallData::PendingBatch* RetryFilter::CallData::PendingBatchesAdd(
   if (batch->send_trailing_metadata) {
     pending_send_trailing_metadata_ = true;
   }
-  // TODO(roth): When we implement hedging, if there are currently attempts
-  // in flight, we will need to pick the one on which the max number of send
-  // ops have already been sent, and we commit to that attempt.
   if (GPR_UNLIKELY(bytes_buffered_for_retry_ >
                    chand_->per_rpc_retry_buffer_size_)) {
     if (GRPC_TRACE_FLAG_ENABLED(grpc_retry_trace)) {
@@ -2473,7 +2761,8 @@ RetryFilter::CallData::PendingBatch* RetryFilter::CallData::PendingBatchesAdd(
               "chand=%p calld=%p: exceeded retry buffer size, committing",
               chand_, this);
     }
-    RetryCommit(call_attempt_.get());
+    RetryCommit(call_attempt_ != nullptr ? call_attempt_.get()
+                                         : HedgedAttemptToCommit());
   }
   return pending;
 }
@@ -2582,6 +2871,8 @@ void RetryFilter::CallData::RetryCommit(CallAttempt* call_attempt) {
     gpr_log(GPR_INFO, "chand=%p calld=%p: committing retries", chand_, this);
   }
   if (call_attempt != nullptr) {
+    // When hedging, make this the current attempt and cancel the others.
+    if (!hedged_attempts_.empty()) CommitHedgedAttempt(call_attempt);
     // If the call attempt's LB call has been committed, inform the call
     // dispatch controller that the call has been committed.
     // Note: If call_attempt is null, this is happening before the first
@@ -2650,22 +2941,226 @@ void RetryFilter::CallData::AddClosureToStartTransparentRetry(
             this);
   }
   GRPC_CALL_STACK_REF(owning_call_, "OnRetryTimer");
-  GRPC_CLOSURE_INIT(&retry_closure_, StartTransparentRetry, this, nullptr);
-  closures->Add(&retry_closure_, GRPC_ERROR_NONE, "start transparent retry");
+  // Several hedged attempts may need a transparent retry at the same time,
+  // so they can't share retry_closure_.
+  grpc_closure* closure =
+      IsHedging() ? arena_->New<grpc_closure>() : &retry_closure_;
+  GRPC_CLOSURE_INIT(closure, StartTransparentRetry, this, nullptr);
+  closures->Add(closure, GRPC_ERROR_NONE, "start transparent retry");
 }
 
 void RetryFilter::CallData::StartTransparentRetry(void* arg,
                                                   grpc_error_handle /*error*/) {
   auto* calld = static_cast<CallData*>(arg);
-  if (GRPC_ERROR_IS_NONE(calld->cancelled_from_surface_)) {
+  if (calld->IsHedging()
+          ? calld->ShouldStartHedgedAttempt(/*is_transparent_retry=*/true)
+          : GRPC_ERROR_IS_NONE(calld->cancelled_from_surface_)) {
     calld->CreateCallAttempt(/*is_transparent_retry=*/true);
   } else {
     GRPC_CALL_COMBINER_STOP(calld->call_combiner_,
-                            "call cancelled before transparent retry");
+                            "call cancelled or committed before transparent "
+                            "retry");
   }
   GRPC_CALL_STACK_UNREF(calld->owning_call_, "OnRetryTimer");
 }
 
+//
+// hedging
+//
+
+bool RetryFilter::CallData::HedgingAllowed() {
+  if (hedging_stopped_) return false;
+  if (num_hedged_attempts_started_ >= retry_policy_->max_attempts()) {
+    return false;
+  }
+  if (retry_throttle_data_ != nullptr && retry_throttle_data_->IsThrottled()) {
+    if (GRPC_TRACE_FLAG_ENABLED(grpc_retry_trace)) {
+      gpr_log(GPR_INFO, "chand=%p calld=%p: hedged attempts throttled", chand_,
+              this);
+    }
+    return false;
+  }
+  auto* service_config_call_data =
+      static_cast<ClientChannelServiceConfigCallData*>(
+          call_context_[GRPC_CONTEXT_SERVICE_CONFIG_CALL_DATA].value);
+  if (!service_config_call_data->call_dispatch_controller()->ShouldRetry()) {
+    if (GRPC_TRACE_FLAG_ENABLED(grpc_retry_trace)) {
+      gpr_log(GPR_INFO,
+              "chand=%p calld=%p: call dispatch controller denied hedging",
+              chand_, this);
+    }
+    return false;
+  }
+  return true;
+}
+
+bool RetryFilter::CallData::ShouldStartHedgedAttempt(
+    bool is_transparent_retry) {
+  if (!GRPC_ERROR_IS_NONE(cancelled_from_surface_)) return false;
+  // Once committed, the only attempt we still start is one that was
+  // scheduled while no attempt was in flight (e.g., if the retry buffer
+  // overflowed while we were waiting for the next attempt).
+  if (retry_committed_) {
+    return call_attempt_ == nullptr && committed_call_ == nullptr &&
+           hedged_attempts_.empty();
+  }
+  // Transparent retries do not count against maxAttempts.
+  if (is_transparent_retry) return true;
+  if (num_hedged_attempts_started_ >= retry_policy_->max_attempts()) {
+    return false;
+  }
+  // If every attempt so far has failed, we already decided to start this
+  // one when the last of them failed.
+  if (hedged_attempts_.empty()) return true;
+  return HedgingAllowed();
+}
+
+void RetryFilter::CallData::StartRetriableBatchesOnHedgedAttempts() {
+  if (GRPC_TRACE_FLAG_ENABLED(grpc_retry_trace)) {
+    gpr_log(GPR_INFO,
+            "chand=%p calld=%p: starting batch on %" PRIuPTR
+            " hedged attempts",
+            chand_, this, hedged_attempts_.size());
+  }
+  CallCombinerClosureList closures;
+  for (auto& call_attempt : hedged_attempts_) {
+    call_attempt->AddRetriableBatches(&closures);
+  }
+  // Note: This will yield the call combiner.
+  closures.RunClosures(call_combiner_);
+}
+
+RetryFilter::CallData::CallAttempt*
+RetryFilter::CallData::HedgedAttemptToCommit() {
+  // Pick the attempt that has gotten furthest, so that the fewest cached
+  // send ops need to be replayed.
+  CallAttempt* best = nullptr;
+  for (auto& call_attempt : hedged_attempts_) {
+    if (best == nullptr ||
+        call_attempt->num_send_ops_started() > best->num_send_ops_started()) {
+      best = call_attempt.get();
+    }
+  }
+  return best;
+}
+
+void RetryFilter::CallData::CommitHedgedAttempt(CallAttempt* call_attempt) {
+  if (GRPC_TRACE_FLAG_ENABLED(grpc_retry_trace)) {
+    gpr_log(GPR_INFO,
+            "chand=%p calld=%p: committing to hedged attempt=%p, cancelling "
+            "%" PRIuPTR " others",
+            chand_, this, call_attempt, hedged_attempts_.size() - 1);
+  }
+  CallCombinerClosureList closures;
+  for (auto& attempt : hedged_attempts_) {
+    if (attempt.get() == call_attempt) {
+      call_attempt_ = std::move(attempt);
+    } else {
+      attempt->CancelLosingHedgedAttempt(&closures);
+    }
+  }
+  GPR_ASSERT(call_attempt_.get() == call_attempt);
+  hedged_attempts_.clear();
+  call_attempt->PropagateHedgedStateToCall();
+  MaybeCancelHedgingTimer();
+  // The cancellations run once the caller yields the call combiner.
+  closures.RunClosuresWithoutYielding(call_combiner_);
+}
+
+void RetryFilter::CallData::RemoveHedgedAttempt(CallAttempt* call_attempt) {
+  for (auto it = hedged_attempts_.begin(); it != hedged_attempts_.end();
+       ++it) {
+    if (it->get() == call_attempt) {
+      hedged_attempts_.erase(it);
+      return;
+    }
+  }
+}
+
+void RetryFilter::CallData::MaybeStartHedgingTimer(Timestamp deadline) {
+  if (hedging_timer_pending_) return;
+  if (num_hedged_attempts_started_ >= retry_policy_->max_attempts()) return;
+  if (deadline < hedging_not_before_) deadline = hedging_not_before_;
+  if (GRPC_TRACE_FLAG_ENABLED(grpc_retry_trace)) {
+    gpr_log(GPR_INFO,
+            "chand=%p calld=%p: next hedged attempt in %" PRId64 " ms", chand_,
+            this, (deadline - ExecCtx::Get()->Now()).millis());
+  }
+  GRPC_CLOSURE_INIT(&hedging_closure_, OnHedgingTimer, this, nullptr);
+  GRPC_CALL_STACK_REF(owning_call_, "OnHedgingTimer");
+  hedging_timer_pending_ = true;
+  grpc_timer_init(&hedging_timer_, deadline, &hedging_closure_);
+}
+
+void RetryFilter::CallData::MaybeCancelHedgingTimer() {
+  if (hedging_timer_pending_) {
+    if (GRPC_TRACE_FLAG_ENABLED(grpc_retry_trace)) {
+      gpr_log(GPR_INFO, "chand=%p calld=%p: cancelling hedging timer", chand_,
+              this);
+    }
+    hedging_timer_pending_ = false;  // Lame timer callback.
+    grpc_timer_cancel(&hedging_timer_);
+  }
+}
+
+void RetryFilter::CallData::OnHedgingTimer(void* arg,
+                                           grpc_error_handle error) {
+  auto* calld = static_cast<CallData*>(arg);
+  GRPC_CLOSURE_INIT(&calld->hedging_closure_, OnHedgingTimerLocked, calld,
+                    nullptr);
+  GRPC_CALL_COMBINER_START(calld->call_combiner_, &calld->hedging_closure_,
+                           GRPC_ERROR_REF(error), "hedging timer fired");
+}
+
+void RetryFilter::CallData::OnHedgingTimerLocked(void* arg,
+                                                 grpc_error_handle error) {
+  auto* calld = static_cast<CallData*>(arg);
+  if (GRPC_ERROR_IS_NONE(error) && calld->hedging_timer_pending_) {
+    calld->hedging_timer_pending_ = false;
+    if (ExecCtx::Get()->Now() < calld->hedging_not_before_) {
+      // Server push-back arrived after this timer was started.
+      calld->MaybeStartHedgingTimer(calld->hedging_not_before_);
+      GRPC_CALL_COMBINER_STOP(calld->call_combiner_,
+                              "hedging timer deferred by server push-back");
+    } else if (calld->ShouldStartHedgedAttempt(
+                   /*is_transparent_retry=*/false)) {
+      calld->CreateCallAttempt(/*is_transparent_retry=*/false);
+    } else {
+      GRPC_CALL_COMBINER_STOP(calld->call_combiner_,
+                              "not starting hedged attempt");
+    }
+  } else {
+    GRPC_CALL_COMBINER_STOP(calld->call_combiner_, "hedging timer cancelled");
+  }
+  GRPC_CALL_STACK_UNREF(calld->owning_call_, "OnHedgingTimer");
+}
+
+void RetryFilter::CallData::AddClosureToStartHedgedAttempt(
+    CallCombinerClosureList* closures) {
+  if (GRPC_TRACE_FLAG_ENABLED(grpc_retry_trace)) {
+    gpr_log(GPR_INFO, "chand=%p calld=%p: scheduling next hedged attempt",
+            chand_, this);
+  }
+  GRPC_CALL_STACK_REF(owning_call_, "StartHedgedAttempt");
+  // This may run concurrently with the hedging timer, so it can't share
+  // hedging_closure_.  There are at most maxAttempts of these per call.
+  grpc_closure* closure = arena_->New<grpc_closure>();
+  GRPC_CLOSURE_INIT(closure, StartHedgedAttempt, this, nullptr);
+  closures->Add(closure, GRPC_ERROR_NONE, "start hedged attempt");
+}
+
+void RetryFilter::CallData::StartHedgedAttempt(void* arg,
+                                               grpc_error_handle /*error*/) {
+  auto* calld = static_cast<CallData*>(arg);
+  if (calld->ShouldStartHedgedAttempt(/*is_transparent_retry=*/false)) {
+    calld->CreateCallAttempt(/*is_transparent_retry=*/false);
+  } else {
+    GRPC_CALL_COMBINER_STOP(calld->call_combiner_,
+                            "not starting hedged attempt");
+  }
+  GRPC_CALL_STACK_UNREF(calld->owning_call_, "StartHedgedAttempt");
+}
+
 }  // namespace
 
 const grpc_channel_filter kRetryFilterVtable = {
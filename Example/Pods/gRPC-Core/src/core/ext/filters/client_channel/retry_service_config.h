@@ -65,6 +65,14 @@ class RetryMethodConfig : public ServiceConfigParser::ParsedConfig {
         retryable_status_codes_(retryable_status_codes),
         per_attempt_recv_timeout_(per_attempt_recv_timeout) {}
 
+  // Constructs the config for a hedgingPolicy, which is mutually
+  // exclusive with retryPolicy.
+  RetryMethodConfig(int max_attempts, Duration hedging_delay,
+                    StatusCodeSet non_fatal_status_codes)
+      : max_attempts_(max_attempts),
+        hedging_delay_(hedging_delay),
+        non_fatal_status_codes_(non_fatal_status_codes) {}
+
   int max_attempts() const { return max_attempts_; }
   Duration initial_backoff() const { return initial_backoff_; }
   Duration max_backoff() const { return max_backoff_; }
@@ -75,6 +83,11 @@ class RetryMethodConfig : public ServiceConfigParser::ParsedConfig {
   absl::optional<Duration> per_attempt_recv_timeout() const {
     return per_attempt_recv_timeout_;
   }
+  // Set only for a hedgingPolicy.
+  absl::optional<Duration> hedging_delay() const { return hedging_delay_; }
+  StatusCodeSet non_fatal_status_codes() const {
+    return non_fatal_status_codes_;
+  }
 
  private:
   int max_attempts_ = 0;
@@ -83,6 +96,8 @@ class RetryMethodConfig : public ServiceConfigParser::ParsedConfig {
   float backoff_multiplier_ = 0;
   StatusCodeSet retryable_status_codes_;
   absl::optional<Duration> per_attempt_recv_timeout_;
+  absl::optional<Duration> hedging_delay_;
+  StatusCodeSet non_fatal_status_codes_;
 };
 
 class RetryServiceConfigParser : public ServiceConfigParser::Parser {
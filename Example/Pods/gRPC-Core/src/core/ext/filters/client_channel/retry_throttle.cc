@@ -108,6 +108,16 @@ void ServerRetryThrottleData::RecordSuccess() {
       static_cast<gpr_atm>(throttle_data->max_milli_tokens_));
 }
 
+bool ServerRetryThrottleData::IsThrottled() {
+  // First, check if we are stale and need to be replaced.
+  ServerRetryThrottleData* throttle_data = this;
+  GetReplacementThrottleDataIfNeeded(&throttle_data);
+  // Same threshold as RecordFailure().
+  const intptr_t value = static_cast<intptr_t>(
+      gpr_atm_no_barrier_load(&throttle_data->milli_tokens_));
+  return value <= throttle_data->max_milli_tokens_ / 2;
+}
+
 //
 // ServerRetryThrottleMap
 //
@@ -20,11 +20,13 @@
 
 #include <inttypes.h>
 #include <limits.h>
+#include <stdint.h>
 
 #include <algorithm>
 #include <memory>
 #include <new>
 #include <utility>
+#include <vector>
 
 #include "absl/status/statusor.h"
 
@@ -74,6 +76,9 @@
 #define GRPC_SUBCHANNEL_RECONNECT_MAX_BACKOFF_SECONDS 120
 #define GRPC_SUBCHANNEL_RECONNECT_JITTER 0.2
 
+// Connection pool parameters.
+#define GRPC_SUBCHANNEL_POOLED_CONNECTION_IDLE_TIMEOUT_SECONDS 30
+
 // Conversion between subchannel call and call stack.
 #define SUBCHANNEL_CALL_TO_CALL_STACK(call) \
   (grpc_call_stack*)((char*)(call) +        \
@@ -93,13 +98,15 @@ DebugOnlyTraceFlag grpc_trace_subchannel_refcount(false, "subchannel_refcount");
 //
 
 ConnectedSubchannel::ConnectedSubchannel(
-    grpc_channel_stack* channel_stack, const ChannelArgs& args,
+    grpc_channel_stack* channel_stack, grpc_transport* transport,
+    const ChannelArgs& args,
     RefCountedPtr<channelz::SubchannelNode> channelz_subchannel)
     : RefCounted<ConnectedSubchannel>(
           GRPC_TRACE_FLAG_ENABLED(grpc_trace_subchannel_refcount)
               ? "ConnectedSubchannel"
               : nullptr),
       channel_stack_(channel_stack),
+      transport_(transport),
       args_(args),
       channelz_subchannel_(std::move(channelz_subchannel)) {}
 
@@ -133,6 +140,10 @@ size_t ConnectedSubchannel::GetInitialCallSizeEstimate() const {
          channel_stack_->call_stack_size;
 }
 
+uint32_t ConnectedSubchannel::max_concurrent_streams() const {
+  return grpc_transport_max_concurrent_streams(transport_);
+}
+
 //
 // SubchannelCall
 //
@@ -149,6 +160,7 @@ RefCountedPtr<SubchannelCall> SubchannelCall::Create(Args args,
 SubchannelCall::SubchannelCall(Args args, grpc_error_handle* error)
     : connected_subchannel_(std::move(args.connected_subchannel)),
       deadline_(args.deadline) {
+  connected_subchannel_->active_calls_.fetch_add(1, std::memory_order_relaxed);
   grpc_call_stack* callstk = SUBCHANNEL_CALL_TO_CALL_STACK(this);
   const grpc_call_element_args call_args = {
       callstk,             /* call_stack */
@@ -220,6 +232,7 @@ void SubchannelCall::Destroy(void* arg, grpc_error_handle /*error*/) {
   grpc_closure* after_call_stack_destroy = self->after_call_stack_destroy_;
   RefCountedPtr<ConnectedSubchannel> connected_subchannel =
       std::move(self->connected_subchannel_);
+  connected_subchannel->active_calls_.fetch_sub(1, std::memory_order_relaxed);
   // Destroy the subchannel call.
   self->~SubchannelCall();
   // Destroy the call stack. This should be after destroying the subchannel
@@ -305,8 +318,9 @@ class Subchannel::ConnectedSubchannelStateWatcher
     : public AsyncConnectivityStateWatcherInterface {
  public:
   // Must be instantiated while holding c->mu.
-  explicit ConnectedSubchannelStateWatcher(WeakRefCountedPtr<Subchannel> c)
-      : subchannel_(std::move(c)) {}
+  ConnectedSubchannelStateWatcher(WeakRefCountedPtr<Subchannel> c,
+                                  ConnectedSubchannel* connected_subchannel)
+      : subchannel_(std::move(c)), connected_subchannel_(connected_subchannel) {}
 
   ~ConnectedSubchannelStateWatcher() override {
     subchannel_.reset(DEBUG_LOCATION, "state_watcher");
@@ -318,36 +332,49 @@ class Subchannel::ConnectedSubchannelStateWatcher
     Subchannel* c = subchannel_.get();
     MutexLock lock(&c->mu_);
     // If we're either shutting down or have already seen this connection
-    // failure (i.e., c->connected_subchannel_ is null), do nothing.
+    // failure (i.e., c->connected_subchannel_ no longer points to the
+    // connection we're watching), do nothing other than dropping the
+    // connection from the pool if it is a pooled one.
     //
     // The transport reports TRANSIENT_FAILURE upon GOAWAY but SHUTDOWN
     // upon connection close.  So if the server gracefully shuts down,
     // we will see TRANSIENT_FAILURE followed by SHUTDOWN, but if not, we
     // will see only SHUTDOWN.  Either way, we react to the first one we
     // see, ignoring anything that happens after that.
-    if (c->connected_subchannel_ == nullptr) return;
-    if (new_state == GRPC_CHANNEL_TRANSIENT_FAILURE ||
-        new_state == GRPC_CHANNEL_SHUTDOWN) {
-      if (GRPC_TRACE_FLAG_ENABLED(grpc_trace_subchannel)) {
-        gpr_log(GPR_INFO,
-                "subchannel %p %s: Connected subchannel %p reports %s: %s", c,
-                c->key_.ToString().c_str(), c->connected_subchannel_.get(),
-                ConnectivityStateName(new_state), status.ToString().c_str());
-      }
-      c->connected_subchannel_.reset();
-      if (c->channelz_node() != nullptr) {
-        c->channelz_node()->SetChildSocket(nullptr);
-      }
-      // Even though we're reporting IDLE instead of TRANSIENT_FAILURE here,
-      // pass along the status from the transport, since it may have
-      // keepalive info attached to it that the channel needs.
-      // TODO(roth): Consider whether there's a cleaner way to do this.
-      c->SetConnectivityStateLocked(GRPC_CHANNEL_IDLE, status);
-      c->backoff_.Reset();
+    if (new_state != GRPC_CHANNEL_TRANSIENT_FAILURE &&
+        new_state != GRPC_CHANNEL_SHUTDOWN) {
+      return;
+    }
+    if (c->connected_subchannel_.get() != connected_subchannel_) {
+      c->RemovePooledConnectionLocked(connected_subchannel_,
+                                      ConnectivityStateName(new_state));
+      return;
     }
+    if (GRPC_TRACE_FLAG_ENABLED(grpc_trace_subchannel)) {
+      gpr_log(GPR_INFO,
+              "subchannel %p %s: Connected subchannel %p reports %s: %s", c,
+              c->key_.ToString().c_str(), c->connected_subchannel_.get(),
+              ConnectivityStateName(new_state), status.ToString().c_str());
+    }
+    c->connected_subchannel_.reset();
+    if (c->channelz_node() != nullptr) {
+      c->channelz_node()->SetChildSocket(nullptr);
+    }
+    // The pooled connections only supplement the main one, so they go with
+    // it; the next connection attempt starts a fresh pool.
+    c->ClearPooledConnectionsLocked(ConnectivityStateName(new_state));
+    // Even though we're reporting IDLE instead of TRANSIENT_FAILURE here,
+    // pass along the status from the transport, since it may have
+    // keepalive info attached to it that the channel needs.
+    // TODO(roth): Consider whether there's a cleaner way to do this.
+    c->SetConnectivityStateLocked(GRPC_CHANNEL_IDLE, status);
+    c->backoff_.Reset();
   }
 
   WeakRefCountedPtr<Subchannel> subchannel_;
+  // The connection being watched.  Only compared by address, never
+  // dereferenced.
+  ConnectedSubchannel* connected_subchannel_;
 };
 
 // Asynchronously notifies the \a watcher of a change in the connectvity state
@@ -630,6 +657,15 @@ Subchannel::Subchannel(SubchannelKey key,
       key_(std::move(key)),
       args_(args),
       pollset_set_(grpc_pollset_set_create()),
+      max_connections_(std::max(
+          1, args_.GetInt(GRPC_ARG_MAX_CONNECTIONS_PER_SUBCHANNEL).value_or(1))),
+      pooled_connection_idle_timeout_(std::max(
+          Duration::Seconds(1),
+          args_
+              .GetDurationFromIntMillis(
+                  GRPC_ARG_SUBCHANNEL_CONNECTION_IDLE_TIMEOUT_MS)
+              .value_or(Duration::Seconds(
+                  GRPC_SUBCHANNEL_POOLED_CONNECTION_IDLE_TIMEOUT_SECONDS)))),
       connector_(std::move(connector)),
       backoff_(ParseArgsForBackoffValues(args_, &min_connect_timeout_)) {
   // A grpc_init is added here to ensure that grpc_shutdown does not happen
@@ -751,6 +787,37 @@ void Subchannel::CancelConnectivityStateWatch(
   }
 }
 
+namespace {
+
+// Number of additional calls \a connected_subchannel can take before new
+// streams have to wait for the peer's concurrency limit.
+int64_t FreeStreamSlots(const ConnectedSubchannel& connected_subchannel) {
+  return static_cast<int64_t>(connected_subchannel.max_concurrent_streams()) -
+         static_cast<int64_t>(connected_subchannel.active_calls());
+}
+
+}  // namespace
+
+RefCountedPtr<ConnectedSubchannel> Subchannel::GetConnectedSubchannelForCall() {
+  MutexLock lock(&mu_);
+  if (max_connections_ == 1 || connected_subchannel_ == nullptr) {
+    return connected_subchannel_;
+  }
+  ConnectedSubchannel* best = connected_subchannel_.get();
+  int64_t best_free_slots = FreeStreamSlots(*best);
+  for (const PooledConnection& pooled : pooled_connections_) {
+    const int64_t free_slots = FreeStreamSlots(*pooled.connected_subchannel);
+    if (free_slots > best_free_slots) {
+      best = pooled.connected_subchannel.get();
+      best_free_slots = free_slots;
+    }
+  }
+  // Every connection is at its limit, so this call will have to wait for a
+  // stream slot.  Open another connection for the ones that follow.
+  if (best_free_slots <= 0) MaybeStartPooledConnectionLocked();
+  return best->Ref();
+}
+
 void Subchannel::RequestConnection() {
   MutexLock lock(&mu_);
   if (state_ == GRPC_CHANNEL_IDLE) {
@@ -785,6 +852,7 @@ void Subchannel::Orphan() {
   shutdown_ = true;
   connector_.reset();
   connected_subchannel_.reset();
+  ClearPooledConnectionsLocked("shutdown");
   health_watcher_map_.ShutdownLocked();
 }
 
@@ -870,6 +938,12 @@ void Subchannel::StartConnectingLocked() {
   next_attempt_time_ = backoff_.NextAttemptTime();
   // Report CONNECTING.
   SetConnectivityStateLocked(GRPC_CHANNEL_CONNECTING, absl::OkStatus());
+  // If the connector is already busy establishing a pooled connection, that
+  // attempt becomes the main connection attempt.
+  if (connecting_pooled_) {
+    connecting_pooled_ = false;
+    return;
+  }
   // Start connection attempt.
   SubchannelConnector::Args args;
   args.address = &address_for_connect_;
@@ -894,6 +968,11 @@ void Subchannel::OnConnectingFinishedLocked(grpc_error_handle error) {
     (void)GRPC_ERROR_UNREF(error);
     return;
   }
+  if (connecting_pooled_) {
+    connecting_pooled_ = false;
+    OnPooledConnectingFinishedLocked(error);
+    return;
+  }
   // If we didn't get a transport or we fail to publish it, report
   // TRANSIENT_FAILURE and start the retry timer.
   // Note that if the connection attempt took longer than the backoff
@@ -929,31 +1008,40 @@ void Subchannel::OnConnectingFinishedLocked(grpc_error_handle error) {
   (void)GRPC_ERROR_UNREF(error);
 }
 
-bool Subchannel::PublishTransportLocked() {
+RefCountedPtr<ConnectedSubchannel> Subchannel::CreateConnectedSubchannelLocked(
+    RefCountedPtr<channelz::SocketNode>* socket) {
   // Construct channel stack.
+  grpc_transport* transport = connecting_result_.transport;
   ChannelStackBuilderImpl builder("subchannel", GRPC_CLIENT_SUBCHANNEL);
   builder.SetChannelArgs(connecting_result_.channel_args)
-      .SetTransport(connecting_result_.transport);
+      .SetTransport(transport);
   if (!CoreConfiguration::Get().channel_init().CreateStack(&builder)) {
-    return false;
+    return nullptr;
   }
   absl::StatusOr<RefCountedPtr<grpc_channel_stack>> stk = builder.Build();
   if (!stk.ok()) {
     auto error = absl_status_to_grpc_error(stk.status());
-    grpc_transport_destroy(connecting_result_.transport);
+    grpc_transport_destroy(transport);
     gpr_log(GPR_ERROR,
             "subchannel %p %s: error initializing subchannel stack: %s", this,
             key_.ToString().c_str(), grpc_error_std_string(error).c_str());
     GRPC_ERROR_UNREF(error);
-    return false;
+    return nullptr;
   }
-  RefCountedPtr<channelz::SocketNode> socket =
-      std::move(connecting_result_.socket_node);
+  *socket = std::move(connecting_result_.socket_node);
   connecting_result_.Reset();
-  if (shutdown_) return false;
+  if (shutdown_) return nullptr;
+  return MakeRefCounted<ConnectedSubchannel>(stk->release(), transport, args_,
+                                             channelz_node_);
+}
+
+bool Subchannel::PublishTransportLocked() {
+  RefCountedPtr<channelz::SocketNode> socket;
+  RefCountedPtr<ConnectedSubchannel> connected_subchannel =
+      CreateConnectedSubchannelLocked(&socket);
+  if (connected_subchannel == nullptr) return false;
   // Publish.
-  connected_subchannel_.reset(
-      new ConnectedSubchannel(stk->release(), args_, channelz_node_));
+  connected_subchannel_ = std::move(connected_subchannel);
   if (GRPC_TRACE_FLAG_ENABLED(grpc_trace_subchannel)) {
     gpr_log(GPR_INFO, "subchannel %p %s: new connected subchannel at %p", this,
             key_.ToString().c_str(), connected_subchannel_.get());
@@ -964,10 +1052,151 @@ bool Subchannel::PublishTransportLocked() {
   // Start watching connected subchannel.
   connected_subchannel_->StartWatch(
       pollset_set_, MakeOrphanable<ConnectedSubchannelStateWatcher>(
-                        WeakRef(DEBUG_LOCATION, "state_watcher")));
+                        WeakRef(DEBUG_LOCATION, "state_watcher"),
+                        connected_subchannel_.get()));
   // Report initial state.
   SetConnectivityStateLocked(GRPC_CHANNEL_READY, absl::Status());
   return true;
 }
 
+void Subchannel::MaybeStartPooledConnectionLocked() {
+  if (shutdown_ || connecting_pooled_ || state_ != GRPC_CHANNEL_READY) return;
+  if (pooled_connections_.size() + 1 >= max_connections_) return;
+  const Timestamp now = ExecCtx::Get()->Now();
+  if (now < next_pooled_attempt_time_) return;
+  if (GRPC_TRACE_FLAG_ENABLED(grpc_trace_subchannel)) {
+    gpr_log(GPR_INFO,
+            "subchannel %p %s: all %" PRIuPTR
+            " connections are at their stream limit, opening another",
+            this, key_.ToString().c_str(), pooled_connections_.size() + 1);
+  }
+  connecting_pooled_ = true;
+  SubchannelConnector::Args args;
+  args.address = &address_for_connect_;
+  args.interested_parties = pollset_set_;
+  args.deadline = now + min_connect_timeout_;
+  args.channel_args = args_;
+  WeakRef(DEBUG_LOCATION, "Connect").release();  // Ref held by callback.
+  connector_->Connect(args, &connecting_result_, &on_connecting_finished_);
+}
+
+void Subchannel::OnPooledConnectingFinishedLocked(grpc_error_handle error) {
+  RefCountedPtr<channelz::SocketNode> socket;
+  RefCountedPtr<ConnectedSubchannel> connected_subchannel;
+  if (connecting_result_.transport != nullptr) {
+    if (state_ == GRPC_CHANNEL_READY) {
+      connected_subchannel = CreateConnectedSubchannelLocked(&socket);
+    } else {
+      // The main connection went away while we were connecting, and
+      // nothing has asked to reconnect yet.
+      grpc_transport_destroy(connecting_result_.transport);
+      connecting_result_.Reset();
+    }
+  }
+  if (connected_subchannel == nullptr) {
+    if (GRPC_TRACE_FLAG_ENABLED(grpc_trace_subchannel)) {
+      gpr_log(GPR_INFO, "subchannel %p %s: pooled connection failed: %s", this,
+              key_.ToString().c_str(), grpc_error_std_string(error).c_str());
+    }
+    next_pooled_attempt_time_ =
+        ExecCtx::Get()->Now() +
+        Duration::Seconds(GRPC_SUBCHANNEL_INITIAL_CONNECT_BACKOFF_SECONDS);
+    (void)GRPC_ERROR_UNREF(error);
+    return;
+  }
+  (void)GRPC_ERROR_UNREF(error);
+  if (GRPC_TRACE_FLAG_ENABLED(grpc_trace_subchannel)) {
+    gpr_log(GPR_INFO,
+            "subchannel %p %s: new pooled connected subchannel at %p", this,
+            key_.ToString().c_str(), connected_subchannel.get());
+  }
+  if (channelz_node_ != nullptr) {
+    channelz_node_->AddPooledSocket(socket);
+    channelz_node_->AddTraceEvent(
+        channelz::ChannelTrace::Severity::Info,
+        grpc_slice_from_static_string("Pooled connection added"));
+  }
+  connected_subchannel->StartWatch(
+      pollset_set_, MakeOrphanable<ConnectedSubchannelStateWatcher>(
+                        WeakRef(DEBUG_LOCATION, "state_watcher"),
+                        connected_subchannel.get()));
+  pooled_connections_.push_back({std::move(connected_subchannel),
+                                 std::move(socket), Timestamp::InfFuture()});
+  MaybeStartPoolIdleTimerLocked();
+}
+
+void Subchannel::RemovePooledConnectionLocked(
+    ConnectedSubchannel* connected_subchannel, const char* reason) {
+  auto it = std::find_if(pooled_connections_.begin(), pooled_connections_.end(),
+                         [connected_subchannel](const PooledConnection& p) {
+                           return p.connected_subchannel.get() ==
+                                  connected_subchannel;
+                         });
+  if (it == pooled_connections_.end()) return;
+  if (GRPC_TRACE_FLAG_ENABLED(grpc_trace_subchannel)) {
+    gpr_log(GPR_INFO,
+            "subchannel %p %s: removing pooled connected subchannel %p: %s",
+            this, key_.ToString().c_str(), connected_subchannel, reason);
+  }
+  if (channelz_node_ != nullptr) {
+    channelz_node_->RemovePooledSocket(it->socket_node.get());
+    channelz_node_->AddTraceEvent(
+        channelz::ChannelTrace::Severity::Info,
+        grpc_slice_from_static_string("Pooled connection removed"));
+  }
+  // Calls already started on the connection hold their own refs to it, so
+  // they run to completion before the transport is destroyed.
+  pooled_connections_.erase(it);
+}
+
+void Subchannel::ClearPooledConnectionsLocked(const char* reason) {
+  while (!pooled_connections_.empty()) {
+    RemovePooledConnectionLocked(
+        pooled_connections_.back().connected_subchannel.get(), reason);
+  }
+  if (pool_idle_timer_handle_.has_value()) {
+    GetDefaultEventEngine()->Cancel(*pool_idle_timer_handle_);
+    pool_idle_timer_handle_.reset();
+  }
+}
+
+void Subchannel::MaybeStartPoolIdleTimerLocked() {
+  if (pool_idle_timer_handle_.has_value() || pooled_connections_.empty()) {
+    return;
+  }
+  pool_idle_timer_handle_ = GetDefaultEventEngine()->RunAfter(
+      pooled_connection_idle_timeout_,
+      [self = WeakRef(DEBUG_LOCATION, "PoolIdleTimer")]() mutable {
+        ApplicationCallbackExecCtx callback_exec_ctx;
+        ExecCtx exec_ctx;
+        self->OnPoolIdleTimer();
+        // See comment in OnConnectingFinishedLocked() for why the ref is
+        // released while the ExecCtx is still active.
+        self.reset();
+      });
+}
+
+void Subchannel::OnPoolIdleTimer() {
+  MutexLock lock(&mu_);
+  pool_idle_timer_handle_.reset();
+  if (shutdown_) return;
+  // A pooled connection is closed once it has been seen without calls on
+  // two consecutive runs of the timer.
+  const Timestamp now = ExecCtx::Get()->Now();
+  std::vector<ConnectedSubchannel*> idle;
+  for (PooledConnection& pooled : pooled_connections_) {
+    if (pooled.connected_subchannel->active_calls() > 0) {
+      pooled.idle_since = Timestamp::InfFuture();
+    } else if (pooled.idle_since == Timestamp::InfFuture()) {
+      pooled.idle_since = now;
+    } else if (now - pooled.idle_since >= pooled_connection_idle_timeout_) {
+      idle.push_back(pooled.connected_subchannel.get());
+    }
+  }
+  for (ConnectedSubchannel* connected_subchannel : idle) {
+    RemovePooledConnectionLocked(connected_subchannel, "idle");
+  }
+  MaybeStartPoolIdleTimerLocked();
+}
+
 }  // namespace grpc_core
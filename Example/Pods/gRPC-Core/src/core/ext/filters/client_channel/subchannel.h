@@ -20,10 +20,13 @@
 #include <grpc/support/port_platform.h>
 
 #include <stddef.h>
+#include <stdint.h>
 
+#include <atomic>
 #include <deque>
 #include <map>
 #include <string>
+#include <vector>
 
 #include "absl/base/thread_annotations.h"
 #include "absl/status/status.h"
@@ -67,7 +70,8 @@ class SubchannelCall;
 class ConnectedSubchannel : public RefCounted<ConnectedSubchannel> {
  public:
   ConnectedSubchannel(
-      grpc_channel_stack* channel_stack, const ChannelArgs& args,
+      grpc_channel_stack* channel_stack, grpc_transport* transport,
+      const ChannelArgs& args,
       RefCountedPtr<channelz::SubchannelNode> channelz_subchannel);
   ~ConnectedSubchannel() override;
 
@@ -84,9 +88,23 @@ class ConnectedSubchannel : public RefCounted<ConnectedSubchannel> {
 
   size_t GetInitialCallSizeEstimate() const;
 
+  // Number of subchannel calls currently using this connection.
+  size_t active_calls() const {
+    return active_calls_.load(std::memory_order_relaxed);
+  }
+
+  // The most streams the peer currently allows to be open on this connection.
+  uint32_t max_concurrent_streams() const;
+
  private:
+  // Maintains active_calls_.
+  friend class SubchannelCall;
+
   grpc_channel_stack* channel_stack_;
+  // Owned by channel_stack_.
+  grpc_transport* transport_;
   ChannelArgs args_;
+  std::atomic<size_t> active_calls_{0};
   // ref counted pointer to the channelz node in this connected subchannel's
   // owning subchannel.
   RefCountedPtr<channelz::SubchannelNode> channelz_subchannel_;
@@ -265,6 +283,14 @@ class Subchannel : public DualRefCounted<Subchannel> {
     return connected_subchannel_;
   }
 
+  // Returns the connection a new call should be started on, or null if the
+  // subchannel is not connected.  When GRPC_ARG_MAX_CONNECTIONS_PER_SUBCHANNEL
+  // allows more than one connection, this is the connection with the most
+  // free stream slots, and another connection is opened if none of them has
+  // any left.
+  RefCountedPtr<ConnectedSubchannel> GetConnectedSubchannelForCall()
+      ABSL_LOCKS_EXCLUDED(mu_);
+
   // Attempt to connect to the backend.  Has no effect if already connected.
   void RequestConnection() ABSL_LOCKS_EXCLUDED(mu_);
 
@@ -349,6 +375,16 @@ class Subchannel : public DualRefCounted<Subchannel> {
   class ConnectedSubchannelStateWatcher;
   class AsyncWatcherNotifierLocked;
 
+  // A connection opened in addition to connected_subchannel_ because the
+  // latter ran out of stream slots.
+  struct PooledConnection {
+    RefCountedPtr<ConnectedSubchannel> connected_subchannel;
+    RefCountedPtr<channelz::SocketNode> socket_node;
+    // When the idle timer last saw the connection without calls, or
+    // InfFuture() if it had calls then.
+    Timestamp idle_since;
+  };
+
   // Sets the subchannel's connectivity state to \a state.
   void SetConnectivityStateLocked(grpc_connectivity_state state,
                                   const absl::Status& status)
@@ -363,6 +399,22 @@ class Subchannel : public DualRefCounted<Subchannel> {
   void OnConnectingFinishedLocked(grpc_error_handle error)
       ABSL_EXCLUSIVE_LOCKS_REQUIRED(mu_);
   bool PublishTransportLocked() ABSL_EXCLUSIVE_LOCKS_REQUIRED(mu_);
+  RefCountedPtr<ConnectedSubchannel> CreateConnectedSubchannelLocked(
+      RefCountedPtr<channelz::SocketNode>* socket)
+      ABSL_EXCLUSIVE_LOCKS_REQUIRED(mu_);
+
+  // Methods for the connection pool.
+  void MaybeStartPooledConnectionLocked() ABSL_EXCLUSIVE_LOCKS_REQUIRED(mu_);
+  void OnPooledConnectingFinishedLocked(grpc_error_handle error)
+      ABSL_EXCLUSIVE_LOCKS_REQUIRED(mu_);
+  void RemovePooledConnectionLocked(ConnectedSubchannel* connected_subchannel,
+                                    const char* reason)
+      ABSL_EXCLUSIVE_LOCKS_REQUIRED(mu_);
+  // Drops every pooled connection, e.g. when the main one goes away.
+  void ClearPooledConnectionsLocked(const char* reason)
+      ABSL_EXCLUSIVE_LOCKS_REQUIRED(mu_);
+  void MaybeStartPoolIdleTimerLocked() ABSL_EXCLUSIVE_LOCKS_REQUIRED(mu_);
+  void OnPoolIdleTimer() ABSL_LOCKS_EXCLUDED(mu_);
 
   // The subchannel pool this subchannel is in.
   RefCountedPtr<SubchannelPoolInterface> subchannel_pool_;
@@ -379,6 +431,9 @@ class Subchannel : public DualRefCounted<Subchannel> {
   RefCountedPtr<channelz::SubchannelNode> channelz_node_;
   // Minimum connection timeout.
   Duration min_connect_timeout_;
+  // Connection pool limits.
+  const size_t max_connections_;
+  const Duration pooled_connection_idle_timeout_;
 
   // Connection state.
   OrphanablePtr<SubchannelConnector> connector_;
@@ -407,6 +462,15 @@ class Subchannel : public DualRefCounted<Subchannel> {
   // Active connection, or null.
   RefCountedPtr<ConnectedSubchannel> connected_subchannel_ ABSL_GUARDED_BY(mu_);
 
+  // Additional connections, only used while connected_subchannel_ is set.
+  std::vector<PooledConnection> pooled_connections_ ABSL_GUARDED_BY(mu_);
+  // True while connector_ is establishing a pooled connection.
+  bool connecting_pooled_ ABSL_GUARDED_BY(mu_) = false;
+  // Earliest time at which to try another pooled connection after a failure.
+  Timestamp next_pooled_attempt_time_ ABSL_GUARDED_BY(mu_);
+  absl::optional<grpc_event_engine::experimental::EventEngine::TaskHandle>
+      pool_idle_timer_handle_ ABSL_GUARDED_BY(mu_);
+
   // Backoff state.
   BackOff backoff_ ABSL_GUARDED_BY(mu_);
   Timestamp next_attempt_time_ ABSL_GUARDED_BY(mu_);
@@ -29,8 +29,10 @@
 #include "src/core/ext/filters/http/message_compress/message_decompress_filter.h"
 #include "src/core/ext/filters/http/server/http_server_filter.h"
 #include "src/core/lib/channel/channel_args.h"
+#include "src/core/lib/channel/channel_args_preconditioning.h"
 #include "src/core/lib/channel/channel_fwd.h"
 #include "src/core/lib/channel/channel_stack_builder.h"
+#include "src/core/lib/compression/compression_internal.h"
 #include "src/core/lib/config/core_configuration.h"
 #include "src/core/lib/surface/channel_init.h"
 #include "src/core/lib/surface/channel_stack_type.h"
@@ -93,5 +95,8 @@ void RegisterHttpFilters(CoreConfiguration::Builder* builder) {
   required(GRPC_CLIENT_SUBCHANNEL, &HttpClientFilter::kFilter);
   required(GRPC_CLIENT_DIRECT_CHANNEL, &HttpClientFilter::kFilter);
   required(GRPC_SERVER_CHANNEL, &HttpServerFilter::kFilter);
+  // Load the deflate dictionary once per channel rather than once per
+  // (de)compression filter instance.
+  builder->channel_args_preconditioning()->RegisterStage(LoadDeflateDictionary);
 }
 }  // namespace grpc_core
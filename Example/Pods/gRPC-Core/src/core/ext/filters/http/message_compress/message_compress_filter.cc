@@ -34,13 +34,19 @@
 #include <grpc/impl/codegen/grpc_types.h>
 #include <grpc/support/log.h>
 
+#include "src/core/lib/channel/channel_args.h"
 #include "src/core/lib/compression/compression_internal.h"
 #include "src/core/lib/compression/message_compress.h"
 #include "src/core/lib/debug/trace.h"
+#include "src/core/lib/event_engine/default_event_engine.h"
+#include "src/core/lib/gprpp/debug_location.h"
+#include "src/core/lib/gprpp/ref_counted_ptr.h"
 #include "src/core/lib/iomgr/call_combiner.h"
 #include "src/core/lib/iomgr/closure.h"
 #include "src/core/lib/iomgr/error.h"
+#include "src/core/lib/iomgr/exec_ctx.h"
 #include "src/core/lib/profiling/timers.h"
+#include "src/core/lib/slice/slice.h"
 #include "src/core/lib/slice/slice_buffer.h"
 #include "src/core/lib/surface/call.h"
 #include "src/core/lib/transport/metadata_batch.h"
@@ -48,6 +54,8 @@
 
 namespace {
 
+using ::grpc_event_engine::experimental::GetDefaultEventEngine;
+
 class ChannelData {
  public:
   explicit ChannelData(grpc_channel_element_args* args) {
@@ -71,6 +79,10 @@ class ChannelData {
               name);
       default_compression_algorithm_ = GRPC_COMPRESS_NONE;
     }
+    deflate_dictionary_ = grpc_core::ChannelArgs::FromC(args->channel_args)
+                              .GetObjectRef<grpc_core::DeflateDictionary>();
+    offload_threshold_ = grpc_core::CompressionOffloadThresholdFromChannelArgs(
+        args->channel_args);
     GPR_ASSERT(!args->is_last);
   }
 
@@ -82,17 +94,29 @@ class ChannelData {
     return enabled_compression_algorithms_;
   }
 
+  const grpc_core::DeflateDictionary* deflate_dictionary() const {
+    return deflate_dictionary_.get();
+  }
+
+  size_t offload_threshold() const { return offload_threshold_; }
+
  private:
   /** The default, channel-level, compression algorithm */
   grpc_compression_algorithm default_compression_algorithm_;
   /** Enabled compression algorithms */
   grpc_core::CompressionAlgorithmSet enabled_compression_algorithms_;
+  /** Preset dictionary for deflate; null if none is configured */
+  grpc_core::RefCountedPtr<grpc_core::DeflateDictionary> deflate_dictionary_;
+  /** Messages this large are compressed off the call path; 0 means never */
+  size_t offload_threshold_;
 };
 
 class CallData {
  public:
   CallData(grpc_call_element* elem, const grpc_call_element_args& args)
-      : call_combiner_(args.call_combiner) {
+      : call_combiner_(args.call_combiner),
+        deflate_dictionary_(static_cast<ChannelData*>(elem->channel_data)
+                                ->deflate_dictionary()) {
     ChannelData* channeld = static_cast<ChannelData*>(elem->channel_data);
     // The call's message compression algorithm is set to channel's default
     // setting. It can be overridden later by initial metadata.
@@ -102,6 +126,9 @@ class CallData {
     }
     GRPC_CLOSURE_INIT(&forward_send_message_batch_in_call_combiner_,
                       ForwardSendMessageBatch, elem, grpc_schedule_on_exec_ctx);
+    GRPC_CLOSURE_INIT(&on_recv_initial_metadata_ready_,
+                      OnRecvInitialMetadataReady, this,
+                      grpc_schedule_on_exec_ctx);
   }
 
   ~CallData() { GRPC_ERROR_UNREF(cancel_error_); }
@@ -111,10 +138,12 @@ class CallData {
 
  private:
   bool SkipMessageCompression();
+  void CompressSendMessage();
   void FinishSendMessage(grpc_call_element* elem);
 
   void ProcessSendInitialMetadata(grpc_call_element* elem,
                                   grpc_metadata_batch* initial_metadata);
+  static void OnRecvInitialMetadataReady(void* arg, grpc_error_handle error);
 
   // Methods for processing a send_message batch
   static void FailSendMessageBatchInCallCombiner(void* calld_arg,
@@ -127,6 +156,15 @@ class CallData {
   grpc_transport_stream_op_batch* send_message_batch_ = nullptr;
   bool seen_initial_metadata_ = false;
   grpc_closure forward_send_message_batch_in_call_combiner_;
+  /** Borrowed from the channel, which outlives the call */
+  const grpc_core::DeflateDictionary* deflate_dictionary_;
+  /** Set once the peer has announced the same deflate dictionary. Until
+      then messages are compressed without it, since the peer might not be
+      able to inflate them. */
+  bool peer_has_deflate_dictionary_ = false;
+  grpc_metadata_batch* recv_initial_metadata_ = nullptr;
+  grpc_closure* original_recv_initial_metadata_ready_ = nullptr;
+  grpc_closure on_recv_initial_metadata_ready_;
 };
 
 // Returns true if we should skip message compression for the current message.
@@ -165,44 +203,82 @@ void CallData::ProcessSendInitialMetadata(
                         channeld->enabled_compression_algorithms());
 }
 
+void CallData::OnRecvInitialMetadataReady(void* arg, grpc_error_handle error) {
+  CallData* calld = static_cast<CallData*>(arg);
+  if (GRPC_ERROR_IS_NONE(error)) {
+    calld->peer_has_deflate_dictionary_ =
+        calld->recv_initial_metadata_->get(
+            grpc_core::GrpcDeflateDictionaryMetadata()) ==
+        calld->deflate_dictionary_->id();
+  }
+  grpc_closure* closure = calld->original_recv_initial_metadata_ready_;
+  calld->original_recv_initial_metadata_ready_ = nullptr;
+  grpc_core::Closure::Run(DEBUG_LOCATION, closure, GRPC_ERROR_REF(error));
+}
+
+void CallData::CompressSendMessage() {
+  grpc_core::SliceBuffer tmp;
+  uint32_t& send_flags = send_message_batch_->payload->send_message.flags;
+  grpc_core::SliceBuffer* payload =
+      send_message_batch_->payload->send_message.send_message;
+  grpc_slice dictionary = peer_has_deflate_dictionary_
+                              ? deflate_dictionary_->data().c_slice()
+                              : grpc_empty_slice();
+  bool did_compress =
+      grpc_msg_compress_with_dictionary(compression_algorithm_, dictionary,
+                                        payload->c_slice_buffer(),
+                                        tmp.c_slice_buffer());
+  if (did_compress) {
+    if (GRPC_TRACE_FLAG_ENABLED(grpc_compression_trace)) {
+      const char* algo_name;
+      const size_t before_size = payload->Length();
+      const size_t after_size = tmp.Length();
+      const float savings_ratio = 1.0f - static_cast<float>(after_size) /
+                                             static_cast<float>(before_size);
+      GPR_ASSERT(grpc_compression_algorithm_name(compression_algorithm_,
+                                                 &algo_name));
+      gpr_log(GPR_INFO,
+              "Compressed[%s] %" PRIuPTR " bytes vs. %" PRIuPTR
+              " bytes (%.2f%% savings)",
+              algo_name, before_size, after_size, 100 * savings_ratio);
+    }
+    tmp.Swap(payload);
+    send_flags |= GRPC_WRITE_INTERNAL_COMPRESS;
+  } else {
+    if (GRPC_TRACE_FLAG_ENABLED(grpc_compression_trace)) {
+      const char* algo_name;
+      GPR_ASSERT(grpc_compression_algorithm_name(compression_algorithm_,
+                                                 &algo_name));
+      gpr_log(
+          GPR_INFO,
+          "Algorithm '%s' enabled but decided not to compress. Input size: "
+          "%" PRIuPTR,
+          algo_name, payload->Length());
+    }
+  }
+}
+
 void CallData::FinishSendMessage(grpc_call_element* elem) {
   // Compress the data if appropriate.
   if (!SkipMessageCompression()) {
-    grpc_core::SliceBuffer tmp;
-    uint32_t& send_flags = send_message_batch_->payload->send_message.flags;
-    grpc_core::SliceBuffer* payload =
-        send_message_batch_->payload->send_message.send_message;
-    bool did_compress =
-        grpc_msg_compress(compression_algorithm_, payload->c_slice_buffer(),
-                          tmp.c_slice_buffer());
-    if (did_compress) {
-      if (GRPC_TRACE_FLAG_ENABLED(grpc_compression_trace)) {
-        const char* algo_name;
-        const size_t before_size = payload->Length();
-        const size_t after_size = tmp.Length();
-        const float savings_ratio = 1.0f - static_cast<float>(after_size) /
-                                               static_cast<float>(before_size);
-        GPR_ASSERT(grpc_compression_algorithm_name(compression_algorithm_,
-                                                   &algo_name));
-        gpr_log(GPR_INFO,
-                "Compressed[%s] %" PRIuPTR " bytes vs. %" PRIuPTR
-                " bytes (%.2f%% savings)",
-                algo_name, before_size, after_size, 100 * savings_ratio);
-      }
-      tmp.Swap(payload);
-      send_flags |= GRPC_WRITE_INTERNAL_COMPRESS;
-    } else {
-      if (GRPC_TRACE_FLAG_ENABLED(grpc_compression_trace)) {
-        const char* algo_name;
-        GPR_ASSERT(grpc_compression_algorithm_name(compression_algorithm_,
-                                                   &algo_name));
-        gpr_log(
-            GPR_INFO,
-            "Algorithm '%s' enabled but decided not to compress. Input size: "
-            "%" PRIuPTR,
-            algo_name, payload->Length());
-      }
+    ChannelData* channeld = static_cast<ChannelData*>(elem->channel_data);
+    const size_t offload_threshold = channeld->offload_threshold();
+    if (offload_threshold > 0 &&
+        send_message_batch_->payload->send_message.send_message->Length() >=
+            offload_threshold) {
+      // Large messages are compressed on the EventEngine thread pool so
+      // that they do not stall whatever else is running on this thread.
+      // We keep holding the call combiner until the batch is passed down,
+      // so nothing else on this call can overtake the message.
+      GetDefaultEventEngine()->Run([this, elem]() {
+        grpc_core::ApplicationCallbackExecCtx callback_exec_ctx;
+        grpc_core::ExecCtx exec_ctx;
+        CompressSendMessage();
+        grpc_call_next_op(elem, absl::exchange(send_message_batch_, nullptr));
+      });
+      return;
     }
+    CompressSendMessage();
   }
   grpc_call_next_op(elem, absl::exchange(send_message_batch_, nullptr));
 }
@@ -246,6 +322,16 @@ void CallData::CompressStartTransportStreamOpBatch(
         batch, GRPC_ERROR_REF(cancel_error_), call_combiner_);
     return;
   }
+  // Handle recv_initial_metadata, to learn whether the peer has our
+  // deflate dictionary.
+  if (batch->recv_initial_metadata && deflate_dictionary_ != nullptr) {
+    recv_initial_metadata_ =
+        batch->payload->recv_initial_metadata.recv_initial_metadata;
+    original_recv_initial_metadata_ready_ =
+        batch->payload->recv_initial_metadata.recv_initial_metadata_ready;
+    batch->payload->recv_initial_metadata.recv_initial_metadata_ready =
+        &on_recv_initial_metadata_ready_;
+  }
   // Handle send_initial_metadata.
   if (batch->send_initial_metadata) {
     GPR_ASSERT(!seen_initial_metadata_);
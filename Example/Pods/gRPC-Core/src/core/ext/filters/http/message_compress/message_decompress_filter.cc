@@ -35,12 +35,17 @@
 
 #include "src/core/ext/filters/message_size/message_size_filter.h"
 #include "src/core/lib/channel/channel_args.h"
+#include "src/core/lib/compression/compression_internal.h"
 #include "src/core/lib/compression/message_compress.h"
+#include "src/core/lib/event_engine/default_event_engine.h"
 #include "src/core/lib/gprpp/debug_location.h"
+#include "src/core/lib/gprpp/ref_counted_ptr.h"
 #include "src/core/lib/iomgr/call_combiner.h"
 #include "src/core/lib/iomgr/closure.h"
 #include "src/core/lib/iomgr/error.h"
+#include "src/core/lib/iomgr/exec_ctx.h"
 #include "src/core/lib/profiling/timers.h"
+#include "src/core/lib/slice/slice.h"
 #include "src/core/lib/slice/slice_buffer.h"
 #include "src/core/lib/transport/metadata_batch.h"
 #include "src/core/lib/transport/transport.h"
@@ -48,29 +53,45 @@
 namespace grpc_core {
 namespace {
 
+using ::grpc_event_engine::experimental::GetDefaultEventEngine;
+
 class ChannelData {
  public:
   explicit ChannelData(const grpc_channel_element_args* args)
       : max_recv_size_(GetMaxRecvSizeFromChannelArgs(
             ChannelArgs::FromC(args->channel_args))),
         message_size_service_config_parser_index_(
-            MessageSizeParser::ParserIndex()) {}
+            MessageSizeParser::ParserIndex()),
+        deflate_dictionary_(ChannelArgs::FromC(args->channel_args)
+                                .GetObjectRef<DeflateDictionary>()),
+        offload_threshold_(
+            CompressionOffloadThresholdFromChannelArgs(args->channel_args)) {}
 
   int max_recv_size() const { return max_recv_size_; }
   size_t message_size_service_config_parser_index() const {
     return message_size_service_config_parser_index_;
   }
+  const DeflateDictionary* deflate_dictionary() const {
+    return deflate_dictionary_.get();
+  }
+  size_t offload_threshold() const { return offload_threshold_; }
 
  private:
   int max_recv_size_;
   const size_t message_size_service_config_parser_index_;
+  // Preset dictionary for deflate; null if none is configured.
+  const RefCountedPtr<DeflateDictionary> deflate_dictionary_;
+  // Messages this large are decompressed off the call path; 0 means never.
+  const size_t offload_threshold_;
 };
 
 class CallData {
  public:
   CallData(const grpc_call_element_args& args, const ChannelData* chand)
       : call_combiner_(args.call_combiner),
-        max_recv_message_length_(chand->max_recv_size()) {
+        max_recv_message_length_(chand->max_recv_size()),
+        deflate_dictionary_(chand->deflate_dictionary()),
+        offload_threshold_(chand->offload_threshold()) {
     // Initialize state for recv_initial_metadata_ready callback
     GRPC_CLOSURE_INIT(&on_recv_initial_metadata_ready_,
                       OnRecvInitialMetadataReady, this,
@@ -101,6 +122,7 @@ class CallData {
   // Methods for processing a receive message event
   void MaybeResumeOnRecvMessageReady();
   static void OnRecvMessageReady(void* arg, grpc_error_handle error);
+  void DecompressRecvMessage();
   void ContinueRecvMessageReadyCallback(grpc_error_handle error);
 
   // Methods for processing a recv_trailing_metadata event
@@ -117,6 +139,12 @@ class CallData {
   // Fields for handling recv_message_ready callback
   bool seen_recv_message_ready_ = false;
   int max_recv_message_length_;
+  // Borrowed from the channel, which outlives the call.
+  const DeflateDictionary* deflate_dictionary_;
+  // Whether the peer announced the same deflate dictionary, and so may
+  // prime the messages it sends with it.
+  bool peer_has_deflate_dictionary_ = false;
+  size_t offload_threshold_;
   grpc_compression_algorithm algorithm_ = GRPC_COMPRESS_NONE;
   absl::optional<SliceBuffer>* recv_message_ = nullptr;
   uint32_t* recv_message_flags_ = nullptr;
@@ -135,6 +163,10 @@ void CallData::OnRecvInitialMetadataReady(void* arg, grpc_error_handle error) {
     calld->algorithm_ =
         calld->recv_initial_metadata_->get(GrpcEncodingMetadata())
             .value_or(GRPC_COMPRESS_NONE);
+    calld->peer_has_deflate_dictionary_ =
+        calld->deflate_dictionary_ != nullptr &&
+        calld->recv_initial_metadata_->get(GrpcDeflateDictionaryMetadata()) ==
+            calld->deflate_dictionary_->id();
   }
   calld->MaybeResumeOnRecvMessageReady();
   calld->MaybeResumeOnRecvTrailingMetadataReady();
@@ -183,28 +215,49 @@ void CallData::OnRecvMessageReady(void* arg, grpc_error_handle error) {
         return calld->ContinueRecvMessageReadyCallback(
             GRPC_ERROR_REF(calld->error_));
       }
-      SliceBuffer decompressed_slices;
-      if (grpc_msg_decompress(calld->algorithm_,
-                              (*calld->recv_message_)->c_slice_buffer(),
-                              decompressed_slices.c_slice_buffer()) == 0) {
-        GPR_DEBUG_ASSERT(GRPC_ERROR_IS_NONE(calld->error_));
-        calld->error_ = GRPC_ERROR_CREATE_FROM_CPP_STRING(absl::StrCat(
-            "Unexpected error decompressing data for algorithm with "
-            "enum value ",
-            calld->algorithm_));
-      } else {
-        *calld->recv_message_flags_ =
-            (*calld->recv_message_flags_ & (~GRPC_WRITE_INTERNAL_COMPRESS)) |
-            GRPC_WRITE_INTERNAL_TEST_ONLY_WAS_COMPRESSED;
-        (*calld->recv_message_)->Swap(&decompressed_slices);
+      if (calld->offload_threshold_ > 0 &&
+          (*calld->recv_message_)->Length() >= calld->offload_threshold_) {
+        // Inflating a large message can take long enough to hold up the
+        // other streams whose reads are processed on this thread, so do it
+        // on the EventEngine thread pool.  We still hold the call combiner,
+        // which keeps this call's later callbacks queued behind it.
+        GetDefaultEventEngine()->Run([calld]() {
+          ApplicationCallbackExecCtx callback_exec_ctx;
+          ExecCtx exec_ctx;
+          calld->DecompressRecvMessage();
+        });
+        return;
       }
-      return calld->ContinueRecvMessageReadyCallback(
-          GRPC_ERROR_REF(calld->error_));
+      return calld->DecompressRecvMessage();
     }
   }
   calld->ContinueRecvMessageReadyCallback(GRPC_ERROR_REF(error));
 }
 
+void CallData::DecompressRecvMessage() {
+  SliceBuffer decompressed_slices;
+  // Without a matching announcement a primed message fails to inflate,
+  // just as it would at a peer that has no dictionary.
+  grpc_slice dictionary = peer_has_deflate_dictionary_
+                              ? deflate_dictionary_->data().c_slice()
+                              : grpc_empty_slice();
+  if (grpc_msg_decompress_with_dictionary(
+          algorithm_, dictionary, (*recv_message_)->c_slice_buffer(),
+          decompressed_slices.c_slice_buffer()) == 0) {
+    GPR_DEBUG_ASSERT(GRPC_ERROR_IS_NONE(error_));
+    error_ = GRPC_ERROR_CREATE_FROM_CPP_STRING(absl::StrCat(
+        "Unexpected error decompressing data for algorithm with "
+        "enum value ",
+        algorithm_));
+  } else {
+    *recv_message_flags_ =
+        (*recv_message_flags_ & (~GRPC_WRITE_INTERNAL_COMPRESS)) |
+        GRPC_WRITE_INTERNAL_TEST_ONLY_WAS_COMPRESSED;
+    (*recv_message_)->Swap(&decompressed_slices);
+  }
+  ContinueRecvMessageReadyCallback(GRPC_ERROR_REF(error_));
+}
+
 void CallData::ContinueRecvMessageReadyCallback(grpc_error_handle error) {
   MaybeResumeOnRecvTrailingMetadataReady();
   // The surface will clean up the receiving stream if there is an error.
@@ -244,6 +297,12 @@ void CallData::OnRecvTrailingMetadataReady(void* arg, grpc_error_handle error) {
 
 void CallData::DecompressStartTransportStreamOpBatch(
     grpc_call_element* elem, grpc_transport_stream_op_batch* batch) {
+  // Announce our deflate dictionary, so that the peer knows it may prime
+  // the messages it sends with it.
+  if (batch->send_initial_metadata && deflate_dictionary_ != nullptr) {
+    batch->payload->send_initial_metadata.send_initial_metadata->Set(
+        GrpcDeflateDictionaryMetadata(), deflate_dictionary_->id());
+  }
   // Handle recv_initial_metadata.
   if (batch->recv_initial_metadata) {
     recv_initial_metadata_ =
@@ -26,6 +26,7 @@
 #include <grpc/support/log.h>
 
 #include "src/core/ext/transport/chttp2/transport/huffsyms.h"
+#include "src/core/lib/slice/b64.h"
 
 static const char alphabet[] =
     "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
@@ -49,6 +50,51 @@ static const b64_huff_sym huff_alphabet[64] = {
 
 static const uint8_t tail_xtra[3] = {0, 2, 3};
 
+/* Huffman output goes through a 64 bit accumulator that is flushed 32 bits at
+   a time; no code is longer than 30 bits, so it never overflows. */
+struct huff_out {
+  uint64_t temp;
+  uint32_t temp_length;
+  uint8_t* out;
+};
+
+static void enc_flush_some(huff_out* out) {
+  if (out->temp_length >= 32) {
+    out->temp_length -= 32;
+    uint32_t word = static_cast<uint32_t>(out->temp >> out->temp_length);
+    out->out[0] = static_cast<uint8_t>(word >> 24);
+    out->out[1] = static_cast<uint8_t>(word >> 16);
+    out->out[2] = static_cast<uint8_t>(word >> 8);
+    out->out[3] = static_cast<uint8_t>(word);
+    out->out += 4;
+  }
+}
+
+static void enc_add_bits(huff_out* out, uint32_t bits, uint32_t length) {
+  out->temp = (out->temp << length) | bits;
+  out->temp_length += length;
+  enc_flush_some(out);
+}
+
+/* Flush everything, padding the last byte with the most significant bits of
+   EOS (all ones). */
+static void enc_finish(huff_out* out) {
+  while (out->temp_length >= 8) {
+    out->temp_length -= 8;
+    *out->out++ = static_cast<uint8_t>(out->temp >> out->temp_length);
+  }
+  if (out->temp_length) {
+    /* NB: the following integer arithmetic operation needs to be in its
+     * expanded form due to the "integral promotion" performed (see section
+     * 3.2.1.1 of the C89 draft standard). A cast to the smaller container type
+     * is then required to avoid the compiler warning */
+    *out->out++ = static_cast<uint8_t>(
+        static_cast<uint8_t>(out->temp << (8u - out->temp_length)) |
+        static_cast<uint8_t>(0xffu >> out->temp_length));
+    out->temp_length = 0;
+  }
+}
+
 grpc_slice grpc_chttp2_base64_encode(const grpc_slice& input) {
   size_t input_length = GRPC_SLICE_LENGTH(input);
   size_t input_triplets = input_length / 3;
@@ -59,8 +105,11 @@ grpc_slice grpc_chttp2_base64_encode(const grpc_slice& input) {
   char* out = reinterpret_cast<char*> GRPC_SLICE_START_PTR(output);
   size_t i;
 
-  /* encode full triplets */
-  for (i = 0; i < input_triplets; i++) {
+  /* encode full triplets, in bulk first */
+  i = grpc_base64_encode_bulk(out, in, 3 * input_triplets, /*url_safe=*/0) / 3;
+  out += 4 * i;
+  in += 3 * i;
+  for (; i < input_triplets; i++) {
     out[0] = alphabet[in[0] >> 2];
     out[1] = alphabet[((in[0] & 0x3) << 4) | (in[1] >> 4)];
     out[2] = alphabet[((in[1] & 0xf) << 2) | (in[2] >> 6)];
@@ -96,10 +145,8 @@ grpc_slice grpc_chttp2_base64_encode(const grpc_slice& input) {
 grpc_slice grpc_chttp2_huffman_compress(const grpc_slice& input) {
   size_t nbits;
   const uint8_t* in;
-  uint8_t* out;
   grpc_slice output;
-  uint32_t temp = 0;
-  uint32_t temp_length = 0;
+  huff_out out;
 
   nbits = 0;
   for (in = GRPC_SLICE_START_PTR(input); in != GRPC_SLICE_END_PTR(input);
@@ -108,62 +155,53 @@ grpc_slice grpc_chttp2_huffman_compress(const grpc_slice& input) {
   }
 
   output = GRPC_SLICE_MALLOC(nbits / 8 + (nbits % 8 != 0));
-  out = GRPC_SLICE_START_PTR(output);
+  out.temp = 0;
+  out.temp_length = 0;
+  out.out = GRPC_SLICE_START_PTR(output);
   for (in = GRPC_SLICE_START_PTR(input); in != GRPC_SLICE_END_PTR(input);
        ++in) {
-    int sym = *in;
-    temp <<= grpc_chttp2_huffsyms[sym].length;
-    temp |= grpc_chttp2_huffsyms[sym].bits;
-    temp_length += grpc_chttp2_huffsyms[sym].length;
-
-    while (temp_length > 8) {
-      temp_length -= 8;
-      *out++ = static_cast<uint8_t>(temp >> temp_length);
-    }
+    const grpc_chttp2_huffsym& sym = grpc_chttp2_huffsyms[*in];
+    enc_add_bits(&out, sym.bits, sym.length);
   }
+  enc_finish(&out);
 
-  if (temp_length) {
-    /* NB: the following integer arithmetic operation needs to be in its
-     * expanded form due to the "integral promotion" performed (see section
-     * 3.2.1.1 of the C89 draft standard). A cast to the smaller container type
-     * is then required to avoid the compiler warning */
-    *out++ =
-        static_cast<uint8_t>(static_cast<uint8_t>(temp << (8u - temp_length)) |
-                             static_cast<uint8_t>(0xffu >> temp_length));
-  }
-
-  GPR_ASSERT(out == GRPC_SLICE_END_PTR(output));
+  GPR_ASSERT(out.out == GRPC_SLICE_END_PTR(output));
 
   return output;
 }
 
-struct huff_out {
-  uint32_t temp;
-  uint32_t temp_length;
-  uint8_t* out;
-};
-static void enc_flush_some(huff_out* out) {
-  while (out->temp_length > 8) {
-    out->temp_length -= 8;
-    *out->out++ = static_cast<uint8_t>(out->temp >> out->temp_length);
-  }
-}
-
 static void enc_add2(huff_out* out, uint8_t a, uint8_t b) {
   b64_huff_sym sa = huff_alphabet[a];
   b64_huff_sym sb = huff_alphabet[b];
-  out->temp = (out->temp << (sa.length + sb.length)) |
-              (static_cast<uint32_t>(sa.bits) << sb.length) | sb.bits;
-  out->temp_length +=
-      static_cast<uint32_t>(sa.length) + static_cast<uint32_t>(sb.length);
-  enc_flush_some(out);
+  enc_add_bits(out, (static_cast<uint32_t>(sa.bits) << sb.length) | sb.bits,
+               static_cast<uint32_t>(sa.length) +
+                   static_cast<uint32_t>(sb.length));
 }
 
 static void enc_add1(huff_out* out, uint8_t a) {
   b64_huff_sym sa = huff_alphabet[a];
-  out->temp = (out->temp << sa.length) | sa.bits;
-  out->temp_length += sa.length;
-  enc_flush_some(out);
+  enc_add_bits(out, sa.bits, sa.length);
+}
+
+/* Huffman codes for every pair of base64 symbols, indexed by the 12 input bits
+   they encode and packed as (length << 24) | bits, so that full triplets cost
+   two lookups and no per-symbol shuffling. */
+static const uint32_t* huff_pairs() {
+  static const uint32_t* pairs = [] {
+    uint32_t* table = new uint32_t[4096];
+    for (uint32_t i = 0; i < 4096; i++) {
+      const b64_huff_sym sa = huff_alphabet[i >> 6];
+      const b64_huff_sym sb = huff_alphabet[i & 0x3f];
+      table[i] = ((static_cast<uint32_t>(sa.length) + sb.length) << 24) |
+                 (static_cast<uint32_t>(sa.bits) << sb.length) | sb.bits;
+    }
+    return table;
+  }();
+  return pairs;
+}
+
+static void enc_add_pair(huff_out* out, uint32_t pair) {
+  enc_add_bits(out, pair & 0xffffff, pair >> 24);
 }
 
 grpc_slice grpc_chttp2_base64_encode_and_huffman_compress(
@@ -185,14 +223,12 @@ grpc_slice grpc_chttp2_base64_encode_and_huffman_compress(
   out.out = start_out;
 
   /* encode full triplets */
+  const uint32_t* pairs = huff_pairs();
   for (i = 0; i < input_triplets; i++) {
-    const uint8_t low_to_high = static_cast<uint8_t>((in[0] & 0x3) << 4);
-    const uint8_t high_to_low = in[1] >> 4;
-    enc_add2(&out, in[0] >> 2, low_to_high | high_to_low);
-
-    const uint8_t a = static_cast<uint8_t>((in[1] & 0xf) << 2);
-    const uint8_t b = (in[2] >> 6);
-    enc_add2(&out, a | b, in[2] & 0x3f);
+    const uint32_t triplet = (static_cast<uint32_t>(in[0]) << 16) |
+                             (static_cast<uint32_t>(in[1]) << 8) | in[2];
+    enc_add_pair(&out, pairs[triplet >> 12]);
+    enc_add_pair(&out, pairs[triplet & 0xfff]);
     in += 3;
   }
 
@@ -214,15 +250,7 @@ grpc_slice grpc_chttp2_base64_encode_and_huffman_compress(
     }
   }
 
-  if (out.temp_length) {
-    /* NB: the following integer arithmetic operation needs to be in its
-     * expanded form due to the "integral promotion" performed (see section
-     * 3.2.1.1 of the C89 draft standard). A cast to the smaller container type
-     * is then required to avoid the compiler warning */
-    *out.out++ = static_cast<uint8_t>(
-        static_cast<uint8_t>(out.temp << (8u - out.temp_length)) |
-        static_cast<uint8_t>(0xffu >> out.temp_length));
-  }
+  enc_finish(&out);
 
   GPR_ASSERT(out.out <= GRPC_SLICE_END_PTR(output));
   GRPC_SLICE_SET_LENGTH(output, out.out - start_out);
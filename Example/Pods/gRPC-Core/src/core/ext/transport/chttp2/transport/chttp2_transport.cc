@@ -25,16 +25,20 @@
 #include <string.h>
 
 #include <algorithm>
+#include <atomic>
 #include <memory>
 #include <new>
 #include <string>
 #include <utility>
+#include <vector>
 
 #include "absl/base/attributes.h"
 #include "absl/status/status.h"
+#include "absl/strings/ascii.h"
 #include "absl/strings/cord.h"
 #include "absl/strings/str_cat.h"
 #include "absl/strings/str_format.h"
+#include "absl/strings/str_split.h"
 #include "absl/strings/string_view.h"
 #include "absl/types/optional.h"
 #include "absl/types/variant.h"
@@ -146,6 +150,9 @@ static void write_action_begin_locked(void* t, grpc_error_handle error);
 static void write_action(void* t, grpc_error_handle error);
 static void write_action_end(void* t, grpc_error_handle error);
 static void write_action_end_locked(void* t, grpc_error_handle error);
+static void write_coalesce_timer_expired(void* t, grpc_error_handle error);
+static void write_coalesce_timer_expired_locked(void* t,
+                                                grpc_error_handle error);
 
 static void read_action(void* t, grpc_error_handle error);
 static void read_action_locked(void* t, grpc_error_handle error);
@@ -305,6 +312,19 @@ static void read_channel_args(grpc_chttp2_transport* t,
   if (max_hpack_table_size >= 0) {
     t->hpack_compressor.SetMaxUsableSize(max_hpack_table_size);
   }
+  auto hpack_keys = [&](const char* arg) {
+    std::vector<std::string> keys;
+    for (absl::string_view key :
+         absl::StrSplit(channel_args.GetString(arg).value_or(""), ',',
+                        absl::SkipWhitespace())) {
+      keys.emplace_back(absl::StripAsciiWhitespace(key));
+    }
+    return keys;
+  };
+  t->hpack_compressor.SetNeverIndexKeys(
+      hpack_keys(GRPC_ARG_HTTP2_HPACK_NEVER_INDEX_KEYS));
+  t->hpack_compressor.SetPinnedKeys(
+      hpack_keys(GRPC_ARG_HTTP2_HPACK_PINNED_KEYS));
 
   t->ping_policy.max_pings_without_data =
       std::max(0, channel_args.GetInt(GRPC_ARG_HTTP2_MAX_PINGS_WITHOUT_DATA)
@@ -322,6 +342,15 @@ static void read_channel_args(grpc_chttp2_transport* t,
   t->write_buffer_size =
       std::max(0, channel_args.GetInt(GRPC_ARG_HTTP2_WRITE_BUFFER_SIZE)
                       .value_or(grpc_core::chttp2::kDefaultWindow));
+  t->write_coalesce_max_delay = std::max(
+      grpc_core::Duration::Zero(),
+      channel_args
+          .GetDurationFromIntMillis(
+              GRPC_ARG_HTTP2_WRITE_COALESCING_MAX_DELAY_MS)
+          .value_or(grpc_core::Duration::Zero()));
+  t->write_coalesce_max_bytes =
+      std::max(0, channel_args.GetInt(GRPC_ARG_HTTP2_WRITE_COALESCING_MAX_BYTES)
+                      .value_or(64 * 1024));
   t->keepalive_time =
       std::max(grpc_core::Duration::Milliseconds(1),
                channel_args.GetDurationFromIntMillis(GRPC_ARG_KEEPALIVE_TIME_MS)
@@ -583,6 +612,12 @@ static void close_transport_locked(grpc_chttp2_transport* t,
       }
       t->close_transport_on_writes_finished =
           grpc_error_add_child(t->close_transport_on_writes_finished, error);
+      if (t->write_coalesce_timer_pending) {
+        // Don't hold the close back for a write that is only waiting for
+        // company.
+        t->write_coalesce_timer_pending = false;
+        grpc_timer_cancel(&t->write_coalesce_timer);
+      }
       return;
     }
     GPR_ASSERT(!GRPC_ERROR_IS_NONE(error));
@@ -866,6 +901,37 @@ static void inc_initiate_write_reason(
   }
 }
 
+// Cancelling the coalescing timer runs its callback, which begins the write.
+static void maybe_flush_coalesced_write(
+    grpc_chttp2_transport* t, grpc_chttp2_initiate_write_reason reason) {
+  if (t->write_coalesce_timer_pending &&
+      grpc_chttp2_should_flush_coalesced_write(t, reason)) {
+    GRPC_STATS_INC_HTTP2_COALESCED_WRITES_FLUSHED_EARLY();
+    t->write_coalesce_timer_pending = false;
+    grpc_timer_cancel(&t->write_coalesce_timer);
+  }
+}
+
+static void write_coalesce_timer_expired(void* tp, grpc_error_handle error) {
+  grpc_chttp2_transport* t = static_cast<grpc_chttp2_transport*>(tp);
+  t->combiner->Run(
+      GRPC_CLOSURE_INIT(&t->write_coalesce_timer_expired_locked,
+                        write_coalesce_timer_expired_locked, t, nullptr),
+      GRPC_ERROR_REF(error));
+}
+
+static void write_coalesce_timer_expired_locked(
+    void* tp, grpc_error_handle /*error*/) {
+  grpc_chttp2_transport* t = static_cast<grpc_chttp2_transport*>(tp);
+  // Fired or cancelled, the held-back write goes out now. It already owns
+  // the "writing" ref taken when it was started.
+  t->write_coalesce_timer_pending = false;
+  t->combiner->FinallyRun(
+      GRPC_CLOSURE_INIT(&t->write_action_begin_locked,
+                        write_action_begin_locked, t, nullptr),
+      GRPC_ERROR_NONE);
+}
+
 void grpc_chttp2_initiate_write(grpc_chttp2_transport* t,
                                 grpc_chttp2_initiate_write_reason reason) {
   GPR_TIMER_SCOPE("grpc_chttp2_initiate_write", 0);
@@ -876,6 +942,23 @@ void grpc_chttp2_initiate_write(grpc_chttp2_transport* t,
       set_write_state(t, GRPC_CHTTP2_WRITE_STATE_WRITING,
                       grpc_chttp2_initiate_write_reason_string(reason));
       GRPC_CHTTP2_REF_TRANSPORT(t, "writing");
+      if (grpc_chttp2_should_coalesce_write(t, reason)) {
+        // Small writes are arriving faster than the coalescing delay: rather
+        // than sending this one on its own, give other calls until the timer
+        // fires (or until enough bytes are queued) to add their frames.
+        GRPC_STATS_INC_HTTP2_WRITES_COALESCED();
+        t->write_coalesce_timer_pending = true;
+        t->write_coalesced = true;
+        t->write_coalesce_start_messages = t->num_messages_in_next_write;
+        GRPC_CLOSURE_INIT(&t->write_coalesce_timer_expired_locked,
+                          write_coalesce_timer_expired, t,
+                          grpc_schedule_on_exec_ctx);
+        grpc_timer_init(
+            &t->write_coalesce_timer,
+            grpc_core::ExecCtx::Get()->Now() + t->write_coalesce_max_delay,
+            &t->write_coalesce_timer_expired_locked);
+        break;
+      }
       // Note that the 'write_action_begin_locked' closure is being scheduled
       // on the 'finally_scheduler' of t->combiner. This means that
       // 'write_action_begin_locked' is called only *after* all the other
@@ -900,8 +983,10 @@ void grpc_chttp2_initiate_write(grpc_chttp2_transport* t,
     case GRPC_CHTTP2_WRITE_STATE_WRITING:
       set_write_state(t, GRPC_CHTTP2_WRITE_STATE_WRITING_WITH_MORE,
                       grpc_chttp2_initiate_write_reason_string(reason));
+      maybe_flush_coalesced_write(t, reason);
       break;
     case GRPC_CHTTP2_WRITE_STATE_WRITING_WITH_MORE:
+      maybe_flush_coalesced_write(t, reason);
       break;
   }
 }
@@ -1396,6 +1481,8 @@ static void perform_stream_op_locked(void* stream_op,
   if (op->send_message) {
     GRPC_STATS_INC_HTTP2_OP_SEND_MESSAGE();
     t->num_messages_in_next_write++;
+    t->write_coalesce_pending_bytes +=
+        op->payload->send_message.send_message->Length();
     GRPC_STATS_INC_HTTP2_SEND_MESSAGE_SIZE(
         op->payload->send_message.send_message->Length());
     on_complete->next_data.scratch |= CLOSURE_BARRIER_MAY_COVER_WRITE;
@@ -3062,6 +3149,11 @@ static grpc_endpoint* chttp2_get_endpoint(grpc_transport* t) {
   return (reinterpret_cast<grpc_chttp2_transport*>(t))->ep;
 }
 
+static uint32_t chttp2_max_concurrent_streams(grpc_transport* t) {
+  return reinterpret_cast<grpc_chttp2_transport*>(t)
+      ->peer_max_concurrent_streams.load(std::memory_order_relaxed);
+}
+
 static const grpc_transport_vtable vtable = {sizeof(grpc_chttp2_stream),
                                              "chttp2",
                                              init_stream,
@@ -3072,7 +3164,8 @@ static const grpc_transport_vtable vtable = {sizeof(grpc_chttp2_stream),
                                              perform_transport_op,
                                              destroy_stream,
                                              destroy_transport,
-                                             chttp2_get_endpoint};
+                                             chttp2_get_endpoint,
+                                             chttp2_max_concurrent_streams};
 
 static const grpc_transport_vtable* get_vtable(void) { return &vtable; }
 
@@ -22,6 +22,7 @@
 
 #include <string.h>
 
+#include <atomic>
 #include <string>
 
 #include "absl/base/attributes.h"
@@ -140,6 +141,10 @@ grpc_error_handle grpc_chttp2_settings_parser_parse(void* p,
           if (is_last) {
             memcpy(parser->target_settings, parser->incoming_settings,
                    GRPC_CHTTP2_NUM_SETTINGS * sizeof(uint32_t));
+            t->peer_max_concurrent_streams.store(
+                parser->target_settings
+                    [GRPC_CHTTP2_SETTINGS_MAX_CONCURRENT_STREAMS],
+                std::memory_order_relaxed);
             t->num_pending_induced_frames++;
             grpc_slice_buffer_add(&t->qbuf, grpc_chttp2_settings_ack_create());
             grpc_chttp2_initiate_write(t,
@@ -24,6 +24,7 @@
 #include <cstdint>
 #include <memory>
 
+#include "absl/hash/hash.h"
 #include "absl/utility/utility.h"
 
 #include <grpc/slice.h>
@@ -327,6 +328,30 @@ void HPackCompressor::Framer::EmitLitHdrWithNonBinaryStringKeyNotIdx(
   Add(emit.data());
 }
 
+void HPackCompressor::Framer::EmitLitHdrWithBinaryStringKeyNvrIdx(
+    Slice key_slice, Slice value_slice) {
+  GRPC_STATS_INC_HPACK_SEND_LITHDR_NVRIDX_V();
+  GRPC_STATS_INC_HPACK_SEND_UNCOMPRESSED();
+  StringKey key(std::move(key_slice));
+  key.WritePrefix(0x10, AddTiny(key.prefix_length()));
+  Add(key.key());
+  BinaryStringValue emit(std::move(value_slice), use_true_binary_metadata_);
+  emit.WritePrefix(AddTiny(emit.prefix_length()));
+  Add(emit.data());
+}
+
+void HPackCompressor::Framer::EmitLitHdrWithNonBinaryStringKeyNvrIdx(
+    Slice key_slice, Slice value_slice) {
+  GRPC_STATS_INC_HPACK_SEND_LITHDR_NVRIDX_V();
+  GRPC_STATS_INC_HPACK_SEND_UNCOMPRESSED();
+  StringKey key(std::move(key_slice));
+  key.WritePrefix(0x10, AddTiny(key.prefix_length()));
+  Add(key.key());
+  NonBinaryStringValue emit(std::move(value_slice));
+  emit.WritePrefix(AddTiny(emit.prefix_length()));
+  Add(emit.data());
+}
+
 void HPackCompressor::Framer::AdvertiseTableSizeChange() {
   VarintWriter<3> w(compressor_->table_.max_size());
   w.Write(0x20, AddTiny(w.length()));
@@ -378,12 +403,99 @@ void HPackCompressor::SliceIndex::EmitTo(absl::string_view key,
   values_.emplace_back(value.Ref(), index);
 }
 
-void HPackCompressor::Framer::Encode(const Slice& key, const Slice& value) {
-  if (absl::EndsWith(key.as_string_view(), "-bin")) {
-    EmitLitHdrWithBinaryStringKeyNotIdx(key.Ref(), value.Ref());
+bool HPackCompressor::CustomMetadataIndex::HasKey(
+    const std::vector<std::string>& keys, absl::string_view key) {
+  return std::find(keys.begin(), keys.end(), key) != keys.end();
+}
+
+bool HPackCompressor::CustomMetadataIndex::SeenRecently(
+    absl::string_view key, absl::string_view value) {
+  const size_t hash = absl::HashOf(key, value);
+  // Zero marks an empty slot.
+  const uint32_t tag = static_cast<uint32_t>(hash) | 1;
+  uint32_t& slot = recent_values_[(hash >> 16) % kNumRecentValues];
+  if (slot == tag) return true;
+  slot = tag;
+  return false;
+}
+
+void HPackCompressor::CustomMetadataIndex::RemoveEvictedValues(
+    const HPackEncoderTable& table) {
+  // Values that are used keep bubbling up, so the ones that have been evicted
+  // from the table end up at the end of the array: remove them.
+  while (!values_.empty() &&
+         !table.ConvertableToDynamicIndex(values_.back().index)) {
+    values_.pop_back();
+  }
+}
+
+void HPackCompressor::CustomMetadataIndex::EmitTo(const Slice& key,
+                                                  const Slice& value,
+                                                  Framer* framer) {
+  const absl::string_view key_view = key.as_string_view();
+  const bool is_binary = absl::EndsWith(key_view, "-bin");
+  if (HasKey(never_index_keys_, key_view)) {
+    if (is_binary) {
+      framer->EmitLitHdrWithBinaryStringKeyNvrIdx(key.Ref(), value.Ref());
+    } else {
+      framer->EmitLitHdrWithNonBinaryStringKeyNvrIdx(key.Ref(), value.Ref());
+    }
+    return;
+  }
+  auto& table = framer->compressor_->table_;
+  using It = std::vector<ValueIndex>::iterator;
+  It prev = values_.end();
+  It found = values_.end();
+  for (It it = values_.begin(); it != values_.end(); ++it) {
+    if (key == it->key && value == it->value) {
+      found = it;
+      break;
+    }
+    prev = it;
+  }
+  if (found != values_.end() && table.ConvertableToDynamicIndex(found->index)) {
+    framer->EmitIndexed(table.DynamicIndex(found->index));
+    // Bubble this entry up so the most used values are found first.
+    if (prev != values_.end()) std::swap(*prev, *found);
+    RemoveEvictedValues(table);
+    return;
+  }
+  // Not in the table (any more): decide whether to add it.
+  const size_t transport_length =
+      hpack_constants::SizeForEntry(key.size(), value.size());
+  bool admit;
+  if (HasKey(pinned_keys_, key_view)) {
+    admit = transport_length <= table.max_size();
   } else {
-    EmitLitHdrWithNonBinaryStringKeyNotIdx(key.Ref(), value.Ref());
+    admit = SeenRecently(key_view, value.as_string_view()) &&
+            transport_length <= table.max_size() / kMaxTableFractionPerValue;
   }
+  admit = admit && transport_length <= HPackEncoderTable::MaxEntrySize();
+  if (!admit) {
+    if (is_binary) {
+      framer->EmitLitHdrWithBinaryStringKeyNotIdx(key.Ref(), value.Ref());
+    } else {
+      framer->EmitLitHdrWithNonBinaryStringKeyNotIdx(key.Ref(), value.Ref());
+    }
+    RemoveEvictedValues(table);
+    return;
+  }
+  const uint32_t index = table.AllocateIndex(transport_length);
+  if (is_binary) {
+    framer->EmitLitHdrWithBinaryStringKeyIncIdx(key.Ref(), value.Ref());
+  } else {
+    framer->EmitLitHdrWithNonBinaryStringKeyIncIdx(key.Ref(), value.Ref());
+  }
+  if (found != values_.end()) {
+    found->index = index;
+  } else {
+    values_.emplace_back(key.Ref(), value.Ref(), index);
+  }
+  RemoveEvictedValues(table);
+}
+
+void HPackCompressor::Framer::Encode(const Slice& key, const Slice& value) {
+  compressor_->custom_metadata_index_.EmitTo(key, value, this);
 }
 
 void HPackCompressor::Framer::Encode(HttpPathMetadata, const Slice& value) {
@@ -657,6 +769,14 @@ void HPackCompressor::SetMaxUsableSize(uint32_t max_table_size) {
   SetMaxTableSize(std::min(table_.max_size(), max_table_size));
 }
 
+void HPackCompressor::SetNeverIndexKeys(std::vector<std::string> keys) {
+  custom_metadata_index_.SetNeverIndexKeys(std::move(keys));
+}
+
+void HPackCompressor::SetPinnedKeys(std::vector<std::string> keys) {
+  custom_metadata_index_.SetPinnedKeys(std::move(keys));
+}
+
 void HPackCompressor::SetMaxTableSize(uint32_t max_table_size) {
   if (table_.SetMaxSize(std::min(max_usable_size_, max_table_size))) {
     advertise_table_size_change_ = true;
@@ -24,6 +24,7 @@
 #include <stddef.h>
 
 #include <cstdint>
+#include <string>
 #include <utility>
 #include <vector>
 
@@ -50,6 +51,7 @@ namespace grpc_core {
 
 class HPackCompressor {
   class SliceIndex;
+  class CustomMetadataIndex;
 
  public:
   HPackCompressor() = default;
@@ -60,6 +62,11 @@ class HPackCompressor {
 
   void SetMaxTableSize(uint32_t max_table_size);
   void SetMaxUsableSize(uint32_t max_table_size);
+  // Keys whose values are never added to the table, and are sent as never
+  // indexed literals.
+  void SetNeverIndexKeys(std::vector<std::string> keys);
+  // Keys whose values are added to the table the first time they're sent.
+  void SetPinnedKeys(std::vector<std::string> keys);
 
   uint32_t test_only_table_size() const {
     return table_.test_only_table_size();
@@ -123,6 +130,7 @@ class HPackCompressor {
 
    private:
     friend class SliceIndex;
+    friend class CustomMetadataIndex;
 
     struct FramePrefix {
       // index (in output_) of the header for the frame
@@ -148,6 +156,10 @@ class HPackCompressor {
                                              Slice value_slice);
     void EmitLitHdrWithNonBinaryStringKeyNotIdx(Slice key_slice,
                                                 Slice value_slice);
+    void EmitLitHdrWithBinaryStringKeyNvrIdx(Slice key_slice,
+                                             Slice value_slice);
+    void EmitLitHdrWithNonBinaryStringKeyNvrIdx(Slice key_slice,
+                                                Slice value_slice);
 
     void EncodeAlwaysIndexed(uint32_t* index, absl::string_view key,
                              Slice value, uint32_t transport_length);
@@ -201,6 +213,52 @@ class HPackCompressor {
     std::vector<ValueIndex> values_;
   };
 
+  // Indexes metadata without a dedicated encoder (i.e. custom metadata).
+  // Values sent once - request ids, per-call signatures - would only evict
+  // useful entries from the table, so a value is only added to it when it
+  // is seen a second time within a short window, unless its key is pinned
+  // or never indexed.
+  class CustomMetadataIndex {
+   public:
+    void EmitTo(const Slice& key, const Slice& value, Framer* framer);
+
+    void SetNeverIndexKeys(std::vector<std::string> keys) {
+      never_index_keys_ = std::move(keys);
+    }
+    void SetPinnedKeys(std::vector<std::string> keys) {
+      pinned_keys_ = std::move(keys);
+    }
+
+   private:
+    // Number of recently sent values remembered for admission.
+    static constexpr size_t kNumRecentValues = 256;
+    // A value may use at most this fraction of the table unless its key is
+    // pinned.
+    static constexpr uint32_t kMaxTableFractionPerValue = 4;
+
+    struct ValueIndex {
+      ValueIndex(Slice key, Slice value, uint32_t index)
+          : key(std::move(key)), value(std::move(value)), index(index) {}
+      Slice key;
+      Slice value;
+      uint32_t index;
+    };
+
+    static bool HasKey(const std::vector<std::string>& keys,
+                       absl::string_view key);
+    // Records that (key, value) is being sent, and returns true if it was
+    // sent recently enough to be worth adding to the table.
+    bool SeenRecently(absl::string_view key, absl::string_view value);
+    void RemoveEvictedValues(const HPackEncoderTable& table);
+
+    std::vector<std::string> never_index_keys_;
+    std::vector<std::string> pinned_keys_;
+    std::vector<ValueIndex> values_;
+    // Direct mapped hashes of recently sent values: a value that is only sent
+    // once is overwritten before it repeats.
+    uint32_t recent_values_[kNumRecentValues] = {};
+  };
+
   struct PreviousTimeout {
     Timeout timeout;
     uint32_t index;
@@ -228,6 +286,7 @@ class HPackCompressor {
   Slice user_agent_;
   SliceIndex path_index_;
   SliceIndex authority_index_;
+  CustomMetadataIndex custom_metadata_index_;
   std::vector<PreviousTimeout> previous_timeouts_;
 };
 
@@ -24,6 +24,7 @@
 #include <stddef.h>
 #include <stdint.h>
 
+#include <atomic>
 #include <string>
 
 #include "absl/strings/string_view.h"
@@ -255,6 +256,10 @@ struct grpc_chttp2_transport {
   grpc_closure* notify_on_receive_settings = nullptr;
   grpc_closure* notify_on_close = nullptr;
 
+  /** copy of the peer's SETTINGS_MAX_CONCURRENT_STREAMS that can be read
+      from outside the combiner */
+  std::atomic<uint32_t> peer_max_concurrent_streams{UINT32_MAX};
+
   /** write execution state of the transport */
   grpc_chttp2_write_state write_state = GRPC_CHTTP2_WRITE_STATE_IDLE;
 
@@ -445,6 +450,32 @@ struct grpc_chttp2_transport {
    * thereby reducing the number of induced frames. */
   uint32_t num_pending_induced_frames = 0;
   bool reading_paused_on_pending_induced_frames = false;
+
+  /* write coalescing */
+  /** How long a write may be held back to pick up frames from other calls;
+   * zero disables coalescing */
+  grpc_core::Duration write_coalesce_max_delay;
+  /** Flush a held-back write once this many message bytes are queued */
+  uint32_t write_coalesce_max_bytes = 0;
+  /** Message bytes queued since the last write began */
+  size_t write_coalesce_pending_bytes = 0;
+  /** Is a held-back write waiting on write_coalesce_timer? */
+  bool write_coalesce_timer_pending = false;
+  /** Was the write being started held back? */
+  bool write_coalesced = false;
+  /** num_messages_in_next_write when the write was held back */
+  uint32_t write_coalesce_start_messages = 0;
+  /** Moving average of the messages a held-back write picked up while it
+   * waited, and a countdown to the next probe while that stays too low */
+  double write_coalesce_gain_avg = 1;
+  uint32_t write_coalesce_probe_countdown = 0;
+  grpc_timer write_coalesce_timer;
+  grpc_closure write_coalesce_timer_expired_locked;
+  /** When the last write began, and moving averages of the interval between
+   * writes (in milliseconds) and of their size (in bytes) */
+  grpc_core::Timestamp last_write_begun = grpc_core::Timestamp::InfPast();
+  double write_interval_avg_ms = 1000;
+  double write_size_avg = 0;
 };
 
 typedef enum {
@@ -594,6 +625,17 @@ grpc_chttp2_begin_write_result grpc_chttp2_begin_write(
     grpc_chttp2_transport* t);
 void grpc_chttp2_end_write(grpc_chttp2_transport* t, grpc_error_handle error);
 
+/** Should a write that \a reason would start from idle be held back for up
+    to t->write_coalesce_max_delay so that it can carry frames other calls are
+    about to queue? Only small writes arriving faster than that delay, on a
+    transport where holding writes back has recently paid off, are held back;
+    anything else would just pay the delay and go out alone. */
+bool grpc_chttp2_should_coalesce_write(
+    grpc_chttp2_transport* t, grpc_chttp2_initiate_write_reason reason);
+/** Should a held-back write be flushed now that \a reason wants to write? */
+bool grpc_chttp2_should_flush_coalesced_write(
+    grpc_chttp2_transport* t, grpc_chttp2_initiate_write_reason reason);
+
 /** Process one slice of incoming data; return 1 if the connection is still
     viable after reading, or 0 if the connection should be torn down */
 grpc_error_handle grpc_chttp2_perform_read(grpc_chttp2_transport* t,
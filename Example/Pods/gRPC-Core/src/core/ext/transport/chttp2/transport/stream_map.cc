@@ -21,20 +21,33 @@
 #include "src/core/ext/transport/chttp2/transport/stream_map.h"
 
 #include <stdlib.h>
+#include <string.h>
 
 #include <grpc/support/alloc.h>
 #include <grpc/support/log.h>
 
+/* Fibonacci hashing: stream ids on a connection are consecutive odd (or even)
+   numbers, and multiplying by 2^64/phi spreads them evenly over the table. */
+static size_t slot_for(uint32_t key, size_t capacity) {
+  return static_cast<size_t>((key * uint64_t{0x9E3779B97F4A7C15}) >> 32) &
+         (capacity - 1);
+}
+
+static void alloc_table(grpc_chttp2_stream_map* map, size_t capacity) {
+  map->keys = static_cast<uint32_t*>(gpr_zalloc(sizeof(uint32_t) * capacity));
+  map->values = static_cast<void**>(gpr_malloc(sizeof(void*) * capacity));
+  map->capacity = capacity;
+  map->used = map->count;
+}
+
 void grpc_chttp2_stream_map_init(grpc_chttp2_stream_map* map,
                                  size_t initial_capacity) {
   GPR_DEBUG_ASSERT(initial_capacity > 1);
-  map->keys =
-      static_cast<uint32_t*>(gpr_malloc(sizeof(uint32_t) * initial_capacity));
-  map->values =
-      static_cast<void**>(gpr_malloc(sizeof(void*) * initial_capacity));
+  size_t capacity = 2;
+  while (capacity < initial_capacity) capacity *= 2;
   map->count = 0;
-  map->free = 0;
-  map->capacity = initial_capacity;
+  map->last_key = 0;
+  alloc_table(map, capacity);
 }
 
 void grpc_chttp2_stream_map_destroy(grpc_chttp2_stream_map* map) {
@@ -42,125 +55,91 @@ void grpc_chttp2_stream_map_destroy(grpc_chttp2_stream_map* map) {
   gpr_free(map->values);
 }
 
-static size_t compact(uint32_t* keys, void** values, size_t count) {
-  size_t i, out;
+static void insert(uint32_t* keys, void** values, size_t capacity,
+                   uint32_t key, void* value) {
+  size_t i = slot_for(key, capacity);
+  while (keys[i] != 0) i = (i + 1) & (capacity - 1);
+  keys[i] = key;
+  values[i] = value;
+}
 
-  for (i = 0, out = 0; i < count; i++) {
-    if (values[i]) {
-      keys[out] = keys[i];
-      values[out] = values[i];
-      out++;
+/* Rebuild the table without its deleted slots, at a size where the live
+   entries fill at most half of it. */
+static void rehash(grpc_chttp2_stream_map* map) {
+  uint32_t* keys = map->keys;
+  void** values = map->values;
+  size_t capacity = map->capacity;
+  size_t new_capacity = 2;
+  while (new_capacity < 2 * (map->count + 1)) new_capacity *= 2;
+  alloc_table(map, new_capacity);
+  for (size_t i = 0; i < capacity; i++) {
+    if (keys[i] != 0 && values[i] != nullptr) {
+      insert(map->keys, map->values, new_capacity, keys[i], values[i]);
     }
   }
-
-  return out;
+  gpr_free(keys);
+  gpr_free(values);
 }
 
 void grpc_chttp2_stream_map_add(grpc_chttp2_stream_map* map, uint32_t key,
                                 void* value) {
-  size_t count = map->count;
-  size_t capacity = map->capacity;
-  uint32_t* keys = map->keys;
-  void** values = map->values;
-
-  // The first assertion ensures that the table is monotonically increasing.
-  GPR_ASSERT(count == 0 || keys[count - 1] < key);
+  // The first assertion ensures that keys are monotonically increasing, which
+  // also rules out re-adding a key that is already present.
+  GPR_ASSERT(key > map->last_key);
   GPR_DEBUG_ASSERT(value);
-  // Asserting that the key is not already in the map can be a debug assertion.
-  // Why: we're already checking that the map elements are monotonically
-  // increasing. If we re-add a key, i.e. if the key is already present, then
-  // either it is the most recently added key in the map (in which case the
-  // first assertion fails due to key == last_key) or there is a more recently
-  // added (larger) key at the end of the map: in which case the first assertion
-  // still fails due to key < last_key.
-  GPR_DEBUG_ASSERT(grpc_chttp2_stream_map_find(map, key) == nullptr);
+  map->last_key = key;
 
-  if (count == capacity) {
-    if (map->free > capacity / 4) {
-      count = compact(keys, values, count);
-      map->free = 0;
-    } else {
-      /* resize when less than 25% of the table is free, because compaction
-         won't help much */
-      map->capacity = capacity = 2 * capacity;
-      map->keys = keys = static_cast<uint32_t*>(
-          gpr_realloc(keys, capacity * sizeof(uint32_t)));
-      map->values = values =
-          static_cast<void**>(gpr_realloc(values, capacity * sizeof(void*)));
-    }
-  }
+  if (4 * (map->used + 1) > 3 * map->capacity) rehash(map);
 
-  keys[count] = key;
-  values[count] = value;
-  map->count = count + 1;
+  insert(map->keys, map->values, map->capacity, key, value);
+  map->count++;
+  map->used++;
 }
 
-template <bool strict_find>
 static void** find(grpc_chttp2_stream_map* map, uint32_t key) {
-  size_t min_idx = 0;
-  size_t max_idx = map->count;
-  size_t mid_idx;
   uint32_t* keys = map->keys;
-  void** values = map->values;
-  uint32_t mid_key;
-
-  GPR_DEBUG_ASSERT(!strict_find || max_idx > 0);
-  if (!strict_find && max_idx == 0) return nullptr;
-
-  while (min_idx < max_idx) {
-    /* find the midpoint, avoiding overflow */
-    mid_idx = min_idx + ((max_idx - min_idx) / 2);
-    mid_key = keys[mid_idx];
-
-    if (mid_key < key) {
-      min_idx = mid_idx + 1;
-    } else if (mid_key > key) {
-      max_idx = mid_idx;
-    } else /* mid_key == key */
-    {
-      return &values[mid_idx];
+  size_t mask = map->capacity - 1;
+  if (key == 0) return nullptr;
+  for (size_t i = slot_for(key, map->capacity);; i = (i + 1) & mask) {
+    if (keys[i] == key) {
+      return map->values[i] != nullptr ? &map->values[i] : nullptr;
     }
+    if (keys[i] == 0) return nullptr;
   }
-
-  GPR_DEBUG_ASSERT(!strict_find);
-  return nullptr;
 }
 
 void* grpc_chttp2_stream_map_delete(grpc_chttp2_stream_map* map, uint32_t key) {
-  void** pvalue = find<true>(map, key);
-  GPR_DEBUG_ASSERT(pvalue != nullptr);
+  void** pvalue = find(map, key);
+  if (pvalue == nullptr) return nullptr;
   void* out = *pvalue;
-  GPR_DEBUG_ASSERT(out != nullptr);
   *pvalue = nullptr;
-  map->free++;
-  /* recognize complete emptyness and ensure we can skip
-     defragmentation later */
-  if (map->free == map->count) {
-    map->free = map->count = 0;
+  map->count--;
+  /* recognize complete emptyness and drop the deleted slots with it */
+  if (map->count == 0) {
+    memset(map->keys, 0, sizeof(uint32_t) * map->capacity);
+    map->used = 0;
   }
   GPR_DEBUG_ASSERT(grpc_chttp2_stream_map_find(map, key) == nullptr);
   return out;
 }
 
 void* grpc_chttp2_stream_map_find(grpc_chttp2_stream_map* map, uint32_t key) {
-  void** pvalue = find<false>(map, key);
+  void** pvalue = find(map, key);
   return pvalue != nullptr ? *pvalue : nullptr;
 }
 
 size_t grpc_chttp2_stream_map_size(grpc_chttp2_stream_map* map) {
-  return map->count - map->free;
+  return map->count;
 }
 
 void* grpc_chttp2_stream_map_rand(grpc_chttp2_stream_map* map) {
-  if (map->count == map->free) {
+  if (map->count == 0) {
     return nullptr;
   }
-  if (map->free != 0) {
-    map->count = compact(map->keys, map->values, map->count);
-    map->free = 0;
-    GPR_ASSERT(map->count > 0);
+  size_t mask = map->capacity - 1;
+  for (size_t i = static_cast<size_t>(rand()) & mask;; i = (i + 1) & mask) {
+    if (map->keys[i] != 0 && map->values[i] != nullptr) return map->values[i];
   }
-  return map->values[(static_cast<size_t>(rand())) % map->count];
 }
 
 void grpc_chttp2_stream_map_for_each(grpc_chttp2_stream_map* map,
@@ -169,8 +148,8 @@ void grpc_chttp2_stream_map_for_each(grpc_chttp2_stream_map* map,
                                      void* user_data) {
   size_t i;
 
-  for (i = 0; i < map->count; i++) {
-    if (map->values[i]) {
+  for (i = 0; i < map->capacity; i++) {
+    if (map->keys[i] != 0 && map->values[i] != nullptr) {
       f(user_data, map->keys[i], map->values[i]);
     }
   }
@@ -26,16 +26,23 @@
 
 /* Data structure to map a uint32_t to a data object (represented by a void*)
 
-   Represented as a sorted array of keys, and a corresponding array of values.
-   Lookups are performed with binary search.
+   Represented as an open-addressing hash table with linear probing: a
+   power-of-two array of keys and a corresponding array of values. Key 0 marks
+   an empty slot (stream id 0 is never a stream); a slot with a key and a NULL
+   value was deleted and keeps its key so that probe sequences stay intact.
+   Deleted slots are dropped the next time the table is rehashed, which happens
+   when live plus deleted slots would exceed 3/4 of the capacity.
    Adds are restricted to strictly higher keys than previously seen (this is
    guaranteed by http2). */
 struct grpc_chttp2_stream_map {
   uint32_t* keys;
   void** values;
+  /* number of live entries */
   size_t count;
-  size_t free;
+  /* number of live and deleted slots */
+  size_t used;
   size_t capacity;
+  uint32_t last_key;
 };
 void grpc_chttp2_stream_map_init(grpc_chttp2_stream_map* map,
                                  size_t initial_capacity);
@@ -59,7 +66,8 @@ void* grpc_chttp2_stream_map_rand(grpc_chttp2_stream_map* map);
 /* How many (populated) entries are in the stream map? */
 size_t grpc_chttp2_stream_map_size(grpc_chttp2_stream_map* map);
 
-/* Callback on each stream */
+/* Callback on each stream. The callback may delete entries (including the one
+   it is called for), but must not add any. */
 void grpc_chttp2_stream_map_for_each(grpc_chttp2_stream_map* map,
                                      void (*f)(void* user_data, uint32_t key,
                                                void* value),
@@ -624,6 +624,41 @@ class StreamWriteContext {
 };
 }  // namespace
 
+// Write coalescing averages are exponentially weighted, so a burst of traffic
+// is noticed within a few writes and a quiet connection stops coalescing just
+// as quickly.
+static constexpr double kWriteCoalescingAlpha = 0.125;
+// Holding writes back stops paying off once they pick up fewer than this many
+// other messages on average...
+static constexpr double kMinWriteCoalescingGain = 0.5;
+// ... after which only one in this many eligible writes is held back, to
+// notice when traffic changes.
+static constexpr uint32_t kWriteCoalescingProbeInterval = 128;
+
+static void update_write_coalescing_state(grpc_chttp2_transport* t,
+                                          bool writing) {
+  if (t->write_coalesced) {
+    t->write_coalesced = false;
+    double gain = static_cast<double>(t->num_messages_in_next_write -
+                                      t->write_coalesce_start_messages);
+    t->write_coalesce_gain_avg +=
+        kWriteCoalescingAlpha * (gain - t->write_coalesce_gain_avg);
+  }
+  t->write_coalesce_pending_bytes = 0;
+  if (!writing) return;
+  constexpr double kMaxIntervalMs = 1000;
+  grpc_core::Timestamp now = grpc_core::ExecCtx::Get()->Now();
+  double interval_ms =
+      std::min(kMaxIntervalMs, static_cast<double>(
+                                   (now - t->last_write_begun).millis()));
+  t->last_write_begun = now;
+  t->write_interval_avg_ms +=
+      kWriteCoalescingAlpha * (interval_ms - t->write_interval_avg_ms);
+  t->write_size_avg += kWriteCoalescingAlpha *
+                       (static_cast<double>(t->outbuf.length) -
+                        t->write_size_avg);
+}
+
 grpc_chttp2_begin_write_result grpc_chttp2_begin_write(
     grpc_chttp2_transport* t) {
   WriteContext ctx(t);
@@ -668,7 +703,55 @@ grpc_chttp2_begin_write_result grpc_chttp2_begin_write(
 
   maybe_initiate_ping(t);
 
-  return ctx.Result();
+  grpc_chttp2_begin_write_result result = ctx.Result();
+  update_write_coalescing_state(t, result.writing);
+  return result;
+}
+
+static bool is_coalescible_write_reason(
+    grpc_chttp2_initiate_write_reason reason) {
+  switch (reason) {
+    case GRPC_CHTTP2_INITIATE_WRITE_START_NEW_STREAM:
+    case GRPC_CHTTP2_INITIATE_WRITE_SEND_MESSAGE:
+    case GRPC_CHTTP2_INITIATE_WRITE_SEND_INITIAL_METADATA:
+    case GRPC_CHTTP2_INITIATE_WRITE_SEND_TRAILING_METADATA:
+      return true;
+    default:
+      // Pings, settings, flow control updates and stream resets are either
+      // latency sensitive or already rare; never hold them back.
+      return false;
+  }
+}
+
+bool grpc_chttp2_should_coalesce_write(
+    grpc_chttp2_transport* t, grpc_chttp2_initiate_write_reason reason) {
+  if (t->write_coalesce_max_delay == grpc_core::Duration::Zero() ||
+      !is_coalescible_write_reason(reason) ||
+      // With a single stream there is nobody else to wait for.
+      grpc_chttp2_stream_map_size(&t->stream_map) < 2 ||
+      t->write_interval_avg_ms >=
+          static_cast<double>(t->write_coalesce_max_delay.millis()) ||
+      t->write_size_avg >= t->write_coalesce_max_bytes) {
+    return false;
+  }
+  if (t->write_coalesce_gain_avg < kMinWriteCoalescingGain &&
+      ++t->write_coalesce_probe_countdown < kWriteCoalescingProbeInterval) {
+    return false;
+  }
+  t->write_coalesce_probe_countdown = 0;
+  return true;
+}
+
+bool grpc_chttp2_should_flush_coalesced_write(
+    grpc_chttp2_transport* t, grpc_chttp2_initiate_write_reason reason) {
+  if (!is_coalescible_write_reason(reason) ||
+      t->write_coalesce_pending_bytes >= t->write_coalesce_max_bytes) {
+    return true;
+  }
+  // Once every open stream has a message in the write there is nothing left
+  // to wait for.
+  return t->num_messages_in_next_write - t->write_coalesce_start_messages + 1 >=
+         grpc_chttp2_stream_map_size(&t->stream_map);
 }
 
 void grpc_chttp2_end_write(grpc_chttp2_transport* t, grpc_error_handle error) {
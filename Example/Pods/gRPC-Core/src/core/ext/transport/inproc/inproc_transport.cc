@@ -1197,13 +1197,15 @@ void set_pollset_set(grpc_transport* /*gt*/, grpc_stream* /*gs*/,
 
 grpc_endpoint* get_endpoint(grpc_transport* /*t*/) { return nullptr; }
 
+uint32_t max_concurrent_streams(grpc_transport* /*t*/) { return UINT32_MAX; }
+
 const grpc_transport_vtable inproc_vtable = {
     sizeof(inproc_stream), "inproc",
     init_stream,           nullptr,
     set_pollset,           set_pollset_set,
     perform_stream_op,     perform_transport_op,
     destroy_stream,        destroy_transport,
-    get_endpoint};
+    get_endpoint,          max_concurrent_streams};
 
 /*******************************************************************************
  * Main inproc transport functions
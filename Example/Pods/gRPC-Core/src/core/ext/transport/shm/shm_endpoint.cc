@@ -0,0 +1,613 @@
+//
+//
+// Copyright 2022 gRPC authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+//
+
+#include <grpc/support/port_platform.h>
+
+#include "src/core/ext/transport/shm/shm_endpoint.h"
+
+#ifdef GRPC_LINUX_SHM_TRANSPORT
+
+#include <errno.h>
+#include <fcntl.h>
+#include <string.h>
+#include <sys/eventfd.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <atomic>
+#include <new>
+#include <string>
+
+#include "absl/base/thread_annotations.h"
+
+#include <grpc/slice.h>
+#include <grpc/slice_buffer.h>
+#include <grpc/status.h>
+#include <grpc/support/log.h>
+
+#include "src/core/lib/gpr/useful.h"
+#include "src/core/lib/gprpp/debug_location.h"
+#include "src/core/lib/gprpp/ref_counted.h"
+#include "src/core/lib/gprpp/sync.h"
+#include "src/core/lib/iomgr/closure.h"
+#include "src/core/lib/iomgr/exec_ctx.h"
+#include "src/core/lib/slice/slice_internal.h"
+
+#ifndef MFD_CLOEXEC
+#define MFD_CLOEXEC 0x0001U
+#endif
+#ifndef MFD_ALLOW_SEALING
+#define MFD_ALLOW_SEALING 0x0002U
+#endif
+
+namespace grpc_core {
+
+namespace {
+
+static_assert(ATOMIC_LLONG_LOCK_FREE == 2 && ATOMIC_INT_LOCK_FREE == 2,
+              "shared-memory rings need lock-free atomics");
+
+constexpr uint64_t kShmSegmentMagic = 0x314d485343505247;  // "GRPCSHM1"
+constexpr size_t kCacheLineSize = 64;
+constexpr size_t kPageSize = 4096;
+
+struct ShmRing {
+  // Total bytes consumed; only written by the consumer.
+  alignas(kCacheLineSize) std::atomic<uint64_t> head;
+  // Total bytes produced; only written by the producer.
+  alignas(kCacheLineSize) std::atomic<uint64_t> tail;
+  // Set by the producer once it will not write again.
+  std::atomic<uint32_t> closed;
+};
+
+struct ShmSegmentHeader {
+  uint64_t magic;
+  uint64_t ring_size;
+  // rings[0] carries client to server bytes, rings[1] server to client.
+  ShmRing rings[2];
+  // Set by side i (0 = client) before it waits on its wakeup fd for bytes to
+  // read or for room to write, and cleared by the side that signals it.
+  alignas(kCacheLineSize) std::atomic<uint32_t> waiting_for_data[2];
+  std::atomic<uint32_t> waiting_for_space[2];
+};
+
+constexpr size_t kShmDataOffset =
+    (sizeof(ShmSegmentHeader) + kPageSize - 1) / kPageSize * kPageSize;
+
+size_t ShmSegmentSize(size_t ring_size) {
+  return kShmDataOffset + 2 * ring_size;
+}
+
+grpc_error_handle ShmError(const char* msg) {
+  // Mirror tcp: mark as UNAVAILABLE so that applications may retry.
+  return grpc_error_set_int(GRPC_ERROR_CREATE_FROM_COPIED_STRING(msg),
+                            GRPC_ERROR_INT_GRPC_STATUS,
+                            GRPC_STATUS_UNAVAILABLE);
+}
+
+class ShmEndpoint {
+ public:
+  // \a ring_size must already have been validated against \a segment_size;
+  // the copy in the segment header is never read again, since the peer can
+  // change it at any time.
+  ShmEndpoint(grpc_fd* socket_fd, char* segment, size_t segment_size,
+              size_t ring_size, int wakeup_fd, int peer_wakeup_fd,
+              bool is_client, absl::string_view peer,
+              absl::string_view local_address);
+
+  grpc_endpoint* base() { return &base_; }
+
+  void Read(grpc_slice_buffer* slices, grpc_closure* cb);
+  void Write(grpc_slice_buffer* slices, grpc_closure* cb);
+  void AddToPollset(grpc_pollset* pollset);
+  void AddToPollsetSet(grpc_pollset_set* pollset_set);
+  void DeleteFromPollsetSet(grpc_pollset_set* pollset_set);
+  void Shutdown(grpc_error_handle why);
+  void Destroy();
+  absl::string_view peer() const { return peer_; }
+  absl::string_view local_address() const { return local_address_; }
+
+  static const grpc_endpoint_vtable kVtable;
+
+ private:
+  ~ShmEndpoint();
+
+  void Ref() { refs_.Ref(); }
+  void Unref() {
+    if (refs_.Unref()) delete this;
+  }
+
+  // Moves whatever the rings allow for the pending read and write, and arms
+  // the wakeup fd if either of them still has to wait for the peer.
+  void ProgressLocked() ABSL_EXCLUSIVE_LOCKS_REQUIRED(mu_);
+  void ReadLocked() ABSL_EXCLUSIVE_LOCKS_REQUIRED(mu_);
+  void WriteLocked() ABSL_EXCLUSIVE_LOCKS_REQUIRED(mu_);
+  void FinishReadLocked(grpc_error_handle error)
+      ABSL_EXCLUSIVE_LOCKS_REQUIRED(mu_);
+  void FinishWriteLocked(grpc_error_handle error)
+      ABSL_EXCLUSIVE_LOCKS_REQUIRED(mu_);
+  // Signals the peer's wakeup fd if it announced \a waiting.
+  void WakePeer(std::atomic<uint32_t>* waiting);
+
+  static void OnWakeup(void* arg, grpc_error_handle error);
+  static void OnSocketReadable(void* arg, grpc_error_handle error);
+
+  grpc_endpoint base_;
+  RefCount refs_;
+  char* const segment_;
+  const size_t segment_size_;
+  ShmSegmentHeader* const header_;
+  const size_t ring_size_;
+  const int side_;
+  ShmRing* const tx_;
+  ShmRing* const rx_;
+  char* const tx_data_;
+  const char* const rx_data_;
+  grpc_fd* const socket_fd_;
+  grpc_fd* const wakeup_fd_;
+  const int peer_wakeup_fd_;
+  const std::string peer_;
+  const std::string local_address_;
+  grpc_closure on_wakeup_;
+  grpc_closure on_socket_readable_;
+
+  Mutex mu_;
+  bool wakeup_armed_ ABSL_GUARDED_BY(mu_) = false;
+  // Set once the unix socket reports that the peer process has gone away.
+  bool peer_gone_ ABSL_GUARDED_BY(mu_) = false;
+  grpc_error_handle shutdown_error_ ABSL_GUARDED_BY(mu_) = GRPC_ERROR_NONE;
+  grpc_closure* read_cb_ ABSL_GUARDED_BY(mu_) = nullptr;
+  grpc_slice_buffer* incoming_ ABSL_GUARDED_BY(mu_) = nullptr;
+  grpc_closure* write_cb_ ABSL_GUARDED_BY(mu_) = nullptr;
+  grpc_slice_buffer* outgoing_ ABSL_GUARDED_BY(mu_) = nullptr;
+  // Bytes of outgoing_->slices[0] already copied into the ring.
+  size_t outgoing_offset_ ABSL_GUARDED_BY(mu_) = 0;
+};
+
+ShmEndpoint::ShmEndpoint(grpc_fd* socket_fd, char* segment,
+                         size_t segment_size, size_t ring_size, int wakeup_fd,
+                         int peer_wakeup_fd, bool is_client,
+                         absl::string_view peer,
+                         absl::string_view local_address)
+    : segment_(segment),
+      segment_size_(segment_size),
+      header_(reinterpret_cast<ShmSegmentHeader*>(segment)),
+      ring_size_(ring_size),
+      side_(is_client ? 0 : 1),
+      tx_(&header_->rings[side_]),
+      rx_(&header_->rings[1 - side_]),
+      tx_data_(segment + kShmDataOffset + side_ * ring_size_),
+      rx_data_(segment + kShmDataOffset + (1 - side_) * ring_size_),
+      socket_fd_(socket_fd),
+      wakeup_fd_(grpc_fd_create(wakeup_fd, "shm-wakeup", false)),
+      peer_wakeup_fd_(peer_wakeup_fd),
+      peer_(peer),
+      local_address_(local_address) {
+  base_.vtable = &kVtable;
+  GRPC_CLOSURE_INIT(&on_wakeup_, OnWakeup, this, grpc_schedule_on_exec_ctx);
+  GRPC_CLOSURE_INIT(&on_socket_readable_, OnSocketReadable, this,
+                    grpc_schedule_on_exec_ctx);
+  // Nothing is ever sent on the socket again, so the only thing it can report
+  // is the peer closing it.
+  Ref();
+  grpc_fd_notify_on_read(socket_fd_, &on_socket_readable_);
+}
+
+ShmEndpoint::~ShmEndpoint() {
+  grpc_fd_orphan(wakeup_fd_, nullptr, nullptr, "shm_endpoint");
+  grpc_fd_orphan(socket_fd_, nullptr, nullptr, "shm_endpoint");
+  close(peer_wakeup_fd_);
+  munmap(segment_, segment_size_);
+  GRPC_ERROR_UNREF(shutdown_error_);
+}
+
+void ShmEndpoint::Read(grpc_slice_buffer* slices, grpc_closure* cb) {
+  MutexLock lock(&mu_);
+  GPR_ASSERT(read_cb_ == nullptr);
+  grpc_slice_buffer_reset_and_unref_internal(slices);
+  if (!GRPC_ERROR_IS_NONE(shutdown_error_)) {
+    ExecCtx::Run(DEBUG_LOCATION, cb, GRPC_ERROR_REF(shutdown_error_));
+    return;
+  }
+  read_cb_ = cb;
+  incoming_ = slices;
+  ProgressLocked();
+}
+
+void ShmEndpoint::Write(grpc_slice_buffer* slices, grpc_closure* cb) {
+  MutexLock lock(&mu_);
+  GPR_ASSERT(write_cb_ == nullptr);
+  if (!GRPC_ERROR_IS_NONE(shutdown_error_)) {
+    ExecCtx::Run(DEBUG_LOCATION, cb, GRPC_ERROR_REF(shutdown_error_));
+    return;
+  }
+  if (slices->length == 0) {
+    ExecCtx::Run(DEBUG_LOCATION, cb, GRPC_ERROR_NONE);
+    return;
+  }
+  write_cb_ = cb;
+  outgoing_ = slices;
+  outgoing_offset_ = 0;
+  ProgressLocked();
+}
+
+void ShmEndpoint::ProgressLocked() {
+  bool announced_sleep = false;
+  while (true) {
+    if (read_cb_ != nullptr) ReadLocked();
+    if (write_cb_ != nullptr) WriteLocked();
+    if (read_cb_ == nullptr && write_cb_ == nullptr) return;
+    if (!announced_sleep) {
+      // Announce what we are waiting for, then look at the rings once more:
+      // the peer checks the flags only after publishing, so either that second
+      // look sees its update or it sees our flag and signals the wakeup fd.
+      // This is needed even if the wakeup fd is already armed: it may have
+      // been armed for the other op, and the peer clears a flag whenever it
+      // signals.
+      if (read_cb_ != nullptr) {
+        header_->waiting_for_data[side_].store(1, std::memory_order_relaxed);
+      }
+      if (write_cb_ != nullptr) {
+        header_->waiting_for_space[side_].store(1, std::memory_order_relaxed);
+      }
+      std::atomic_thread_fence(std::memory_order_seq_cst);
+      announced_sleep = true;
+      continue;
+    }
+    if (!wakeup_armed_) {
+      wakeup_armed_ = true;
+      Ref();
+      grpc_fd_notify_on_read(wakeup_fd_, &on_wakeup_);
+    }
+    return;
+  }
+}
+
+void ShmEndpoint::ReadLocked() {
+  const bool closed = rx_->closed.load(std::memory_order_acquire);
+  const uint64_t head = rx_->head.load(std::memory_order_relaxed);
+  const uint64_t tail = rx_->tail.load(std::memory_order_acquire);
+  const uint64_t available = tail - head;
+  if (available > ring_size_) {
+    FinishReadLocked(ShmError("Shared memory ring corrupted"));
+    return;
+  }
+  if (available == 0) {
+    if (closed || peer_gone_) FinishReadLocked(ShmError("Socket closed"));
+    return;
+  }
+  const size_t n = static_cast<size_t>(available);
+  const size_t offset = static_cast<size_t>(head & (ring_size_ - 1));
+  const size_t first = std::min(n, ring_size_ - offset);
+  grpc_slice slice = GRPC_SLICE_MALLOC(n);
+  memcpy(GRPC_SLICE_START_PTR(slice), rx_data_ + offset, first);
+  memcpy(GRPC_SLICE_START_PTR(slice) + first, rx_data_, n - first);
+  rx_->head.store(tail, std::memory_order_release);
+  WakePeer(&header_->waiting_for_space[1 - side_]);
+  grpc_slice_buffer_add(incoming_, slice);
+  FinishReadLocked(GRPC_ERROR_NONE);
+}
+
+void ShmEndpoint::WriteLocked() {
+  if (peer_gone_ || rx_->closed.load(std::memory_order_acquire)) {
+    FinishWriteLocked(ShmError("Shared memory peer closed"));
+    return;
+  }
+  const uint64_t head = tx_->head.load(std::memory_order_acquire);
+  uint64_t tail = tx_->tail.load(std::memory_order_relaxed);
+  if (tail - head > ring_size_) {
+    FinishWriteLocked(ShmError("Shared memory ring corrupted"));
+    return;
+  }
+  size_t space = ring_size_ - static_cast<size_t>(tail - head);
+  const uint64_t start = tail;
+  while (space > 0 && outgoing_->count > 0) {
+    const grpc_slice& slice = outgoing_->slices[0];
+    const size_t n =
+        std::min(space, GRPC_SLICE_LENGTH(slice) - outgoing_offset_);
+    const uint8_t* src = GRPC_SLICE_START_PTR(slice) + outgoing_offset_;
+    const size_t offset = static_cast<size_t>(tail & (ring_size_ - 1));
+    const size_t first = std::min(n, ring_size_ - offset);
+    memcpy(tx_data_ + offset, src, first);
+    memcpy(tx_data_, src + first, n - first);
+    tail += n;
+    space -= n;
+    outgoing_offset_ += n;
+    if (outgoing_offset_ == GRPC_SLICE_LENGTH(slice)) {
+      grpc_slice_buffer_remove_first(outgoing_);
+      outgoing_offset_ = 0;
+    }
+  }
+  if (tail != start) {
+    tx_->tail.store(tail, std::memory_order_release);
+    WakePeer(&header_->waiting_for_data[1 - side_]);
+  }
+  if (outgoing_->count == 0) FinishWriteLocked(GRPC_ERROR_NONE);
+}
+
+void ShmEndpoint::FinishReadLocked(grpc_error_handle error) {
+  if (!GRPC_ERROR_IS_NONE(error)) {
+    grpc_slice_buffer_reset_and_unref_internal(incoming_);
+  }
+  ExecCtx::Run(DEBUG_LOCATION, read_cb_, error);
+  read_cb_ = nullptr;
+  incoming_ = nullptr;
+}
+
+void ShmEndpoint::FinishWriteLocked(grpc_error_handle error) {
+  ExecCtx::Run(DEBUG_LOCATION, write_cb_, error);
+  write_cb_ = nullptr;
+  outgoing_ = nullptr;
+}
+
+void ShmEndpoint::WakePeer(std::atomic<uint32_t>* waiting) {
+  std::atomic_thread_fence(std::memory_order_seq_cst);
+  if (waiting->load(std::memory_order_relaxed) != 0 &&
+      waiting->exchange(0, std::memory_order_relaxed) != 0) {
+    eventfd_write(peer_wakeup_fd_, 1);
+  }
+}
+
+void ShmEndpoint::OnWakeup(void* arg, grpc_error_handle error) {
+  ShmEndpoint* self = static_cast<ShmEndpoint*>(arg);
+  {
+    MutexLock lock(&self->mu_);
+    self->wakeup_armed_ = false;
+    if (GRPC_ERROR_IS_NONE(error)) {
+      // Drain the counter; the fd is edge triggered.
+      eventfd_t value;
+      eventfd_read(grpc_fd_wrapped_fd(self->wakeup_fd_), &value);
+      self->ProgressLocked();
+    }
+  }
+  self->Unref();
+}
+
+void ShmEndpoint::OnSocketReadable(void* arg, grpc_error_handle error) {
+  ShmEndpoint* self = static_cast<ShmEndpoint*>(arg);
+  if (GRPC_ERROR_IS_NONE(error)) {
+    char c;
+    ssize_t r;
+    do {
+      r = recv(grpc_fd_wrapped_fd(self->socket_fd_), &c, 1,
+               MSG_PEEK | MSG_DONTWAIT);
+    } while (r < 0 && errno == EINTR);
+    if (r > 0 || (r < 0 && errno == EAGAIN)) {
+      grpc_fd_notify_on_read(self->socket_fd_, &self->on_socket_readable_);
+      return;
+    }
+    MutexLock lock(&self->mu_);
+    self->peer_gone_ = true;
+    self->ProgressLocked();
+  }
+  self->Unref();
+}
+
+void ShmEndpoint::AddToPollset(grpc_pollset* pollset) {
+  grpc_pollset_add_fd(pollset, wakeup_fd_);
+  grpc_pollset_add_fd(pollset, socket_fd_);
+}
+
+void ShmEndpoint::AddToPollsetSet(grpc_pollset_set* pollset_set) {
+  grpc_pollset_set_add_fd(pollset_set, wakeup_fd_);
+  grpc_pollset_set_add_fd(pollset_set, socket_fd_);
+}
+
+void ShmEndpoint::DeleteFromPollsetSet(grpc_pollset_set* pollset_set) {
+  grpc_pollset_set_del_fd(pollset_set, wakeup_fd_);
+  grpc_pollset_set_del_fd(pollset_set, socket_fd_);
+}
+
+void ShmEndpoint::Shutdown(grpc_error_handle why) {
+  MutexLock lock(&mu_);
+  if (!GRPC_ERROR_IS_NONE(shutdown_error_)) {
+    GRPC_ERROR_UNREF(why);
+    return;
+  }
+  shutdown_error_ = why;
+  // Let the peer see end-of-stream once it has drained what we wrote.
+  tx_->closed.store(1, std::memory_order_release);
+  eventfd_write(peer_wakeup_fd_, 1);
+  if (read_cb_ != nullptr) FinishReadLocked(GRPC_ERROR_REF(why));
+  if (write_cb_ != nullptr) FinishWriteLocked(GRPC_ERROR_REF(why));
+  grpc_fd_shutdown(wakeup_fd_, GRPC_ERROR_REF(why));
+  grpc_fd_shutdown(socket_fd_, GRPC_ERROR_REF(why));
+}
+
+void ShmEndpoint::Destroy() {
+  Shutdown(GRPC_ERROR_CREATE_FROM_STATIC_STRING("Endpoint destroyed"));
+  Unref();
+}
+
+ShmEndpoint* ToShmEndpoint(grpc_endpoint* ep) {
+  return reinterpret_cast<ShmEndpoint*>(ep);
+}
+
+const grpc_endpoint_vtable ShmEndpoint::kVtable = {
+    // read
+    [](grpc_endpoint* ep, grpc_slice_buffer* slices, grpc_closure* cb,
+       bool /*urgent*/, int /*min_progress_size*/) {
+      ToShmEndpoint(ep)->Read(slices, cb);
+    },
+    // write
+    [](grpc_endpoint* ep, grpc_slice_buffer* slices, grpc_closure* cb,
+       void* /*arg*/, int /*max_frame_size*/) {
+      ToShmEndpoint(ep)->Write(slices, cb);
+    },
+    // add_to_pollset
+    [](grpc_endpoint* ep, grpc_pollset* pollset) {
+      ToShmEndpoint(ep)->AddToPollset(pollset);
+    },
+    // add_to_pollset_set
+    [](grpc_endpoint* ep, grpc_pollset_set* pollset_set) {
+      ToShmEndpoint(ep)->AddToPollsetSet(pollset_set);
+    },
+    // delete_from_pollset_set
+    [](grpc_endpoint* ep, grpc_pollset_set* pollset_set) {
+      ToShmEndpoint(ep)->DeleteFromPollsetSet(pollset_set);
+    },
+    // shutdown
+    [](grpc_endpoint* ep, grpc_error_handle why) {
+      ToShmEndpoint(ep)->Shutdown(why);
+    },
+    // destroy
+    [](grpc_endpoint* ep) { ToShmEndpoint(ep)->Destroy(); },
+    // get_peer
+    [](grpc_endpoint* ep) { return ToShmEndpoint(ep)->peer(); },
+    // get_local_address
+    [](grpc_endpoint* ep) { return ToShmEndpoint(ep)->local_address(); },
+    // get_fd
+    [](grpc_endpoint* /*ep*/) { return -1; },
+    // can_track_err
+    [](grpc_endpoint* /*ep*/) { return false; },
+};
+
+int MemfdCreate(const char* name) {
+#ifdef SYS_memfd_create
+  return static_cast<int>(
+      syscall(SYS_memfd_create, name, MFD_CLOEXEC | MFD_ALLOW_SEALING));
+#else
+  errno = ENOSYS;
+  return -1;
+#endif
+}
+
+bool ShmSegmentIsSealed(int memfd) {
+#ifdef F_GET_SEALS
+  const int seals = fcntl(memfd, F_GET_SEALS);
+  return seals >= 0 && (seals & (F_SEAL_SHRINK | F_SEAL_GROW)) ==
+                           (F_SEAL_SHRINK | F_SEAL_GROW);
+#else
+  (void)memfd;
+  return false;
+#endif
+}
+
+}  // namespace
+
+void ShmSegmentFdsClose(ShmSegmentFds* fds) {
+  for (int* fd : {&fds->memfd, &fds->wakeup_fds[0], &fds->wakeup_fds[1]}) {
+    if (*fd >= 0) close(*fd);
+    *fd = -1;
+  }
+}
+
+grpc_error_handle ShmSegmentCreate(size_t ring_size, ShmSegmentFds* fds) {
+  GPR_ASSERT(ring_size > 0 && (ring_size & (ring_size - 1)) == 0);
+  const size_t size = ShmSegmentSize(ring_size);
+  fds->memfd = MemfdCreate("grpc-shm");
+  if (fds->memfd < 0) return GRPC_OS_ERROR(errno, "memfd_create");
+  if (ftruncate(fds->memfd, static_cast<off_t>(size)) != 0) {
+    grpc_error_handle error = GRPC_OS_ERROR(errno, "ftruncate");
+    ShmSegmentFdsClose(fds);
+    return error;
+  }
+#ifdef F_ADD_SEALS
+  // Stop either side from resizing the segment under the other's mapping.
+  // The client refuses segments without these seals.
+  if (fcntl(fds->memfd, F_ADD_SEALS,
+            F_SEAL_SHRINK | F_SEAL_GROW | F_SEAL_SEAL) != 0) {
+    grpc_error_handle error = GRPC_OS_ERROR(errno, "fcntl(F_ADD_SEALS)");
+    ShmSegmentFdsClose(fds);
+    return error;
+  }
+#endif
+  void* segment =
+      mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fds->memfd, 0);
+  if (segment == MAP_FAILED) {
+    grpc_error_handle error = GRPC_OS_ERROR(errno, "mmap");
+    ShmSegmentFdsClose(fds);
+    return error;
+  }
+  // The file is zero filled, which is already the initial state of every
+  // atomic; constructing the header just makes that explicit.
+  ShmSegmentHeader* header = new (segment) ShmSegmentHeader();
+  header->magic = kShmSegmentMagic;
+  header->ring_size = ring_size;
+  munmap(segment, size);
+  for (int& fd : fds->wakeup_fds) {
+    fd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if (fd < 0) {
+      grpc_error_handle error = GRPC_OS_ERROR(errno, "eventfd");
+      ShmSegmentFdsClose(fds);
+      return error;
+    }
+  }
+  return GRPC_ERROR_NONE;
+}
+
+grpc_endpoint* ShmEndpointCreate(grpc_fd* socket_fd, ShmSegmentFds fds,
+                                 bool is_client, absl::string_view peer,
+                                 absl::string_view local_address,
+                                 grpc_error_handle* error) {
+  struct stat st;
+  void* segment = MAP_FAILED;
+  size_t size = 0;
+  uint64_t ring_size = 0;
+  if (fstat(fds.memfd, &st) != 0) {
+    *error = GRPC_OS_ERROR(errno, "fstat");
+  } else if (is_client && !ShmSegmentIsSealed(fds.memfd)) {
+    // The server could otherwise shrink the segment and fault our accesses.
+    *error = GRPC_ERROR_CREATE_FROM_STATIC_STRING(
+        "Shared memory segment is not sealed against resizing");
+  } else if (static_cast<size_t>(st.st_size) < kShmDataOffset) {
+    *error = GRPC_ERROR_CREATE_FROM_STATIC_STRING(
+        "Shared memory segment too small");
+  } else {
+    size = static_cast<size_t>(st.st_size);
+    segment = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED,
+                   fds.memfd, 0);
+    if (segment == MAP_FAILED) *error = GRPC_OS_ERROR(errno, "mmap");
+  }
+  if (segment != MAP_FAILED) {
+    const ShmSegmentHeader* header =
+        static_cast<const ShmSegmentHeader*>(segment);
+    ring_size = header->ring_size;
+    if (header->magic != kShmSegmentMagic || ring_size == 0 ||
+        (ring_size & (ring_size - 1)) != 0 ||
+        ring_size > (size - kShmDataOffset) / 2 ||
+        ShmSegmentSize(ring_size) != size) {
+      *error = GRPC_ERROR_CREATE_FROM_STATIC_STRING(
+          "Invalid shared memory segment");
+      munmap(segment, size);
+      segment = MAP_FAILED;
+    }
+  }
+  if (segment == MAP_FAILED) {
+    ShmSegmentFdsClose(&fds);
+    grpc_fd_orphan(socket_fd, nullptr, nullptr, "shm_endpoint_create");
+    return nullptr;
+  }
+  // The mapping keeps the segment alive.
+  close(fds.memfd);
+  const int side = is_client ? 0 : 1;
+  ShmEndpoint* ep = new ShmEndpoint(
+      socket_fd, static_cast<char*>(segment), size,
+      static_cast<size_t>(ring_size), fds.wakeup_fds[side],
+      fds.wakeup_fds[1 - side], is_client, peer, local_address);
+  *error = GRPC_ERROR_NONE;
+  return ep->base();
+}
+
+}  // namespace grpc_core
+
+#endif  // GRPC_LINUX_SHM_TRANSPORT
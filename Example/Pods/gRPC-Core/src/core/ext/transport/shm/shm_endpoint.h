@@ -0,0 +1,71 @@
+//
+//
+// Copyright 2022 gRPC authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+//
+
+#ifndef GRPC_CORE_EXT_TRANSPORT_SHM_SHM_ENDPOINT_H
+#define GRPC_CORE_EXT_TRANSPORT_SHM_SHM_ENDPOINT_H
+
+#include <grpc/support/port_platform.h>
+
+#include "src/core/lib/iomgr/port.h"
+
+#ifdef GRPC_LINUX_SHM_TRANSPORT
+
+#include <stddef.h>
+
+#include "absl/strings/string_view.h"
+
+#include "src/core/lib/iomgr/endpoint.h"
+#include "src/core/lib/iomgr/error.h"
+#include "src/core/lib/iomgr/ev_posix.h"
+
+// An endpoint that carries a byte stream between two processes on the same
+// host through a pair of single-producer/single-consumer rings in a memfd
+// segment, one per direction. Each side owns an eventfd that the other side
+// signals only when the owner has announced that it is about to sleep, so a
+// busy connection moves data without any syscalls. The unix socket the segment
+// was exchanged over stays open purely to notice the peer going away.
+
+namespace grpc_core {
+
+// File descriptors describing one shared-memory connection. The first wakeup
+// fd belongs to the client, the second to the server.
+struct ShmSegmentFds {
+  int memfd = -1;
+  int wakeup_fds[2] = {-1, -1};
+};
+
+// Closes every valid fd in \a fds and resets them to -1.
+void ShmSegmentFdsClose(ShmSegmentFds* fds);
+
+// Allocates and initialises a segment whose rings hold \a ring_size bytes
+// each. \a ring_size must be a power of two. Used by the accepting side.
+grpc_error_handle ShmSegmentCreate(size_t ring_size, ShmSegmentFds* fds);
+
+// Creates an endpoint over the segment in \a fds, taking ownership of all of
+// them as well as \a socket_fd. On failure everything is closed and nullptr is
+// returned with \a error set.
+grpc_endpoint* ShmEndpointCreate(grpc_fd* socket_fd, ShmSegmentFds fds,
+                                 bool is_client, absl::string_view peer,
+                                 absl::string_view local_address,
+                                 grpc_error_handle* error);
+
+}  // namespace grpc_core
+
+#endif  // GRPC_LINUX_SHM_TRANSPORT
+
+#endif  // GRPC_CORE_EXT_TRANSPORT_SHM_SHM_ENDPOINT_H
@@ -0,0 +1,589 @@
+//
+//
+// Copyright 2022 gRPC authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+//
+
+#include <grpc/support/port_platform.h>
+
+#include "src/core/ext/transport/shm/shm_handshaker.h"
+
+#include "src/core/lib/iomgr/port.h"
+
+#ifdef GRPC_LINUX_SHM_TRANSPORT
+
+#include <errno.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <memory>
+#include <string>
+
+#include "absl/base/thread_annotations.h"
+#include "absl/memory/memory.h"
+
+#include <grpc/impl/codegen/grpc_types.h>
+#include <grpc/slice.h>
+#include <grpc/slice_buffer.h>
+#include <grpc/support/alloc.h>
+
+#include "src/core/ext/transport/shm/shm_endpoint.h"
+#include "src/core/lib/channel/channel_args.h"
+#include "src/core/lib/gpr/useful.h"
+#include "src/core/lib/gprpp/debug_location.h"
+#include "src/core/lib/gprpp/ref_counted_ptr.h"
+#include "src/core/lib/gprpp/sync.h"
+#include "src/core/lib/iomgr/closure.h"
+#include "src/core/lib/iomgr/endpoint.h"
+#include "src/core/lib/iomgr/error.h"
+#include "src/core/lib/iomgr/ev_posix.h"
+#include "src/core/lib/iomgr/exec_ctx.h"
+#include "src/core/lib/iomgr/iomgr_fwd.h"
+#include "src/core/lib/iomgr/pollset_set.h"
+#include "src/core/lib/iomgr/tcp_posix.h"
+#include "src/core/lib/slice/slice_internal.h"
+#include "src/core/lib/transport/handshaker.h"
+#include "src/core/lib/transport/handshaker_factory.h"
+#include "src/core/lib/transport/handshaker_registry.h"
+
+#endif  // GRPC_LINUX_SHM_TRANSPORT
+
+namespace grpc_core {
+
+#ifdef GRPC_LINUX_SHM_TRANSPORT
+
+namespace {
+
+// The handshake is one message each way on the unix socket. The client's
+// hello starts with a NUL byte, which can never begin an HTTP/2 preface or a
+// TLS record, so the server can tell it apart from a regular client by the
+// first byte. The server answers with the segment and wakeup fds attached.
+constexpr char kShmClientHello[] = "\0GRPC-SHM-HELLO1";
+constexpr char kShmServerReady[] = "\0GRPC-SHM-READY1";
+constexpr size_t kShmHandshakeMessageSize = sizeof(kShmClientHello) - 1;
+static_assert(sizeof(kShmServerReady) - 1 == kShmHandshakeMessageSize,
+              "handshake messages must have the same size");
+constexpr int kShmHandshakeFdCount = 3;
+
+constexpr int kDefaultShmRingSize = 1024 * 1024;
+constexpr int kMinShmRingSize = 64 * 1024;
+constexpr int kMaxShmRingSize = 64 * 1024 * 1024;
+
+bool IsUnixSocket(int fd) {
+  if (fd < 0) return false;
+  struct sockaddr_storage addr;
+  socklen_t len = sizeof(addr);
+  return getsockname(fd, reinterpret_cast<struct sockaddr*>(&addr), &len) ==
+             0 &&
+         addr.ss_family == AF_UNIX;
+}
+
+// Copies the first \a n bytes of \a buffer, which must hold at least that
+// many, without consuming them.
+void PeekSliceBuffer(const grpc_slice_buffer* buffer, size_t n, char* dst) {
+  for (size_t i = 0; n > 0; ++i) {
+    const grpc_slice& slice = buffer->slices[i];
+    const size_t len = std::min(n, GRPC_SLICE_LENGTH(slice));
+    memcpy(dst, GRPC_SLICE_START_PTR(slice), len);
+    dst += len;
+    n -= len;
+  }
+}
+
+//
+// ShmHandshaker
+//
+
+// State shared by both sides: each starts on the tcp endpoint, takes its fd
+// back and ends by handing args->endpoint a shared-memory endpoint.
+class ShmHandshaker : public Handshaker {
+ public:
+  explicit ShmHandshaker(grpc_pollset_set* interested_parties)
+      : interested_parties_(interested_parties) {}
+
+  void Shutdown(grpc_error_handle why) override;
+
+ protected:
+  ~ShmHandshaker() override;
+
+  void CleanupArgsForFailureLocked() ABSL_EXCLUSIVE_LOCKS_REQUIRED(mu_);
+  void HandshakeFailedLocked(grpc_error_handle error)
+      ABSL_EXCLUSIVE_LOCKS_REQUIRED(mu_);
+  // Detaches the fd from args_->endpoint, destroying the endpoint. Invokes
+  // \a on_released once fd_ is valid.
+  void ReleaseSocketLocked(grpc_closure* on_released)
+      ABSL_EXCLUSIVE_LOCKS_REQUIRED(mu_);
+  // Wraps fd_ in socket_fd_ so that it can be polled.
+  void WrapSocketLocked() ABSL_EXCLUSIVE_LOCKS_REQUIRED(mu_);
+  // Finishes the handshake with a shared-memory endpoint over \a fds.
+  void FinishLocked(ShmSegmentFds fds, bool is_client)
+      ABSL_EXCLUSIVE_LOCKS_REQUIRED(mu_);
+
+  Mutex mu_;
+  bool is_shutdown_ ABSL_GUARDED_BY(mu_) = false;
+  // Endpoint and read buffer to destroy after a shutdown.
+  grpc_endpoint* endpoint_to_destroy_ ABSL_GUARDED_BY(mu_) = nullptr;
+  grpc_slice_buffer* read_buffer_to_destroy_ ABSL_GUARDED_BY(mu_) = nullptr;
+  grpc_pollset_set* const interested_parties_;
+  grpc_closure* on_handshake_done_ = nullptr;
+  HandshakerArgs* args_ = nullptr;
+  std::string peer_;
+  std::string local_address_;
+  // The released socket, first bare and then wrapped.
+  int fd_ = -1;
+  grpc_fd* socket_fd_ = nullptr;
+};
+
+ShmHandshaker::~ShmHandshaker() {
+  if (endpoint_to_destroy_ != nullptr) {
+    grpc_endpoint_destroy(endpoint_to_destroy_);
+  }
+  if (read_buffer_to_destroy_ != nullptr) {
+    grpc_slice_buffer_destroy_internal(read_buffer_to_destroy_);
+    gpr_free(read_buffer_to_destroy_);
+  }
+  if (socket_fd_ != nullptr) {
+    if (interested_parties_ != nullptr) {
+      grpc_pollset_set_del_fd(interested_parties_, socket_fd_);
+    }
+    grpc_fd_orphan(socket_fd_, nullptr, nullptr, "shm_handshaker");
+  } else if (fd_ >= 0) {
+    close(fd_);
+  }
+}
+
+void ShmHandshaker::Shutdown(grpc_error_handle why) {
+  {
+    MutexLock lock(&mu_);
+    if (!is_shutdown_) {
+      is_shutdown_ = true;
+      // Whichever operation is in flight fails and reports the shutdown.
+      if (args_->endpoint != nullptr) {
+        grpc_endpoint_shutdown(args_->endpoint, GRPC_ERROR_REF(why));
+      }
+      if (socket_fd_ != nullptr) {
+        grpc_fd_shutdown(socket_fd_, GRPC_ERROR_REF(why));
+      }
+      CleanupArgsForFailureLocked();
+    }
+  }
+  GRPC_ERROR_UNREF(why);
+}
+
+void ShmHandshaker::CleanupArgsForFailureLocked() {
+  endpoint_to_destroy_ = args_->endpoint;
+  args_->endpoint = nullptr;
+  read_buffer_to_destroy_ = args_->read_buffer;
+  args_->read_buffer = nullptr;
+  args_->args = ChannelArgs();
+}
+
+void ShmHandshaker::HandshakeFailedLocked(grpc_error_handle error) {
+  if (GRPC_ERROR_IS_NONE(error)) {
+    error = GRPC_ERROR_CREATE_FROM_STATIC_STRING("Handshaker shutdown");
+  }
+  if (!is_shutdown_) {
+    if (args_->endpoint != nullptr) {
+      grpc_endpoint_shutdown(args_->endpoint, GRPC_ERROR_REF(error));
+    }
+    CleanupArgsForFailureLocked();
+    is_shutdown_ = true;
+  }
+  ExecCtx::Run(DEBUG_LOCATION, on_handshake_done_, error);
+}
+
+void ShmHandshaker::ReleaseSocketLocked(grpc_closure* on_released) {
+  peer_ = std::string(grpc_endpoint_get_peer(args_->endpoint));
+  local_address_ =
+      std::string(grpc_endpoint_get_local_address(args_->endpoint));
+  Ref().release();  // Ref held by on_released.
+  grpc_tcp_destroy_and_release_fd(args_->endpoint, &fd_, on_released);
+  args_->endpoint = nullptr;
+}
+
+void ShmHandshaker::WrapSocketLocked() {
+  socket_fd_ = grpc_fd_create(fd_, "shm_handshaker", false);
+  fd_ = -1;
+  if (interested_parties_ != nullptr) {
+    grpc_pollset_set_add_fd(interested_parties_, socket_fd_);
+  }
+}
+
+void ShmHandshaker::FinishLocked(ShmSegmentFds fds, bool is_client) {
+  if (interested_parties_ != nullptr) {
+    grpc_pollset_set_del_fd(interested_parties_, socket_fd_);
+  }
+  grpc_fd* socket_fd = socket_fd_;
+  socket_fd_ = nullptr;
+  grpc_error_handle error = GRPC_ERROR_NONE;
+  args_->endpoint = ShmEndpointCreate(socket_fd, fds, is_client, peer_,
+                                      local_address_, &error);
+  if (args_->endpoint == nullptr) {
+    HandshakeFailedLocked(error);
+    return;
+  }
+  is_shutdown_ = true;
+  ExecCtx::Run(DEBUG_LOCATION, on_handshake_done_, GRPC_ERROR_NONE);
+}
+
+//
+// ShmClientHandshaker
+//
+
+class ShmClientHandshaker : public ShmHandshaker {
+ public:
+  explicit ShmClientHandshaker(grpc_pollset_set* interested_parties);
+  void DoHandshake(grpc_tcp_server_acceptor* acceptor,
+                   grpc_closure* on_handshake_done,
+                   HandshakerArgs* args) override;
+  const char* name() const override { return "shm_client"; }
+
+ private:
+  static void OnSocketReleased(void* arg, grpc_error_handle error);
+  static void OnReplyReadable(void* arg, grpc_error_handle error);
+
+  grpc_closure on_socket_released_;
+  grpc_closure on_reply_readable_;
+};
+
+ShmClientHandshaker::ShmClientHandshaker(grpc_pollset_set* interested_parties)
+    : ShmHandshaker(interested_parties) {
+  GRPC_CLOSURE_INIT(&on_socket_released_, OnSocketReleased, this,
+                    grpc_schedule_on_exec_ctx);
+  GRPC_CLOSURE_INIT(&on_reply_readable_, OnReplyReadable, this,
+                    grpc_schedule_on_exec_ctx);
+}
+
+void ShmClientHandshaker::DoHandshake(grpc_tcp_server_acceptor* /*acceptor*/,
+                                      grpc_closure* on_handshake_done,
+                                      HandshakerArgs* args) {
+  MutexLock lock(&mu_);
+  on_handshake_done_ = on_handshake_done;
+  args_ = args;
+  // Only unix sockets can pass fds; leave anything else alone.
+  if (!IsUnixSocket(grpc_endpoint_get_fd(args->endpoint))) {
+    is_shutdown_ = true;
+    ExecCtx::Run(DEBUG_LOCATION, on_handshake_done, GRPC_ERROR_NONE);
+    return;
+  }
+  ReleaseSocketLocked(&on_socket_released_);
+}
+
+void ShmClientHandshaker::OnSocketReleased(void* arg,
+                                           grpc_error_handle /*error*/) {
+  RefCountedPtr<ShmClientHandshaker> self(
+      static_cast<ShmClientHandshaker*>(arg));
+  MutexLock lock(&self->mu_);
+  if (self->is_shutdown_) {
+    self->HandshakeFailedLocked(GRPC_ERROR_NONE);
+    return;
+  }
+  ssize_t sent;
+  do {
+    sent = send(self->fd_, kShmClientHello, kShmHandshakeMessageSize,
+                MSG_NOSIGNAL);
+  } while (sent < 0 && errno == EINTR);
+  if (sent != static_cast<ssize_t>(kShmHandshakeMessageSize)) {
+    self->HandshakeFailedLocked(
+        sent < 0 ? GRPC_OS_ERROR(errno, "send")
+                 : GRPC_ERROR_CREATE_FROM_STATIC_STRING(
+                       "Short write of shm handshake"));
+    return;
+  }
+  self->WrapSocketLocked();
+  self->Ref().release();  // Ref held by on_reply_readable_.
+  grpc_fd_notify_on_read(self->socket_fd_, &self->on_reply_readable_);
+}
+
+void ShmClientHandshaker::OnReplyReadable(void* arg, grpc_error_handle error) {
+  RefCountedPtr<ShmClientHandshaker> self(
+      static_cast<ShmClientHandshaker*>(arg));
+  MutexLock lock(&self->mu_);
+  if (!GRPC_ERROR_IS_NONE(error) || self->is_shutdown_) {
+    self->HandshakeFailedLocked(GRPC_ERROR_REF(error));
+    return;
+  }
+  char reply[kShmHandshakeMessageSize];
+  struct iovec iov = {reply, sizeof(reply)};
+  union {
+    char buf[CMSG_SPACE(kShmHandshakeFdCount * sizeof(int))];
+    struct cmsghdr align;
+  } control;
+  struct msghdr msg;
+  memset(&msg, 0, sizeof(msg));
+  msg.msg_iov = &iov;
+  msg.msg_iovlen = 1;
+  msg.msg_control = control.buf;
+  msg.msg_controllen = sizeof(control.buf);
+  ssize_t received;
+  do {
+    received = recvmsg(grpc_fd_wrapped_fd(self->socket_fd_), &msg,
+                       MSG_DONTWAIT | MSG_CMSG_CLOEXEC);
+  } while (received < 0 && errno == EINTR);
+  const int recv_errno = errno;
+  if (received < 0 && recv_errno == EAGAIN) {
+    // Ref held by on_reply_readable_.
+    ShmClientHandshaker* handshaker = self.release();
+    grpc_fd_notify_on_read(handshaker->socket_fd_,
+                           &handshaker->on_reply_readable_);
+    return;
+  }
+  int fds[kShmHandshakeFdCount] = {-1, -1, -1};
+  size_t fd_count = 0;
+  for (struct cmsghdr* cmsg = CMSG_FIRSTHDR(&msg); cmsg != nullptr;
+       cmsg = CMSG_NXTHDR(&msg, cmsg)) {
+    if (cmsg->cmsg_level != SOL_SOCKET || cmsg->cmsg_type != SCM_RIGHTS) {
+      continue;
+    }
+    const int* data = reinterpret_cast<const int*>(CMSG_DATA(cmsg));
+    const size_t n = (cmsg->cmsg_len - CMSG_LEN(0)) / sizeof(int);
+    for (size_t i = 0; i < n; ++i) {
+      if (fd_count < kShmHandshakeFdCount) {
+        fds[fd_count++] = data[i];
+      } else {
+        close(data[i]);
+      }
+    }
+  }
+  ShmSegmentFds segment_fds;
+  segment_fds.memfd = fds[0];
+  segment_fds.wakeup_fds[0] = fds[1];
+  segment_fds.wakeup_fds[1] = fds[2];
+  grpc_error_handle reply_error = GRPC_ERROR_NONE;
+  if (received < 0) {
+    reply_error = GRPC_OS_ERROR(recv_errno, "recvmsg");
+  } else if (received != static_cast<ssize_t>(kShmHandshakeMessageSize) ||
+             memcmp(reply, kShmServerReady, kShmHandshakeMessageSize) != 0) {
+    // A server without the handshaker treats the hello as a bad HTTP/2
+    // preface and answers with a GOAWAY or just closes the connection.
+    reply_error = GRPC_ERROR_CREATE_FROM_STATIC_STRING(
+        "Server did not accept the shm handshake; it may not have "
+        GRPC_ARG_SHM_TRANSPORT " enabled");
+  } else if (fd_count != kShmHandshakeFdCount) {
+    reply_error =
+        GRPC_ERROR_CREATE_FROM_STATIC_STRING("Malformed shm handshake reply");
+  }
+  if (!GRPC_ERROR_IS_NONE(reply_error)) {
+    ShmSegmentFdsClose(&segment_fds);
+    self->HandshakeFailedLocked(reply_error);
+    return;
+  }
+  self->FinishLocked(segment_fds, /*is_client=*/true);
+}
+
+//
+// ShmServerHandshaker
+//
+
+class ShmServerHandshaker : public ShmHandshaker {
+ public:
+  ShmServerHandshaker(grpc_pollset_set* interested_parties, size_t ring_size);
+  void DoHandshake(grpc_tcp_server_acceptor* acceptor,
+                   grpc_closure* on_handshake_done,
+                   HandshakerArgs* args) override;
+  const char* name() const override { return "shm_server"; }
+
+ private:
+  ~ShmServerHandshaker() override;
+
+  void ReadLocked() ABSL_EXCLUSIVE_LOCKS_REQUIRED(mu_);
+  static void OnHelloRead(void* arg, grpc_error_handle error);
+  static void OnSocketReleased(void* arg, grpc_error_handle error);
+
+  const size_t ring_size_;
+  grpc_slice_buffer incoming_;
+  ShmSegmentFds segment_fds_;
+  grpc_closure on_hello_read_;
+  grpc_closure on_socket_released_;
+};
+
+ShmServerHandshaker::ShmServerHandshaker(grpc_pollset_set* interested_parties,
+                                         size_t ring_size)
+    : ShmHandshaker(interested_parties), ring_size_(ring_size) {
+  grpc_slice_buffer_init(&incoming_);
+  GRPC_CLOSURE_INIT(&on_hello_read_, OnHelloRead, this,
+                    grpc_schedule_on_exec_ctx);
+  GRPC_CLOSURE_INIT(&on_socket_released_, OnSocketReleased, this,
+                    grpc_schedule_on_exec_ctx);
+}
+
+ShmServerHandshaker::~ShmServerHandshaker() {
+  grpc_slice_buffer_destroy_internal(&incoming_);
+  ShmSegmentFdsClose(&segment_fds_);
+}
+
+void ShmServerHandshaker::DoHandshake(grpc_tcp_server_acceptor* /*acceptor*/,
+                                      grpc_closure* on_handshake_done,
+                                      HandshakerArgs* args) {
+  MutexLock lock(&mu_);
+  on_handshake_done_ = on_handshake_done;
+  args_ = args;
+  if (!IsUnixSocket(grpc_endpoint_get_fd(args->endpoint))) {
+    is_shutdown_ = true;
+    ExecCtx::Run(DEBUG_LOCATION, on_handshake_done, GRPC_ERROR_NONE);
+    return;
+  }
+  ReadLocked();
+}
+
+void ShmServerHandshaker::ReadLocked() {
+  Ref().release();  // Ref held by on_hello_read_.
+  grpc_endpoint_read(args_->endpoint, &incoming_, &on_hello_read_,
+                     /*urgent=*/true, /*min_progress_size=*/1);
+}
+
+void ShmServerHandshaker::OnHelloRead(void* arg, grpc_error_handle error) {
+  RefCountedPtr<ShmServerHandshaker> self(
+      static_cast<ShmServerHandshaker*>(arg));
+  MutexLock lock(&self->mu_);
+  if (!GRPC_ERROR_IS_NONE(error) || self->is_shutdown_) {
+    self->HandshakeFailedLocked(GRPC_ERROR_REF(error));
+    return;
+  }
+  grpc_slice_buffer* read_buffer = self->args_->read_buffer;
+  grpc_slice_buffer_move_into(&self->incoming_, read_buffer);
+  if (read_buffer->length == 0) {
+    self->ReadLocked();
+    return;
+  }
+  char hello[kShmHandshakeMessageSize];
+  PeekSliceBuffer(read_buffer, 1, hello);
+  if (hello[0] != kShmClientHello[0]) {
+    // A regular client: leave what was read for the next handshaker.
+    self->is_shutdown_ = true;
+    ExecCtx::Run(DEBUG_LOCATION, self->on_handshake_done_, GRPC_ERROR_NONE);
+    return;
+  }
+  if (read_buffer->length < kShmHandshakeMessageSize) {
+    self->ReadLocked();
+    return;
+  }
+  PeekSliceBuffer(read_buffer, kShmHandshakeMessageSize, hello);
+  // The client sends nothing else until it has the reply.
+  if (read_buffer->length != kShmHandshakeMessageSize ||
+      memcmp(hello, kShmClientHello, kShmHandshakeMessageSize) != 0) {
+    self->HandshakeFailedLocked(
+        GRPC_ERROR_CREATE_FROM_STATIC_STRING("Malformed shm handshake"));
+    return;
+  }
+  grpc_slice_buffer_reset_and_unref_internal(read_buffer);
+  grpc_error_handle segment_error =
+      ShmSegmentCreate(self->ring_size_, &self->segment_fds_);
+  if (!GRPC_ERROR_IS_NONE(segment_error)) {
+    self->HandshakeFailedLocked(segment_error);
+    return;
+  }
+  self->ReleaseSocketLocked(&self->on_socket_released_);
+}
+
+void ShmServerHandshaker::OnSocketReleased(void* arg,
+                                           grpc_error_handle /*error*/) {
+  RefCountedPtr<ShmServerHandshaker> self(
+      static_cast<ShmServerHandshaker*>(arg));
+  MutexLock lock(&self->mu_);
+  if (self->is_shutdown_) {
+    self->HandshakeFailedLocked(GRPC_ERROR_NONE);
+    return;
+  }
+  const int fds[kShmHandshakeFdCount] = {self->segment_fds_.memfd,
+                                         self->segment_fds_.wakeup_fds[0],
+                                         self->segment_fds_.wakeup_fds[1]};
+  struct iovec iov = {const_cast<char*>(kShmServerReady),
+                      kShmHandshakeMessageSize};
+  union {
+    char buf[CMSG_SPACE(sizeof(fds))];
+    struct cmsghdr align;
+  } control;
+  memset(&control, 0, sizeof(control));
+  struct msghdr msg;
+  memset(&msg, 0, sizeof(msg));
+  msg.msg_iov = &iov;
+  msg.msg_iovlen = 1;
+  msg.msg_control = control.buf;
+  msg.msg_controllen = sizeof(control.buf);
+  struct cmsghdr* cmsg = CMSG_FIRSTHDR(&msg);
+  cmsg->cmsg_level = SOL_SOCKET;
+  cmsg->cmsg_type = SCM_RIGHTS;
+  cmsg->cmsg_len = CMSG_LEN(sizeof(fds));
+  memcpy(CMSG_DATA(cmsg), fds, sizeof(fds));
+  ssize_t sent;
+  do {
+    sent = sendmsg(self->fd_, &msg, MSG_NOSIGNAL);
+  } while (sent < 0 && errno == EINTR);
+  if (sent != static_cast<ssize_t>(kShmHandshakeMessageSize)) {
+    self->HandshakeFailedLocked(
+        sent < 0 ? GRPC_OS_ERROR(errno, "sendmsg")
+                 : GRPC_ERROR_CREATE_FROM_STATIC_STRING(
+                       "Short write of shm handshake"));
+    return;
+  }
+  self->WrapSocketLocked();
+  ShmSegmentFds segment_fds = self->segment_fds_;
+  self->segment_fds_ = ShmSegmentFds();
+  self->FinishLocked(segment_fds, /*is_client=*/false);
+}
+
+//
+// Factories
+//
+
+class ShmClientHandshakerFactory : public HandshakerFactory {
+ public:
+  void AddHandshakers(const ChannelArgs& args,
+                      grpc_pollset_set* interested_parties,
+                      HandshakeManager* handshake_mgr) override {
+    if (!args.GetBool(GRPC_ARG_SHM_TRANSPORT).value_or(false)) return;
+    handshake_mgr->Add(MakeRefCounted<ShmClientHandshaker>(interested_parties));
+  }
+  ~ShmClientHandshakerFactory() override = default;
+};
+
+class ShmServerHandshakerFactory : public HandshakerFactory {
+ public:
+  void AddHandshakers(const ChannelArgs& args,
+                      grpc_pollset_set* interested_parties,
+                      HandshakeManager* handshake_mgr) override {
+    if (!args.GetBool(GRPC_ARG_SHM_TRANSPORT).value_or(false)) return;
+    const int requested = Clamp(args.GetInt(GRPC_ARG_SHM_TRANSPORT_RING_SIZE)
+                                    .value_or(kDefaultShmRingSize),
+                                kMinShmRingSize, kMaxShmRingSize);
+    size_t ring_size = kMinShmRingSize;
+    while (ring_size < static_cast<size_t>(requested)) ring_size *= 2;
+    handshake_mgr->Add(
+        MakeRefCounted<ShmServerHandshaker>(interested_parties, ring_size));
+  }
+  ~ShmServerHandshakerFactory() override = default;
+};
+
+}  // namespace
+
+void RegisterShmHandshaker(CoreConfiguration::Builder* builder) {
+  builder->handshaker_registry()->RegisterHandshakerFactory(
+      true /* at_start */, HANDSHAKER_CLIENT,
+      absl::make_unique<ShmClientHandshakerFactory>());
+  builder->handshaker_registry()->RegisterHandshakerFactory(
+      true /* at_start */, HANDSHAKER_SERVER,
+      absl::make_unique<ShmServerHandshakerFactory>());
+}
+
+#else  // GRPC_LINUX_SHM_TRANSPORT
+
+void RegisterShmHandshaker(CoreConfiguration::Builder* /*builder*/) {}
+
+#endif  // GRPC_LINUX_SHM_TRANSPORT
+
+}  // namespace grpc_core
@@ -0,0 +1,36 @@
+//
+//
+// Copyright 2022 gRPC authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+//
+
+#ifndef GRPC_CORE_EXT_TRANSPORT_SHM_SHM_HANDSHAKER_H
+#define GRPC_CORE_EXT_TRANSPORT_SHM_SHM_HANDSHAKER_H
+
+#include <grpc/support/port_platform.h>
+
+#include "src/core/lib/config/core_configuration.h"
+
+namespace grpc_core {
+
+// Register the handshakers that move unix socket connections onto the
+// shared-memory endpoint when GRPC_ARG_SHM_TRANSPORT is set. They must be
+// registered before the TCP connect handshaker so that they run right after
+// it on clients, and ahead of security on both sides.
+void RegisterShmHandshaker(CoreConfiguration::Builder* builder);
+
+}  // namespace grpc_core
+
+#endif  // GRPC_CORE_EXT_TRANSPORT_SHM_SHM_HANDSHAKER_H
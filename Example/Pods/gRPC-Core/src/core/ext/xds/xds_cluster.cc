@@ -46,6 +46,7 @@
 
 #include <grpc/support/log.h>
 
+#include "src/core/ext/filters/client_channel/lb_policy/maglev/maglev.h"
 #include "src/core/ext/xds/upb_utils.h"
 #include "src/core/ext/xds/xds_common_types.h"
 #include "src/core/ext/xds/xds_resource_type.h"
@@ -91,6 +92,8 @@ std::string XdsClusterResource::ToString() const {
   if (lb_policy == "RING_HASH") {
     contents.push_back(absl::StrCat("min_ring_size=", min_ring_size));
     contents.push_back(absl::StrCat("max_ring_size=", max_ring_size));
+  } else if (lb_policy == "MAGLEV") {
+    contents.push_back(absl::StrCat("maglev_table_size=", maglev_table_size));
   }
   contents.push_back(
       absl::StrFormat("max_concurrent_requests=%d", max_concurrent_requests));
@@ -331,6 +334,27 @@ absl::StatusOr<XdsClusterResource> CdsResourceParse(
         errors.emplace_back("ring hash lb config has invalid hash function.");
       }
     }
+  } else if (XdsMaglevEnabled() &&
+             envoy_config_cluster_v3_Cluster_lb_policy(cluster) ==
+                 envoy_config_cluster_v3_Cluster_MAGLEV) {
+    cds_update.lb_policy = "MAGLEV";
+    // Record maglev lb config
+    auto* maglev_config =
+        envoy_config_cluster_v3_Cluster_maglev_lb_config(cluster);
+    if (maglev_config != nullptr) {
+      const google_protobuf_UInt64Value* table_size =
+          envoy_config_cluster_v3_Cluster_MaglevLbConfig_table_size(
+              maglev_config);
+      if (table_size != nullptr) {
+        cds_update.maglev_table_size =
+            google_protobuf_UInt64Value_value(table_size);
+        absl::Status status =
+            ValidateMaglevTableSize(cds_update.maglev_table_size);
+        if (!status.ok()) {
+          errors.emplace_back(std::string(status.message()));
+        }
+      }
+    }
   } else {
     errors.emplace_back("LB policy is not supported.");
   }
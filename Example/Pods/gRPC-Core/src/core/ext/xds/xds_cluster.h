@@ -63,11 +63,13 @@ struct XdsClusterResource {
   // If not set, load reporting will be disabled.
   absl::optional<XdsBootstrap::XdsServer> lrs_load_reporting_server;
 
-  // The LB policy to use (e.g., "ROUND_ROBIN" or "RING_HASH").
+  // The LB policy to use (e.g., "ROUND_ROBIN", "RING_HASH" or "MAGLEV").
   std::string lb_policy;
   // Used for RING_HASH LB policy only.
   uint64_t min_ring_size = 1024;
   uint64_t max_ring_size = 8388608;
+  // Used for MAGLEV LB policy only.
+  uint64_t maglev_table_size = 65537;
   // Maximum number of outstanding requests can be made to the upstream
   // cluster.
   uint32_t max_concurrent_requests = 1024;
@@ -83,6 +85,7 @@ struct XdsClusterResource {
            lrs_load_reporting_server == other.lrs_load_reporting_server &&
            lb_policy == other.lb_policy &&
            min_ring_size == other.min_ring_size &&
+           maglev_table_size == other.maglev_table_size &&
            max_ring_size == other.max_ring_size &&
            max_concurrent_requests == other.max_concurrent_requests &&
            outlier_detection == other.outlier_detection;
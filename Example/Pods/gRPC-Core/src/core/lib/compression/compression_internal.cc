@@ -20,17 +20,27 @@
 
 #include "src/core/lib/compression/compression_internal.h"
 
+#include <inttypes.h>
+#include <limits.h>
 #include <stdlib.h>
 #include <string.h>
 
+#include <string>
+#include <utility>
+
 #include "absl/container/inlined_vector.h"
 #include "absl/strings/ascii.h"
 #include "absl/strings/str_split.h"
 
+#include <zlib.h>
+
 #include <grpc/support/log.h>
 
 #include "src/core/lib/channel/channel_args.h"
 #include "src/core/lib/debug/trace.h"
+#include "src/core/lib/gprpp/ref_counted_ptr.h"
+#include "src/core/lib/iomgr/error.h"
+#include "src/core/lib/iomgr/load_file.h"
 #include "src/core/lib/surface/api_trace.h"
 
 namespace grpc_core {
@@ -246,4 +256,38 @@ DefaultCompressionAlgorithmFromChannelArgs(const grpc_channel_args* args) {
   return absl::nullopt;
 }
 
+DeflateDictionary::DeflateDictionary(Slice data)
+    : data_(std::move(data)),
+      id_(adler32(adler32(0, nullptr, 0), data_.begin(),
+                  static_cast<uInt>(data_.size()))) {}
+
+ChannelArgs LoadDeflateDictionary(ChannelArgs args) {
+  if (args.GetObject<DeflateDictionary>() != nullptr) return args;
+  auto path = args.GetString(GRPC_ARG_DEFLATE_DICTIONARY_FILE);
+  if (!path.has_value()) return args;
+  grpc_slice dictionary;
+  grpc_error_handle error =
+      grpc_load_file(std::string(*path).c_str(), 0, &dictionary);
+  if (!GRPC_ERROR_IS_NONE(error)) {
+    gpr_log(GPR_ERROR, "could not load deflate dictionary: %s",
+            grpc_error_std_string(error).c_str());
+    GRPC_ERROR_UNREF(error);
+    return args;
+  }
+  Slice data(dictionary);
+  if (data.empty() || data.size() > UINT_MAX) {
+    gpr_log(GPR_ERROR, "ignoring deflate dictionary of %" PRIuPTR " bytes",
+            data.size());
+    return args;
+  }
+  return args.SetObject(MakeRefCounted<DeflateDictionary>(std::move(data)));
+}
+
+size_t CompressionOffloadThresholdFromChannelArgs(
+    const grpc_channel_args* args) {
+  return grpc_channel_args_find_integer(
+      args, GRPC_ARG_COMPRESSION_OFFLOAD_THRESHOLD,
+      grpc_integer_options{0, 0, INT_MAX});
+}
+
 }  // namespace grpc_core
@@ -21,6 +21,7 @@
 
 #include <grpc/support/port_platform.h>
 
+#include <stddef.h>
 #include <stdint.h>
 
 #include <initializer_list>
@@ -31,7 +32,10 @@
 #include <grpc/impl/codegen/compression_types.h>
 #include <grpc/impl/codegen/grpc_types.h>
 
+#include "src/core/lib/channel/channel_args.h"
+#include "src/core/lib/gpr/useful.h"
 #include "src/core/lib/gprpp/bitset.h"
+#include "src/core/lib/gprpp/ref_counted.h"
 #include "src/core/lib/slice/slice.h"
 
 namespace grpc_core {
@@ -47,6 +51,11 @@ const char* CompressionAlgorithmAsString(grpc_compression_algorithm algorithm);
 // if not found.
 absl::optional<grpc_compression_algorithm>
 DefaultCompressionAlgorithmFromChannelArgs(const grpc_channel_args* args);
+// Retrieve the message size at which (de)compression is moved off the call
+// path (see GRPC_ARG_COMPRESSION_OFFLOAD_THRESHOLD). 0, the default, means
+// never.
+size_t CompressionOffloadThresholdFromChannelArgs(
+    const grpc_channel_args* args);
 
 // A set of grpc_compression_algorithm values.
 class CompressionAlgorithmSet {
@@ -88,6 +97,34 @@ class CompressionAlgorithmSet {
   BitSet<GRPC_COMPRESS_ALGORITHMS_COUNT> set_;
 };
 
+// A preset dictionary for the deflate algorithm, loaded from the file named
+// by GRPC_ARG_DEFLATE_DICTIONARY_FILE. It is loaded once when the channel is
+// created and shared by the filters of all of its stacks via channel args.
+class DeflateDictionary : public RefCounted<DeflateDictionary> {
+ public:
+  explicit DeflateDictionary(Slice data);
+
+  static absl::string_view ChannelArgName() {
+    return "grpc.internal.deflate_dictionary";
+  }
+  static int ChannelArgsCompare(const DeflateDictionary* a,
+                                const DeflateDictionary* b) {
+    return QsortCompare(a->data_.as_string_view(), b->data_.as_string_view());
+  }
+
+  const Slice& data() const { return data_; }
+  // zlib's id for the dictionary (its Adler-32 checksum). Never 0.
+  uint32_t id() const { return id_; }
+
+ private:
+  const Slice data_;
+  const uint32_t id_;
+};
+
+// Channel args preconditioning stage that loads the deflate dictionary, if
+// GRPC_ARG_DEFLATE_DICTIONARY_FILE names one and it is not loaded yet.
+ChannelArgs LoadDeflateDictionary(ChannelArgs args);
+
 }  // namespace grpc_core
 
 #endif /* GRPC_CORE_LIB_COMPRESSION_COMPRESSION_INTERNAL_H */
@@ -22,6 +22,10 @@
 
 #include <string.h>
 
+#include <vector>
+
+#include "absl/base/thread_annotations.h"
+
 #include <zconf.h>
 #include <zlib.h>
 
@@ -29,12 +33,14 @@
 #include <grpc/support/alloc.h>
 #include <grpc/support/log.h>
 
+#include "src/core/lib/gprpp/no_destruct.h"
+#include "src/core/lib/gprpp/sync.h"
 #include "src/core/lib/slice/slice_refcount.h"
 
 #define OUTPUT_BLOCK_SIZE 1024
 
-static int zlib_body(z_stream* zs, grpc_slice_buffer* input,
-                     grpc_slice_buffer* output,
+static int zlib_body(z_stream* zs, grpc_slice dictionary,
+                     grpc_slice_buffer* input, grpc_slice_buffer* output,
                      int (*flate)(z_stream* zs, int flush)) {
   int r = Z_STREAM_END; /* Do not fail on an empty input. */
   int flush;
@@ -60,6 +66,20 @@ static int zlib_body(z_stream* zs, grpc_slice_buffer* input,
         zs->next_out = GRPC_SLICE_START_PTR(outbuf);
       }
       r = flate(zs, flush);
+      if (r == Z_NEED_DICT) {
+        /* Only inflate asks for this, at the start of a stream that was
+           primed with a preset dictionary. zlib checks that the one we
+           supply is the one the sender used. */
+        GPR_ASSERT(GRPC_SLICE_LENGTH(dictionary) <= uint_max);
+        if (GRPC_SLICE_LENGTH(dictionary) == 0 ||
+            inflateSetDictionary(
+                zs, GRPC_SLICE_START_PTR(dictionary),
+                static_cast<uInt> GRPC_SLICE_LENGTH(dictionary)) != Z_OK) {
+          gpr_log(GPR_INFO, "zlib: missing or mismatched preset dictionary");
+          goto error;
+        }
+        r = flate(zs, flush);
+      }
       if (r < 0 && r != Z_BUF_ERROR /* not fatal */) {
         gpr_log(GPR_INFO, "zlib error (%d)", r);
         goto error;
@@ -93,20 +113,96 @@ static void* zalloc_gpr(void* /*opaque*/, unsigned int items,
 
 static void zfree_gpr(void* /*opaque*/, void* address) { gpr_free(address); }
 
-static int zlib_compress(grpc_slice_buffer* input, grpc_slice_buffer* output,
-                         int gzip) {
-  z_stream zs;
+namespace {
+
+enum ZlibStreamKind {
+  kDeflate,
+  kDeflateGzip,
+  kInflate,
+  kInflateGzip,
+  kNumZlibStreamKinds,
+};
+
+/* Setting up a z_stream allocates its window and hash tables (about 256KiB
+   for deflate), which costs more than compressing a small message. Streams
+   are therefore reset and kept for the next message rather than torn down. */
+class ZlibStreamPool {
+ public:
+  z_stream* Get(ZlibStreamKind kind) {
+    {
+      grpc_core::MutexLock lock(&mu_);
+      std::vector<z_stream*>& idle = idle_[kind];
+      if (!idle.empty()) {
+        z_stream* zs = idle.back();
+        idle.pop_back();
+        return zs;
+      }
+    }
+    z_stream* zs = static_cast<z_stream*>(gpr_zalloc(sizeof(*zs)));
+    zs->zalloc = zalloc_gpr;
+    zs->zfree = zfree_gpr;
+    int r;
+    switch (kind) {
+      case kDeflate:
+      case kDeflateGzip:
+        r = deflateInit2(zs, Z_DEFAULT_COMPRESSION, Z_DEFLATED,
+                         15 | (kind == kDeflateGzip ? 16 : 0), 8,
+                         Z_DEFAULT_STRATEGY);
+        break;
+      default:
+        r = inflateInit2(zs, 15 | (kind == kInflateGzip ? 16 : 0));
+        break;
+    }
+    GPR_ASSERT(r == Z_OK);
+    return zs;
+  }
+
+  void Return(ZlibStreamKind kind, z_stream* zs) {
+    const bool is_deflate = kind == kDeflate || kind == kDeflateGzip;
+    if ((is_deflate ? deflateReset(zs) : inflateReset(zs)) == Z_OK) {
+      grpc_core::MutexLock lock(&mu_);
+      if (idle_[kind].size() < kMaxIdleStreamsPerKind) {
+        idle_[kind].push_back(zs);
+        return;
+      }
+    }
+    if (is_deflate) {
+      deflateEnd(zs);
+    } else {
+      inflateEnd(zs);
+    }
+    gpr_free(zs);
+  }
+
+ private:
+  /* Bounds the memory held by idle streams. */
+  static constexpr size_t kMaxIdleStreamsPerKind = 4;
+
+  grpc_core::Mutex mu_;
+  std::vector<z_stream*> idle_[kNumZlibStreamKinds] ABSL_GUARDED_BY(mu_);
+};
+
+grpc_core::NoDestruct<ZlibStreamPool> g_zlib_stream_pool;
+
+}  // namespace
+
+static int zlib_compress(grpc_slice dictionary, grpc_slice_buffer* input,
+                         grpc_slice_buffer* output, int gzip) {
+  const ZlibStreamKind kind = gzip ? kDeflateGzip : kDeflate;
+  z_stream* zs = g_zlib_stream_pool->Get(kind);
   int r;
   size_t i;
   size_t count_before = output->count;
   size_t length_before = output->length;
-  memset(&zs, 0, sizeof(zs));
-  zs.zalloc = zalloc_gpr;
-  zs.zfree = zfree_gpr;
-  r = deflateInit2(&zs, Z_DEFAULT_COMPRESSION, Z_DEFLATED, 15 | (gzip ? 16 : 0),
-                   8, Z_DEFAULT_STRATEGY);
-  GPR_ASSERT(r == Z_OK);
-  r = zlib_body(&zs, input, output, deflate) && output->length < input->length;
+  /* The gzip format has no room for a preset dictionary. */
+  if (!gzip && GRPC_SLICE_LENGTH(dictionary) > 0) {
+    GPR_ASSERT(GRPC_SLICE_LENGTH(dictionary) <= ~static_cast<uInt>(0));
+    r = deflateSetDictionary(zs, GRPC_SLICE_START_PTR(dictionary),
+                             static_cast<uInt> GRPC_SLICE_LENGTH(dictionary));
+    GPR_ASSERT(r == Z_OK);
+  }
+  r = zlib_body(zs, dictionary, input, output, deflate) &&
+      output->length < input->length;
   if (!r) {
     for (i = count_before; i < output->count; i++) {
       grpc_slice_unref_internal(output->slices[i]);
@@ -114,23 +210,19 @@ static int zlib_compress(grpc_slice_buffer* input, grpc_slice_buffer* output,
     output->count = count_before;
     output->length = length_before;
   }
-  deflateEnd(&zs);
+  g_zlib_stream_pool->Return(kind, zs);
   return r;
 }
 
-static int zlib_decompress(grpc_slice_buffer* input, grpc_slice_buffer* output,
-                           int gzip) {
-  z_stream zs;
+static int zlib_decompress(grpc_slice dictionary, grpc_slice_buffer* input,
+                           grpc_slice_buffer* output, int gzip) {
+  const ZlibStreamKind kind = gzip ? kInflateGzip : kInflate;
+  z_stream* zs = g_zlib_stream_pool->Get(kind);
   int r;
   size_t i;
   size_t count_before = output->count;
   size_t length_before = output->length;
-  memset(&zs, 0, sizeof(zs));
-  zs.zalloc = zalloc_gpr;
-  zs.zfree = zfree_gpr;
-  r = inflateInit2(&zs, 15 | (gzip ? 16 : 0));
-  GPR_ASSERT(r == Z_OK);
-  r = zlib_body(&zs, input, output, inflate);
+  r = zlib_body(zs, dictionary, input, output, inflate);
   if (!r) {
     for (i = count_before; i < output->count; i++) {
       grpc_slice_unref_internal(output->slices[i]);
@@ -138,7 +230,7 @@ static int zlib_decompress(grpc_slice_buffer* input, grpc_slice_buffer* output,
     output->count = count_before;
     output->length = length_before;
   }
-  inflateEnd(&zs);
+  g_zlib_stream_pool->Return(kind, zs);
   return r;
 }
 
@@ -151,16 +243,17 @@ static int copy(grpc_slice_buffer* input, grpc_slice_buffer* output) {
 }
 
 static int compress_inner(grpc_compression_algorithm algorithm,
-                          grpc_slice_buffer* input, grpc_slice_buffer* output) {
+                          grpc_slice dictionary, grpc_slice_buffer* input,
+                          grpc_slice_buffer* output) {
   switch (algorithm) {
     case GRPC_COMPRESS_NONE:
       /* the fallback path always needs to be send uncompressed: we simply
          rely on that here */
       return 0;
     case GRPC_COMPRESS_DEFLATE:
-      return zlib_compress(input, output, 0);
+      return zlib_compress(dictionary, input, output, 0);
     case GRPC_COMPRESS_GZIP:
-      return zlib_compress(input, output, 1);
+      return zlib_compress(dictionary, input, output, 1);
     case GRPC_COMPRESS_ALGORITHMS_COUNT:
       break;
   }
@@ -170,22 +263,38 @@ static int compress_inner(grpc_compression_algorithm algorithm,
 
 int grpc_msg_compress(grpc_compression_algorithm algorithm,
                       grpc_slice_buffer* input, grpc_slice_buffer* output) {
-  if (!compress_inner(algorithm, input, output)) {
+  return grpc_msg_compress_with_dictionary(algorithm, grpc_empty_slice(),
+                                           input, output);
+}
+
+int grpc_msg_decompress(grpc_compression_algorithm algorithm,
+                        grpc_slice_buffer* input, grpc_slice_buffer* output) {
+  return grpc_msg_decompress_with_dictionary(algorithm, grpc_empty_slice(),
+                                             input, output);
+}
+
+int grpc_msg_compress_with_dictionary(grpc_compression_algorithm algorithm,
+                                      grpc_slice dictionary,
+                                      grpc_slice_buffer* input,
+                                      grpc_slice_buffer* output) {
+  if (!compress_inner(algorithm, dictionary, input, output)) {
     copy(input, output);
     return 0;
   }
   return 1;
 }
 
-int grpc_msg_decompress(grpc_compression_algorithm algorithm,
-                        grpc_slice_buffer* input, grpc_slice_buffer* output) {
+int grpc_msg_decompress_with_dictionary(grpc_compression_algorithm algorithm,
+                                        grpc_slice dictionary,
+                                        grpc_slice_buffer* input,
+                                        grpc_slice_buffer* output) {
   switch (algorithm) {
     case GRPC_COMPRESS_NONE:
       return copy(input, output);
     case GRPC_COMPRESS_DEFLATE:
-      return zlib_decompress(input, output, 0);
+      return zlib_decompress(dictionary, input, output, 0);
     case GRPC_COMPRESS_GZIP:
-      return zlib_decompress(input, output, 1);
+      return zlib_decompress(dictionary, input, output, 1);
     case GRPC_COMPRESS_ALGORITHMS_COUNT:
       break;
   }
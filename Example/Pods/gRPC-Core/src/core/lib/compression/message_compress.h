@@ -36,4 +36,20 @@ int grpc_msg_compress(grpc_compression_algorithm algorithm,
 int grpc_msg_decompress(grpc_compression_algorithm algorithm,
                         grpc_slice_buffer* input, grpc_slice_buffer* output);
 
+/* As grpc_msg_compress, but GRPC_COMPRESS_DEFLATE output is primed with the
+   preset 'dictionary' (borrowed; ignored if empty or for other algorithms).
+   The receiver needs the same dictionary to decompress it. */
+int grpc_msg_compress_with_dictionary(grpc_compression_algorithm algorithm,
+                                      grpc_slice dictionary,
+                                      grpc_slice_buffer* input,
+                                      grpc_slice_buffer* output);
+
+/* As grpc_msg_decompress, but GRPC_COMPRESS_DEFLATE input that was primed
+   with a preset dictionary is inflated using 'dictionary' (borrowed). Fails
+   if the input needs a dictionary and 'dictionary' is not that one. */
+int grpc_msg_decompress_with_dictionary(grpc_compression_algorithm algorithm,
+                                        grpc_slice dictionary,
+                                        grpc_slice_buffer* input,
+                                        grpc_slice_buffer* output);
+
 #endif /* GRPC_CORE_LIB_COMPRESSION_MESSAGE_COMPRESS_H */
@@ -61,6 +61,8 @@ const char* grpc_stats_counter_name[GRPC_STATS_COUNTER_COUNT] = {
     "http2_writes_offloaded",
     "http2_writes_continued",
     "http2_partial_writes",
+    "http2_writes_coalesced",
+    "http2_coalesced_writes_flushed_early",
     "http2_initiate_write_due_to_initial_write",
     "http2_initiate_write_due_to_start_new_stream",
     "http2_initiate_write_due_to_send_message",
@@ -170,6 +172,8 @@ const char* grpc_stats_counter_doc[GRPC_STATS_COUNTER_COUNT] = {
     "written",
     "Number of HTTP2 writes that were made knowing there was still more data "
     "to be written (we cap maximum write size to syscall_write)",
+    "Number of HTTP2 writes held back to coalesce frames from several calls",
+    "Number of coalesced HTTP2 writes flushed before their delay expired",
     "Number of HTTP2 writes initiated due to 'initial_write'",
     "Number of HTTP2 writes initiated due to 'start_new_stream'",
     "Number of HTTP2 writes initiated due to 'send_message'",
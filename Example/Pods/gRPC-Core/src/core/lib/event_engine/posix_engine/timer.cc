@@ -22,32 +22,22 @@
 
 #include <algorithm>
 #include <atomic>
-#include <limits>
 #include <utility>
 
 #include <grpc/support/cpu.h>
 
-#include "src/core/lib/event_engine/posix_engine/timer_heap.h"
+#include "src/core/lib/event_engine/posix_engine/timer_wheel.h"
 #include "src/core/lib/gpr/useful.h"
 #include "src/core/lib/gprpp/time.h"
 
 namespace grpc_event_engine {
 namespace posix_engine {
 
-static const size_t kInvalidHeapIndex = std::numeric_limits<size_t>::max();
-static const double kAddDeadlineScale = 0.33;
-static const double kMinQueueWindowDuration = 0.01;
-static const double kMaxQueueWindowDuration = 1.0;
-
 grpc_core::Timestamp TimerList::Shard::ComputeMinDeadline() {
-  return heap.is_empty()
-             ? queue_deadline_cap + grpc_core::Duration::Epsilon()
-             : grpc_core::Timestamp::FromMillisecondsAfterProcessEpoch(
-                   heap.Top()->deadline);
+  return grpc_core::Timestamp::FromMillisecondsAfterProcessEpoch(
+      wheel.NextDeadline());
 }
 
-TimerList::Shard::Shard() : stats(1.0 / kAddDeadlineScale, 0.1, 0.5) {}
-
 TimerList::TimerList(TimerListHost* host)
     : host_(host),
       num_shards_(grpc_core::Clamp(2 * gpr_cpu_num_cores(), 1u, 32u)),
@@ -56,30 +46,12 @@ TimerList::TimerList(TimerListHost* host)
       shard_queue_(new Shard*[num_shards_]) {
   for (size_t i = 0; i < num_shards_; i++) {
     Shard& shard = shards_[i];
-    shard.queue_deadline_cap =
-        grpc_core::Timestamp::FromMillisecondsAfterProcessEpoch(
-            min_timer_.load(std::memory_order_relaxed));
     shard.shard_queue_index = i;
-    shard.list.next = shard.list.prev = &shard.list;
     shard.min_deadline = shard.ComputeMinDeadline();
     shard_queue_[i] = &shard;
   }
 }
 
-namespace {
-/* returns true if the first element in the list */
-void ListJoin(Timer* head, Timer* timer) {
-  timer->next = head;
-  timer->prev = head->prev;
-  timer->next->prev = timer->prev->next = timer;
-}
-
-void ListRemove(Timer* timer) {
-  timer->next->prev = timer->prev;
-  timer->prev->next = timer->next;
-}
-}  // namespace
-
 void TimerList::SwapAdjacentShardsInQueue(uint32_t first_shard_queue_index) {
   Shard* temp;
   temp = shard_queue_[first_shard_queue_index];
@@ -123,15 +95,7 @@ void TimerList::TimerInit(Timer* timer, grpc_core::Timestamp deadline,
     if (deadline <= now) {
       deadline = now;
     }
-
-    shard->stats.AddSample((deadline - now).millis() / 1000.0);
-
-    if (deadline < shard->queue_deadline_cap) {
-      is_first_timer = shard->heap.Add(timer);
-    } else {
-      timer->heap_index = kInvalidHeapIndex;
-      ListJoin(&shard->list, timer);
-    }
+    is_first_timer = shard->wheel.Add(timer);
   }
 
   /* Deadline may have decreased, we need to adjust the main queue.  Note
@@ -166,65 +130,19 @@ bool TimerList::TimerCancel(Timer* timer) {
 
   if (timer->pending) {
     timer->pending = false;
-    if (timer->heap_index == kInvalidHeapIndex) {
-      ListRemove(timer);
-    } else {
-      shard->heap.Remove(timer);
-    }
+    shard->wheel.Remove(timer);
     return true;
   }
 
   return false;
 }
 
-/* Rebalances the timer shard by computing a new 'queue_deadline_cap' and moving
-   all relevant timers in shard->list (i.e timers with deadlines earlier than
-   'queue_deadline_cap') into into shard->heap.
-   Returns 'true' if shard->heap has at least ONE element */
-bool TimerList::Shard::RefillHeap(grpc_core::Timestamp now) {
-  /* Compute the new queue window width and bound by the limits: */
-  double computed_deadline_delta = stats.UpdateAverage() * kAddDeadlineScale;
-  double deadline_delta =
-      grpc_core::Clamp(computed_deadline_delta, kMinQueueWindowDuration,
-                       kMaxQueueWindowDuration);
-  Timer *timer, *next;
-
-  /* Compute the new cap and put all timers under it into the queue: */
-  queue_deadline_cap = std::max(now, queue_deadline_cap) +
-                       grpc_core::Duration::FromSecondsAsDouble(deadline_delta);
-
-  for (timer = list.next; timer != &list; timer = next) {
-    next = timer->next;
-    auto timer_deadline =
-        grpc_core::Timestamp::FromMillisecondsAfterProcessEpoch(
-            timer->deadline);
-
-    if (timer_deadline < queue_deadline_cap) {
-      ListRemove(timer);
-      heap.Add(timer);
-    }
-  }
-  return !heap.is_empty();
-}
-
 /* This pops the next non-cancelled timer with deadline <= now from the
    queue, or returns NULL if there isn't one. */
 Timer* TimerList::Shard::PopOne(grpc_core::Timestamp now) {
-  Timer* timer;
-  for (;;) {
-    if (heap.is_empty()) {
-      if (now < queue_deadline_cap) return nullptr;
-      if (!RefillHeap(now)) return nullptr;
-    }
-    timer = heap.Top();
-    auto timer_deadline =
-        grpc_core::Timestamp::FromMillisecondsAfterProcessEpoch(
-            timer->deadline);
-    if (timer_deadline > now) return nullptr;
-    timer->pending = false;
-    heap.Pop();
-    return timer;
-  }
+  Timer* timer = wheel.Pop(now.milliseconds_after_process_epoch());
+  if (timer != nullptr) timer->pending = false;
+  return timer;
 }
 
 void TimerList::Shard::PopTimers(
@@ -33,17 +33,16 @@
 
 #include <grpc/event_engine/event_engine.h>
 
-#include "src/core/lib/event_engine/posix_engine/timer_heap.h"
+#include "src/core/lib/event_engine/posix_engine/timer_wheel.h"
 #include "src/core/lib/gprpp/sync.h"
 #include "src/core/lib/gprpp/time.h"
-#include "src/core/lib/gprpp/time_averaged_stats.h"
 
 namespace grpc_event_engine {
 namespace posix_engine {
 
 struct Timer {
   int64_t deadline;
-  // kInvalidHeapIndex if not in heap.
+  // The timer wheel bucket the timer is linked into.
   size_t heap_index;
   bool pending;
   struct Timer* next;
@@ -130,20 +129,11 @@ class TimerList {
       grpc_core::Timestamp* next);
 
  private:
-  /* A "timer shard". Contains a 'heap' and a 'list' of timers. All timers with
-   * deadlines earlier than 'queue_deadline_cap' are maintained in the heap and
-   * others are maintained in the list (unordered). This helps to keep the
-   * number of elements in the heap low.
-   *
-   * The 'queue_deadline_cap' gets recomputed periodically based on the timer
-   * stats maintained in 'stats' and the relevant timers are then moved from the
-   * 'list' to 'heap'.
-   */
+  /* A "timer shard". Holds its timers in a hierarchical timing wheel, so that
+   * adding and cancelling a timer is O(1) regardless of how many timers are
+   * pending or how far out their deadlines are. */
   struct Shard {
-    Shard();
-
     grpc_core::Timestamp ComputeMinDeadline() ABSL_EXCLUSIVE_LOCKS_REQUIRED(mu);
-    bool RefillHeap(grpc_core::Timestamp now) ABSL_EXCLUSIVE_LOCKS_REQUIRED(mu);
     Timer* PopOne(grpc_core::Timestamp now) ABSL_EXCLUSIVE_LOCKS_REQUIRED(mu);
     void PopTimers(grpc_core::Timestamp now,
                    grpc_core::Timestamp* new_min_deadline,
@@ -151,18 +141,12 @@ class TimerList {
         ABSL_LOCKS_EXCLUDED(mu);
 
     grpc_core::Mutex mu;
-    grpc_core::TimeAveragedStats stats ABSL_GUARDED_BY(mu);
-    /* All and only timers with deadlines < this will be in the heap. */
-    grpc_core::Timestamp queue_deadline_cap ABSL_GUARDED_BY(mu);
-    /* The deadline of the next timer due in this shard. */
+    /* The deadline of the next timer due in this shard (a lower bound: it may
+       also be a time at which the wheel needs to cascade timers). */
     grpc_core::Timestamp min_deadline ABSL_GUARDED_BY(&TimerList::mu_);
     /* Index of this timer_shard in the g_shard_queue. */
     uint32_t shard_queue_index ABSL_GUARDED_BY(&TimerList::mu_);
-    /* This holds all timers with deadlines < queue_deadline_cap. Timers in this
-       list have the top bit of their deadline set to 0. */
-    TimerHeap heap ABSL_GUARDED_BY(mu);
-    /* This holds timers whose deadline is >= queue_deadline_cap. */
-    Timer list ABSL_GUARDED_BY(mu);
+    TimerWheel wheel ABSL_GUARDED_BY(mu);
   };
 
   void SwapAdjacentShardsInQueue(uint32_t first_shard_queue_index)
@@ -0,0 +1,190 @@
+/*
+ *
+ * Copyright 2022 gRPC authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#include <grpc/support/port_platform.h>
+
+#include "src/core/lib/event_engine/posix_engine/timer_wheel.h"
+
+#include <algorithm>
+#include <limits>
+
+#include "absl/numeric/bits.h"
+
+#include "src/core/lib/event_engine/posix_engine/timer.h"
+
+namespace grpc_event_engine {
+namespace posix_engine {
+
+namespace {
+constexpr uint64_t kNoEvent = std::numeric_limits<uint64_t>::max();
+
+int64_t ClampToDeadline(uint64_t t) {
+  return t > static_cast<uint64_t>(std::numeric_limits<int64_t>::max())
+             ? std::numeric_limits<int64_t>::max()
+             : static_cast<int64_t>(t);
+}
+}  // namespace
+
+TimerWheel::TimerWheel(int64_t now)
+    : now_(now < 0 ? 0 : static_cast<uint64_t>(now)), overflow_min_(kNoEvent) {}
+
+void TimerWheel::LinkFront(size_t bucket, Timer* timer) {
+  timer->heap_index = bucket;
+  timer->prev = nullptr;
+  timer->next = buckets_[bucket];
+  if (timer->next != nullptr) timer->next->prev = timer;
+  buckets_[bucket] = timer;
+}
+
+/* Expired timers are popped in the order they expired. */
+void TimerWheel::LinkExpired(Timer* timer) {
+  timer->heap_index = kExpiredBucket;
+  timer->next = nullptr;
+  timer->prev = expired_tail_;
+  if (timer->prev != nullptr) {
+    timer->prev->next = timer;
+  } else {
+    buckets_[kExpiredBucket] = timer;
+  }
+  expired_tail_ = timer;
+}
+
+void TimerWheel::Unlink(Timer* timer) {
+  size_t bucket = timer->heap_index;
+  if (timer->prev != nullptr) {
+    timer->prev->next = timer->next;
+  } else {
+    buckets_[bucket] = timer->next;
+  }
+  if (timer->next != nullptr) {
+    timer->next->prev = timer->prev;
+  } else if (bucket == kExpiredBucket) {
+    expired_tail_ = timer->prev;
+  }
+  if (bucket < kOverflowBucket && buckets_[bucket] == nullptr) {
+    occupied_[bucket / kSlots] &= ~(uint64_t{1} << (bucket % kSlots));
+  }
+}
+
+/* Links timer into the bucket matching its deadline relative to now_ and
+   returns the time at which that bucket will next be processed. Level L is the
+   lowest level whose slot range still contains both now_ and the deadline, so
+   the slot is never behind the wheel's current position. */
+uint64_t TimerWheel::Place(Timer* timer) {
+  uint64_t deadline =
+      timer->deadline < 0 ? 0 : static_cast<uint64_t>(timer->deadline);
+  if (deadline < now_) {
+    LinkExpired(timer);
+    return 0;
+  }
+  uint64_t diff = deadline ^ now_;
+  for (size_t level = 0; level < kLevels; level++) {
+    size_t shift = level * kBits;
+    if ((diff >> (shift + kBits)) == 0) {
+      size_t slot = (deadline >> shift) & (kSlots - 1);
+      LinkFront(level * kSlots + slot, timer);
+      occupied_[level] |= uint64_t{1} << slot;
+      return (deadline >> shift) << shift;
+    }
+  }
+  LinkFront(kOverflowBucket, timer);
+  overflow_min_ = std::min(overflow_min_, deadline);
+  return (deadline >> kSpanBits) << kSpanBits;
+}
+
+/* Returns the next time at which a wheel bucket must be processed, and the
+   bucket in *bucket. A non-empty lower level always comes due before any
+   higher level, since higher levels only hold timers beyond the current slot
+   range of the levels below them. Expired timers are not considered. */
+uint64_t TimerWheel::NextEvent(size_t* bucket) {
+  for (size_t level = 0; level < kLevels; level++) {
+    if (occupied_[level] == 0) continue;
+    size_t shift = level * kBits;
+    size_t slot = static_cast<size_t>(absl::countr_zero(occupied_[level]));
+    uint64_t block = (now_ >> (shift + kBits)) << (shift + kBits);
+    *bucket = level * kSlots + slot;
+    return block | (static_cast<uint64_t>(slot) << shift);
+  }
+  if (buckets_[kOverflowBucket] != nullptr) {
+    *bucket = kOverflowBucket;
+    return std::max((overflow_min_ >> kSpanBits) << kSpanBits, now_);
+  }
+  return kNoEvent;
+}
+
+/* Moves every timer due at or before now into the expired list, cascading
+   timers from higher levels down as their slots come due. A higher level slot
+   that starts right at now + 1 is cascaded as well: the wheel's position moves
+   to now + 1, and a slot at the current position must not hold any timers for
+   NextEvent to stay correct. */
+void TimerWheel::Advance(int64_t now) {
+  if (now < 0) return;
+  uint64_t target = static_cast<uint64_t>(now);
+  size_t bucket;
+  for (;;) {
+    uint64_t event = NextEvent(&bucket);
+    if (event > target && (event != target + 1 || bucket < kSlots)) break;
+    now_ = event;
+    Timer* timer = buckets_[bucket];
+    buckets_[bucket] = nullptr;
+    if (bucket < kOverflowBucket) {
+      occupied_[bucket / kSlots] &= ~(uint64_t{1} << (bucket % kSlots));
+    } else {
+      overflow_min_ = kNoEvent;
+    }
+    while (timer != nullptr) {
+      Timer* next = timer->next;
+      if (bucket < kSlots) {
+        LinkExpired(timer);
+      } else {
+        Place(timer);
+      }
+      timer = next;
+    }
+  }
+  now_ = std::max(now_, target + 1);
+}
+
+bool TimerWheel::Add(Timer* timer) {
+  size_t bucket;
+  uint64_t first = buckets_[kExpiredBucket] != nullptr ? 0 : NextEvent(&bucket);
+  timer_count_++;
+  return Place(timer) < first;
+}
+
+void TimerWheel::Remove(Timer* timer) {
+  Unlink(timer);
+  timer_count_--;
+}
+
+int64_t TimerWheel::NextDeadline() {
+  if (buckets_[kExpiredBucket] != nullptr) return ClampToDeadline(now_) - 1;
+  size_t bucket;
+  return ClampToDeadline(NextEvent(&bucket));
+}
+
+Timer* TimerWheel::Pop(int64_t now) {
+  Advance(now);
+  Timer* timer = buckets_[kExpiredBucket];
+  if (timer == nullptr) return nullptr;
+  Remove(timer);
+  return timer;
+}
+
+}  // namespace posix_engine
+}  // namespace grpc_event_engine
@@ -0,0 +1,96 @@
+/*
+ *
+ * Copyright 2022 gRPC authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#ifndef GRPC_CORE_LIB_EVENT_ENGINE_POSIX_ENGINE_TIMER_WHEEL_H
+#define GRPC_CORE_LIB_EVENT_ENGINE_POSIX_ENGINE_TIMER_WHEEL_H
+
+#include <grpc/support/port_platform.h>
+
+#include <stddef.h>
+
+#include <cstdint>
+
+namespace grpc_event_engine {
+namespace posix_engine {
+
+struct Timer;
+
+// A hierarchical timing wheel with millisecond ticks.
+//
+// Level L has kSlots slots, each covering 64^L ticks, so the kLevels levels
+// cover about 12 days ahead of the wheel's current time. Timers further out
+// than that sit in an unordered overflow bucket that is redistributed once
+// every 2^30 ticks. Adding and removing a timer is O(1); timers only move
+// between buckets when the wheel's time crosses a slot boundary of a higher
+// level (at most once per level per timer).
+//
+// Each timer stores the id of the bucket it is linked into in heap_index and
+// uses next/prev to link into that bucket.
+class TimerWheel {
+ public:
+  explicit TimerWheel(int64_t now = 0);
+
+  TimerWheel(const TimerWheel&) = delete;
+  TimerWheel& operator=(const TimerWheel&) = delete;
+
+  /* return true if the new timer may now be the earliest timer in the wheel */
+  bool Add(Timer* timer);
+  void Remove(Timer* timer);
+
+  /* Returns a lower bound on the time at which the wheel next needs attention:
+     either a timer deadline or a time at which timers must be moved to a lower
+     level. Returns INT64_MAX if the wheel is empty. */
+  int64_t NextDeadline();
+
+  /* Pops one timer with deadline <= now, or returns nullptr if there is none */
+  Timer* Pop(int64_t now);
+
+  bool is_empty() const { return timer_count_ == 0; }
+
+ private:
+  static constexpr size_t kLevels = 5;
+  static constexpr size_t kBits = 6;
+  static constexpr size_t kSlots = size_t{1} << kBits;
+  static constexpr size_t kSpanBits = kLevels * kBits;
+  static constexpr size_t kOverflowBucket = kLevels * kSlots;
+  static constexpr size_t kExpiredBucket = kOverflowBucket + 1;
+
+  void LinkFront(size_t bucket, Timer* timer);
+  void LinkExpired(Timer* timer);
+  void Unlink(Timer* timer);
+  uint64_t Place(Timer* timer);
+  uint64_t NextEvent(size_t* bucket);
+  void Advance(int64_t now);
+
+  /* The first tick that has not been processed yet. */
+  uint64_t now_;
+  /* Lower bound on the deadlines in the overflow bucket. */
+  uint64_t overflow_min_;
+  /* One bit per non-empty slot, per level. */
+  uint64_t occupied_[kLevels] = {};
+  /* Heads of the per-slot lists, followed by the overflow bucket and the list
+     of expired timers waiting to be popped. */
+  Timer* buckets_[kExpiredBucket + 1] = {};
+  Timer* expired_tail_ = nullptr;
+  size_t timer_count_ = 0;
+};
+
+}  // namespace posix_engine
+}  // namespace grpc_event_engine
+
+#endif /* GRPC_CORE_LIB_EVENT_ENGINE_POSIX_ENGINE_TIMER_WHEEL_H */
@@ -20,15 +20,104 @@
 
 #include "src/core/lib/event_engine/thread_pool.h"
 
+#include <algorithm>
 #include <utility>
 
+#include "absl/memory/memory.h"
+#include "absl/time/clock.h"
+#include "absl/time/time.h"
+
+#include <grpc/support/cpu.h>
+
 #include "src/core/lib/gprpp/thd.h"
 
 namespace grpc_event_engine {
 namespace experimental {
 
-ThreadPool::Thread::Thread(ThreadPool* pool)
+namespace {
+// Upper bound on pool threads per core. Callbacks may block, so the pool
+// still grows well past the core count, but no longer without limit.
+constexpr int kMaxThreadsPerCore = 16;
+constexpr int64_t kInitialQueueCapacity = 64;
+// Once the pool is at its thread limit and this many callbacks are queued,
+// threads outside the pool that add callbacks wait until the backlog drops
+// below kBacklogLowWater. The wait is bounded, since an adder may hold a
+// lock that the queued callbacks need.
+constexpr int64_t kBacklogHighWater = 1 << 16;
+constexpr int64_t kBacklogLowWater = 1 << 14;
+constexpr absl::Duration kMaxBacklogWait = absl::Milliseconds(10);
+}  // namespace
+
+GPR_THREAD_LOCAL(ThreadPool*) ThreadPool::g_current_pool_{nullptr};
+GPR_THREAD_LOCAL(ThreadPool::WorkQueue*) ThreadPool::g_current_queue_{nullptr};
+
+ThreadPool::WorkQueue::Buffer::Buffer(int64_t capacity)
+    : mask(capacity - 1), slots(new std::atomic<Callback*>[capacity]) {}
+
+ThreadPool::WorkQueue::WorkQueue() {
+  buffers_.emplace_back(new Buffer(kInitialQueueCapacity));
+  buffer_.store(buffers_.back().get(), std::memory_order_relaxed);
+}
+
+ThreadPool::WorkQueue::Buffer* ThreadPool::WorkQueue::Grow(Buffer* buffer,
+                                                           int64_t top,
+                                                           int64_t bottom) {
+  buffers_.emplace_back(new Buffer(2 * (buffer->mask + 1)));
+  Buffer* grown = buffers_.back().get();
+  for (int64_t i = top; i < bottom; i++) grown->Put(i, buffer->Get(i));
+  buffer_.store(grown, std::memory_order_release);
+  return grown;
+}
+
+void ThreadPool::WorkQueue::Push(Callback* callback) {
+  int64_t b = bottom_.load(std::memory_order_relaxed);
+  int64_t t = top_.load(std::memory_order_acquire);
+  Buffer* buffer = buffer_.load(std::memory_order_relaxed);
+  if (b - t > buffer->mask) buffer = Grow(buffer, t, b);
+  buffer->Put(b, callback);
+  std::atomic_thread_fence(std::memory_order_release);
+  bottom_.store(b + 1, std::memory_order_relaxed);
+}
+
+ThreadPool::Callback* ThreadPool::WorkQueue::Pop() {
+  int64_t b = bottom_.load(std::memory_order_relaxed) - 1;
+  Buffer* buffer = buffer_.load(std::memory_order_relaxed);
+  bottom_.store(b, std::memory_order_relaxed);
+  std::atomic_thread_fence(std::memory_order_seq_cst);
+  int64_t t = top_.load(std::memory_order_relaxed);
+  if (t > b) {
+    // Empty
+    bottom_.store(b + 1, std::memory_order_relaxed);
+    return nullptr;
+  }
+  Callback* callback = buffer->Get(b);
+  if (t == b) {
+    // Last element: race stealers for it
+    if (!top_.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst,
+                                      std::memory_order_relaxed)) {
+      callback = nullptr;
+    }
+    bottom_.store(b + 1, std::memory_order_relaxed);
+  }
+  return callback;
+}
+
+ThreadPool::Callback* ThreadPool::WorkQueue::Steal() {
+  int64_t t = top_.load(std::memory_order_acquire);
+  std::atomic_thread_fence(std::memory_order_seq_cst);
+  int64_t b = bottom_.load(std::memory_order_acquire);
+  if (t >= b) return nullptr;
+  Callback* callback = buffer_.load(std::memory_order_acquire)->Get(t);
+  if (!top_.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst,
+                                    std::memory_order_relaxed)) {
+    return nullptr;
+  }
+  return callback;
+}
+
+ThreadPool::Thread::Thread(ThreadPool* pool, int slot)
     : pool_(pool),
+      slot_(slot),
       thd_(
           "posix_eventengine_pool",
           [](void* th) { static_cast<ThreadPool::Thread*>(th)->ThreadFunc(); },
@@ -38,9 +127,10 @@ ThreadPool::Thread::Thread(ThreadPool* pool)
 ThreadPool::Thread::~Thread() { thd_.Join(); }
 
 void ThreadPool::Thread::ThreadFunc() {
-  pool_->ThreadFunc();
+  pool_->ThreadFunc(slot_);
   // Now that we have killed ourselves, we should reduce the thread count
   grpc_core::MutexLock lock(&pool_->mu_);
+  pool_->slot_used_[slot_] = false;
   pool_->nthreads_--;
   // Move ourselves to dead list
   pool_->dead_threads_.push_back(this);
@@ -51,48 +141,121 @@ void ThreadPool::Thread::ThreadFunc() {
   }
 }
 
-void ThreadPool::ThreadFunc() {
+ThreadPool::Callback ThreadPool::NextCallback(int slot) {
+  // Own deque first (newest callback, likely still in cache), then the shared
+  // queue, then the oldest callback of another thread.
+  Callback callback;
+  Callback* stolen = queues_[slot]->Pop();
+  if (stolen == nullptr) {
+    grpc_core::MutexLock lock(&global_mu_);
+    if (!global_queue_.empty()) {
+      callback = std::move(global_queue_.front());
+      global_queue_.pop_front();
+    }
+  }
+  if (stolen == nullptr && !callback) {
+    int nslots = nslots_.load(std::memory_order_acquire);
+    for (int i = 1; i < nslots && stolen == nullptr; i++) {
+      stolen = queues_[(slot + i) % nslots]->Steal();
+    }
+  }
+  if (stolen != nullptr) {
+    callback = std::move(*stolen);
+    delete stolen;
+  }
+  if (callback) {
+    int64_t queued = queued_.fetch_sub(1) - 1;
+    if (adders_waiting_.load(std::memory_order_relaxed) > 0 &&
+        queued <= kBacklogLowWater) {
+      grpc_core::MutexLock lock(&mu_);
+      backlog_cv_.SignalAll();
+    }
+  }
+  return callback;
+}
+
+void ThreadPool::ThreadFunc(int slot) {
+  g_current_pool_ = this;
+  g_current_queue_ = queues_[slot].get();
   for (;;) {
+    // a fork could be initiated while the thread was running callbacks
+    if (forking_.load(std::memory_order_relaxed)) break;
+    // Drain callbacks before considering shutdown to ensure all work
+    // gets completed.
+    Callback callback = NextCallback(slot);
+    if (callback) {
+      // If we were the last thread looking for work and more is queued,
+      // get another thread looking before we get busy.
+      if (searching_.fetch_sub(1) == 1 && queued_.load() > 0) {
+        WakeOrStartThread();
+      }
+      callback();
+      searching_++;
+      continue;
+    }
     // Wait until work is available or we are shutting down.
-    grpc_core::ReleasableMutexLock lock(&mu_);
-    if (!forking_ && !shutdown_ && callbacks_.empty()) {
+    grpc_core::MutexLock lock(&mu_);
+    if (forking_) break;
+    // Stop searching before the last look at queued_: a racing Add either
+    // sees no searching thread and wakes one, or its callback is seen here.
+    searching_--;
+    if (queued_.load() <= 0) {
       // If there are too many threads waiting, then quit this thread
-      if (threads_waiting_ >= reserve_threads_) {
+      if (shutdown_ || threads_waiting_ >= reserve_threads_) {
+        searching_++;
         break;
       }
       threads_waiting_++;
-      cv_.Wait(&mu_);
+      while (!forking_ && !shutdown_ && wakeups_ == 0) {
+        cv_.Wait(&mu_);
+      }
+      if (wakeups_ > 0) {
+        // Woken by Add, which already counted us as searching again
+        wakeups_--;
+        continue;
+      }
       threads_waiting_--;
     }
-    // a fork could be initiated while the thread was waiting
-    if (forking_) return;
-    // Drain callbacks before considering shutdown to ensure all work
-    // gets completed.
-    if (!callbacks_.empty()) {
-      auto cb = std::move(callbacks_.front());
-      callbacks_.pop();
-      lock.Release();
-      cb();
-    } else if (shutdown_) {
-      break;
-    }
+    searching_++;
   }
+  searching_--;
+  // Hand whatever is left in our deque to the other threads (or to the
+  // threads started after a fork).
+  Callback* callback;
+  while ((callback = queues_[slot]->Pop()) != nullptr) {
+    grpc_core::MutexLock lock(&global_mu_);
+    global_queue_.push_back(std::move(*callback));
+    delete callback;
+  }
+  g_current_pool_ = nullptr;
+  g_current_queue_ = nullptr;
 }
 
 ThreadPool::ThreadPool(int reserve_threads)
-    : shutdown_(false),
-      reserve_threads_(reserve_threads),
-      nthreads_(0),
-      threads_waiting_(0),
-      forking_(false) {
+    : reserve_threads_(reserve_threads),
+      max_threads_(std::max(
+          reserve_threads,
+          kMaxThreadsPerCore * static_cast<int>(gpr_cpu_num_cores()))),
+      queues_(max_threads_),
+      slot_used_(max_threads_, false) {
   grpc_core::MutexLock lock(&mu_);
   StartNThreadsLocked(reserve_threads_);
 }
 
 void ThreadPool::StartNThreadsLocked(int n) {
   for (int i = 0; i < n; i++) {
+    // Slots are handed out lowest first, so the used ones stay contiguous
+    auto free_slot = std::find(slot_used_.begin(), slot_used_.end(), false);
+    if (free_slot == slot_used_.end()) return;
+    int slot = static_cast<int>(free_slot - slot_used_.begin());
+    *free_slot = true;
+    if (slot >= nslots_.load(std::memory_order_relaxed)) {
+      queues_[slot] = absl::make_unique<WorkQueue>();
+      nslots_.store(slot + 1, std::memory_order_release);
+    }
     nthreads_++;
-    new Thread(this);
+    searching_++;
+    new Thread(this, slot);
   }
 }
 
@@ -105,6 +268,7 @@ ThreadPool::~ThreadPool() {
   grpc_core::MutexLock lock(&mu_);
   shutdown_ = true;
   cv_.SignalAll();
+  backlog_cv_.SignalAll();
   while (nthreads_ != 0) {
     shutdown_cv_.Wait(&mu_);
   }
@@ -112,18 +276,45 @@ ThreadPool::~ThreadPool() {
 }
 
 void ThreadPool::Add(absl::AnyInvocable<void()> callback) {
-  grpc_core::MutexLock lock(&mu_);
-  // Add works to the callbacks list
-  callbacks_.push(std::move(callback));
+  bool in_pool = g_current_pool_ == this;
+  if (in_pool) {
+    // Fast path: a pool thread keeps its callbacks on its own deque, where
+    // it will run them itself unless an idle thread steals them first.
+    g_current_queue_->Push(new Callback(std::move(callback)));
+  } else {
+    grpc_core::MutexLock lock(&global_mu_);
+    global_queue_.push_back(std::move(callback));
+  }
+  // Counted after the push, so that a thread that sees the count can also
+  // find the callback
+  queued_.fetch_add(1);
   // Store the callback for later if we are forking.
   // TODO(hork): should we block instead?
+  if (forking_.load(std::memory_order_relaxed)) return;
+  WakeOrStartThread();
+  if (!in_pool) WaitForBacklog();
+}
+
+void ThreadPool::WakeOrStartThread() {
+  // A thread that is looking for work will find the callback
+  if (searching_.load() > 0) return;
+  // Busy pool at its thread limit: the running threads will get to it
+  if (threads_waiting_.load() == 0 &&
+      nthreads_.load(std::memory_order_relaxed) >= max_threads_) {
+    return;
+  }
+  grpc_core::MutexLock lock(&mu_);
   if (forking_) return;
   // Increase pool size or notify as needed
   if (threads_waiting_ == 0) {
     // Kick off a new thread
-    nthreads_++;
-    new Thread(this);
+    StartNThreadsLocked(1);
   } else {
+    // Count the woken thread as searching right away, so that the callbacks
+    // added before it gets to run do not wake more threads
+    threads_waiting_--;
+    searching_++;
+    wakeups_++;
     cv_.Signal();
   }
   // Also use this chance to harvest dead threads
@@ -132,16 +323,30 @@ void ThreadPool::Add(absl::AnyInvocable<void()> callback) {
   }
 }
 
+void ThreadPool::WaitForBacklog() {
+  if (queued_.load(std::memory_order_relaxed) < kBacklogHighWater ||
+      nthreads_.load(std::memory_order_relaxed) < max_threads_) {
+    return;
+  }
+  grpc_core::MutexLock lock(&mu_);
+  adders_waiting_++;
+  absl::Time deadline = absl::Now() + kMaxBacklogWait;
+  while (!forking_ && !shutdown_ && queued_.load() > kBacklogLowWater) {
+    if (backlog_cv_.WaitWithDeadline(&mu_, deadline)) break;
+  }
+  adders_waiting_--;
+}
+
 void ThreadPool::PrepareFork() {
   grpc_core::MutexLock lock(&mu_);
   forking_ = true;
   cv_.SignalAll();
+  backlog_cv_.SignalAll();
   while (nthreads_ != 0) {
     fork_cv_.Wait(&mu_);
   }
   ReapThreads(&dead_threads_);
 }
-
 void ThreadPool::PostforkParent() {
   grpc_core::MutexLock lock(&mu_);
   forking_ = false;
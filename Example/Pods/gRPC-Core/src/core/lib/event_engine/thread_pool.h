@@ -21,19 +21,35 @@
 
 #include <grpc/support/port_platform.h>
 
-#include <queue>
+#include <stdint.h>
+
+#include <atomic>
+#include <deque>
+#include <memory>
 #include <vector>
 
 #include "absl/base/thread_annotations.h"
 #include "absl/functional/any_invocable.h"
 
 #include "src/core/lib/event_engine/forkable.h"
+#include "src/core/lib/gpr/tls.h"
 #include "src/core/lib/gprpp/sync.h"
 #include "src/core/lib/gprpp/thd.h"
 
 namespace grpc_event_engine {
 namespace experimental {
 
+// A work-stealing thread pool.
+//
+// Every pool thread owns a work-stealing deque. Callbacks added from a pool
+// thread are pushed onto that thread's deque without taking a lock; callbacks
+// added from other threads go to a shared queue. An idle thread runs its own
+// deque first, then the shared queue, and then steals from the other threads.
+//
+// Threads are started on demand when no thread is idle, up to a limit that
+// scales with the number of cores. Once the limit is reached and the backlog
+// is large, threads outside the pool that add callbacks are briefly held back
+// until the backlog drains.
 class ThreadPool final : public grpc_event_engine::experimental::Forkable {
  public:
   explicit ThreadPool(int reserve_threads);
@@ -47,32 +63,92 @@ class ThreadPool final : public grpc_event_engine::experimental::Forkable {
   void PostforkChild() override;
 
  private:
+  using Callback = absl::AnyInvocable<void()>;
+
+  // Chase-Lev work-stealing deque. Only the owning thread may Push and Pop
+  // (at the bottom); any thread may Steal (from the top).
+  class WorkQueue {
+   public:
+    WorkQueue();
+
+    void Push(Callback* callback);
+    // Return nullptr when the deque is empty.
+    Callback* Pop();
+    // Return nullptr when the deque is empty or another thread won the race.
+    Callback* Steal();
+
+   private:
+    struct Buffer {
+      explicit Buffer(int64_t capacity);
+      Callback* Get(int64_t i) const {
+        return slots[i & mask].load(std::memory_order_relaxed);
+      }
+      void Put(int64_t i, Callback* callback) {
+        slots[i & mask].store(callback, std::memory_order_relaxed);
+      }
+      const int64_t mask;
+      std::unique_ptr<std::atomic<Callback*>[]> slots;
+    };
+
+    Buffer* Grow(Buffer* buffer, int64_t top, int64_t bottom);
+
+    std::atomic<int64_t> top_{0};
+    std::atomic<int64_t> bottom_{0};
+    std::atomic<Buffer*> buffer_;
+    // Stealers may still read from a replaced buffer, so every buffer is kept
+    // until the deque is destroyed. Only touched by the owner.
+    std::vector<std::unique_ptr<Buffer>> buffers_;
+  };
+
   class Thread {
    public:
-    explicit Thread(ThreadPool* pool);
+    Thread(ThreadPool* pool, int slot);
     ~Thread();
 
    private:
     ThreadPool* pool_;
+    int slot_;
     grpc_core::Thread thd_;
     void ThreadFunc();
   };
 
-  void ThreadFunc();
+  void ThreadFunc(int slot);
+  Callback NextCallback(int slot);
+  void WakeOrStartThread();
+  void WaitForBacklog();
   void StartNThreadsLocked(int n) ABSL_EXCLUSIVE_LOCKS_REQUIRED(&mu_);
   static void ReapThreads(std::vector<Thread*>* tlist);
 
+  // The pool and deque of the pool thread running on this thread, if any.
+  static GPR_THREAD_LOCAL(ThreadPool*) g_current_pool_;
+  static GPR_THREAD_LOCAL(WorkQueue*) g_current_queue_;
+
   grpc_core::Mutex mu_;
   grpc_core::CondVar cv_;
   grpc_core::CondVar shutdown_cv_;
   grpc_core::CondVar fork_cv_;
-  bool shutdown_;
-  std::queue<absl::AnyInvocable<void()>> callbacks_;
-  int reserve_threads_;
-  int nthreads_;
-  int threads_waiting_;
-  std::vector<Thread*> dead_threads_;
-  bool forking_;
+  grpc_core::CondVar backlog_cv_;
+  std::atomic<bool> shutdown_{false};
+  std::atomic<bool> forking_{false};
+  const int reserve_threads_;
+  const int max_threads_;
+  std::atomic<int> nthreads_{0};
+  std::atomic<int> threads_waiting_{0};
+  // Started threads that are neither running a callback nor waiting.
+  std::atomic<int> searching_{0};
+  std::atomic<int> adders_waiting_{0};
+  // Waiting threads signalled by Add that have not woken up yet.
+  int wakeups_ ABSL_GUARDED_BY(mu_) = 0;
+  // Callbacks added but not yet taken by a thread, wherever they are queued.
+  std::atomic<int64_t> queued_{0};
+  std::vector<Thread*> dead_threads_ ABSL_GUARDED_BY(mu_);
+  // One deque per thread slot; a slot is owned by at most one live thread.
+  std::vector<std::unique_ptr<WorkQueue>> queues_;
+  std::vector<bool> slot_used_ ABSL_GUARDED_BY(mu_);
+  // Slots below this have been used by a thread and may hold work to steal.
+  std::atomic<int> nslots_{0};
+  grpc_core::Mutex global_mu_;
+  std::deque<Callback> global_queue_ ABSL_GUARDED_BY(global_mu_);
 };
 
 }  // namespace experimental
@@ -88,6 +88,8 @@
 #endif
 #ifndef GRPC_LINUX_EVENTFD
 #define GRPC_POSIX_NO_SPECIAL_WAKEUP_FD 1
+#else
+#define GRPC_LINUX_SHM_TRANSPORT 1
 #endif
 #ifndef GRPC_LINUX_SOCKETUTILS
 #define GRPC_POSIX_SOCKETUTILS
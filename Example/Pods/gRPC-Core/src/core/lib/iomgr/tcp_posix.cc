@@ -1109,7 +1109,6 @@ ssize_t tcp_send(int fd, const struct msghdr* msg, int* saved_errno,
   GPR_TIMER_SCOPE("sendmsg", 1);
   ssize_t sent_length;
   do {
-    /* TODO(klempner): Cork if this is a partial write */
     GRPC_STATS_INC_SYSCALL_WRITE();
     sent_length = sendmsg(fd, msg, SENDMSG_FLAGS | additional_flags);
   } while (sent_length < 0 && (*saved_errno = errno) == EINTR);
@@ -1656,7 +1655,15 @@ static bool tcp_flush(grpc_tcp* tcp, grpc_error_handle* error) {
       GRPC_STATS_INC_TCP_WRITE_SIZE(sending_length);
       GRPC_STATS_INC_TCP_WRITE_IOV_SIZE(iov_size);
 
-      sent_length = tcp_send(tcp->fd, &msg, &saved_errno);
+      int additional_flags = 0;
+#ifdef MSG_MORE
+      // More of this flush follows (we ran out of iovecs): let the kernel hold
+      // a trailing partial segment for it instead of sending a runt packet.
+      if (outgoing_slice_idx != tcp->outgoing_buffer->count) {
+        additional_flags |= MSG_MORE;
+      }
+#endif
+      sent_length = tcp_send(tcp->fd, &msg, &saved_errno, additional_flags);
     }
 
     if (sent_length < 0) {
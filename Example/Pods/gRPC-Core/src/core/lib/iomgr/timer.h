@@ -32,7 +32,8 @@
 
 typedef struct grpc_timer {
   int64_t deadline;
-  // Uninitialized if not using heap, or INVALID_HEAP_INDEX if not in heap.
+  // Uninitialized if not using the generic timer list, otherwise the timer
+  // wheel bucket the timer is linked into.
   uint32_t heap_index;
   bool pending;
   struct grpc_timer* next;
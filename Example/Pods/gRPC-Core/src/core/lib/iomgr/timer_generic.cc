@@ -33,46 +33,26 @@
 #include "src/core/lib/gpr/spinlock.h"
 #include "src/core/lib/gpr/tls.h"
 #include "src/core/lib/gpr/useful.h"
-#include "src/core/lib/gprpp/manual_constructor.h"
 #include "src/core/lib/gprpp/time.h"
-#include "src/core/lib/gprpp/time_averaged_stats.h"
 #include "src/core/lib/iomgr/exec_ctx.h"
 #include "src/core/lib/iomgr/port.h"
 #include "src/core/lib/iomgr/timer.h"
-#include "src/core/lib/iomgr/timer_heap.h"
-
-#define INVALID_HEAP_INDEX 0xffffffffu
-
-#define ADD_DEADLINE_SCALE 0.33
-#define MIN_QUEUE_WINDOW_DURATION 0.01
-#define MAX_QUEUE_WINDOW_DURATION 1.0
+#include "src/core/lib/iomgr/timer_wheel.h"
 
 grpc_core::TraceFlag grpc_timer_trace(false, "timer");
 grpc_core::TraceFlag grpc_timer_check_trace(false, "timer_check");
 
-/* A "timer shard". Contains a 'heap' and a 'list' of timers. All timers with
- * deadlines earlier than 'queue_deadline_cap' are maintained in the heap and
- * others are maintained in the list (unordered). This helps to keep the number
- * of elements in the heap low.
- *
- * The 'queue_deadline_cap' gets recomputed periodically based on the timer
- * stats maintained in 'stats' and the relevant timers are then moved from the
- * 'list' to 'heap'.
- */
+/* A "timer shard". Holds its timers in a hierarchical timing wheel, so that
+ * adding and cancelling a timer is O(1) regardless of how many timers are
+ * pending or how far out their deadlines are. */
 struct timer_shard {
   gpr_mu mu;
-  grpc_core::ManualConstructor<grpc_core::TimeAveragedStats> stats;
-  /* All and only timers with deadlines < this will be in the heap. */
-  grpc_core::Timestamp queue_deadline_cap;
-  /* The deadline of the next timer due in this shard. */
+  /* The deadline of the next timer due in this shard (a lower bound: it may
+     also be a time at which the wheel needs to cascade timers). */
   grpc_core::Timestamp min_deadline;
   /* Index of this timer_shard in the g_shard_queue. */
   uint32_t shard_queue_index;
-  /* This holds all timers with deadlines < queue_deadline_cap. Timers in this
-     list have the top bit of their deadline set to 0. */
-  grpc_timer_heap heap;
-  /* This holds timers whose deadline is >= queue_deadline_cap. */
-  grpc_timer list;
+  grpc_timer_wheel wheel;
 };
 static size_t g_num_shards;
 
@@ -235,10 +215,8 @@ static grpc_timer_check_result run_some_expired_timers(
     grpc_error_handle error);
 
 static grpc_core::Timestamp compute_min_deadline(timer_shard* shard) {
-  return grpc_timer_heap_is_empty(&shard->heap)
-             ? shard->queue_deadline_cap + grpc_core::Duration::Epsilon()
-             : grpc_core::Timestamp::FromMillisecondsAfterProcessEpoch(
-                   grpc_timer_heap_top(&shard->heap)->deadline);
+  return grpc_core::Timestamp::FromMillisecondsAfterProcessEpoch(
+      grpc_timer_wheel_next_deadline(&shard->wheel));
 }
 
 static void timer_list_init() {
@@ -260,11 +238,10 @@ static void timer_list_init() {
   for (i = 0; i < g_num_shards; i++) {
     timer_shard* shard = &g_shards[i];
     gpr_mu_init(&shard->mu);
-    shard->stats.Init(1.0 / ADD_DEADLINE_SCALE, 0.1, 0.5);
-    shard->queue_deadline_cap = g_shared_mutables.min_timer;
     shard->shard_queue_index = i;
-    grpc_timer_heap_init(&shard->heap);
-    shard->list.next = shard->list.prev = &shard->list;
+    grpc_timer_wheel_init(
+        &shard->wheel,
+        g_shared_mutables.min_timer.milliseconds_after_process_epoch());
     shard->min_deadline = compute_min_deadline(shard);
     g_shard_queue[i] = shard;
   }
@@ -280,7 +257,6 @@ static void timer_list_shutdown() {
   for (i = 0; i < g_num_shards; i++) {
     timer_shard* shard = &g_shards[i];
     gpr_mu_destroy(&shard->mu);
-    grpc_timer_heap_destroy(&shard->heap);
   }
   gpr_mu_destroy(&g_shared_mutables.mu);
   gpr_free(g_shards);
@@ -290,18 +266,6 @@ static void timer_list_shutdown() {
   DESTROY_TIMER_HASH_TABLE();
 }
 
-/* returns true if the first element in the list */
-static void list_join(grpc_timer* head, grpc_timer* timer) {
-  timer->next = head;
-  timer->prev = head->prev;
-  timer->next->prev = timer->prev->next = timer;
-}
-
-static void list_remove(grpc_timer* timer) {
-  timer->next->prev = timer->prev;
-  timer->prev->next = timer->next;
-}
-
 static void swap_adjacent_shards_in_queue(uint32_t first_shard_queue_index) {
   timer_shard* temp;
   temp = g_shard_queue[first_shard_queue_index];
@@ -332,7 +296,6 @@ void grpc_timer_init_unset(grpc_timer* timer) { timer->pending = false; }
 static void timer_init(grpc_timer* timer, grpc_core::Timestamp deadline,
                        grpc_closure* closure) {
   int is_first_timer = 0;
-  timer_shard* shard = &g_shards[grpc_core::HashPointer(timer, g_num_shards)];
   timer->closure = closure;
   timer->deadline = deadline.milliseconds_after_process_epoch();
 
@@ -356,6 +319,7 @@ static void timer_init(grpc_timer* timer, grpc_core::Timestamp deadline,
     return;
   }
 
+  timer_shard* shard = &g_shards[grpc_core::HashPointer(timer, g_num_shards)];
   gpr_mu_lock(&shard->mu);
   timer->pending = true;
   grpc_core::Timestamp now = grpc_core::ExecCtx::Get()->Now();
@@ -367,22 +331,12 @@ static void timer_init(grpc_timer* timer, grpc_core::Timestamp deadline,
     return;
   }
 
-  shard->stats->AddSample((deadline - now).millis() / 1000.0);
-
   ADD_TO_HASH_TABLE(timer);
 
-  if (deadline < shard->queue_deadline_cap) {
-    is_first_timer = grpc_timer_heap_add(&shard->heap, timer);
-  } else {
-    timer->heap_index = INVALID_HEAP_INDEX;
-    list_join(&shard->list, timer);
-  }
+  is_first_timer = grpc_timer_wheel_add(&shard->wheel, timer);
   if (GRPC_TRACE_FLAG_ENABLED(grpc_timer_trace)) {
-    gpr_log(GPR_INFO,
-            "  .. add to shard %d with queue_deadline_cap=%" PRId64
-            " => is_first_timer=%s",
+    gpr_log(GPR_INFO, "  .. add to shard %d => is_first_timer=%s",
             static_cast<int>(shard - g_shards),
-            shard->queue_deadline_cap.milliseconds_after_process_epoch(),
             is_first_timer ? "true" : "false");
   }
   gpr_mu_unlock(&shard->mu);
@@ -453,93 +407,28 @@ static void timer_cancel(grpc_timer* timer) {
     grpc_core::ExecCtx::Run(DEBUG_LOCATION, timer->closure,
                             GRPC_ERROR_CANCELLED);
     timer->pending = false;
-    if (timer->heap_index == INVALID_HEAP_INDEX) {
-      list_remove(timer);
-    } else {
-      grpc_timer_heap_remove(&shard->heap, timer);
-    }
+    grpc_timer_wheel_remove(&shard->wheel, timer);
   } else {
     VALIDATE_NON_PENDING_TIMER(timer);
   }
   gpr_mu_unlock(&shard->mu);
 }
 
-/* Rebalances the timer shard by computing a new 'queue_deadline_cap' and moving
-   all relevant timers in shard->list (i.e timers with deadlines earlier than
-   'queue_deadline_cap') into into shard->heap.
-   Returns 'true' if shard->heap has at least ONE element
-   REQUIRES: shard->mu locked */
-static bool refill_heap(timer_shard* shard, grpc_core::Timestamp now) {
-  /* Compute the new queue window width and bound by the limits: */
-  double computed_deadline_delta =
-      shard->stats->UpdateAverage() * ADD_DEADLINE_SCALE;
-  double deadline_delta =
-      grpc_core::Clamp(computed_deadline_delta, MIN_QUEUE_WINDOW_DURATION,
-                       MAX_QUEUE_WINDOW_DURATION);
-  grpc_timer *timer, *next;
-
-  /* Compute the new cap and put all timers under it into the queue: */
-  shard->queue_deadline_cap =
-      std::max(now, shard->queue_deadline_cap) +
-      grpc_core::Duration::FromSecondsAsDouble(deadline_delta);
-
-  if (GRPC_TRACE_FLAG_ENABLED(grpc_timer_check_trace)) {
-    gpr_log(GPR_INFO, "  .. shard[%d]->queue_deadline_cap --> %" PRId64,
-            static_cast<int>(shard - g_shards),
-            shard->queue_deadline_cap.milliseconds_after_process_epoch());
-  }
-  for (timer = shard->list.next; timer != &shard->list; timer = next) {
-    next = timer->next;
-    auto timer_deadline =
-        grpc_core::Timestamp::FromMillisecondsAfterProcessEpoch(
-            timer->deadline);
-
-    if (timer_deadline < shard->queue_deadline_cap) {
-      if (GRPC_TRACE_FLAG_ENABLED(grpc_timer_check_trace)) {
-        gpr_log(GPR_INFO, "  .. add timer with deadline %" PRId64 " to heap",
-                timer_deadline.milliseconds_after_process_epoch());
-      }
-      list_remove(timer);
-      grpc_timer_heap_add(&shard->heap, timer);
-    }
-  }
-  return !grpc_timer_heap_is_empty(&shard->heap);
-}
-
 /* This pops the next non-cancelled timer with deadline <= now from the
    queue, or returns NULL if there isn't one.
    REQUIRES: shard->mu locked */
 static grpc_timer* pop_one(timer_shard* shard, grpc_core::Timestamp now) {
-  grpc_timer* timer;
-  for (;;) {
-    if (GRPC_TRACE_FLAG_ENABLED(grpc_timer_check_trace)) {
-      gpr_log(GPR_INFO, "  .. shard[%d]: heap_empty=%s",
-              static_cast<int>(shard - g_shards),
-              grpc_timer_heap_is_empty(&shard->heap) ? "true" : "false");
-    }
-    if (grpc_timer_heap_is_empty(&shard->heap)) {
-      if (now < shard->queue_deadline_cap) return nullptr;
-      if (!refill_heap(shard, now)) return nullptr;
-    }
-    timer = grpc_timer_heap_top(&shard->heap);
-    auto timer_deadline =
-        grpc_core::Timestamp::FromMillisecondsAfterProcessEpoch(
-            timer->deadline);
-    if (GRPC_TRACE_FLAG_ENABLED(grpc_timer_check_trace)) {
-      gpr_log(GPR_INFO,
-              "  .. check top timer deadline=%" PRId64 " now=%" PRId64,
-              timer_deadline.milliseconds_after_process_epoch(),
-              now.milliseconds_after_process_epoch());
-    }
-    if (timer_deadline > now) return nullptr;
-    if (GRPC_TRACE_FLAG_ENABLED(grpc_timer_trace)) {
-      gpr_log(GPR_INFO, "TIMER %p: FIRE %" PRId64 "ms late", timer,
-              (now - timer_deadline).millis());
-    }
-    timer->pending = false;
-    grpc_timer_heap_pop(&shard->heap);
-    return timer;
+  grpc_timer* timer = grpc_timer_wheel_pop(
+      &shard->wheel, now.milliseconds_after_process_epoch());
+  if (timer == nullptr) return nullptr;
+  if (GRPC_TRACE_FLAG_ENABLED(grpc_timer_trace)) {
+    gpr_log(GPR_INFO, "TIMER %p: FIRE %" PRId64 "ms late", timer,
+            (now - grpc_core::Timestamp::FromMillisecondsAfterProcessEpoch(
+                       timer->deadline))
+                .millis());
   }
+  timer->pending = false;
+  return timer;
 }
 
 /* REQUIRES: shard->mu unlocked */
@@ -0,0 +1,203 @@
+/*
+ *
+ * Copyright 2022 gRPC authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#include <grpc/support/port_platform.h>
+
+#include "src/core/lib/iomgr/timer_wheel.h"
+
+#include <string.h>
+
+#include <algorithm>
+
+#include "absl/numeric/bits.h"
+
+#define SPAN_BITS (GRPC_TIMER_WHEEL_LEVELS * GRPC_TIMER_WHEEL_BITS)
+#define OVERFLOW_BUCKET (GRPC_TIMER_WHEEL_LEVELS * GRPC_TIMER_WHEEL_SLOTS)
+#define EXPIRED_BUCKET (OVERFLOW_BUCKET + 1)
+#define NO_EVENT UINT64_MAX
+
+static int64_t clamp_to_deadline(uint64_t t) {
+  return t > static_cast<uint64_t>(INT64_MAX) ? INT64_MAX
+                                              : static_cast<int64_t>(t);
+}
+
+static void link_front(grpc_timer_wheel* wheel, uint32_t bucket,
+                       grpc_timer* timer) {
+  timer->heap_index = bucket;
+  timer->prev = nullptr;
+  timer->next = wheel->buckets[bucket];
+  if (timer->next != nullptr) timer->next->prev = timer;
+  wheel->buckets[bucket] = timer;
+}
+
+/* Expired timers are popped in the order they expired. */
+static void link_expired(grpc_timer_wheel* wheel, grpc_timer* timer) {
+  timer->heap_index = EXPIRED_BUCKET;
+  timer->next = nullptr;
+  timer->prev = wheel->expired_tail;
+  if (timer->prev != nullptr) {
+    timer->prev->next = timer;
+  } else {
+    wheel->buckets[EXPIRED_BUCKET] = timer;
+  }
+  wheel->expired_tail = timer;
+}
+
+static void unlink(grpc_timer_wheel* wheel, grpc_timer* timer) {
+  uint32_t bucket = timer->heap_index;
+  if (timer->prev != nullptr) {
+    timer->prev->next = timer->next;
+  } else {
+    wheel->buckets[bucket] = timer->next;
+  }
+  if (timer->next != nullptr) {
+    timer->next->prev = timer->prev;
+  } else if (bucket == EXPIRED_BUCKET) {
+    wheel->expired_tail = timer->prev;
+  }
+  if (bucket < OVERFLOW_BUCKET && wheel->buckets[bucket] == nullptr) {
+    wheel->occupied[bucket / GRPC_TIMER_WHEEL_SLOTS] &=
+        ~(uint64_t{1} << (bucket % GRPC_TIMER_WHEEL_SLOTS));
+  }
+}
+
+/* Links timer into the bucket matching its deadline relative to wheel->now and
+   returns the time at which that bucket will next be processed. Level L is the
+   lowest level whose slot range still contains both wheel->now and the
+   deadline, so the slot is never behind the wheel's current position. */
+static uint64_t place(grpc_timer_wheel* wheel, grpc_timer* timer) {
+  uint64_t deadline =
+      timer->deadline < 0 ? 0 : static_cast<uint64_t>(timer->deadline);
+  if (deadline < wheel->now) {
+    link_expired(wheel, timer);
+    return 0;
+  }
+  uint64_t diff = deadline ^ wheel->now;
+  for (uint32_t level = 0; level < GRPC_TIMER_WHEEL_LEVELS; level++) {
+    uint32_t shift = level * GRPC_TIMER_WHEEL_BITS;
+    if ((diff >> (shift + GRPC_TIMER_WHEEL_BITS)) == 0) {
+      uint32_t slot = (deadline >> shift) & (GRPC_TIMER_WHEEL_SLOTS - 1);
+      link_front(wheel, level * GRPC_TIMER_WHEEL_SLOTS + slot, timer);
+      wheel->occupied[level] |= uint64_t{1} << slot;
+      return (deadline >> shift) << shift;
+    }
+  }
+  link_front(wheel, OVERFLOW_BUCKET, timer);
+  wheel->overflow_min = std::min(wheel->overflow_min, deadline);
+  return (deadline >> SPAN_BITS) << SPAN_BITS;
+}
+
+/* Returns the next time at which a wheel bucket must be processed, and the
+   bucket in *bucket. A non-empty lower level always comes due before any
+   higher level, since higher levels only hold timers beyond the current slot
+   range of the levels below them. Expired timers are not considered. */
+static uint64_t next_event(grpc_timer_wheel* wheel, uint32_t* bucket) {
+  for (uint32_t level = 0; level < GRPC_TIMER_WHEEL_LEVELS; level++) {
+    if (wheel->occupied[level] == 0) continue;
+    uint32_t shift = level * GRPC_TIMER_WHEEL_BITS;
+    uint32_t slot =
+        static_cast<uint32_t>(absl::countr_zero(wheel->occupied[level]));
+    uint64_t block = (wheel->now >> (shift + GRPC_TIMER_WHEEL_BITS))
+                     << (shift + GRPC_TIMER_WHEEL_BITS);
+    *bucket = level * GRPC_TIMER_WHEEL_SLOTS + slot;
+    return block | (static_cast<uint64_t>(slot) << shift);
+  }
+  if (wheel->buckets[OVERFLOW_BUCKET] != nullptr) {
+    *bucket = OVERFLOW_BUCKET;
+    return std::max((wheel->overflow_min >> SPAN_BITS) << SPAN_BITS,
+                    wheel->now);
+  }
+  return NO_EVENT;
+}
+
+/* Moves every timer due at or before now into the expired list, cascading
+   timers from higher levels down as their slots come due. A higher level slot
+   that starts right at now + 1 is cascaded as well: the wheel's position moves
+   to now + 1, and a slot at the current position must not hold any timers for
+   next_event to stay correct. */
+static void advance(grpc_timer_wheel* wheel, int64_t now) {
+  if (now < 0) return;
+  uint64_t target = static_cast<uint64_t>(now);
+  uint32_t bucket;
+  for (;;) {
+    uint64_t event = next_event(wheel, &bucket);
+    if (event > target &&
+        (event != target + 1 || bucket < GRPC_TIMER_WHEEL_SLOTS)) {
+      break;
+    }
+    wheel->now = event;
+    grpc_timer* timer = wheel->buckets[bucket];
+    wheel->buckets[bucket] = nullptr;
+    if (bucket < OVERFLOW_BUCKET) {
+      wheel->occupied[bucket / GRPC_TIMER_WHEEL_SLOTS] &=
+          ~(uint64_t{1} << (bucket % GRPC_TIMER_WHEEL_SLOTS));
+    } else {
+      wheel->overflow_min = NO_EVENT;
+    }
+    while (timer != nullptr) {
+      grpc_timer* next = timer->next;
+      if (bucket < GRPC_TIMER_WHEEL_SLOTS) {
+        link_expired(wheel, timer);
+      } else {
+        place(wheel, timer);
+      }
+      timer = next;
+    }
+  }
+  wheel->now = std::max(wheel->now, target + 1);
+}
+
+void grpc_timer_wheel_init(grpc_timer_wheel* wheel, int64_t now) {
+  memset(wheel, 0, sizeof(*wheel));
+  wheel->now = now < 0 ? 0 : static_cast<uint64_t>(now);
+  wheel->overflow_min = NO_EVENT;
+}
+
+bool grpc_timer_wheel_add(grpc_timer_wheel* wheel, grpc_timer* timer) {
+  uint32_t bucket;
+  uint64_t first = wheel->buckets[EXPIRED_BUCKET] != nullptr
+                       ? 0
+                       : next_event(wheel, &bucket);
+  wheel->timer_count++;
+  return place(wheel, timer) < first;
+}
+
+void grpc_timer_wheel_remove(grpc_timer_wheel* wheel, grpc_timer* timer) {
+  unlink(wheel, timer);
+  wheel->timer_count--;
+}
+
+int64_t grpc_timer_wheel_next_deadline(grpc_timer_wheel* wheel) {
+  if (wheel->buckets[EXPIRED_BUCKET] != nullptr) {
+    return clamp_to_deadline(wheel->now) - 1;
+  }
+  uint32_t bucket;
+  return clamp_to_deadline(next_event(wheel, &bucket));
+}
+
+grpc_timer* grpc_timer_wheel_pop(grpc_timer_wheel* wheel, int64_t now) {
+  advance(wheel, now);
+  grpc_timer* timer = wheel->buckets[EXPIRED_BUCKET];
+  if (timer == nullptr) return nullptr;
+  grpc_timer_wheel_remove(wheel, timer);
+  return timer;
+}
+
+bool grpc_timer_wheel_is_empty(grpc_timer_wheel* wheel) {
+  return wheel->timer_count == 0;
+}
@@ -0,0 +1,76 @@
+/*
+ *
+ * Copyright 2022 gRPC authors.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#ifndef GRPC_CORE_LIB_IOMGR_TIMER_WHEEL_H
+#define GRPC_CORE_LIB_IOMGR_TIMER_WHEEL_H
+
+#include <grpc/support/port_platform.h>
+
+#include <stdint.h>
+
+#include "src/core/lib/iomgr/timer.h"
+
+/* A hierarchical timing wheel with millisecond ticks.
+
+   Level L has GRPC_TIMER_WHEEL_SLOTS slots, each covering 64^L ticks, so five
+   levels cover about 12 days ahead of the wheel's current time. Timers further
+   out than that sit in an unordered overflow bucket that is redistributed once
+   every 2^30 ticks. Adding and removing a timer is O(1); timers only move
+   between buckets when the wheel's time crosses a slot boundary of a higher
+   level (at most once per level per timer).
+
+   Each timer stores the id of the bucket it is linked into in heap_index and
+   uses next/prev to link into that bucket. */
+
+#define GRPC_TIMER_WHEEL_LEVELS 5
+#define GRPC_TIMER_WHEEL_BITS 6
+#define GRPC_TIMER_WHEEL_SLOTS (1u << GRPC_TIMER_WHEEL_BITS)
+#define GRPC_TIMER_WHEEL_BUCKETS \
+  (GRPC_TIMER_WHEEL_LEVELS * GRPC_TIMER_WHEEL_SLOTS + 2)
+
+struct grpc_timer_wheel {
+  /* The first tick that has not been processed yet. */
+  uint64_t now;
+  /* Lower bound on the deadlines in the overflow bucket. */
+  uint64_t overflow_min;
+  /* One bit per non-empty slot, per level. */
+  uint64_t occupied[GRPC_TIMER_WHEEL_LEVELS];
+  /* Heads of the per-slot lists, followed by the overflow bucket and the list
+     of expired timers waiting to be popped. */
+  grpc_timer* buckets[GRPC_TIMER_WHEEL_BUCKETS];
+  grpc_timer* expired_tail;
+  uint32_t timer_count;
+};
+
+void grpc_timer_wheel_init(grpc_timer_wheel* wheel, int64_t now);
+
+/* return true if the new timer may now be the earliest timer in the wheel */
+bool grpc_timer_wheel_add(grpc_timer_wheel* wheel, grpc_timer* timer);
+void grpc_timer_wheel_remove(grpc_timer_wheel* wheel, grpc_timer* timer);
+
+/* Returns a lower bound on the time at which the wheel next needs attention:
+   either a timer deadline or a time at which timers must be moved to a lower
+   level. Returns INT64_MAX if the wheel is empty. */
+int64_t grpc_timer_wheel_next_deadline(grpc_timer_wheel* wheel);
+
+/* Pops one timer with deadline <= now, or returns nullptr if there is none */
+grpc_timer* grpc_timer_wheel_pop(grpc_timer_wheel* wheel, int64_t now);
+
+bool grpc_timer_wheel_is_empty(grpc_timer_wheel* wheel);
+
+#endif /* GRPC_CORE_LIB_IOMGR_TIMER_WHEEL_H */
@@ -23,11 +23,14 @@
 #include <atomic>
 #include <new>
 
+#include "absl/types/optional.h"
 #include "absl/utility/utility.h"
 
 #include <grpc/support/alloc.h>
+#include <grpc/support/cpu.h>
 
 #include "src/core/lib/gpr/alloc.h"
+#include "src/core/lib/gpr/useful.h"
 
 namespace {
 
@@ -48,8 +51,10 @@ void* ArenaStorage(size_t initial_size) {
 
 namespace grpc_core {
 
-Arena::~Arena() {
-  Zone* z = last_zone_;
+Arena::~Arena() { FreeZones(); }
+
+void Arena::FreeZones() {
+  Zone* z = last_zone_.exchange(nullptr, std::memory_order_relaxed);
   while (z) {
     Zone* prev_z = z->prev;
     Destruct(z);
@@ -86,6 +91,10 @@ size_t Arena::Destroy() {
   }
   size_t size = total_used_.load(std::memory_order_relaxed);
   memory_allocator_->Release(total_allocated_.load(std::memory_order_relaxed));
+  if (pool_ != nullptr) {
+    pool_->Recycle(this);
+    return size;
+  }
   this->~Arena();
   gpr_free_aligned(this);
   return size;
@@ -118,4 +127,135 @@ void Arena::ManagedNewObject::Link(std::atomic<ManagedNewObject*>* head) {
   }
 }
 
+//
+// ArenaPool
+//
+
+ArenaPool::ArenaPool(MemoryOwner* memory_owner)
+    : memory_owner_(memory_owner),
+      num_shards_(Clamp(gpr_cpu_num_cores(), 1u, 16u)),
+      shards_(new Shard[num_shards_]) {
+  for (size_t i = 0; i < num_shards_; i++) {
+    for (auto& size_class : shards_[i].slots) {
+      for (auto& slot : size_class) {
+        slot.store(nullptr, std::memory_order_relaxed);
+      }
+    }
+  }
+}
+
+ArenaPool::~ArenaPool() { ReleaseCached(); }
+
+size_t ArenaPool::SizeClassBytes(int size_class) {
+  // 1KiB, 1.5KiB, 2KiB, 3KiB, 4KiB, ... 64KiB
+  size_t bytes = size_t{1024} << (size_class / 2);
+  return size_class % 2 == 0 ? bytes : bytes + bytes / 2;
+}
+
+int ArenaPool::SizeClassFor(size_t size) {
+  for (int i = 0; i < kNumSizeClasses; i++) {
+    if (size <= SizeClassBytes(i)) return i;
+  }
+  return -1;
+}
+
+ArenaPool::Shard& ArenaPool::ThisCpuShard() {
+  return shards_[static_cast<size_t>(gpr_cpu_current_cpu()) % num_shards_];
+}
+
+std::pair<Arena*, void*> ArenaPool::CreateWithAlloc(size_t initial_size,
+                                                    size_t alloc_size) {
+  static constexpr size_t base_size =
+      GPR_ROUND_UP_TO_ALIGNMENT_SIZE(sizeof(Arena));
+  const int size_class = SizeClassFor(initial_size);
+  if (size_class < 0) {
+    return Arena::CreateWithAlloc(initial_size, alloc_size, memory_owner_);
+  }
+  Arena* arena = nullptr;
+  for (auto& slot : ThisCpuShard().slots[size_class]) {
+    if (slot.load(std::memory_order_relaxed) != nullptr) {
+      arena = slot.exchange(nullptr, std::memory_order_acquire);
+      if (arena != nullptr) break;
+    }
+  }
+  if (arena != nullptr) {
+    arena->total_used_.store(GPR_ROUND_UP_TO_ALIGNMENT_SIZE(alloc_size),
+                             std::memory_order_relaxed);
+  } else {
+    const size_t bytes = SizeClassBytes(size_class);
+    memory_owner_->Reserve(bytes);
+    arena = new (ArenaStorage(bytes))
+        Arena(bytes, alloc_size, memory_owner_, this);
+  }
+  return std::make_pair(arena, reinterpret_cast<char*>(arena) + base_size);
+}
+
+void ArenaPool::Recycle(Arena* arena) {
+  // Destroy() already ran the managed destructors and released the zones'
+  // quota; rewind the arena to the state Arena's constructor leaves it in.
+  arena->FreeZones();
+  arena->total_used_.store(0, std::memory_order_relaxed);
+  arena->total_allocated_.store(0, std::memory_order_relaxed);
+  if (!shutdown_.load(std::memory_order_relaxed)) {
+    const size_t bytes = arena->initial_zone_size_;
+    const size_t num_slots =
+        Clamp(kMaxCachedBytes / bytes, size_t{2}, size_t{kSlotsPerSizeClass});
+    std::atomic<Arena*>* slots = ThisCpuShard().slots[SizeClassFor(bytes)];
+    for (size_t i = 0; i < num_slots; i++) {
+      Arena* expected = nullptr;
+      if (slots[i].load(std::memory_order_relaxed) == nullptr &&
+          slots[i].compare_exchange_strong(expected, arena,
+                                           std::memory_order_release,
+                                           std::memory_order_relaxed)) {
+        MaybePostReclaimer();
+        return;
+      }
+    }
+  }
+  Free(arena);
+}
+
+void ArenaPool::Free(Arena* arena) {
+  memory_owner_->Release(arena->initial_zone_size_);
+  arena->~Arena();
+  gpr_free_aligned(arena);
+}
+
+void ArenaPool::ReleaseCached() {
+  for (size_t i = 0; i < num_shards_; i++) {
+    for (auto& size_class : shards_[i].slots) {
+      for (auto& slot : size_class) {
+        Arena* arena = slot.exchange(nullptr, std::memory_order_acquire);
+        if (arena != nullptr) Free(arena);
+      }
+    }
+  }
+}
+
+void ArenaPool::Shutdown() {
+  MutexLock lock(&reclaim_mu_);
+  shutdown_.store(true, std::memory_order_relaxed);
+  ReleaseCached();
+}
+
+void ArenaPool::Reclaim() {
+  MutexLock lock(&reclaim_mu_);
+  if (shutdown_.load(std::memory_order_relaxed)) return;
+  ReleaseCached();
+}
+
+void ArenaPool::MaybePostReclaimer() {
+  if (reclaimer_posted_.load(std::memory_order_relaxed) ||
+      reclaimer_posted_.exchange(true, std::memory_order_acq_rel)) {
+    return;
+  }
+  memory_owner_->PostReclaimer(
+      ReclamationPass::kBenign,
+      [self = Ref()](absl::optional<ReclamationSweep> sweep) {
+        if (!sweep.has_value()) return;
+        self->reclaimer_posted_.store(false, std::memory_order_relaxed);
+        self->Reclaim();
+      });
+}
+
 }  // namespace grpc_core
@@ -37,11 +37,15 @@
 
 #include "src/core/lib/gpr/alloc.h"
 #include "src/core/lib/gprpp/construct_destruct.h"
+#include "src/core/lib/gprpp/ref_counted.h"
+#include "src/core/lib/gprpp/sync.h"
 #include "src/core/lib/promise/context.h"
 #include "src/core/lib/resource_quota/memory_quota.h"
 
 namespace grpc_core {
 
+class ArenaPool;
+
 class Arena {
  public:
   // Create an arena, with \a initial_size bytes in the first allocated buffer.
@@ -55,6 +59,7 @@ class Arena {
       MemoryAllocator* memory_allocator);
 
   // Destroy an arena, returning the total number of bytes allocated.
+  // Arenas that came from an ArenaPool are handed back to it instead.
   size_t Destroy();
   // Allocate \a size bytes from the arena.
   void* Alloc(size_t size) {
@@ -89,6 +94,8 @@ class Arena {
   }
 
  private:
+  friend class ArenaPool;
+
   struct Zone {
     Zone* prev;
   };
@@ -118,15 +125,20 @@ class Arena {
   //   quick optimization (avoiding an atomic fetch-add) for the common case
   //   where we wish to create an arena and then perform an immediate
   //   allocation.
+  //
+  //   pool: The pool that Destroy() should return this arena to, if any.
   explicit Arena(size_t initial_size, size_t initial_alloc,
-                 MemoryAllocator* memory_allocator)
+                 MemoryAllocator* memory_allocator, ArenaPool* pool = nullptr)
       : total_used_(GPR_ROUND_UP_TO_ALIGNMENT_SIZE(initial_alloc)),
         initial_zone_size_(initial_size),
-        memory_allocator_(memory_allocator) {}
+        memory_allocator_(memory_allocator),
+        pool_(pool) {}
 
   ~Arena();
 
   void* AllocZone(size_t size);
+  // Free every zone but the initial one, leaving the arena empty.
+  void FreeZones();
 
   // Keep track of the total used size. We use this in our call sizing
   // hysteresis.
@@ -142,6 +154,70 @@ class Arena {
   std::atomic<ManagedNewObject*> managed_new_head_{nullptr};
   // The backing memory quota
   MemoryAllocator* const memory_allocator_;
+  ArenaPool* const pool_;
+};
+
+// Keeps the arenas of finished calls for reuse by later calls on the same
+// channel, so that most calls neither malloc nor free one.
+// Arenas are binned into size classes (two per power of two, 1KiB to 64KiB;
+// bigger ones are not pooled) and cached in per CPU slots that are claimed and
+// filled with atomic exchanges. The initial zone of every pooled arena, in use
+// or cached, is reserved against the memory quota, and cached arenas are freed
+// by a benign reclaimer when the quota comes under pressure.
+class ArenaPool : public RefCounted<ArenaPool> {
+ public:
+  explicit ArenaPool(MemoryOwner* memory_owner);
+  ~ArenaPool() override;
+
+  ArenaPool(const ArenaPool&) = delete;
+  ArenaPool& operator=(const ArenaPool&) = delete;
+
+  // Like Arena::CreateWithAlloc, but reuses a cached arena when there is one
+  // and returns the arena here when it is destroyed.
+  std::pair<Arena*, void*> CreateWithAlloc(size_t initial_size,
+                                           size_t alloc_size);
+
+  // Free all cached arenas and stop caching new ones. Must be called before
+  // the memory owner goes away, and not concurrently with Arena::Destroy() on
+  // arenas from this pool.
+  void Shutdown();
+
+ private:
+  friend class Arena;
+
+  static constexpr int kNumSizeClasses = 13;
+  static constexpr int kSlotsPerSizeClass = 8;
+  // Per size class and shard: bigger classes get fewer slots, but at least 2.
+  static constexpr size_t kMaxCachedBytes = 64 * 1024;
+
+  struct Shard {
+    std::atomic<Arena*> slots[kNumSizeClasses][kSlotsPerSizeClass];
+  };
+
+  // Initial zone size of the arenas in a size class.
+  static size_t SizeClassBytes(int size_class);
+  // The smallest size class fitting size, or -1 if it is too big to pool.
+  static int SizeClassFor(size_t size);
+
+  Shard& ThisCpuShard();
+  // Called by Arena::Destroy().
+  void Recycle(Arena* arena);
+  void Free(Arena* arena);
+  // Free all cached arenas.
+  void ReleaseCached();
+  void MaybePostReclaimer();
+  // Called by the reclaimer: like ReleaseCached(), but a no-op once Shutdown()
+  // has run, since the memory owner may be gone by then.
+  void Reclaim();
+
+  MemoryOwner* const memory_owner_;
+  const size_t num_shards_;
+  const std::unique_ptr<Shard[]> shards_;
+  // Serializes Reclaim() against Shutdown(), so that no reclaimer touches the
+  // memory owner after Shutdown() returns.
+  Mutex reclaim_mu_;
+  std::atomic<bool> shutdown_{false};
+  std::atomic<bool> reclaimer_posted_{false};
 };
 
 // Smart pointer for arenas when the final size is not required.
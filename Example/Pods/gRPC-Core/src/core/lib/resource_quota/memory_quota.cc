@@ -26,10 +26,14 @@
 #include "absl/strings/str_cat.h"
 #include "absl/utility/utility.h"
 
+#include <grpc/support/cpu.h>
+
 #include "src/core/lib/debug/trace.h"
+#include "src/core/lib/gpr/tls.h"
 #include "src/core/lib/gpr/useful.h"
 #include "src/core/lib/gprpp/global_config_env.h"
 #include "src/core/lib/gprpp/mpscq.h"
+#include "src/core/lib/iomgr/exec_ctx.h"
 #include "src/core/lib/promise/exec_ctx_wakeup_scheduler.h"
 #include "src/core/lib/promise/loop.h"
 #include "src/core/lib/promise/map.h"
@@ -170,13 +174,16 @@ Poll<RefCountedPtr<ReclaimerQueue::Handle>> ReclaimerQueue::PollNext() {
 
 GrpcMemoryAllocatorImpl::GrpcMemoryAllocatorImpl(
     std::shared_ptr<BasicMemoryQuota> memory_quota, std::string name)
-    : memory_quota_(memory_quota), name_(std::move(name)) {
+    : memory_quota_(memory_quota),
+      num_free_bytes_shards_(
+          Clamp<size_t>(gpr_cpu_num_cores(), 1, kMaxFreeBytesShards)),
+      free_bytes_(new FreeBytesShard[num_free_bytes_shards_]),
+      name_(std::move(name)) {
   memory_quota_->Take(taken_bytes_);
 }
 
 GrpcMemoryAllocatorImpl::~GrpcMemoryAllocatorImpl() {
-  GPR_ASSERT(free_bytes_.load(std::memory_order_acquire) +
-                 sizeof(GrpcMemoryAllocatorImpl) ==
+  GPR_ASSERT(TotalFreeBytes() + sizeof(GrpcMemoryAllocatorImpl) ==
              taken_bytes_.load(std::memory_order_relaxed));
   memory_quota_->Return(taken_bytes_);
 }
@@ -240,38 +247,107 @@ absl::optional<size_t> GrpcMemoryAllocatorImpl::TryReserve(
 
   // How much do we want to reserve?
   const size_t reserve = request.min() + scaled_size_over_min;
-  // See how many bytes are available.
-  size_t available = free_bytes_.load(std::memory_order_acquire);
-  while (true) {
+  // Take it from this thread's shard of the free pool, gathering up the other
+  // shards into it first if it is short.
+  FreeBytesShard& shard = ThisThreadShard();
+  for (bool rebalanced = false;; rebalanced = true) {
+    // See how many bytes are available.
+    size_t available = shard.free_bytes.load(std::memory_order_acquire);
     // Does the current free pool satisfy the request?
-    if (available < reserve) {
-      return {};
+    while (available >= reserve) {
+      // Try to reserve the requested amount.
+      // If the amount of free memory changed through this loop, then
+      // available will be set to the new value and we'll repeat.
+      if (shard.free_bytes.compare_exchange_weak(
+              available, available - reserve, std::memory_order_acq_rel,
+              std::memory_order_acquire)) {
+        return reserve;
+      }
     }
-    // Try to reserve the requested amount.
-    // If the amount of free memory changed through this loop, then available
-    // will be set to the new value and we'll repeat.
-    if (free_bytes_.compare_exchange_weak(available, available - reserve,
-                                          std::memory_order_acq_rel,
-                                          std::memory_order_acquire)) {
-      return reserve;
+    if (rebalanced || num_free_bytes_shards_ == 1) return {};
+    Rebalance(&shard);
+  }
+}
+
+void GrpcMemoryAllocatorImpl::Release(size_t n) {
+  // Add the released memory to our free bytes counter... if this increases
+  // from  0 to non-zero, then we have more to do, otherwise, we're actually
+  // done.
+  size_t prev_free =
+      ThisThreadShard().free_bytes.fetch_add(n, std::memory_order_release);
+  if ((max_quota_buffer_size() > 0 &&
+       prev_free + n > max_quota_buffer_size() / num_free_bytes_shards_) ||
+      (periodic_donate_back() && donate_back_.Tick([](Duration) {}))) {
+    // Try to immediately return some free'ed memory back to the total quota.
+    MaybeDonateBack();
+  }
+  if (prev_free != 0) return;
+  MaybeRegisterReclaimer();
+}
+
+GrpcMemoryAllocatorImpl::FreeBytesShard&
+GrpcMemoryAllocatorImpl::ThisThreadShard() {
+  if (num_free_bytes_shards_ == 1) return free_bytes_[0];
+  // Threads are numbered round robin on first use. The CPU id would be
+  // cheaper, but gpr_cpu_current_cpu() is constant on some platforms (iOS),
+  // which would put every thread on one shard.
+  static std::atomic<size_t> next_thread_index{0};
+  static GPR_THREAD_LOCAL(size_t) thread_index(0);
+  if (thread_index == 0) {
+    thread_index =
+        next_thread_index.fetch_add(1, std::memory_order_relaxed) + 1;
+  }
+  return free_bytes_[thread_index % num_free_bytes_shards_];
+}
+
+size_t GrpcMemoryAllocatorImpl::TotalFreeBytes() const {
+  size_t total = 0;
+  for (size_t i = 0; i < num_free_bytes_shards_; i++) {
+    total += free_bytes_[i].free_bytes.load(std::memory_order_acquire);
+  }
+  return total;
+}
+
+void GrpcMemoryAllocatorImpl::Rebalance(FreeBytesShard* shard) {
+  size_t gathered = 0;
+  for (size_t i = 0; i < num_free_bytes_shards_; i++) {
+    FreeBytesShard& other = free_bytes_[i];
+    if (&other == shard ||
+        other.free_bytes.load(std::memory_order_relaxed) == 0) {
+      continue;
     }
+    gathered += other.free_bytes.exchange(0, std::memory_order_acq_rel);
+  }
+  if (gathered != 0) {
+    shard->free_bytes.fetch_add(gathered, std::memory_order_acq_rel);
   }
 }
 
 void GrpcMemoryAllocatorImpl::MaybeDonateBack() {
-  size_t free = free_bytes_.load(std::memory_order_relaxed);
+  // Each shard may buffer its share of max_quota_buffer_size().
+  const size_t max_shard_buffer_size =
+      max_quota_buffer_size() / num_free_bytes_shards_;
+  for (size_t i = 0; i < num_free_bytes_shards_; i++) {
+    MaybeDonateBackShard(&free_bytes_[i], max_shard_buffer_size);
+  }
+}
+
+void GrpcMemoryAllocatorImpl::MaybeDonateBackShard(
+    FreeBytesShard* shard, size_t max_shard_buffer_size) {
+  size_t free = shard->free_bytes.load(std::memory_order_relaxed);
   while (free > 0) {
     size_t ret = 0;
-    if (max_quota_buffer_size() > 0 && free > max_quota_buffer_size() / 2) {
-      ret = std::max(ret, free - max_quota_buffer_size() / 2);
+    if (max_shard_buffer_size > 0 && free > max_shard_buffer_size / 2) {
+      ret = std::max(ret, free - max_shard_buffer_size / 2);
     }
     if (periodic_donate_back()) {
       ret = std::max(ret, free > 8192 ? free / 2 : free);
     }
+    if (ret == 0) return;
     const size_t new_free = free - ret;
-    if (free_bytes_.compare_exchange_weak(free, new_free,
-                                          std::memory_order_acq_rel,
-                                          std::memory_order_acquire)) {
+    if (shard->free_bytes.compare_exchange_weak(free, new_free,
+                                                std::memory_order_acq_rel,
+                                                std::memory_order_acquire)) {
       if (GRPC_TRACE_FLAG_ENABLED(grpc_resource_quota_trace)) {
         gpr_log(GPR_INFO, "[%p|%s] Early return %" PRIdPTR " bytes", this,
                 name_.c_str(), ret);
@@ -293,14 +369,17 @@ void GrpcMemoryAllocatorImpl::Replenish() {
   // Record that we've taken it.
   taken_bytes_.fetch_add(amount, std::memory_order_relaxed);
   // Add the taken amount to the free pool.
-  free_bytes_.fetch_add(amount, std::memory_order_acq_rel);
+  ThisThreadShard().free_bytes.fetch_add(amount, std::memory_order_acq_rel);
   // See if we can add ourselves as a reclaimer.
   MaybeRegisterReclaimer();
 }
 
 void GrpcMemoryAllocatorImpl::MaybeRegisterReclaimer() {
   // If the reclaimer is already registered, then there's nothing to do.
-  if (registered_reclaimer_.exchange(true, std::memory_order_relaxed)) {
+  // (Check before the exchange: this is reached every time a shard of the
+  // free pool refills from empty, and should not always dirty the line.)
+  if (registered_reclaimer_.load(std::memory_order_relaxed) ||
+      registered_reclaimer_.exchange(true, std::memory_order_relaxed)) {
     return;
   }
   MutexLock lock(&reclaimer_mu_);
@@ -316,7 +395,11 @@ void GrpcMemoryAllocatorImpl::MaybeRegisterReclaimer() {
     auto* p = static_cast<GrpcMemoryAllocatorImpl*>(self.get());
     p->registered_reclaimer_.store(false, std::memory_order_relaxed);
     // Figure out how many bytes we can return to the quota.
-    size_t return_bytes = p->free_bytes_.exchange(0, std::memory_order_acq_rel);
+    size_t return_bytes = 0;
+    for (size_t i = 0; i < p->num_free_bytes_shards_; i++) {
+      return_bytes +=
+          p->free_bytes_[i].free_bytes.exchange(0, std::memory_order_acq_rel);
+    }
     if (return_bytes == 0) return;
     // Subtract that from our outstanding balance.
     p->taken_bytes_.fetch_sub(return_bytes);
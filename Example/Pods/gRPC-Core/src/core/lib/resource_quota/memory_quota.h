@@ -365,20 +365,7 @@ class GrpcMemoryAllocatorImpl final : public EventEngineMemoryAllocatorImpl {
   size_t Reserve(MemoryRequest request) override;
 
   // Release some bytes that were previously reserved.
-  void Release(size_t n) override {
-    // Add the released memory to our free bytes counter... if this increases
-    // from  0 to non-zero, then we have more to do, otherwise, we're actually
-    // done.
-    size_t prev_free = free_bytes_.fetch_add(n, std::memory_order_release);
-    if ((max_quota_buffer_size() > 0 &&
-         prev_free + n > max_quota_buffer_size()) ||
-        (periodic_donate_back() && donate_back_.Tick([](Duration) {}))) {
-      // Try to immediately return some free'ed memory back to the total quota.
-      MaybeDonateBack();
-    }
-    if (prev_free != 0) return;
-    MaybeRegisterReclaimer();
-  }
+  void Release(size_t n) override;
 
   // Post a reclamation function.
   template <typename F>
@@ -410,11 +397,27 @@ class GrpcMemoryAllocatorImpl final : public EventEngineMemoryAllocatorImpl {
         GPR_GLOBAL_CONFIG_GET(grpc_experimental_max_quota_buffer_size);
     return value;
   }
+  // One shard of the free pool, padded out to its own cache line.
+  struct FreeBytesShard {
+    std::atomic<size_t> free_bytes{0};
+    char padding[GPR_CACHELINE_SIZE - sizeof(std::atomic<size_t>)];
+  };
+
+  // The shard of the free pool that the current thread uses.
+  FreeBytesShard& ThisThreadShard();
+  // Total free bytes across all shards.
+  size_t TotalFreeBytes() const;
   // Primitive reservation function.
   absl::optional<size_t> TryReserve(MemoryRequest request) GRPC_MUST_USE_RESULT;
+  // Move the free bytes of every other shard into shard, so that a request
+  // that none of them could satisfy alone may be.
+  void Rebalance(FreeBytesShard* shard);
   // This function may be invoked during a memory release operation.
   // It will try to return half of our free pool to the quota.
   void MaybeDonateBack();
+  // MaybeDonateBack() for a single shard.
+  void MaybeDonateBackShard(FreeBytesShard* shard,
+                            size_t max_shard_buffer_size);
   // Replenish bytes from the quota, without blocking, possibly entering
   // overcommit.
   void Replenish();
@@ -434,7 +437,13 @@ class GrpcMemoryAllocatorImpl final : public EventEngineMemoryAllocatorImpl {
   // contention, each MemoryAllocator can keep some memory in addition to what
   // it is immediately using, and the quota can pull it back under memory
   // pressure.
-  std::atomic<size_t> free_bytes_{0};
+  // This is sharded by thread (up to kMaxFreeBytesShards) so that the reserves
+  // and releases of the slices read and written on different threads do not
+  // contend on one cache line; a shard that runs dry takes the others' free
+  // bytes before asking the quota for more.
+  static constexpr size_t kMaxFreeBytesShards = 16;
+  const size_t num_free_bytes_shards_;
+  const std::unique_ptr<FreeBytesShard[]> free_bytes_;
   // Amount of memory taken from the quota by this allocator.
   std::atomic<size_t> taken_bytes_{sizeof(GrpcMemoryAllocatorImpl)};
   std::atomic<bool> registered_reclaimer_{false};
@@ -23,12 +23,23 @@
 #include <stdint.h>
 #include <string.h>
 
+#include <algorithm>
+
 #include <grpc/support/alloc.h>
 #include <grpc/support/log.h>
 
 #include "src/core/lib/gpr/useful.h"
 #include "src/core/lib/slice/slice_refcount.h"
 
+#if defined(__aarch64__) && defined(__ARM_NEON)
+#include <arm_neon.h>
+#define GRPC_BASE64_NEON 1
+#elif (defined(__x86_64__) || defined(__i386__)) && \
+    (defined(__GNUC__) || defined(__clang__))
+#include <tmmintrin.h>
+#define GRPC_BASE64_SSSE3 1
+#endif
+
 /* --- Constants. --- */
 
 static const int8_t base64_bytes[] = {
@@ -54,6 +65,249 @@ static const char base64_url_safe_chars[] =
 #define GRPC_BASE64_MULTILINE_LINE_LEN 76
 #define GRPC_BASE64_MULTILINE_NUM_BLOCKS (GRPC_BASE64_MULTILINE_LINE_LEN / 4)
 
+/* --- Bulk (SIMD) kernels. --- */
+
+/* Both directions work on whole groups. Decoding maps characters to sextets
+   with range compares rather than table lookups, so the same kernel serves
+   either alphabet, and it bails out of any block holding something that is not
+   in the alphabet (padding, line breaks, garbage) without writing it. */
+
+#if GRPC_BASE64_NEON
+
+/* 48 input bytes -> 64 characters per iteration. */
+static size_t encode_bulk_neon(char* result, const uint8_t* data,
+                               size_t data_size, const char* base64_chars) {
+  const uint8_t* chars = reinterpret_cast<const uint8_t*>(base64_chars);
+  uint8x16x4_t table;
+  table.val[0] = vld1q_u8(chars);
+  table.val[1] = vld1q_u8(chars + 16);
+  table.val[2] = vld1q_u8(chars + 32);
+  table.val[3] = vld1q_u8(chars + 48);
+  const uint8x16_t mask = vdupq_n_u8(0x3f);
+  uint8_t* out = reinterpret_cast<uint8_t*>(result);
+  size_t i = 0;
+  for (; data_size - i >= 48; i += 48) {
+    uint8x16x3_t in = vld3q_u8(data + i);
+    uint8x16x4_t enc;
+    enc.val[0] = vshrq_n_u8(in.val[0], 2);
+    enc.val[1] = vandq_u8(
+        vorrq_u8(vshlq_n_u8(in.val[0], 4), vshrq_n_u8(in.val[1], 4)), mask);
+    enc.val[2] = vandq_u8(
+        vorrq_u8(vshlq_n_u8(in.val[1], 2), vshrq_n_u8(in.val[2], 6)), mask);
+    enc.val[3] = vandq_u8(in.val[2], mask);
+    enc.val[0] = vqtbl4q_u8(table, enc.val[0]);
+    enc.val[1] = vqtbl4q_u8(table, enc.val[1]);
+    enc.val[2] = vqtbl4q_u8(table, enc.val[2]);
+    enc.val[3] = vqtbl4q_u8(table, enc.val[3]);
+    vst4q_u8(out, enc);
+    out += 64;
+  }
+  return i;
+}
+
+/* Maps one register of characters to sextets, or'ing 0xff into *invalid for
+   every lane that is not in the alphabet. */
+static uint8x16_t decode_lanes_neon(uint8x16_t c, uint8_t c62, uint8_t c63,
+                                    uint8x16_t* invalid) {
+  const uint8x16_t upper =
+      vcleq_u8(vsubq_u8(c, vdupq_n_u8('A')), vdupq_n_u8(25));
+  const uint8x16_t lower =
+      vcleq_u8(vsubq_u8(c, vdupq_n_u8('a')), vdupq_n_u8(25));
+  const uint8x16_t digit = vcleq_u8(vsubq_u8(c, vdupq_n_u8('0')), vdupq_n_u8(9));
+  const uint8x16_t is62 = vceqq_u8(c, vdupq_n_u8(c62));
+  const uint8x16_t is63 = vceqq_u8(c, vdupq_n_u8(c63));
+  *invalid = vorrq_u8(
+      *invalid,
+      vmvnq_u8(vorrq_u8(vorrq_u8(upper, lower),
+                        vorrq_u8(digit, vorrq_u8(is62, is63)))));
+  uint8x16_t shift = vandq_u8(upper, vdupq_n_u8(static_cast<uint8_t>(-'A')));
+  shift = vorrq_u8(
+      shift, vandq_u8(lower, vdupq_n_u8(static_cast<uint8_t>(26 - 'a'))));
+  shift = vorrq_u8(
+      shift, vandq_u8(digit, vdupq_n_u8(static_cast<uint8_t>(52 - '0'))));
+  shift = vorrq_u8(
+      shift, vandq_u8(is62, vdupq_n_u8(static_cast<uint8_t>(62 - c62))));
+  shift = vorrq_u8(
+      shift, vandq_u8(is63, vdupq_n_u8(static_cast<uint8_t>(63 - c63))));
+  return vaddq_u8(c, shift);
+}
+
+/* 64 characters -> 48 output bytes per iteration. */
+static size_t decode_bulk_neon(uint8_t* result, const uint8_t* b64,
+                               size_t b64_len, uint8_t c62, uint8_t c63) {
+  size_t i = 0;
+  for (; b64_len - i >= 64; i += 64) {
+    uint8x16x4_t in = vld4q_u8(b64 + i);
+    uint8x16_t invalid = vdupq_n_u8(0);
+    in.val[0] = decode_lanes_neon(in.val[0], c62, c63, &invalid);
+    in.val[1] = decode_lanes_neon(in.val[1], c62, c63, &invalid);
+    in.val[2] = decode_lanes_neon(in.val[2], c62, c63, &invalid);
+    in.val[3] = decode_lanes_neon(in.val[3], c62, c63, &invalid);
+    if (vmaxvq_u8(invalid) != 0) break;
+    uint8x16x3_t out;
+    out.val[0] = vorrq_u8(vshlq_n_u8(in.val[0], 2), vshrq_n_u8(in.val[1], 4));
+    out.val[1] = vorrq_u8(vshlq_n_u8(in.val[1], 4), vshrq_n_u8(in.val[2], 2));
+    out.val[2] = vorrq_u8(vshlq_n_u8(in.val[2], 6), in.val[3]);
+    vst3q_u8(result, out);
+    result += 48;
+  }
+  return i;
+}
+
+#endif /* GRPC_BASE64_NEON */
+
+#if GRPC_BASE64_SSSE3
+
+/* SSSE3 is not part of the x86 baseline, so these are compiled for it
+   explicitly and only called after checking the CPU at runtime. */
+#define GRPC_BASE64_SSSE3_FN __attribute__((target("ssse3")))
+
+static bool cpu_has_ssse3() {
+  static const bool has_ssse3 = __builtin_cpu_supports("ssse3");
+  return has_ssse3;
+}
+
+/* 12 input bytes -> 16 characters per iteration; reads 16 bytes at a time so
+   it stops while at least 16 remain. */
+GRPC_BASE64_SSSE3_FN static size_t encode_bulk_ssse3(char* result,
+                                                     const uint8_t* data,
+                                                     size_t data_size,
+                                                     const char* base64_chars) {
+  /* Spread every 3 input bytes over a 32 bit lane as [b1 b0 b2 b1] ... */
+  const __m128i spread =
+      _mm_setr_epi8(1, 0, 2, 1, 4, 3, 5, 4, 7, 6, 8, 7, 10, 9, 11, 10);
+  /* ... then move each sextet into its own byte with two multiplies. */
+  const __m128i mask_ac = _mm_set1_epi32(0x0fc0fc00);
+  const __m128i shift_ac = _mm_set1_epi32(0x04000040);
+  const __m128i mask_bd = _mm_set1_epi32(0x003f03f0);
+  const __m128i shift_bd = _mm_set1_epi32(0x01000010);
+  /* Sextet -> character is an add whose offset is picked by range:
+     0..25 -> 13, 26..51 -> 0, 52..61 -> 1..10, 62 -> 11, 63 -> 12. */
+  const __m128i offsets = _mm_setr_epi8(
+      'a' - 26, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52,
+      '0' - 52, '0' - 52, '0' - 52, '0' - 52,
+      static_cast<char>(base64_chars[62] - 62),
+      static_cast<char>(base64_chars[63] - 63), 'A', 0, 0);
+  size_t i = 0;
+  for (; data_size - i >= 16; i += 12) {
+    __m128i in =
+        _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i));
+    in = _mm_shuffle_epi8(in, spread);
+    const __m128i ac =
+        _mm_mulhi_epu16(_mm_and_si128(in, mask_ac), shift_ac);
+    const __m128i bd =
+        _mm_mullo_epi16(_mm_and_si128(in, mask_bd), shift_bd);
+    const __m128i sextets = _mm_or_si128(ac, bd);
+    __m128i range = _mm_subs_epu8(sextets, _mm_set1_epi8(51));
+    range = _mm_or_si128(
+        range, _mm_and_si128(_mm_cmpgt_epi8(_mm_set1_epi8(26), sextets),
+                             _mm_set1_epi8(13)));
+    const __m128i chars =
+        _mm_add_epi8(sextets, _mm_shuffle_epi8(offsets, range));
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(result), chars);
+    result += 16;
+  }
+  return i;
+}
+
+GRPC_BASE64_SSSE3_FN static inline __m128i in_range_ssse3(__m128i c, char lo,
+                                                         char hi) {
+  return _mm_and_si128(_mm_cmpgt_epi8(c, _mm_set1_epi8(lo - 1)),
+                       _mm_cmplt_epi8(c, _mm_set1_epi8(hi + 1)));
+}
+
+/* 16 characters -> 12 output bytes per iteration. */
+GRPC_BASE64_SSSE3_FN static size_t decode_bulk_ssse3(uint8_t* result,
+                                                     const uint8_t* b64,
+                                                     size_t b64_len, char c62,
+                                                     char c63) {
+  /* [a b c d] sextets -> 24 bit big endian value in the low bytes of each
+     32 bit lane, then compacted into 12 contiguous bytes. */
+  const __m128i merge_pairs = _mm_set1_epi32(0x01400140);
+  const __m128i merge_quads = _mm_set1_epi32(0x00011000);
+  const __m128i pack = _mm_setr_epi8(2, 1, 0, 6, 5, 4, 10, 9, 8, 14, 13, 12,
+                                     -1, -1, -1, -1);
+  size_t i = 0;
+  for (; b64_len - i >= 16; i += 16) {
+    const __m128i c =
+        _mm_loadu_si128(reinterpret_cast<const __m128i*>(b64 + i));
+    /* Bytes >= 0x80 are negative here and fail every range. */
+    const __m128i upper = in_range_ssse3(c, 'A', 'Z');
+    const __m128i lower = in_range_ssse3(c, 'a', 'z');
+    const __m128i digit = in_range_ssse3(c, '0', '9');
+    const __m128i is62 = _mm_cmpeq_epi8(c, _mm_set1_epi8(c62));
+    const __m128i is63 = _mm_cmpeq_epi8(c, _mm_set1_epi8(c63));
+    const __m128i valid = _mm_or_si128(
+        _mm_or_si128(upper, lower),
+        _mm_or_si128(digit, _mm_or_si128(is62, is63)));
+    if (_mm_movemask_epi8(valid) != 0xffff) break;
+    __m128i shift = _mm_and_si128(upper, _mm_set1_epi8(-'A'));
+    shift = _mm_or_si128(shift,
+                         _mm_and_si128(lower, _mm_set1_epi8(26 - 'a')));
+    shift = _mm_or_si128(shift,
+                         _mm_and_si128(digit, _mm_set1_epi8(52 - '0')));
+    shift = _mm_or_si128(
+        shift, _mm_and_si128(is62, _mm_set1_epi8(static_cast<char>(62 - c62))));
+    shift = _mm_or_si128(
+        shift, _mm_and_si128(is63, _mm_set1_epi8(static_cast<char>(63 - c63))));
+    __m128i out = _mm_add_epi8(c, shift);
+    out = _mm_maddubs_epi16(out, merge_pairs);
+    out = _mm_madd_epi16(out, merge_quads);
+    out = _mm_shuffle_epi8(out, pack);
+    _mm_storel_epi64(reinterpret_cast<__m128i*>(result), out);
+    const uint32_t tail = static_cast<uint32_t>(
+        _mm_cvtsi128_si32(_mm_srli_si128(out, 8)));
+    memcpy(result + 8, &tail, 4);
+    result += 12;
+  }
+  return i;
+}
+
+#endif /* GRPC_BASE64_SSSE3 */
+
+size_t grpc_base64_encode_bulk(char* result, const uint8_t* data,
+                               size_t data_size, int url_safe) {
+  const char* base64_chars =
+      url_safe ? base64_url_safe_chars : base64_url_unsafe_chars;
+#if GRPC_BASE64_NEON
+  return encode_bulk_neon(result, data, data_size, base64_chars);
+#elif GRPC_BASE64_SSSE3
+  if (cpu_has_ssse3()) {
+    return encode_bulk_ssse3(result, data, data_size, base64_chars);
+  }
+  return 0;
+#else
+  (void)result;
+  (void)data;
+  (void)data_size;
+  (void)base64_chars;
+  return 0;
+#endif
+}
+
+size_t grpc_base64_decode_bulk(uint8_t* result, const uint8_t* b64,
+                               size_t b64_len, int url_safe) {
+  const char* base64_chars =
+      url_safe ? base64_url_safe_chars : base64_url_unsafe_chars;
+#if GRPC_BASE64_NEON
+  return decode_bulk_neon(result, b64, b64_len,
+                          static_cast<uint8_t>(base64_chars[62]),
+                          static_cast<uint8_t>(base64_chars[63]));
+#elif GRPC_BASE64_SSSE3
+  if (cpu_has_ssse3()) {
+    return decode_bulk_ssse3(result, b64, b64_len, base64_chars[62],
+                             base64_chars[63]);
+  }
+  return 0;
+#else
+  (void)result;
+  (void)b64;
+  (void)b64_len;
+  (void)base64_chars;
+  return 0;
+#endif
+}
+
 /* --- base64 functions. --- */
 
 char* grpc_base64_encode(const void* vdata, size_t data_size, int url_safe,
@@ -86,18 +340,34 @@ void grpc_base64_encode_core(char* result, const void* vdata, size_t data_size,
   size_t num_blocks = 0;
   size_t i = 0;
 
-  /* Encode each block. */
+  /* Encode each line (or everything, without line breaks): the bulk encoder
+     takes what it can and the remaining blocks are done one at a time. */
   while (data_size >= 3) {
-    *current++ = base64_chars[(data[i] >> 2) & 0x3F];
-    *current++ =
-        base64_chars[((data[i] & 0x03) << 4) | ((data[i + 1] >> 4) & 0x0F)];
-    *current++ =
-        base64_chars[((data[i + 1] & 0x0F) << 2) | ((data[i + 2] >> 6) & 0x03)];
-    *current++ = base64_chars[data[i + 2] & 0x3F];
+    size_t line_blocks = data_size / 3;
+    if (multiline) {
+      line_blocks = std::min(line_blocks, static_cast<size_t>(
+                                              GRPC_BASE64_MULTILINE_NUM_BLOCKS -
+                                              num_blocks));
+    }
+    const size_t bulk =
+        grpc_base64_encode_bulk(current, data + i, 3 * line_blocks, url_safe);
+    current += bulk / 3 * 4;
+    data_size -= bulk;
+    i += bulk;
+    num_blocks += bulk / 3;
+    for (line_blocks -= bulk / 3; line_blocks > 0; --line_blocks) {
+      *current++ = base64_chars[(data[i] >> 2) & 0x3F];
+      *current++ =
+          base64_chars[((data[i] & 0x03) << 4) | ((data[i + 1] >> 4) & 0x0F)];
+      *current++ = base64_chars[((data[i + 1] & 0x0F) << 2) |
+                                ((data[i + 2] >> 6) & 0x03)];
+      *current++ = base64_chars[data[i + 2] & 0x3F];
 
-    data_size -= 3;
-    i += 3;
-    if (multiline && (++num_blocks == GRPC_BASE64_MULTILINE_NUM_BLOCKS)) {
+      data_size -= 3;
+      i += 3;
+      ++num_blocks;
+    }
+    if (multiline && num_blocks == GRPC_BASE64_MULTILINE_NUM_BLOCKS) {
       *current++ = '\r';
       *current++ = '\n';
       num_blocks = 0;
@@ -196,7 +466,18 @@ grpc_slice grpc_base64_decode_with_len(const char* b64, size_t b64_len,
   unsigned char codes[4];
   size_t num_codes = 0;
 
-  while (b64_len--) {
+  while (b64_len > 0) {
+    if (num_codes == 0) {
+      /* On a group boundary: let the bulk decoder take the plain runs. */
+      const size_t bulk = grpc_base64_decode_bulk(
+          current + result_size, reinterpret_cast<const uint8_t*>(b64), b64_len,
+          url_safe);
+      b64 += bulk;
+      b64_len -= bulk;
+      result_size += bulk / 4 * 3;
+      if (b64_len == 0) break;
+    }
+    --b64_len;
     unsigned char c = static_cast<unsigned char>(*b64++);
     signed char code;
     if (c >= GPR_ARRAY_SIZE(base64_bytes)) continue;
@@ -22,6 +22,7 @@
 #include <grpc/support/port_platform.h>
 
 #include <stddef.h>
+#include <stdint.h>
 
 #include <grpc/slice.h>
 
@@ -49,4 +50,22 @@ grpc_slice grpc_base64_decode(const char* b64, int url_safe);
 grpc_slice grpc_base64_decode_with_len(const char* b64, size_t b64_len,
                                        int url_safe);
 
+/* Bulk helpers for the base64 codecs in core. They use SIMD kernels where the
+   target has them (NEON on aarch64, SSSE3 on x86 when the CPU supports it)
+   and only ever process whole groups: padding, line breaks and the last
+   partial group are left to the caller's scalar loop. */
+
+/* Encodes a prefix of data (a multiple of 3 bytes, possibly empty) into 4/3 as
+   many characters at result. Returns the number of input bytes consumed. */
+size_t grpc_base64_encode_bulk(char* result, const uint8_t* data,
+                               size_t data_size, int url_safe);
+
+/* Decodes a prefix of b64 (a multiple of 4 characters, possibly empty) made of
+   alphabet characters only into 3/4 as many bytes at result. Stops before the
+   first block holding anything else, so the caller still sees (and reports)
+   padding and invalid characters. Returns the number of characters
+   consumed. */
+size_t grpc_base64_decode_bulk(uint8_t* result, const uint8_t* b64,
+                               size_t b64_len, int url_safe);
+
 #endif /* GRPC_CORE_LIB_SLICE_B64_H */
@@ -74,6 +74,7 @@ Channel::Channel(bool is_client, std::string target,
       allocator_(channel_args.GetObject<ResourceQuota>()
                      ->memory_quota()
                      ->CreateMemoryOwner(target)),
+      arena_pool_(MakeRefCounted<ArenaPool>(&allocator_)),
       target_(std::move(target)),
       channel_stack_(std::move(channel_stack)) {
   // We need to make sure that grpc_shutdown() does not shut things down
@@ -104,6 +105,12 @@ Channel::Channel(bool is_client, std::string target,
   };
 }
 
+Channel::~Channel() {
+  // The pool may outlive us (its reclaimer holds a ref), but not our memory
+  // owner, so drop what it caches now.
+  arena_pool_->Shutdown();
+}
+
 absl::StatusOr<RefCountedPtr<Channel>> Channel::CreateWithBuilder(
     ChannelStackBuilder* builder) {
   auto channel_args = builder->channel_args();
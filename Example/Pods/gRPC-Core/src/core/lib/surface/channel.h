@@ -51,6 +51,7 @@
 #include "src/core/lib/gprpp/sync.h"
 #include "src/core/lib/gprpp/time.h"
 #include "src/core/lib/iomgr/iomgr_fwd.h"
+#include "src/core/lib/resource_quota/arena.h"
 #include "src/core/lib/resource_quota/memory_quota.h"
 #include "src/core/lib/slice/slice.h"
 #include "src/core/lib/surface/channel_stack_type.h"
@@ -116,6 +117,8 @@ class Channel : public RefCounted<Channel>,
   static absl::StatusOr<RefCountedPtr<Channel>> CreateWithBuilder(
       ChannelStackBuilder* builder);
 
+  ~Channel() override;
+
   grpc_channel_stack* channel_stack() const { return channel_stack_.get(); }
 
   grpc_compression_options compression_options() const {
@@ -140,6 +143,8 @@ class Channel : public RefCounted<Channel>,
   void UpdateCallSizeEstimate(size_t size);
   absl::string_view target() const { return target_; }
   MemoryAllocator* allocator() { return &allocator_; }
+  // Call arenas come from here.
+  ArenaPool* arena_pool() { return arena_pool_.get(); }
   bool is_client() const { return is_client_; }
   RegisteredCall* RegisterCall(const char* method, const char* host);
 
@@ -163,7 +168,8 @@ class Channel : public RefCounted<Channel>,
   std::atomic<size_t> call_size_estimate_;
   CallRegistrationTable registration_table_;
   RefCountedPtr<channelz::ChannelNode> channelz_node_;
-  MemoryAllocator allocator_;
+  MemoryOwner allocator_;
+  const RefCountedPtr<ArenaPool> arena_pool_;
   std::string target_;
   const RefCountedPtr<grpc_channel_stack> channel_stack_;
 };
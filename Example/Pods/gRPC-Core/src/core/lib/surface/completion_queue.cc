@@ -216,6 +216,8 @@ struct cq_vtable {
                      void* reserved);
   grpc_event (*pluck)(grpc_completion_queue* cq, void* tag,
                       gpr_timespec deadline, void* reserved);
+  int (*next_batch)(grpc_completion_queue* cq, grpc_event* events,
+                    int max_events, gpr_timespec deadline, void* reserved);
 };
 
 namespace {
@@ -237,6 +239,10 @@ class CqEventQueue {
 
   bool Push(grpc_cq_completion* c);
   grpc_cq_completion* Pop();
+  /* Pops up to max completions into out under a single acquisition of the
+   * consumer lock. Like Pop(), may come back short (even empty) while the
+   * queue is not */
+  size_t PopBatch(grpc_cq_completion** out, size_t max);
 
  private:
   /* Spinlock to serialize consumers i.e pop() operations */
@@ -399,6 +405,10 @@ static void cq_end_op_for_callback(
 static grpc_event cq_next(grpc_completion_queue* cq, gpr_timespec deadline,
                           void* reserved);
 
+static int cq_next_batch(grpc_completion_queue* cq, grpc_event* events,
+                         int max_events, gpr_timespec deadline,
+                         void* reserved);
+
 static grpc_event cq_pluck(grpc_completion_queue* cq, void* tag,
                            gpr_timespec deadline, void* reserved);
 
@@ -418,15 +428,15 @@ static const cq_vtable g_cq_vtable[] = {
     /* GRPC_CQ_NEXT */
     {GRPC_CQ_NEXT, sizeof(cq_next_data), cq_init_next, cq_shutdown_next,
      cq_destroy_next, cq_begin_op_for_next, cq_end_op_for_next, cq_next,
-     nullptr},
+     nullptr, cq_next_batch},
     /* GRPC_CQ_PLUCK */
     {GRPC_CQ_PLUCK, sizeof(cq_pluck_data), cq_init_pluck, cq_shutdown_pluck,
      cq_destroy_pluck, cq_begin_op_for_pluck, cq_end_op_for_pluck, nullptr,
-     cq_pluck},
+     cq_pluck, nullptr},
     /* GRPC_CQ_CALLBACK */
     {GRPC_CQ_CALLBACK, sizeof(cq_callback_data), cq_init_callback,
      cq_shutdown_callback, cq_destroy_callback, cq_begin_op_for_callback,
-     cq_end_op_for_callback, nullptr, nullptr},
+     cq_end_op_for_callback, nullptr, nullptr, nullptr},
 };
 
 #define DATA_FROM_CQ(cq) ((void*)((cq) + 1))
@@ -487,26 +497,38 @@ bool CqEventQueue::Push(grpc_cq_completion* c) {
 
 grpc_cq_completion* CqEventQueue::Pop() {
   grpc_cq_completion* c = nullptr;
+  PopBatch(&c, 1);
+  return c;
+}
+
+size_t CqEventQueue::PopBatch(grpc_cq_completion** out, size_t max) {
+  size_t n = 0;
 
   if (gpr_spinlock_trylock(&queue_lock_)) {
     GRPC_STATS_INC_CQ_EV_QUEUE_TRYLOCK_SUCCESSES();
 
     bool is_empty = false;
-    c = reinterpret_cast<grpc_cq_completion*>(queue_.PopAndCheckEnd(&is_empty));
+    while (n < max) {
+      grpc_cq_completion* c = reinterpret_cast<grpc_cq_completion*>(
+          queue_.PopAndCheckEnd(&is_empty));
+      if (c == nullptr) break;
+      out[n++] = c;
+    }
     gpr_spinlock_unlock(&queue_lock_);
 
-    if (c == nullptr && !is_empty) {
+    if (n < max && !is_empty) {
       GRPC_STATS_INC_CQ_EV_QUEUE_TRANSIENT_POP_FAILURES();
     }
   } else {
     GRPC_STATS_INC_CQ_EV_QUEUE_TRYLOCK_FAILURES();
   }
 
-  if (c) {
-    num_queue_items_.fetch_sub(1, std::memory_order_relaxed);
+  if (n > 0) {
+    num_queue_items_.fetch_sub(static_cast<intptr_t>(n),
+                               std::memory_order_relaxed);
   }
 
-  return c;
+  return n;
 }
 
 grpc_completion_queue* grpc_completion_queue_create_internal(
@@ -958,24 +980,38 @@ static void dump_pending_tags(grpc_completion_queue* cq) {
 static void dump_pending_tags(grpc_completion_queue* /*cq*/) {}
 #endif
 
-static grpc_event cq_next(grpc_completion_queue* cq, gpr_timespec deadline,
-                          void* reserved) {
-  GPR_TIMER_SCOPE("grpc_completion_queue_next", 0);
+/* Fills events with up to max_events completions that are ready to be popped
+   right away, without polling. Returns how many it filled. */
+static int cq_drain_ready(cq_next_data* cqd, grpc_event* events,
+                          int max_events) {
+  grpc_cq_completion* batch[16];
+  int n = 0;
+  while (n < max_events) {
+    size_t want = std::min(GPR_ARRAY_SIZE(batch),
+                           static_cast<size_t>(max_events - n));
+    size_t got = cqd->queue.PopBatch(batch, want);
+    for (size_t i = 0; i < got; i++) {
+      grpc_cq_completion* c = batch[i];
+      events[n].type = GRPC_OP_COMPLETE;
+      events[n].success = c->next & 1u;
+      events[n].tag = c->tag;
+      c->done(c->done_arg, c);
+      n++;
+    }
+    if (got < want) break;
+  }
+  return n;
+}
 
-  grpc_event ret;
+/* Shared by grpc_completion_queue_next and grpc_completion_queue_next_batch:
+   waits for the first completion like the former, then takes whatever else is
+   already queued (up to max_events) before returning. Timeouts and shutdown
+   are reported as a single event. */
+static int cq_next_events(grpc_completion_queue* cq, grpc_event* events,
+                          int max_events, gpr_timespec deadline) {
+  int num_events = 0;
   cq_next_data* cqd = static_cast<cq_next_data*> DATA_FROM_CQ(cq);
 
-  GRPC_API_TRACE(
-      "grpc_completion_queue_next("
-      "cq=%p, "
-      "deadline=gpr_timespec { tv_sec: %" PRId64
-      ", tv_nsec: %d, clock_type: %d }, "
-      "reserved=%p)",
-      5,
-      (cq, deadline.tv_sec, deadline.tv_nsec, (int)deadline.clock_type,
-       reserved));
-  GPR_ASSERT(!reserved);
-
   dump_pending_tags(cq);
 
   GRPC_CQ_INTERNAL_REF(cq, "next");
@@ -996,27 +1032,24 @@ static grpc_event cq_next(grpc_completion_queue* cq, gpr_timespec deadline,
     if (is_finished_arg.stolen_completion != nullptr) {
       grpc_cq_completion* c = is_finished_arg.stolen_completion;
       is_finished_arg.stolen_completion = nullptr;
-      ret.type = GRPC_OP_COMPLETE;
-      ret.success = c->next & 1u;
-      ret.tag = c->tag;
+      events[0].type = GRPC_OP_COMPLETE;
+      events[0].success = c->next & 1u;
+      events[0].tag = c->tag;
       c->done(c->done_arg, c);
+      num_events = 1 + cq_drain_ready(cqd, events + 1, max_events - 1);
       break;
     }
 
-    grpc_cq_completion* c = cqd->queue.Pop();
+    num_events = cq_drain_ready(cqd, events, max_events);
 
-    if (c != nullptr) {
-      ret.type = GRPC_OP_COMPLETE;
-      ret.success = c->next & 1u;
-      ret.tag = c->tag;
-      c->done(c->done_arg, c);
+    if (num_events > 0) {
       break;
     } else {
-      /* If c == NULL it means either the queue is empty OR in an transient
-         inconsistent state. If it is the latter, we shold do a 0-timeout poll
-         so that the thread comes back quickly from poll to make a second
-         attempt at popping. Not doing this can potentially deadlock this
-         thread forever (if the deadline is infinity) */
+      /* If nothing was popped it means either the queue is empty OR in an
+         transient inconsistent state. If it is the latter, we shold do a
+         0-timeout poll so that the thread comes back quickly from poll to make
+         a second attempt at popping. Not doing this can potentially deadlock
+         this thread forever (if the deadline is infinity) */
       if (cqd->queue.num_items() > 0) {
         iteration_deadline = grpc_core::Timestamp::ProcessEpoch();
       }
@@ -1035,15 +1068,17 @@ static grpc_event cq_next(grpc_completion_queue* cq, gpr_timespec deadline,
         continue;
       }
 
-      ret.type = GRPC_QUEUE_SHUTDOWN;
-      ret.success = 0;
+      events[0].type = GRPC_QUEUE_SHUTDOWN;
+      events[0].success = 0;
+      num_events = 1;
       break;
     }
 
     if (!is_finished_arg.first_loop &&
         grpc_core::ExecCtx::Get()->Now() >= deadline_millis) {
-      ret.type = GRPC_QUEUE_TIMEOUT;
-      ret.success = 0;
+      events[0].type = GRPC_QUEUE_TIMEOUT;
+      events[0].success = 0;
+      num_events = 1;
       dump_pending_tags(cq);
       break;
     }
@@ -1060,11 +1095,12 @@ static grpc_event cq_next(grpc_completion_queue* cq, gpr_timespec deadline,
               grpc_error_std_string(err).c_str());
       GRPC_ERROR_UNREF(err);
       if (err == GRPC_ERROR_CANCELLED) {
-        ret.type = GRPC_QUEUE_SHUTDOWN;
+        events[0].type = GRPC_QUEUE_SHUTDOWN;
       } else {
-        ret.type = GRPC_QUEUE_TIMEOUT;
+        events[0].type = GRPC_QUEUE_TIMEOUT;
       }
-      ret.success = 0;
+      events[0].success = 0;
+      num_events = 1;
       dump_pending_tags(cq);
       break;
     }
@@ -1078,14 +1114,56 @@ static grpc_event cq_next(grpc_completion_queue* cq, gpr_timespec deadline,
     gpr_mu_unlock(cq->mu);
   }
 
-  GRPC_SURFACE_TRACE_RETURNED_EVENT(cq, &ret);
+  for (int i = 0; i < num_events; i++) {
+    GRPC_SURFACE_TRACE_RETURNED_EVENT(cq, &events[i]);
+  }
   GRPC_CQ_INTERNAL_UNREF(cq, "next");
 
   GPR_ASSERT(is_finished_arg.stolen_completion == nullptr);
 
+  return num_events;
+}
+
+static grpc_event cq_next(grpc_completion_queue* cq, gpr_timespec deadline,
+                          void* reserved) {
+  GPR_TIMER_SCOPE("grpc_completion_queue_next", 0);
+
+  GRPC_API_TRACE(
+      "grpc_completion_queue_next("
+      "cq=%p, "
+      "deadline=gpr_timespec { tv_sec: %" PRId64
+      ", tv_nsec: %d, clock_type: %d }, "
+      "reserved=%p)",
+      5,
+      (cq, deadline.tv_sec, deadline.tv_nsec, (int)deadline.clock_type,
+       reserved));
+  GPR_ASSERT(!reserved);
+
+  grpc_event ret;
+  cq_next_events(cq, &ret, 1, deadline);
   return ret;
 }
 
+static int cq_next_batch(grpc_completion_queue* cq, grpc_event* events,
+                         int max_events, gpr_timespec deadline,
+                         void* reserved) {
+  GPR_TIMER_SCOPE("grpc_completion_queue_next_batch", 0);
+
+  GRPC_API_TRACE(
+      "grpc_completion_queue_next_batch("
+      "cq=%p, events=%p, max_events=%d, "
+      "deadline=gpr_timespec { tv_sec: %" PRId64
+      ", tv_nsec: %d, clock_type: %d }, "
+      "reserved=%p)",
+      7,
+      (cq, events, max_events, deadline.tv_sec, deadline.tv_nsec,
+       (int)deadline.clock_type, reserved));
+  GPR_ASSERT(!reserved);
+  GPR_ASSERT(max_events > 0);
+
+  return cq_next_events(cq, events, max_events, deadline);
+}
+
 /* Finishes the completion queue shutdown. This means that there are no more
    completion events / tags expected from the completion queue
    - Must be called under completion queue lock
@@ -1133,6 +1211,12 @@ grpc_event grpc_completion_queue_next(grpc_completion_queue* cq,
   return cq->vtable->next(cq, deadline, reserved);
 }
 
+int grpc_completion_queue_next_batch(grpc_completion_queue* cq,
+                                     grpc_event* events, int max_events,
+                                     gpr_timespec deadline, void* reserved) {
+  return cq->vtable->next_batch(cq, events, max_events, deadline, reserved);
+}
+
 static int add_plucker(grpc_completion_queue* cq, void* tag,
                        grpc_pollset_worker** worker) {
   cq_pluck_data* cqd = static_cast<cq_pluck_data*> DATA_FROM_CQ(cq);
@@ -302,6 +302,15 @@ struct GrpcPreviousRpcAttemptsMetadata
   static absl::string_view key() { return "grpc-previous-rpc-attempts"; }
 };
 
+// grpc-deflate-dictionary metadata trait.
+// Sent in initial metadata by a peer that can inflate messages primed with a
+// preset deflate dictionary; the value is the dictionary's zlib id.
+struct GrpcDeflateDictionaryMetadata
+    : public SimpleIntBasedMetadata<uint32_t, 0> {
+  static constexpr bool kRepeatable = false;
+  static absl::string_view key() { return "grpc-deflate-dictionary"; }
+};
+
 // grpc-retry-pushback-ms metadata trait.
 struct GrpcRetryPushbackMsMetadata {
   static constexpr bool kRepeatable = false;
@@ -1289,7 +1298,8 @@ using grpc_metadata_batch_base = grpc_core::MetadataMap<
     // Non-colon prefixed headers begin here
     grpc_core::ContentTypeMetadata, grpc_core::TeMetadata,
     grpc_core::GrpcEncodingMetadata, grpc_core::GrpcInternalEncodingRequest,
-    grpc_core::GrpcAcceptEncodingMetadata, grpc_core::GrpcStatusMetadata,
+    grpc_core::GrpcAcceptEncodingMetadata,
+    grpc_core::GrpcDeflateDictionaryMetadata, grpc_core::GrpcStatusMetadata,
     grpc_core::GrpcTimeoutMetadata, grpc_core::GrpcPreviousRpcAttemptsMetadata,
     grpc_core::GrpcRetryPushbackMsMetadata, grpc_core::UserAgentMetadata,
     grpc_core::GrpcMessageMetadata, grpc_core::HostMetadata,
@@ -141,6 +141,10 @@ grpc_endpoint* grpc_transport_get_endpoint(grpc_transport* transport) {
   return transport->vtable->get_endpoint(transport);
 }
 
+uint32_t grpc_transport_max_concurrent_streams(grpc_transport* transport) {
+  return transport->vtable->max_concurrent_streams(transport);
+}
+
 // This comment should be sung to the tune of
 // "Supercalifragilisticexpialidocious":
 //
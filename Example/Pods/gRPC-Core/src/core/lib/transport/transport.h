@@ -576,6 +576,10 @@ void grpc_transport_destroy(grpc_transport* transport);
 /* Get the endpoint used by \a transport */
 grpc_endpoint* grpc_transport_get_endpoint(grpc_transport* transport);
 
+/* Get the most streams the peer of \a transport currently allows to be open
+   at once (UINT32_MAX if unlimited). Safe to call from any thread. */
+uint32_t grpc_transport_max_concurrent_streams(grpc_transport* transport);
+
 /* Allocate a grpc_transport_op, and preconfigure the on_complete closure to
    \a on_complete and then delete the returned transport op */
 grpc_transport_op* grpc_make_transport_op(grpc_closure* on_complete);
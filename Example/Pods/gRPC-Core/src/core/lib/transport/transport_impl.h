@@ -83,6 +83,9 @@ typedef struct grpc_transport_vtable {
 
   /* implementation of grpc_transport_get_endpoint */
   grpc_endpoint* (*get_endpoint)(grpc_transport* self);
+
+  /* implementation of grpc_transport_max_concurrent_streams */
+  uint32_t (*max_concurrent_streams)(grpc_transport* self);
 } grpc_transport_vtable;
 
 /* an instance of a grpc transport */
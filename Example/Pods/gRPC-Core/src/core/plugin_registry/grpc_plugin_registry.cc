@@ -43,11 +43,17 @@ void grpc_lb_policy_pick_first_init(void);
 void grpc_lb_policy_pick_first_shutdown(void);
 void grpc_lb_policy_round_robin_init(void);
 void grpc_lb_policy_round_robin_shutdown(void);
+void grpc_lb_policy_weighted_round_robin_init(void);
+void grpc_lb_policy_weighted_round_robin_shutdown(void);
+void grpc_lb_policy_least_request_init(void);
+void grpc_lb_policy_least_request_shutdown(void);
 void grpc_resolver_dns_ares_init(void);
 void grpc_resolver_dns_ares_shutdown(void);
 namespace grpc_core {
 void GrpcLbPolicyRingHashInit(void);
 void GrpcLbPolicyRingHashShutdown(void);
+void GrpcLbPolicyMaglevInit(void);
+void GrpcLbPolicyMaglevShutdown(void);
 #ifndef GRPC_NO_RLS
 void RlsLbPluginInit();
 void RlsLbPluginShutdown();
@@ -72,8 +78,14 @@ void grpc_register_built_in_plugins(void) {
                        grpc_lb_policy_pick_first_shutdown);
   grpc_register_plugin(grpc_lb_policy_round_robin_init,
                        grpc_lb_policy_round_robin_shutdown);
+  grpc_register_plugin(grpc_lb_policy_weighted_round_robin_init,
+                       grpc_lb_policy_weighted_round_robin_shutdown);
+  grpc_register_plugin(grpc_lb_policy_least_request_init,
+                       grpc_lb_policy_least_request_shutdown);
   grpc_register_plugin(grpc_core::GrpcLbPolicyRingHashInit,
                        grpc_core::GrpcLbPolicyRingHashShutdown);
+  grpc_register_plugin(grpc_core::GrpcLbPolicyMaglevInit,
+                       grpc_core::GrpcLbPolicyMaglevShutdown);
   grpc_register_plugin(grpc_resolver_dns_ares_init,
                        grpc_resolver_dns_ares_shutdown);
   grpc_register_extra_plugins();
@@ -101,6 +113,7 @@ extern void FaultInjectionFilterRegister(CoreConfiguration::Builder* builder);
 extern void RegisterNativeDnsResolver(CoreConfiguration::Builder* builder);
 extern void RegisterAresDnsResolver(CoreConfiguration::Builder* builder);
 extern void RegisterSockaddrResolver(CoreConfiguration::Builder* builder);
+extern void RegisterShmHandshaker(CoreConfiguration::Builder* builder);
 extern void RegisterFakeResolver(CoreConfiguration::Builder* builder);
 #ifdef GPR_SUPPORT_BINDER_TRANSPORT
 extern void RegisterBinderResolver(CoreConfiguration::Builder* builder);
@@ -109,8 +122,9 @@ extern void RegisterBinderResolver(CoreConfiguration::Builder* builder);
 void BuildCoreConfiguration(CoreConfiguration::Builder* builder) {
   // The order of the handshaker registration is crucial here.
   // We want TCP connect handshaker to be registered last so that it is added to
-  // the start of the handshaker list.
+  // the start of the handshaker list, directly followed by the shm handshaker.
   RegisterHttpConnectHandshaker(builder);
+  RegisterShmHandshaker(builder);
   RegisterTCPConnectHandshaker(builder);
   BuildClientChannelConfiguration(builder);
   SecurityRegisterHandshakerFactories(builder);
@@ -81,6 +81,8 @@
 #include "absl/strings/string_view.h"
 
 #include <grpc/grpc_security.h>
+#include <grpc/slice.h>
+#include <grpc/slice_buffer.h>
 #include <grpc/support/alloc.h>
 #include <grpc/support/log.h>
 #include <grpc/support/string_util.h>
@@ -92,6 +94,7 @@
 #include "src/core/tsi/ssl/session_cache/ssl_session_cache.h"
 #include "src/core/tsi/ssl_types.h"
 #include "src/core/tsi/transport_security.h"
+#include "src/core/tsi/transport_security_grpc.h"
 
 /* --- Constants. ---*/
 
@@ -110,6 +113,18 @@
    SSL structure. This is what we would ultimately want though... */
 #define TSI_SSL_MAX_PROTECTION_OVERHEAD 100
 
+/* The zero-copy protector drives SSL through a custom BIO, which needs the
+   BIO_meth_* API. */
+#if defined(OPENSSL_IS_BORINGSSL) || OPENSSL_VERSION_NUMBER >= 0x10100000
+#define TSI_SSL_ZERO_COPY_SUPPORT 1
+#else
+#define TSI_SSL_ZERO_COPY_SUPPORT 0
+#endif
+
+/* Size of a TLS record header, and the largest plaintext a record carries. */
+#define TSI_SSL_RECORD_HEADER_SIZE 5
+#define TSI_SSL_MAX_RECORD_PLAINTEXT_SIZE 16384
+
 using TlsSessionKeyLogger = tsi::TlsSessionKeyLoggerCache::TlsSessionKeyLogger;
 
 /* --- Structure definitions. ---*/
@@ -169,6 +184,25 @@ struct tsi_ssl_frame_protector {
   size_t buffer_size;
   size_t buffer_offset;
 };
+#if TSI_SSL_ZERO_COPY_SUPPORT
+struct tsi_ssl_zero_copy_grpc_protector {
+  tsi_zero_copy_grpc_protector base;
+  /* Serializes protect and unprotect, which both drive ssl. */
+  gpr_mu mu;
+  SSL* ssl;
+  size_t max_frame_size;
+  /* Coalesces small unprotected slices into full records. */
+  unsigned char* buffer;
+  size_t buffer_size;
+  size_t buffer_offset;
+  /* Protected bytes not yet read by ssl. Only the first readable_bytes of them,
+     which make up complete records, are handed to ssl. */
+  grpc_slice_buffer protected_sb;
+  size_t readable_bytes;
+  /* Protected bytes written by ssl, not yet returned by protect. */
+  grpc_slice_buffer protected_output;
+};
+#endif /* TSI_SSL_ZERO_COPY_SUPPORT */
 /* --- Library Initialization. ---*/
 
 static gpr_once g_init_openssl_once = GPR_ONCE_INIT;
@@ -1232,6 +1266,231 @@ static const tsi_frame_protector_vtable frame_protector_vtable = {
     ssl_protector_destroy,
 };
 
+#if TSI_SSL_ZERO_COPY_SUPPORT
+
+/* --- tsi_zero_copy_grpc_protector methods implementation. ---
+
+   After the handshake, the BIO pair used by the handshaker is replaced by a BIO
+   that reads protected bytes straight out of protected_sb and writes records
+   straight into protected_output, so that SSL encrypts from and decrypts into
+   the caller's slices without the staging buffers and BIO pair copies of the
+   tsi_frame_protector path. */
+
+static int ssl_zero_copy_bio_write(BIO* bio, const char* in, int inl) {
+  tsi_ssl_zero_copy_grpc_protector* impl =
+      static_cast<tsi_ssl_zero_copy_grpc_protector*>(BIO_get_data(bio));
+  BIO_clear_retry_flags(bio);
+  if (inl <= 0) return 0;
+  grpc_slice slice = GRPC_SLICE_MALLOC(static_cast<size_t>(inl));
+  memcpy(GRPC_SLICE_START_PTR(slice), in, static_cast<size_t>(inl));
+  grpc_slice_buffer_add(&impl->protected_output, slice);
+  return inl;
+}
+
+static int ssl_zero_copy_bio_read(BIO* bio, char* out, int outl) {
+  tsi_ssl_zero_copy_grpc_protector* impl =
+      static_cast<tsi_ssl_zero_copy_grpc_protector*>(BIO_get_data(bio));
+  BIO_clear_retry_flags(bio);
+  if (outl <= 0) return 0;
+  size_t n = std::min(static_cast<size_t>(outl), impl->readable_bytes);
+  if (n == 0) {
+    BIO_set_retry_read(bio);
+    return -1;
+  }
+  grpc_slice_buffer_move_first_into_buffer(&impl->protected_sb, n, out);
+  impl->readable_bytes -= n;
+  return static_cast<int>(n);
+}
+
+static long ssl_zero_copy_bio_ctrl(BIO* /*bio*/, int cmd, long /*num*/,
+                                   void* /*ptr*/) {
+  /* Writes complete immediately, so a flush has nothing to do. */
+  return cmd == BIO_CTRL_FLUSH ? 1 : 0;
+}
+
+static int ssl_zero_copy_bio_create(BIO* bio) {
+  BIO_set_init(bio, 1);
+  return 1;
+}
+
+static gpr_once g_ssl_zero_copy_bio_method_once = GPR_ONCE_INIT;
+static BIO_METHOD* g_ssl_zero_copy_bio_method = nullptr;
+
+static void init_ssl_zero_copy_bio_method(void) {
+  g_ssl_zero_copy_bio_method =
+      BIO_meth_new(BIO_get_new_index() | BIO_TYPE_SOURCE_SINK, "grpc_slices");
+  GPR_ASSERT(g_ssl_zero_copy_bio_method != nullptr);
+  BIO_meth_set_write(g_ssl_zero_copy_bio_method, ssl_zero_copy_bio_write);
+  BIO_meth_set_read(g_ssl_zero_copy_bio_method, ssl_zero_copy_bio_read);
+  BIO_meth_set_ctrl(g_ssl_zero_copy_bio_method, ssl_zero_copy_bio_ctrl);
+  BIO_meth_set_create(g_ssl_zero_copy_bio_method, ssl_zero_copy_bio_create);
+}
+
+/* Copies the TLS record header at offset in sb to header. sb must hold at
+   least TSI_SSL_RECORD_HEADER_SIZE bytes from offset. */
+static void ssl_zero_copy_peek_record_header(const grpc_slice_buffer* sb,
+                                             size_t offset,
+                                             unsigned char* header) {
+  size_t i = 0;
+  while (offset >= GRPC_SLICE_LENGTH(sb->slices[i])) {
+    offset -= GRPC_SLICE_LENGTH(sb->slices[i]);
+    i++;
+  }
+  for (size_t copied = 0; copied < TSI_SSL_RECORD_HEADER_SIZE;) {
+    const grpc_slice& slice = sb->slices[i];
+    size_t n = std::min(GRPC_SLICE_LENGTH(slice) - offset,
+                        TSI_SSL_RECORD_HEADER_SIZE - copied);
+    memcpy(header + copied, GRPC_SLICE_START_PTR(slice) + offset, n);
+    copied += n;
+    offset = 0;
+    i++;
+  }
+}
+
+/* Extends readable_bytes over the complete records in protected_sb, and
+   returns the number of bytes still needed to complete the next one. */
+static size_t ssl_zero_copy_update_readable_bytes(
+    tsi_ssl_zero_copy_grpc_protector* impl) {
+  while (true) {
+    size_t available = impl->protected_sb.length - impl->readable_bytes;
+    if (available < TSI_SSL_RECORD_HEADER_SIZE) {
+      return TSI_SSL_RECORD_HEADER_SIZE - available;
+    }
+    unsigned char header[TSI_SSL_RECORD_HEADER_SIZE];
+    ssl_zero_copy_peek_record_header(&impl->protected_sb, impl->readable_bytes,
+                                     header);
+    /* Not a TLS record (content types are 20 to 24): hand everything to ssl
+       and let it report the corruption. */
+    if (header[0] < 20 || header[0] > 24) {
+      impl->readable_bytes = impl->protected_sb.length;
+      return 1;
+    }
+    size_t record_size = TSI_SSL_RECORD_HEADER_SIZE +
+                         ((static_cast<size_t>(header[3]) << 8) | header[4]);
+    if (available < record_size) return record_size - available;
+    impl->readable_bytes += record_size;
+  }
+}
+
+static tsi_result ssl_zero_copy_grpc_protector_protect(
+    tsi_zero_copy_grpc_protector* self, grpc_slice_buffer* unprotected_slices,
+    grpc_slice_buffer* protected_slices) {
+  if (self == nullptr || unprotected_slices == nullptr ||
+      protected_slices == nullptr) {
+    gpr_log(GPR_ERROR, "Invalid nullptr arguments to zero-copy ssl protect.");
+    return TSI_INVALID_ARGUMENT;
+  }
+  tsi_ssl_zero_copy_grpc_protector* impl =
+      reinterpret_cast<tsi_ssl_zero_copy_grpc_protector*>(self);
+  tsi_result result = TSI_OK;
+  gpr_mu_lock(&impl->mu);
+  for (size_t i = 0; i < unprotected_slices->count && result == TSI_OK; i++) {
+    grpc_slice slice = unprotected_slices->slices[i];
+    unsigned char* bytes = GRPC_SLICE_START_PTR(slice);
+    size_t size = GRPC_SLICE_LENGTH(slice);
+    while (size > 0 && result == TSI_OK) {
+      if (impl->buffer_offset == 0 && size >= impl->buffer_size) {
+        /* Seal whole records straight out of the slice; ssl splits the write
+           at the max send fragment, which is buffer_size. */
+        size_t n = std::min(size - size % impl->buffer_size,
+                            static_cast<size_t>(INT_MAX) / impl->buffer_size *
+                                impl->buffer_size);
+        result = do_ssl_write(impl->ssl, bytes, n);
+        bytes += n;
+        size -= n;
+        continue;
+      }
+      /* Otherwise coalesce into the next record. */
+      size_t n = std::min(size, impl->buffer_size - impl->buffer_offset);
+      memcpy(impl->buffer + impl->buffer_offset, bytes, n);
+      impl->buffer_offset += n;
+      bytes += n;
+      size -= n;
+      if (impl->buffer_offset == impl->buffer_size) {
+        result = do_ssl_write(impl->ssl, impl->buffer, impl->buffer_offset);
+        impl->buffer_offset = 0;
+      }
+    }
+  }
+  if (result == TSI_OK && impl->buffer_offset != 0) {
+    result = do_ssl_write(impl->ssl, impl->buffer, impl->buffer_offset);
+    impl->buffer_offset = 0;
+  }
+  grpc_slice_buffer_move_into(&impl->protected_output, protected_slices);
+  gpr_mu_unlock(&impl->mu);
+  grpc_slice_buffer_reset_and_unref(unprotected_slices);
+  return result;
+}
+
+static tsi_result ssl_zero_copy_grpc_protector_unprotect(
+    tsi_zero_copy_grpc_protector* self, grpc_slice_buffer* protected_slices,
+    grpc_slice_buffer* unprotected_slices, int* min_progress_size) {
+  if (self == nullptr || unprotected_slices == nullptr ||
+      protected_slices == nullptr) {
+    gpr_log(GPR_ERROR,
+            "Invalid nullptr arguments to zero-copy ssl unprotect.");
+    return TSI_INVALID_ARGUMENT;
+  }
+  tsi_ssl_zero_copy_grpc_protector* impl =
+      reinterpret_cast<tsi_ssl_zero_copy_grpc_protector*>(self);
+  tsi_result result = TSI_OK;
+  gpr_mu_lock(&impl->mu);
+  grpc_slice_buffer_move_into(protected_slices, &impl->protected_sb);
+  size_t needed = ssl_zero_copy_update_readable_bytes(impl);
+  while (impl->readable_bytes > 0 || SSL_pending(impl->ssl) > 0) {
+    /* A record's plaintext is never larger than the record itself. */
+    size_t size = std::max(
+        std::min(impl->readable_bytes,
+                 static_cast<size_t>(TSI_SSL_MAX_RECORD_PLAINTEXT_SIZE)),
+        static_cast<size_t>(SSL_pending(impl->ssl)));
+    grpc_slice slice = GRPC_SLICE_MALLOC(size);
+    result = do_ssl_read(impl->ssl, GRPC_SLICE_START_PTR(slice), &size);
+    if (result != TSI_OK || size == 0) {
+      grpc_slice_unref(slice);
+      break;
+    }
+    GRPC_SLICE_SET_LENGTH(slice, size);
+    grpc_slice_buffer_add(unprotected_slices, slice);
+  }
+  gpr_mu_unlock(&impl->mu);
+  if (min_progress_size != nullptr) {
+    *min_progress_size = static_cast<int>(needed);
+  }
+  return result;
+}
+
+static void ssl_zero_copy_grpc_protector_destroy(
+    tsi_zero_copy_grpc_protector* self) {
+  if (self == nullptr) return;
+  tsi_ssl_zero_copy_grpc_protector* impl =
+      reinterpret_cast<tsi_ssl_zero_copy_grpc_protector*>(self);
+  if (impl->ssl != nullptr) SSL_free(impl->ssl);
+  gpr_free(impl->buffer);
+  grpc_slice_buffer_destroy(&impl->protected_sb);
+  grpc_slice_buffer_destroy(&impl->protected_output);
+  gpr_mu_destroy(&impl->mu);
+  gpr_free(impl);
+}
+
+static tsi_result ssl_zero_copy_grpc_protector_max_frame_size(
+    tsi_zero_copy_grpc_protector* self, size_t* max_frame_size) {
+  if (self == nullptr || max_frame_size == nullptr) return TSI_INVALID_ARGUMENT;
+  tsi_ssl_zero_copy_grpc_protector* impl =
+      reinterpret_cast<tsi_ssl_zero_copy_grpc_protector*>(self);
+  *max_frame_size = impl->max_frame_size;
+  return TSI_OK;
+}
+
+static const tsi_zero_copy_grpc_protector_vtable
+    zero_copy_grpc_protector_vtable = {
+        ssl_zero_copy_grpc_protector_protect,
+        ssl_zero_copy_grpc_protector_unprotect,
+        ssl_zero_copy_grpc_protector_destroy,
+        ssl_zero_copy_grpc_protector_max_frame_size,
+};
+
+#endif /* TSI_SSL_ZERO_COPY_SUPPORT */
+
 /* --- tsi_server_handshaker_factory methods implementation. --- */
 
 static void tsi_ssl_handshaker_factory_destroy(
@@ -1369,10 +1628,99 @@ static tsi_result ssl_handshaker_result_extract_peer(
 static tsi_result ssl_handshaker_result_get_frame_protector_type(
     const tsi_handshaker_result* /*self*/,
     tsi_frame_protector_type* frame_protector_type) {
+#if TSI_SSL_ZERO_COPY_SUPPORT
+  *frame_protector_type = TSI_FRAME_PROTECTOR_NORMAL_OR_ZERO_COPY;
+#else
   *frame_protector_type = TSI_FRAME_PROTECTOR_NORMAL;
+#endif
   return TSI_OK;
 }
 
+#if TSI_SSL_ZERO_COPY_SUPPORT
+static tsi_result ssl_handshaker_result_create_zero_copy_grpc_protector(
+    const tsi_handshaker_result* self, size_t* max_output_protected_frame_size,
+    tsi_zero_copy_grpc_protector** protector) {
+  tsi_ssl_handshaker_result* impl =
+      reinterpret_cast<tsi_ssl_handshaker_result*>(
+          const_cast<tsi_handshaker_result*>(self));
+  /* Unless asked for smaller frames, send full size records. */
+  size_t max_frame_size =
+      TSI_SSL_MAX_RECORD_PLAINTEXT_SIZE + TSI_SSL_MAX_PROTECTION_OVERHEAD;
+  if (max_output_protected_frame_size != nullptr) {
+    *max_output_protected_frame_size =
+        grpc_core::Clamp(*max_output_protected_frame_size,
+                         static_cast<size_t>(
+                             TSI_SSL_MAX_PROTECTED_FRAME_SIZE_LOWER_BOUND),
+                         max_frame_size);
+    max_frame_size = *max_output_protected_frame_size;
+  }
+  BIO* bio = nullptr;
+  gpr_once_init(&g_ssl_zero_copy_bio_method_once,
+                init_ssl_zero_copy_bio_method);
+  tsi_ssl_zero_copy_grpc_protector* protector_impl =
+      grpc_core::Zalloc<tsi_ssl_zero_copy_grpc_protector>();
+  protector_impl->base.vtable = &zero_copy_grpc_protector_vtable;
+  gpr_mu_init(&protector_impl->mu);
+  protector_impl->max_frame_size = max_frame_size;
+  protector_impl->buffer_size = max_frame_size - TSI_SSL_MAX_PROTECTION_OVERHEAD;
+  protector_impl->buffer =
+      static_cast<unsigned char*>(gpr_malloc(protector_impl->buffer_size));
+  grpc_slice_buffer_init(&protector_impl->protected_sb);
+  grpc_slice_buffer_init(&protector_impl->protected_output);
+  /* Transfer ownership of ssl to the protector. */
+  protector_impl->ssl = impl->ssl;
+  impl->ssl = nullptr;
+  /* Keep whatever is still buffered in the BIO pair in either direction: the
+     ssl end may hold records that followed the handshake, the network end
+     handshake bytes that were not sent yet. */
+  BIO* ssl_io = SSL_get_rbio(protector_impl->ssl);
+  for (int pending; (pending = static_cast<int>(BIO_pending(ssl_io))) > 0;) {
+    grpc_slice slice = GRPC_SLICE_MALLOC(static_cast<size_t>(pending));
+    int read = BIO_read(ssl_io, GRPC_SLICE_START_PTR(slice), pending);
+    if (read <= 0) {
+      grpc_slice_unref(slice);
+      gpr_log(GPR_ERROR, "Could not read from BIO even though some data is "
+                         "pending");
+      goto error;
+    }
+    GRPC_SLICE_SET_LENGTH(slice, static_cast<size_t>(read));
+    grpc_slice_buffer_add(&protector_impl->protected_sb, slice);
+  }
+  for (int pending;
+       (pending = static_cast<int>(BIO_pending(impl->network_io))) > 0;) {
+    grpc_slice slice = GRPC_SLICE_MALLOC(static_cast<size_t>(pending));
+    int read = BIO_read(impl->network_io, GRPC_SLICE_START_PTR(slice), pending);
+    if (read <= 0) {
+      grpc_slice_unref(slice);
+      gpr_log(GPR_ERROR, "Could not read from BIO even though some data is "
+                         "pending");
+      goto error;
+    }
+    GRPC_SLICE_SET_LENGTH(slice, static_cast<size_t>(read));
+    grpc_slice_buffer_add(&protector_impl->protected_output, slice);
+  }
+  ssl_zero_copy_update_readable_bytes(protector_impl);
+  bio = BIO_new(g_ssl_zero_copy_bio_method);
+  if (bio == nullptr) {
+    gpr_log(GPR_ERROR, "Could not create BIO for zero-copy ssl protector.");
+    goto error;
+  }
+  BIO_set_data(bio, protector_impl);
+  /* This frees the ssl end of the BIO pair. */
+  SSL_set_bio(protector_impl->ssl, bio, bio);
+  BIO_free(impl->network_io);
+  impl->network_io = nullptr;
+  SSL_set_max_send_fragment(protector_impl->ssl,
+                            static_cast<long>(protector_impl->buffer_size));
+  *protector = &protector_impl->base;
+  return TSI_OK;
+
+error:
+  ssl_zero_copy_grpc_protector_destroy(&protector_impl->base);
+  return TSI_INTERNAL_ERROR;
+}
+#endif /* TSI_SSL_ZERO_COPY_SUPPORT */
+
 static tsi_result ssl_handshaker_result_create_frame_protector(
     const tsi_handshaker_result* self, size_t* max_output_protected_frame_size,
     tsi_frame_protector** protector) {
@@ -1440,7 +1788,11 @@ static void ssl_handshaker_result_destroy(tsi_handshaker_result* self) {
 static const tsi_handshaker_result_vtable handshaker_result_vtable = {
     ssl_handshaker_result_extract_peer,
     ssl_handshaker_result_get_frame_protector_type,
+#if TSI_SSL_ZERO_COPY_SUPPORT
+    ssl_handshaker_result_create_zero_copy_grpc_protector,
+#else
     nullptr, /* create_zero_copy_grpc_protector */
+#endif
     ssl_handshaker_result_create_frame_protector,
     ssl_handshaker_result_get_unused_bytes,
     ssl_handshaker_result_destroy,
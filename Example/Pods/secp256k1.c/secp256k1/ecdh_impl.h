@@ -10,6 +10,29 @@
 #include "secp256k1.h"
 #include "ecmult_const_impl.h"
 
+/* Number of shared secrets that share one field inversion in secp256k1_ecdh_batch. */
+#define ECDH_BATCH_SIZE 32
+
+/** Hash an affine point in compressed form into a 32-byte shared secret.
+ *  Note we cannot use secp256k1_eckey_pubkey_serialize here since it does not
+ *  expect its output to be secret and has a timing sidechannel. */
+static void secp256k1_ecdh_hash_point(unsigned char *result, secp256k1_ge *pt) {
+    unsigned char x[32];
+    unsigned char y[1];
+    secp256k1_sha256 sha;
+
+    secp256k1_fe_normalize(&pt->x);
+    secp256k1_fe_normalize(&pt->y);
+    secp256k1_fe_get_b32(x, &pt->x);
+    y[0] = 0x02 | secp256k1_fe_is_odd(&pt->y);
+
+    secp256k1_sha256_initialize(&sha);
+    secp256k1_sha256_write(&sha, y, sizeof(y));
+    secp256k1_sha256_write(&sha, x, sizeof(x));
+    secp256k1_sha256_finalize(&sha, result);
+    memset(x, 0, sizeof(x));
+}
+
 int secp256k1_ecdh(const secp256k1_context* ctx, unsigned char *result, const secp256k1_pubkey *point, const unsigned char *scalar) {
     int ret = 0;
     int overflow = 0;
@@ -21,29 +44,16 @@ int secp256k1_ecdh(const secp256k1_context* ctx, unsigned char *result, const se
     ARG_CHECK(point != NULL);
     ARG_CHECK(scalar != NULL);
 
-    secp256k1_pubkey_load(ctx, &pt, point);
+    if (!secp256k1_pubkey_load(ctx, &pt, point)) {
+        return 0;
+    }
     secp256k1_scalar_set_b32(&s, scalar, &overflow);
     if (overflow || secp256k1_scalar_is_zero(&s)) {
         ret = 0;
     } else {
-        unsigned char x[32];
-        unsigned char y[1];
-        secp256k1_sha256 sha;
-
         secp256k1_ecmult_const(&res, &pt, &s, 256);
         secp256k1_ge_set_gej(&pt, &res);
-        /* Compute a hash of the point in compressed form
-         * Note we cannot use secp256k1_eckey_pubkey_serialize here since it does not
-         * expect its output to be secret and has a timing sidechannel. */
-        secp256k1_fe_normalize(&pt.x);
-        secp256k1_fe_normalize(&pt.y);
-        secp256k1_fe_get_b32(x, &pt.x);
-        y[0] = 0x02 | secp256k1_fe_is_odd(&pt.y);
-
-        secp256k1_sha256_initialize(&sha);
-        secp256k1_sha256_write(&sha, y, sizeof(y));
-        secp256k1_sha256_write(&sha, x, sizeof(x));
-        secp256k1_sha256_finalize(&sha, result);
+        secp256k1_ecdh_hash_point(result, &pt);
         ret = 1;
     }
 
@@ -51,4 +61,54 @@ int secp256k1_ecdh(const secp256k1_context* ctx, unsigned char *result, const se
     return ret;
 }
 
+int secp256k1_ecdh_batch(const secp256k1_context* ctx, unsigned char *results, const secp256k1_pubkey * const *pubkeys, size_t n, const unsigned char *privkey) {
+    int ret = 1;
+    int overflow = 0;
+    int valid[ECDH_BATCH_SIZE];
+    secp256k1_gej res[ECDH_BATCH_SIZE];
+    secp256k1_ge pt[ECDH_BATCH_SIZE];
+    secp256k1_scalar s;
+    size_t i, j, chunk;
+    VERIFY_CHECK(ctx != NULL);
+    ARG_CHECK(results != NULL);
+    ARG_CHECK(n == 0 || pubkeys != NULL);
+    ARG_CHECK(privkey != NULL);
+
+    secp256k1_scalar_set_b32(&s, privkey, &overflow);
+    if (overflow || secp256k1_scalar_is_zero(&s)) {
+        secp256k1_scalar_clear(&s);
+        memset(results, 0, n * 32);
+        return 0;
+    }
+
+    for (i = 0; i < n; i += chunk) {
+        chunk = n - i < ECDH_BATCH_SIZE ? n - i : ECDH_BATCH_SIZE;
+        for (j = 0; j < chunk; j++) {
+            valid[j] = secp256k1_pubkey_load(ctx, &pt[j], pubkeys[i + j]);
+            if (!valid[j]) {
+                /* Multiply the generator instead so that every result in the
+                 * chunk is a valid point for the shared inversion below. */
+                pt[j] = secp256k1_ge_const_g;
+                ret = 0;
+            }
+            secp256k1_ecmult_const(&res[j], &pt[j], &s, 256);
+        }
+        /* The scalar is nonzero and the group has prime order, so none of the
+         * results is infinity and their z coordinates can be inverted together. */
+        secp256k1_ge_set_all_gej(pt, res, chunk);
+        for (j = 0; j < chunk; j++) {
+            if (valid[j]) {
+                secp256k1_ecdh_hash_point(results + 32 * (i + j), &pt[j]);
+            } else {
+                memset(results + 32 * (i + j), 0, 32);
+            }
+            secp256k1_ge_clear(&pt[j]);
+            secp256k1_gej_clear(&res[j]);
+        }
+    }
+
+    secp256k1_scalar_clear(&s);
+    return ret;
+}
+
 #endif /* SECP256K1_MODULE_ECDH_MAIN_H */
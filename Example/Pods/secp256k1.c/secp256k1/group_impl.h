@@ -152,6 +152,32 @@ static void secp256k1_ge_set_all_gej_var(secp256k1_ge *r, const secp256k1_gej *a
     free(azi);
 }
 
+static void secp256k1_ge_set_all_gej(secp256k1_ge *r, const secp256k1_gej *a, size_t len) {
+    secp256k1_fe u;
+    secp256k1_fe zi;
+    size_t i;
+
+    if (len == 0) {
+        return;
+    }
+    /* Use the x coordinates of r to hold the running products of the z coordinates. */
+    r[0].x = a[0].z;
+    for (i = 1; i < len; i++) {
+        secp256k1_fe_mul(&r[i].x, &r[i - 1].x, &a[i].z);
+    }
+    secp256k1_fe_inv(&u, &r[len - 1].x);
+
+    /* Peel off one z coordinate at a time, walking backwards. */
+    for (i = len - 1; i > 0; i--) {
+        secp256k1_fe_mul(&zi, &u, &r[i - 1].x);
+        secp256k1_fe_mul(&u, &u, &a[i].z);
+        secp256k1_ge_set_gej_zinv(&r[i], &a[i], &zi);
+    }
+    secp256k1_ge_set_gej_zinv(&r[0], &a[0], &u);
+    secp256k1_fe_clear(&u);
+    secp256k1_fe_clear(&zi);
+}
+
 static void secp256k1_ge_set_table_gej_var(secp256k1_ge *r, const secp256k1_gej *a, const secp256k1_fe *zr, size_t len) {
     size_t i = len - 1;
     secp256k1_fe zi;
@@ -47,8 +47,8 @@ typedef struct secp256k1_context_struct secp256k1_context;
  *  The purpose of this structure is to replace dynamic memory allocations,
  *  because we target architectures where this may not be available. It is
  *  essentially a resizable (within specified parameters) block of bytes,
- *  which is initially created either by memory allocation or TODO as a pointer
- *  into some fixed rewritable space.
+ *  which is allocated once on first use and then reused by every later call
+ *  until the scratch space is destroyed.
  *
  *  Unlike the context object, this cannot safely be shared between threads
  *  without additional synchronization logic.
@@ -646,6 +646,53 @@ SECP256K1_API SECP256K1_WARN_UNUSED_RESULT int secp256k1_ec_pubkey_combine(
     const secp256k1_pubkey * const * ins,
     size_t n
 ) SECP256K1_ARG_NONNULL(2) SECP256K1_ARG_NONNULL(3);
+
+/** Compute the scratch space size needed by secp256k1_ec_pubkey_multi_mul.
+ *  Returns: the max_size to pass to secp256k1_scratch_space_create so that n
+ *           points are processed in a single batch.
+ *  Args:    ctx:   pointer to a context object (cannot be NULL)
+ *  In:      n:     the number of public keys that will be multiplied
+ *
+ *  A scratch space created with this size can be reused for any later call
+ *  with at most n points. Smaller scratch spaces also work, but the points
+ *  are then processed in several batches.
+ */
+SECP256K1_API size_t secp256k1_ec_pubkey_multi_mul_scratch_size(
+    const secp256k1_context* ctx,
+    size_t n
+) SECP256K1_ARG_NONNULL(1);
+
+/** Compute gscalar*G + sum(scalars[i]*pubkeys[i]) (multi-scalar multiplication).
+ *  Returns: 1: the result is a valid public key.
+ *           0: a scalar was out of range, a public key was invalid, the result
+ *              is the point at infinity, or the scratch space is too small for
+ *              even a single point.
+ *  Args:    ctx:       pointer to a context object initialized for validation
+ *                      (cannot be NULL)
+ *           scratch:   scratch space used for the computation (cannot be NULL).
+ *                      Its memory is allocated on first use and reused by
+ *                      later calls until it is destroyed.
+ *  Out:     out:       pointer to a public key object for placing the result
+ *                      (cannot be NULL)
+ *  In:      gscalar32: pointer to a 32-byte scalar for the generator (can be NULL)
+ *           pubkeys:   pointer to array of pointers to public keys (can be NULL if n is 0)
+ *           scalars32: pointer to array of pointers to 32-byte scalars, one per
+ *                      public key (can be NULL if n is 0)
+ *           n:         the number of public keys (at least 1 if gscalar32 is NULL)
+ *
+ *  Uses Strauss' algorithm for small n and Pippenger's bucket method for large
+ *  n. This function is not constant time and must only be used with public
+ *  scalars.
+ */
+SECP256K1_API SECP256K1_WARN_UNUSED_RESULT int secp256k1_ec_pubkey_multi_mul(
+    const secp256k1_context* ctx,
+    secp256k1_scratch_space *scratch,
+    secp256k1_pubkey *out,
+    const unsigned char *gscalar32,
+    const secp256k1_pubkey * const *pubkeys,
+    const unsigned char * const *scalars32,
+    size_t n
+) SECP256K1_ARG_NONNULL(1) SECP256K1_ARG_NONNULL(2) SECP256K1_ARG_NONNULL(3);
     
     /** Opaque data structured that holds a parsed ECDSA signature,
      *  supporting pubkey recovery.
@@ -758,6 +805,30 @@ SECP256K1_API SECP256K1_WARN_UNUSED_RESULT int secp256k1_ec_pubkey_combine(
                                                                   const secp256k1_pubkey *pubkey,
                                                                   const unsigned char *privkey
                                                                   ) SECP256K1_ARG_NONNULL(1) SECP256K1_ARG_NONNULL(2) SECP256K1_ARG_NONNULL(3) SECP256K1_ARG_NONNULL(4);
+
+    /** Compute EC Diffie-Hellman secrets between one private key and many public keys
+     *  in constant time. Equivalent to calling secp256k1_ecdh once per public key,
+     *  but the affine conversion of the shared points is batched so that only one
+     *  field inversion is needed per group of points.
+     *  Returns: 1: exponentiation was successful
+     *           0: scalar was invalid (zero or overflow), in which case all results
+     *              are zeroed, or some public key was invalid, in which case its
+     *              result is zeroed and the others are still computed
+     *  Args:    ctx:        pointer to a context object (cannot be NULL)
+     *  Out:     results:    a 32*n byte array which will be populated with one ECDH
+     *                       secret per public key, in the same order
+     *  In:      pubkeys:    pointer to an array of n pointers to initialized public
+     *                       keys (can be NULL if n is 0)
+     *           n:          the number of public keys
+     *           privkey:    a 32-byte scalar with which to multiply the points
+     */
+    SECP256K1_API SECP256K1_WARN_UNUSED_RESULT int secp256k1_ecdh_batch(
+                                                                        const secp256k1_context* ctx,
+                                                                        unsigned char *results,
+                                                                        const secp256k1_pubkey * const *pubkeys,
+                                                                        size_t n,
+                                                                        const unsigned char *privkey
+                                                                        ) SECP256K1_ARG_NONNULL(1) SECP256K1_ARG_NONNULL(2) SECP256K1_ARG_NONNULL(5);
     
     
 #ifdef __cplusplus
@@ -10,8 +10,15 @@
 #define SECP256K1_SCRATCH_MAX_FRAMES	5
 
 /* The typedef is used internally; the struct name is used in the public API
- * (where it is exposed as a different typedef) */
+ * (where it is exposed as a different typedef).
+ *
+ * All frames are carved out of a single arena which is allocated the first
+ * time a frame is requested and kept until the scratch space is destroyed, so
+ * that repeated ecmult_multi calls on the same scratch space do not hit the
+ * allocator. */
 typedef struct secp256k1_scratch_space_struct {
+    void *arena;
+    size_t arena_size;
     void *data[SECP256K1_SCRATCH_MAX_FRAMES];
     size_t offset[SECP256K1_SCRATCH_MAX_FRAMES];
     size_t frame_size[SECP256K1_SCRATCH_MAX_FRAMES];
@@ -27,7 +34,7 @@ static void secp256k1_scratch_destroy(secp256k1_scratch* scratch);
 /** Attempts to allocate a new stack frame with `n` available bytes. Returns 1 on success, 0 on failure */
 static int secp256k1_scratch_allocate_frame(secp256k1_scratch* scratch, size_t n, size_t objects);
 
-/** Deallocates a stack frame */
+/** Deallocates a stack frame. The underlying arena memory is kept for reuse. */
 static void secp256k1_scratch_deallocate_frame(secp256k1_scratch* scratch);
 
 /** Returns the maximum allocation the scratch space will allow */
@@ -28,6 +28,7 @@ static secp256k1_scratch* secp256k1_scratch_create(const secp256k1_callback* err
 static void secp256k1_scratch_destroy(secp256k1_scratch* scratch) {
     if (scratch != NULL) {
         VERIFY_CHECK(scratch->frame == 0);
+        free(scratch->arena);
         free(scratch);
     }
 }
@@ -45,14 +46,28 @@ static size_t secp256k1_scratch_max_allocation(const secp256k1_scratch* scratch,
 }
 
 static int secp256k1_scratch_allocate_frame(secp256k1_scratch* scratch, size_t n, size_t objects) {
+    size_t i;
+    size_t offset = 0;
     VERIFY_CHECK(scratch->frame < SECP256K1_SCRATCH_MAX_FRAMES);
 
     if (n <= secp256k1_scratch_max_allocation(scratch, objects)) {
         n += objects * ALIGNMENT;
-        scratch->data[scratch->frame] = checked_malloc(scratch->error_callback, n);
-        if (scratch->data[scratch->frame] == NULL) {
-            return 0;
+        if (scratch->arena == NULL) {
+            /* Reserve the whole arena up front (plus room to keep every frame
+             * start aligned), so that frames never have to be moved and later
+             * calls reuse the same memory. */
+            scratch->arena_size = scratch->max_size + SECP256K1_SCRATCH_MAX_FRAMES * ALIGNMENT;
+            scratch->arena = checked_malloc(scratch->error_callback, scratch->arena_size);
+            if (scratch->arena == NULL) {
+                scratch->arena_size = 0;
+                return 0;
+            }
         }
+        for (i = 0; i < scratch->frame; i++) {
+            offset += ((scratch->frame_size[i] + ALIGNMENT - 1) / ALIGNMENT) * ALIGNMENT;
+        }
+        VERIFY_CHECK(offset + n <= scratch->arena_size);
+        scratch->data[scratch->frame] = (void *) ((unsigned char *) scratch->arena + offset);
         scratch->frame_size[scratch->frame] = n;
         scratch->offset[scratch->frame] = 0;
         scratch->frame++;
@@ -65,7 +80,7 @@ static int secp256k1_scratch_allocate_frame(secp256k1_scratch* scratch, size_t n
 static void secp256k1_scratch_deallocate_frame(secp256k1_scratch* scratch) {
     VERIFY_CHECK(scratch->frame > 0);
     scratch->frame -= 1;
-    free(scratch->data[scratch->frame]);
+    scratch->data[scratch->frame] = NULL;
 }
 
 static void *secp256k1_scratch_alloc(secp256k1_scratch* scratch, size_t size) {
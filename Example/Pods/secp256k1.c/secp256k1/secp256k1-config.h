@@ -156,6 +156,7 @@
 #define USE_FIELD_INV_BUILTIN 1
 #define USE_SCALAR_INV_BUILTIN 1
 #define ENABLE_MODULE_RECOVERY 1
+#define ENABLE_MODULE_ECDH 1
 
 #ifdef __LP64__
 #define HAVE___INT128 1
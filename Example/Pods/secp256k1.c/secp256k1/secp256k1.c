@@ -588,6 +588,81 @@ int secp256k1_ec_pubkey_combine(const secp256k1_context* ctx, secp256k1_pubkey *
     return 1;
 }
 
+size_t secp256k1_ec_pubkey_multi_mul_scratch_size(const secp256k1_context* ctx, size_t n) {
+    size_t n_batch_points = n > ECMULT_MAX_POINTS_PER_BATCH ? ECMULT_MAX_POINTS_PER_BATCH : n;
+    size_t pippenger_size;
+    size_t strauss_size;
+    VERIFY_CHECK(ctx != NULL);
+    (void)ctx;
+
+    /* secp256k1_ecmult_multi_var always checks that at least one pippenger
+     * point fits, then runs pippenger above the threshold and strauss below it.
+     * One extra ALIGNMENT keeps secp256k1_scratch_max_allocation strictly
+     * positive. */
+    pippenger_size = secp256k1_pippenger_scratch_size(n_batch_points, secp256k1_pippenger_bucket_window(n_batch_points)) + (PIPPENGER_SCRATCH_OBJECTS + 1) * ALIGNMENT;
+    if (n_batch_points >= ECMULT_PIPPENGER_THRESHOLD) {
+        return pippenger_size;
+    }
+    strauss_size = secp256k1_strauss_scratch_size(n_batch_points) + (STRAUSS_SCRATCH_OBJECTS + 1) * ALIGNMENT;
+    return strauss_size > pippenger_size ? strauss_size : pippenger_size;
+}
+
+typedef struct {
+    const secp256k1_context *ctx;
+    const secp256k1_pubkey * const *pubkeys;
+    const unsigned char * const *scalars32;
+} secp256k1_ec_pubkey_multi_mul_data;
+
+static int secp256k1_ec_pubkey_multi_mul_callback(secp256k1_scalar *sc, secp256k1_ge *pt, size_t idx, void *data) {
+    const secp256k1_ec_pubkey_multi_mul_data *d = (const secp256k1_ec_pubkey_multi_mul_data *)data;
+    int overflow = 0;
+
+    secp256k1_scalar_set_b32(sc, d->scalars32[idx], &overflow);
+    if (overflow) {
+        return 0;
+    }
+    return secp256k1_pubkey_load(d->ctx, pt, d->pubkeys[idx]);
+}
+
+int secp256k1_ec_pubkey_multi_mul(const secp256k1_context* ctx, secp256k1_scratch_space *scratch, secp256k1_pubkey *out, const unsigned char *gscalar32, const secp256k1_pubkey * const *pubkeys, const unsigned char * const *scalars32, size_t n) {
+    secp256k1_ec_pubkey_multi_mul_data data;
+    secp256k1_scalar gsc;
+    secp256k1_gej rj;
+    secp256k1_ge r;
+    int overflow = 0;
+    int ret;
+
+    VERIFY_CHECK(ctx != NULL);
+    ARG_CHECK(out != NULL);
+    memset(out, 0, sizeof(*out));
+    ARG_CHECK(secp256k1_ecmult_context_is_built(&ctx->ecmult_ctx));
+    ARG_CHECK(scratch != NULL);
+    ARG_CHECK(n == 0 || pubkeys != NULL);
+    ARG_CHECK(n == 0 || scalars32 != NULL);
+    ARG_CHECK(gscalar32 != NULL || n >= 1);
+
+    if (gscalar32 != NULL) {
+        secp256k1_scalar_set_b32(&gsc, gscalar32, &overflow);
+        if (overflow) {
+            return 0;
+        }
+    }
+
+    data.ctx = ctx;
+    data.pubkeys = pubkeys;
+    data.scalars32 = scalars32;
+    ret = secp256k1_ecmult_multi_var(&ctx->ecmult_ctx, scratch, &rj, gscalar32 != NULL ? &gsc : NULL, secp256k1_ec_pubkey_multi_mul_callback, &data, n);
+    if (gscalar32 != NULL) {
+        secp256k1_scalar_clear(&gsc);
+    }
+    if (!ret || secp256k1_gej_is_infinity(&rj)) {
+        return 0;
+    }
+    secp256k1_ge_set_gej(&r, &rj);
+    secp256k1_pubkey_save(out, &r);
+    return 1;
+}
+
 #ifdef ENABLE_MODULE_ECDH
 # include "ecdh_impl.h"
 #endif